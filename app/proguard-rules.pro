@@ -10,6 +10,7 @@
 -keep class com.nova.companion.inference.LlamaJNI { *; }
 -keep class com.nova.companion.voice.WhisperJNI { *; }
 -keep class com.nova.companion.voice.PiperJNI { *; }
+-keep class com.nova.companion.voice.AudioFrontendJNI { *; }
 
 # ── JNI callback interfaces (called from native code) ─────────────────
 -keep class com.nova.companion.voice.WhisperSegmentCallback { *; }
@@ -0,0 +1,50 @@
+/**
+ * Automatic gain control — see agc.h.
+ */
+
+#include "agc.h"
+
+#include "audio_simd.h"
+
+#include <algorithm>
+#include <cmath>
+
+static constexpr float ATTACK_MS = 50.0f;
+static constexpr float RELEASE_MS = 1500.0f;
+// Hops quieter than this (-54 dBFS) never raise the gain
+static constexpr float MIN_ACTIVE_RMS = 0.002f;
+
+static float smoothing(float timeMs, int sampleRate, int hop) {
+    return 1.0f - std::exp(-(float) hop * 1000.0f / (timeMs * (float) sampleRate));
+}
+
+Agc::Agc(int sampleRate, int hop)
+    : m_attack(smoothing(ATTACK_MS, sampleRate, hop)),
+      m_release(smoothing(RELEASE_MS, sampleRate, hop)) {}
+
+void Agc::reset() {
+    m_gainDb = 0.0f;
+    m_gain = 1.0f;
+}
+
+void Agc::process(float *hop, int n, bool active) {
+    if (n <= 0) return;
+
+    const float rms = std::sqrt(simd::dot(hop, hop, n) / (float) n);
+    if (active && rms > MIN_ACTIVE_RMS) {
+        const float desired = std::min(std::max(TARGET_RMS / rms, MIN_GAIN), MAX_GAIN);
+        const float desiredDb = 20.0f * std::log10(desired);
+        const float rate = desiredDb < m_gainDb ? m_attack : m_release;
+        m_gainDb += rate * (desiredDb - m_gainDb);
+    }
+
+    // Never push this hop's peak into clipping, whatever the tracked gain
+    float target = std::pow(10.0f, m_gainDb / 20.0f);
+    const float peak = simd::abs_max(hop, n);
+    if (peak * target > PEAK_LIMIT) target = PEAK_LIMIT / peak;
+
+    // Ramp from the previous gain unless that alone would clip
+    const float start = peak * m_gain > PEAK_LIMIT ? target : m_gain;
+    simd::gain_ramp(hop, n, start, target);
+    m_gain = target;
+}
@@ -0,0 +1,34 @@
+/**
+ * Automatic gain control for the voice front end — the native replacement
+ * for AudioRecorder's streaming gain and the platform AutomaticGainControl.
+ *
+ * Tracks the hop RMS towards a fixed speech level in the dB domain, fast
+ * when turning down (attack) and slow when turning up (release), and only
+ * adapts on hops flagged as active so pauses don't pump the noise up. Gain
+ * changes are ramped across the hop and the result never clips.
+ */
+
+#pragma once
+
+class Agc {
+public:
+    static constexpr float TARGET_RMS = 0.1f;   // -20 dBFS
+    static constexpr float MIN_GAIN = 0.1f;     // same range as AudioRecorder
+    static constexpr float MAX_GAIN = 10.0f;
+    static constexpr float PEAK_LIMIT = 0.99f;
+
+    explicit Agc(int sampleRate = 16000, int hop = 160);
+
+    // Apply gain to one hop in place. Only active hops move the target gain.
+    void process(float *hop, int n, bool active);
+
+    float gain() const { return m_gain; }
+
+    void reset();
+
+private:
+    float m_attack;    // per-hop smoothing when lowering the gain
+    float m_release;   // per-hop smoothing when raising it
+    float m_gainDb = 0.0f;
+    float m_gain = 1.0f;
+};
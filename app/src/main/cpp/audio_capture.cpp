@@ -0,0 +1,74 @@
+/**
+ * AAudio microphone capture — see audio_capture.h.
+ */
+
+#include "audio_capture.h"
+
+#include <aaudio/AAudio.h>
+#include <android/log.h>
+
+#define LOG_TAG "NovaCapture"
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+
+bool AudioCapture::open(int sampleRate) {
+    close();
+
+    AAudioStreamBuilder *builder = nullptr;
+    aaudio_result_t result = AAudio_createStreamBuilder(&builder);
+    if (result != AAUDIO_OK) {
+        LOGE("AAudio_createStreamBuilder failed: %s", AAudio_convertResultToText(result));
+        return false;
+    }
+
+    AAudioStreamBuilder_setDirection(builder, AAUDIO_DIRECTION_INPUT);
+    AAudioStreamBuilder_setSampleRate(builder, sampleRate);
+    AAudioStreamBuilder_setChannelCount(builder, 1);
+    AAudioStreamBuilder_setFormat(builder, AAUDIO_FORMAT_PCM_I16);
+    AAudioStreamBuilder_setSharingMode(builder, AAUDIO_SHARING_MODE_SHARED);
+    AAudioStreamBuilder_setPerformanceMode(builder, AAUDIO_PERFORMANCE_MODE_POWER_SAVING);
+    if (__builtin_available(android 28, *)) {
+        // Same tuning as AudioRecord's VOICE_RECOGNITION source
+        AAudioStreamBuilder_setInputPreset(builder, AAUDIO_INPUT_PRESET_VOICE_RECOGNITION);
+    }
+
+    AAudioStream *stream = nullptr;
+    result = AAudioStreamBuilder_openStream(builder, &stream);
+    AAudioStreamBuilder_delete(builder);
+    if (result != AAUDIO_OK) {
+        LOGE("Failed to open input stream: %s", AAudio_convertResultToText(result));
+        return false;
+    }
+
+    const int32_t actualRate = AAudioStream_getSampleRate(stream);
+    if (actualRate != sampleRate) {
+        LOGE("Input stream opened at %d Hz, need %d Hz", actualRate, sampleRate);
+        AAudioStream_close(stream);
+        return false;
+    }
+
+    result = AAudioStream_requestStart(stream);
+    if (result != AAUDIO_OK) {
+        LOGE("Failed to start input stream: %s", AAudio_convertResultToText(result));
+        AAudioStream_close(stream);
+        return false;
+    }
+
+    m_stream = stream;
+    LOGI("Capture started (%d Hz mono, burst=%d frames)", actualRate,
+         AAudioStream_getFramesPerBurst(stream));
+    return true;
+}
+
+void AudioCapture::close() {
+    if (!m_stream) return;
+    AAudioStream_requestStop(m_stream);
+    AAudioStream_close(m_stream);
+    m_stream = nullptr;
+    LOGI("Capture stopped");
+}
+
+int AudioCapture::read(int16_t *out, int frames, int64_t timeoutNanos) {
+    if (!m_stream) return AAUDIO_ERROR_INVALID_STATE;
+    return AAudioStream_read(m_stream, out, frames, timeoutNanos);
+}
@@ -0,0 +1,31 @@
+/**
+ * Microphone capture via AAudio — 16 kHz mono int16, voice recognition
+ * preset, power-saving performance mode. Read with blocking calls from the
+ * front-end worker thread; there is no realtime callback to keep lean.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+struct AAudioStreamStruct;
+
+class AudioCapture {
+public:
+    AudioCapture() = default;
+    ~AudioCapture() { close(); }
+    AudioCapture(const AudioCapture &) = delete;
+    AudioCapture &operator=(const AudioCapture &) = delete;
+
+    bool open(int sampleRate);
+    void close();
+    bool isOpen() const { return m_stream != nullptr; }
+
+    // Blocking read of up to `frames` samples. Returns frames read (0 on
+    // timeout) or a negative AAudio error — e.g. when the device was
+    // disconnected and the stream must be reopened.
+    int read(int16_t *out, int frames, int64_t timeoutNanos);
+
+private:
+    AAudioStreamStruct *m_stream = nullptr;
+};
@@ -0,0 +1,320 @@
+/**
+ * Streaming audio file readers — see audio_file.h.
+ */
+
+#include "audio_file.h"
+
+#include <android/log.h>
+#include <media/NdkMediaCodec.h>
+#include <media/NdkMediaExtractor.h>
+#include <media/NdkMediaFormat.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <fcntl.h>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+#define LOG_TAG "AudioFile"
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+
+// Frames converted per fread
+static constexpr int READ_BLOCK_FRAMES = 4096;
+static constexpr int64_t CODEC_TIMEOUT_US = 10000;
+static constexpr int RAW_PCM_RATE = 16000;
+
+static uint32_t le32(const uint8_t *p) {
+    return (uint32_t) p[0] | ((uint32_t) p[1] << 8) | ((uint32_t) p[2] << 16) | ((uint32_t) p[3] << 24);
+}
+
+static uint16_t le16(const uint8_t *p) {
+    return (uint16_t) (p[0] | (p[1] << 8));
+}
+
+static bool has_extension(const char *path, const char *ext) {
+    const size_t n = strlen(path), e = strlen(ext);
+    return n >= e && strcasecmp(path + n - e, ext) == 0;
+}
+
+// ════════════════════════════════════════════════════════════════
+// WAV / raw PCM
+// ════════════════════════════════════════════════════════════════
+
+class PcmFileReader : public AudioFileReader {
+public:
+    enum Encoding { INT, FLOAT };
+
+    PcmFileReader(FILE *file, int rate, int channels, int bytesPerSample, Encoding encoding,
+                  int64_t dataBytes, const char *format)
+        : m_file(file), m_rate(rate), m_channels(channels), m_bytes(bytesPerSample),
+          m_encoding(encoding), m_remaining(dataBytes), m_format(format),
+          m_block((size_t) READ_BLOCK_FRAMES * channels * bytesPerSample) {}
+
+    ~PcmFileReader() override { fclose(m_file); }
+
+    int sampleRate() const override { return m_rate; }
+    const char *format() const override { return m_format; }
+
+    int read(float *out, int maxFrames) override {
+        const int frameBytes = m_channels * m_bytes;
+        int frames = std::min(maxFrames, READ_BLOCK_FRAMES);
+        if (m_remaining >= 0) frames = (int) std::min<int64_t>(frames, m_remaining / frameBytes);
+        if (frames <= 0) return 0;
+
+        const size_t got = fread(m_block.data(), (size_t) frameBytes, (size_t) frames, m_file);
+        if (got == 0) return ferror(m_file) ? -1 : 0;
+        if (m_remaining >= 0) m_remaining -= (int64_t) got * frameBytes;
+
+        const uint8_t *p = m_block.data();
+        const float norm = 1.0f / (float) m_channels;
+        for (size_t f = 0; f < got; f++) {
+            float sum = 0.0f;
+            for (int c = 0; c < m_channels; c++, p += m_bytes) sum += sample(p);
+            out[f] = sum * norm;
+        }
+        return (int) got;
+    }
+
+private:
+    float sample(const uint8_t *p) const {
+        if (m_encoding == FLOAT) {
+            float v;
+            memcpy(&v, p, sizeof(v));
+            return v;
+        }
+        switch (m_bytes) {
+            case 1: return ((float) p[0] - 128.0f) / 128.0f;   // 8-bit WAV is unsigned
+            case 2: return (float) (int16_t) le16(p) / 32768.0f;
+            case 3: return (float) ((int32_t) ((uint32_t) p[0] << 8 | (uint32_t) p[1] << 16 | (uint32_t) p[2] << 24) >> 8) / 8388608.0f;
+            default: return (float) (int32_t) le32(p) / 2147483648.0f;
+        }
+    }
+
+    FILE *m_file;
+    int m_rate;
+    int m_channels;
+    int m_bytes;
+    Encoding m_encoding;
+    int64_t m_remaining;   // data bytes left, -1 if unknown (read to EOF)
+    const char *m_format;
+    std::vector<uint8_t> m_block;
+};
+
+// Walk the RIFF chunks up to "data"; null if this isn't a WAV we can read
+static std::unique_ptr<AudioFileReader> open_wav(FILE *file) {
+    uint8_t header[12];
+    if (fread(header, 1, 12, file) != 12 || memcmp(header, "RIFF", 4) != 0 || memcmp(header + 8, "WAVE", 4) != 0) {
+        return nullptr;
+    }
+
+    int rate = 0, channels = 0, bits = 0;
+    uint16_t tag = 0;
+    uint8_t chunk[8];
+    while (fread(chunk, 1, 8, file) == 8) {
+        const uint32_t size = le32(chunk + 4);
+        if (memcmp(chunk, "fmt ", 4) == 0) {
+            uint8_t fmt[40] = {};
+            const size_t n = std::min<size_t>(size, sizeof(fmt));
+            if (size < 16 || fread(fmt, 1, n, file) != n) return nullptr;
+            tag = le16(fmt);
+            channels = le16(fmt + 2);
+            rate = (int) le32(fmt + 4);
+            bits = le16(fmt + 14);
+            if (tag == 0xFFFE && n >= 26) tag = le16(fmt + 24);  // EXTENSIBLE: subformat GUID
+            if (fseek(file, (long) (size - n + (size & 1)), SEEK_CUR) != 0) return nullptr;
+        } else if (memcmp(chunk, "data", 4) == 0) {
+            const bool isFloat = tag == 3 && bits == 32;
+            const bool isInt = tag == 1 && (bits == 8 || bits == 16 || bits == 24 || bits == 32);
+            if (rate <= 0 || channels <= 0 || (!isFloat && !isInt)) {
+                LOGE("Unsupported WAV: format %u, %d bits, %d ch, %d Hz", tag, bits, channels, rate);
+                return nullptr;
+            }
+            // Streaming writers leave 0 or 0xFFFFFFFF when the length is unknown
+            const int64_t dataBytes = (size == 0 || size == 0xFFFFFFFFu) ? -1 : (int64_t) size;
+            return std::make_unique<PcmFileReader>(file, rate, channels, bits / 8,
+                                                   isFloat ? PcmFileReader::FLOAT : PcmFileReader::INT,
+                                                   dataBytes, "wav");
+        } else if (fseek(file, (long) (size + (size & 1)), SEEK_CUR) != 0) {
+            return nullptr;
+        }
+    }
+    return nullptr;
+}
+
+// ════════════════════════════════════════════════════════════════
+// Platform codecs (OGG/Opus, M4A, MP3, ...)
+// ════════════════════════════════════════════════════════════════
+
+class MediaCodecReader : public AudioFileReader {
+public:
+    ~MediaCodecReader() override {
+        if (m_codec) {
+            AMediaCodec_stop(m_codec);
+            AMediaCodec_delete(m_codec);
+        }
+        if (m_extractor) AMediaExtractor_delete(m_extractor);
+        if (m_fd >= 0) close(m_fd);
+    }
+
+    bool open(const char *path) {
+        m_fd = ::open(path, O_RDONLY | O_CLOEXEC);
+        struct stat st {};
+        if (m_fd < 0 || fstat(m_fd, &st) != 0) return false;
+
+        m_extractor = AMediaExtractor_new();
+        if (AMediaExtractor_setDataSourceFd(m_extractor, m_fd, 0, st.st_size) != AMEDIA_OK) return false;
+
+        const size_t tracks = AMediaExtractor_getTrackCount(m_extractor);
+        for (size_t i = 0; i < tracks && !m_codec; i++) {
+            AMediaFormat *format = AMediaExtractor_getTrackFormat(m_extractor, i);
+            const char *mime = nullptr;
+            if (AMediaFormat_getString(format, AMEDIAFORMAT_KEY_MIME, &mime) && strncmp(mime, "audio/", 6) == 0) {
+                m_mime = mime;
+                AMediaFormat_getInt32(format, AMEDIAFORMAT_KEY_SAMPLE_RATE, &m_rate);
+                AMediaFormat_getInt32(format, AMEDIAFORMAT_KEY_CHANNEL_COUNT, &m_channels);
+                AMediaExtractor_selectTrack(m_extractor, i);
+                m_codec = AMediaCodec_createDecoderByType(mime);
+                if (m_codec && (AMediaCodec_configure(m_codec, format, nullptr, nullptr, 0) != AMEDIA_OK ||
+                                AMediaCodec_start(m_codec) != AMEDIA_OK)) {
+                    AMediaCodec_delete(m_codec);
+                    m_codec = nullptr;
+                }
+            }
+            AMediaFormat_delete(format);
+        }
+        if (!m_codec) return false;
+
+        // Decode up to the first output so the real output rate is known
+        while (m_pending.empty() && !m_outputDone) {
+            if (!pump()) return false;
+        }
+        return m_rate > 0 && m_channels > 0;
+    }
+
+    int sampleRate() const override { return m_rate; }
+    const char *format() const override { return m_mime.c_str(); }
+
+    int read(float *out, int maxFrames) override {
+        while (m_pending.empty() && !m_outputDone) {
+            if (!pump()) return -1;
+        }
+        const int n = (int) std::min<size_t>((size_t) maxFrames, m_pending.size());
+        std::copy(m_pending.begin(), m_pending.begin() + n, out);
+        m_pending.erase(m_pending.begin(), m_pending.begin() + n);
+        return n;
+    }
+
+private:
+    // Feed one input buffer and drain one output buffer; false on codec error
+    bool pump() {
+        if (!m_inputDone) {
+            const ssize_t in = AMediaCodec_dequeueInputBuffer(m_codec, CODEC_TIMEOUT_US);
+            if (in >= 0) {
+                size_t capacity = 0;
+                uint8_t *buf = AMediaCodec_getInputBuffer(m_codec, (size_t) in, &capacity);
+                const ssize_t n = AMediaExtractor_readSampleData(m_extractor, buf, capacity);
+                if (n < 0) {
+                    AMediaCodec_queueInputBuffer(m_codec, (size_t) in, 0, 0, 0,
+                                                 AMEDIACODEC_BUFFER_FLAG_END_OF_STREAM);
+                    m_inputDone = true;
+                } else {
+                    const int64_t pts = AMediaExtractor_getSampleTime(m_extractor);
+                    AMediaCodec_queueInputBuffer(m_codec, (size_t) in, 0, (size_t) n, (uint64_t) pts, 0);
+                    AMediaExtractor_advance(m_extractor);
+                }
+            }
+        }
+
+        AMediaCodecBufferInfo info;
+        const ssize_t out = AMediaCodec_dequeueOutputBuffer(m_codec, &info, CODEC_TIMEOUT_US);
+        if (out >= 0) {
+            size_t size = 0;
+            uint8_t *buf = AMediaCodec_getOutputBuffer(m_codec, (size_t) out, &size);
+            if (buf && info.size > 0) append(buf + info.offset, (size_t) info.size);
+            AMediaCodec_releaseOutputBuffer(m_codec, (size_t) out, false);
+            if (info.flags & AMEDIACODEC_BUFFER_FLAG_END_OF_STREAM) m_outputDone = true;
+        } else if (out == AMEDIACODEC_INFO_OUTPUT_FORMAT_CHANGED) {
+            AMediaFormat *format = AMediaCodec_getOutputFormat(m_codec);
+            AMediaFormat_getInt32(format, AMEDIAFORMAT_KEY_SAMPLE_RATE, &m_rate);
+            AMediaFormat_getInt32(format, AMEDIAFORMAT_KEY_CHANNEL_COUNT, &m_channels);
+            int32_t encoding = PCM_ENCODING_16BIT;
+            AMediaFormat_getInt32(format, "pcm-encoding", &encoding);
+            m_floatOutput = encoding == PCM_ENCODING_FLOAT;
+            AMediaFormat_delete(format);
+        } else if (out != AMEDIACODEC_INFO_TRY_AGAIN_LATER && out != AMEDIACODEC_INFO_OUTPUT_BUFFERS_CHANGED) {
+            LOGE("Decoder error %zd (%s)", out, m_mime.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    void append(const uint8_t *data, size_t bytes) {
+        const int channels = std::max(1, m_channels);
+        const float norm = 1.0f / (float) channels;
+        if (m_floatOutput) {
+            const size_t frames = bytes / (sizeof(float) * channels);
+            const auto *p = reinterpret_cast<const float *>(data);
+            for (size_t f = 0; f < frames; f++) {
+                float sum = 0.0f;
+                for (int c = 0; c < channels; c++) sum += *p++;
+                m_pending.push_back(sum * norm);
+            }
+        } else {
+            const size_t frames = bytes / (sizeof(int16_t) * channels);
+            const auto *p = reinterpret_cast<const int16_t *>(data);
+            for (size_t f = 0; f < frames; f++) {
+                float sum = 0.0f;
+                for (int c = 0; c < channels; c++) sum += *p++;
+                m_pending.push_back(sum * norm / 32768.0f);
+            }
+        }
+    }
+
+    // android.media.AudioFormat encodings
+    static constexpr int32_t PCM_ENCODING_16BIT = 2;
+    static constexpr int32_t PCM_ENCODING_FLOAT = 4;
+
+    int m_fd = -1;
+    AMediaExtractor *m_extractor = nullptr;
+    AMediaCodec *m_codec = nullptr;
+    std::string m_mime;
+    int32_t m_rate = 0;
+    int32_t m_channels = 0;
+    bool m_floatOutput = false;
+    bool m_inputDone = false;
+    bool m_outputDone = false;
+    std::deque<float> m_pending;   // decoded mono samples not read yet (one codec buffer)
+};
+
+// ════════════════════════════════════════════════════════════════
+// Factory
+// ════════════════════════════════════════════════════════════════
+
+std::unique_ptr<AudioFileReader> AudioFileReader::open(const char *path) {
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        LOGE("Cannot open %s", path);
+        return nullptr;
+    }
+
+    if (has_extension(path, ".pcm") || has_extension(path, ".raw")) {
+        return std::make_unique<PcmFileReader>(file, RAW_PCM_RATE, 1, 2, PcmFileReader::INT, -1, "pcm");
+    }
+
+    if (auto wav = open_wav(file)) return wav;
+    fclose(file);
+
+    auto codec = std::make_unique<MediaCodecReader>();
+    if (!codec->open(path)) {
+        LOGE("No decoder for %s", path);
+        return nullptr;
+    }
+    LOGI("Decoding %s with the platform codec (%d Hz)", codec->format(), codec->sampleRate());
+    return codec;
+}
@@ -0,0 +1,34 @@
+/**
+ * Streaming audio file readers for file transcription.
+ *
+ * Every reader hands out mono float blocks at the file's own sample rate,
+ * a few thousand frames at a time, so memory stays bounded whatever the file
+ * length. Formats:
+ *
+ *   WAV   RIFF/WAVE, PCM 8/16/24/32-bit or 32-bit float (incl. EXTENSIBLE)
+ *   PCM   headerless .pcm/.raw, assumed 16 kHz mono s16le
+ *   other anything the platform's MediaExtractor + MediaCodec can decode —
+ *         in practice OGG/Opus voice notes, M4A/AAC, MP3, AMR
+ *
+ * Channels are averaged down to mono.
+ */
+
+#pragma once
+
+#include <memory>
+
+class AudioFileReader {
+public:
+    virtual ~AudioFileReader() = default;
+
+    // Pick a reader by header / extension; null if the file can't be opened
+    static std::unique_ptr<AudioFileReader> open(const char *path);
+
+    virtual int sampleRate() const = 0;
+
+    // Read up to maxFrames mono frames; 0 at end of stream, -1 on error
+    virtual int read(float *out, int maxFrames) = 0;
+
+    // Short format name for logs ("wav", "pcm", "audio/opus", ...)
+    virtual const char *format() const = 0;
+};
@@ -0,0 +1,97 @@
+/**
+ * AAudio speaker output — see audio_playback.h.
+ */
+
+#include "audio_playback.h"
+
+#include <aaudio/AAudio.h>
+#include <android/log.h>
+
+#include <cstring>
+
+#define LOG_TAG "NovaPlayback"
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+
+int AudioPlayback::dataCallback(AAudioStream * /* stream */, void *user, void *audio, int32_t frames) {
+    auto *self = static_cast<AudioPlayback *>(user);
+    auto *out = static_cast<int16_t *>(audio);
+    if (self->m_flush.exchange(false)) self->m_fifo.clear();
+
+    const size_t got = self->m_fifo.read(out, (size_t) frames);
+    if (got < (size_t) frames) memset(out + got, 0, ((size_t) frames - got) * sizeof(int16_t));
+    self->m_played.fetch_add((int64_t) got, std::memory_order_release);
+    return AAUDIO_CALLBACK_RESULT_CONTINUE;
+}
+
+void AudioPlayback::errorCallback(AAudioStream * /* stream */, void *user, aaudio_result_t error) {
+    // Runs on an AAudio thread; the stream can't be closed from here
+    auto *self = static_cast<AudioPlayback *>(user);
+    self->m_disconnected.store(true);
+    LOGE("Output stream error: %s", AAudio_convertResultToText(error));
+}
+
+bool AudioPlayback::open() {
+    close();
+
+    AAudioStreamBuilder *builder = nullptr;
+    aaudio_result_t result = AAudio_createStreamBuilder(&builder);
+    if (result != AAUDIO_OK) {
+        LOGE("AAudio_createStreamBuilder failed: %s", AAudio_convertResultToText(result));
+        return false;
+    }
+
+    // No sample rate: the device's native one keeps the low-latency path
+    AAudioStreamBuilder_setDirection(builder, AAUDIO_DIRECTION_OUTPUT);
+    AAudioStreamBuilder_setChannelCount(builder, 1);
+    AAudioStreamBuilder_setFormat(builder, AAUDIO_FORMAT_PCM_I16);
+    AAudioStreamBuilder_setSharingMode(builder, AAUDIO_SHARING_MODE_SHARED);
+    AAudioStreamBuilder_setPerformanceMode(builder, AAUDIO_PERFORMANCE_MODE_LOW_LATENCY);
+    if (__builtin_available(android 28, *)) {
+        // Same attributes as PiperTTS's AudioTrack
+        AAudioStreamBuilder_setUsage(builder, AAUDIO_USAGE_MEDIA);
+        AAudioStreamBuilder_setContentType(builder, AAUDIO_CONTENT_TYPE_SPEECH);
+    }
+    AAudioStreamBuilder_setDataCallback(builder, dataCallback, this);
+    AAudioStreamBuilder_setErrorCallback(builder, errorCallback, this);
+
+    AAudioStream *stream = nullptr;
+    result = AAudioStreamBuilder_openStream(builder, &stream);
+    AAudioStreamBuilder_delete(builder);
+    if (result != AAUDIO_OK) {
+        LOGE("Failed to open output stream: %s", AAudio_convertResultToText(result));
+        return false;
+    }
+
+    m_fifo.clear();
+    m_flush.store(false);
+    m_disconnected.store(false);
+    m_played.store(0);
+    m_sampleRate.store(AAudioStream_getSampleRate(stream));
+
+    // Double buffering is enough once the callback never blocks
+    const int32_t burst = AAudioStream_getFramesPerBurst(stream);
+    AAudioStream_setBufferSizeInFrames(stream, burst * 2);
+
+    result = AAudioStream_requestStart(stream);
+    if (result != AAUDIO_OK) {
+        LOGE("Failed to start output stream: %s", AAudio_convertResultToText(result));
+        AAudioStream_close(stream);
+        return false;
+    }
+
+    m_stream.store(stream);
+    LOGI("Playback started (%d Hz mono, burst=%d frames, buffer=%d frames)", m_sampleRate.load(), burst,
+         AAudioStream_getBufferSizeInFrames(stream));
+    return true;
+}
+
+void AudioPlayback::close() {
+    // Cleared first, so a producer polling in write() gives up instead of
+    // waiting on a fifo nothing drains any more
+    AAudioStreamStruct *stream = m_stream.exchange(nullptr);
+    if (!stream) return;
+    AAudioStream_requestStop(stream);
+    AAudioStream_close(stream);
+    LOGI("Playback stopped");
+}
@@ -0,0 +1,76 @@
+/**
+ * Speaker output via AAudio for the native voice pipeline: mono int16 at
+ * the device's native rate, in low-latency mode, so the stream takes the
+ * fast mixer path.
+ *
+ * The data callback runs on AAudio's realtime thread. It only reads a
+ * lock-free SpscQueue, and any part of a burst the producer hasn't filled
+ * yet plays as silence. The producer side blocks by polling while the fifo
+ * is full, which caps how far synthesis runs ahead of the speaker.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+#include "spsc_queue.h"
+
+struct AAudioStreamStruct;
+
+class AudioPlayback {
+public:
+    explicit AudioPlayback(size_t fifoSamples) : m_fifo(fifoSamples) {}
+    ~AudioPlayback() { close(); }
+    AudioPlayback(const AudioPlayback &) = delete;
+    AudioPlayback &operator=(const AudioPlayback &) = delete;
+
+    bool open();
+    void close();
+    bool isOpen() const { return m_stream.load() != nullptr; }
+    // The device went away; close() and open() again between replies
+    bool disconnected() const { return m_disconnected.load(); }
+
+    // Read by the reply thread while the control thread may reopen the stream
+    int sampleRate() const { return m_sampleRate.load(); }
+
+    // Producer: queue n samples, polling while the fifo is full. Gives up
+    // (false) once keepGoing() returns false or the stream is closed.
+    template <typename KeepGoing>
+    bool write(const int16_t *pcm, size_t n, KeepGoing keepGoing) {
+        while (n > 0) {
+            if (!m_stream.load() || !keepGoing()) return false;
+            const size_t written = m_fifo.write(pcm, n);
+            pcm += written;
+            n -= written;
+            if (n > 0) std::this_thread::sleep_for(std::chrono::milliseconds(WRITE_POLL_MS));
+        }
+        return true;
+    }
+
+    // Drop everything not yet played. The callback does the actual clearing,
+    // so this is safe from any thread.
+    void flush() { m_flush.store(true); }
+
+    // Samples of real audio played since open (silence fill not counted)
+    int64_t playedSamples() const { return m_played.load(std::memory_order_acquire); }
+
+    // Nothing left to play
+    bool idle() const { return m_fifo.empty(); }
+
+private:
+    // Producer poll interval while the fifo is full (about one burst)
+    static constexpr int WRITE_POLL_MS = 5;
+
+    static int dataCallback(AAudioStreamStruct *stream, void *user, void *audio, int32_t frames);
+    static void errorCallback(AAudioStreamStruct *stream, void *user, int32_t error);
+
+    SpscQueue<int16_t> m_fifo;
+    std::atomic<bool> m_flush{false};
+    std::atomic<bool> m_disconnected{false};
+    std::atomic<int64_t> m_played{0};
+    std::atomic<AAudioStreamStruct *> m_stream{nullptr};   // polled by the producer in write()
+    std::atomic<int> m_sampleRate{0};
+};
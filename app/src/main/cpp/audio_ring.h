@@ -0,0 +1,73 @@
+/**
+ * Single-writer PCM history ring shared by the native audio consumers.
+ *
+ * The capture thread appends 16-bit mono samples; readers (wake word, VAD,
+ * utterance capture for whisper) address audio by absolute sample position,
+ * so a consumer can reach back in time — e.g. pre-roll before a wake word.
+ * Reads never block the writer: a reader that falls more than one capacity
+ * behind simply gets a failed read.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+class AudioRing {
+public:
+    // capacity is rounded up to a power of two
+    explicit AudioRing(size_t capacity) {
+        size_t cap = 1;
+        while (cap < capacity) cap <<= 1;
+        m_data.resize(cap);
+        m_mask = cap - 1;
+    }
+
+    size_t capacity() const { return m_data.size(); }
+
+    // Total samples ever written — the position one past the newest sample
+    int64_t writePos() const { return m_writePos.load(std::memory_order_acquire); }
+
+    // Oldest position that is still guaranteed readable
+    int64_t oldestPos() const {
+        const int64_t wp = writePos();
+        return wp > (int64_t) capacity() ? wp - (int64_t) capacity() : 0;
+    }
+
+    // Writer thread only
+    void write(const int16_t *samples, size_t n) {
+        const int64_t wp = m_writePos.load(std::memory_order_relaxed);
+        size_t offset = (size_t) wp & m_mask;
+        size_t first = std::min(n, capacity() - offset);
+        memcpy(m_data.data() + offset, samples, first * sizeof(int16_t));
+        if (first < n) {
+            memcpy(m_data.data(), samples + first, (n - first) * sizeof(int16_t));
+        }
+        m_writePos.store(wp + (int64_t) n, std::memory_order_release);
+    }
+
+    // Copy [from, from + n) into out. Returns false if that range isn't
+    // fully written yet or was overwritten while copying.
+    bool read(int64_t from, int16_t *out, size_t n) const {
+        const int64_t wp = writePos();
+        if (from < 0 || from + (int64_t) n > wp || from < wp - (int64_t) capacity()) {
+            return false;
+        }
+        size_t offset = (size_t) from & m_mask;
+        size_t first = std::min(n, capacity() - offset);
+        memcpy(out, m_data.data() + offset, first * sizeof(int16_t));
+        if (first < n) {
+            memcpy(out + first, m_data.data(), (n - first) * sizeof(int16_t));
+        }
+        // The writer may have lapped us during the copy
+        return from >= writePos() - (int64_t) capacity();
+    }
+
+private:
+    std::vector<int16_t> m_data;
+    size_t m_mask = 0;
+    std::atomic<int64_t> m_writePos{0};
+};
@@ -0,0 +1,428 @@
+/**
+ * Vector kernels for the audio front end — see audio_simd.h.
+ */
+
+#include "audio_simd.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define NOVA_SIMD_NEON 1
+#elif defined(__AVX2__)
+#include <immintrin.h>
+#define NOVA_SIMD_AVX2 1
+#endif
+
+namespace simd {
+
+static constexpr float NOISE_EPS = 1e-10f;
+
+static inline int16_t saturate_s16(float v) {
+    return (int16_t) lrintf(std::min(std::max(v, -32768.0f), 32767.0f));
+}
+
+static inline float wiener_bin(float power, float noise, float &clean, float alpha, float floor) {
+    const float n = std::max(noise, NOISE_EPS);
+    const float xi = alpha * clean / n + (1.0f - alpha) * std::max(power / n - 1.0f, 0.0f);
+    const float g = std::max(xi / (1.0f + xi), floor);
+    clean = g * g * power;
+    return g;
+}
+
+static inline float noise_bin(float power, float noise, float fall, float rise) {
+    return power < noise ? noise + fall * (power - noise) : std::max(noise * rise, NOISE_EPS);
+}
+
+#if defined(NOVA_SIMD_NEON)
+
+const char *isa() { return "neon"; }
+
+void mul(const float *a, const float *b, float *out, int n) {
+    int i = 0;
+    for (; i + 4 <= n; i += 4) vst1q_f32(out + i, vmulq_f32(vld1q_f32(a + i), vld1q_f32(b + i)));
+    for (; i < n; i++) out[i] = a[i] * b[i];
+}
+
+void power(const float *c, float *out, int n) {
+    int k = 0;
+    for (; k + 4 <= n; k += 4) {
+        const float32x4x2_t v = vld2q_f32(c + 2 * k);  // de-interleave re / im
+        vst1q_f32(out + k, vfmaq_f32(vmulq_f32(v.val[0], v.val[0]), v.val[1], v.val[1]));
+    }
+    for (; k < n; k++) out[k] = c[2 * k] * c[2 * k] + c[2 * k + 1] * c[2 * k + 1];
+}
+
+float dot(const float *a, const float *b, int n) {
+    float32x4_t acc = vdupq_n_f32(0.0f);
+    int i = 0;
+    for (; i + 4 <= n; i += 4) acc = vfmaq_f32(acc, vld1q_f32(a + i), vld1q_f32(b + i));
+    float sum = vaddvq_f32(acc);
+    for (; i < n; i++) sum += a[i] * b[i];
+    return sum;
+}
+
+float max(const float *a, size_t n) {
+    float32x4_t m = vdupq_n_f32(-FLT_MAX);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) m = vmaxq_f32(m, vld1q_f32(a + i));
+    float r = vmaxvq_f32(m);
+    for (; i < n; i++) r = std::max(r, a[i]);
+    return r;
+}
+
+void clamp_offset_scale(float *a, size_t n, float lo, float offset, float scale) {
+    const float32x4_t vlo = vdupq_n_f32(lo), voff = vdupq_n_f32(offset), vscale = vdupq_n_f32(scale);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        vst1q_f32(a + i, vmulq_f32(vaddq_f32(vmaxq_f32(vld1q_f32(a + i), vlo), voff), vscale));
+    }
+    for (; i < n; i++) a[i] = (std::max(a[i], lo) + offset) * scale;
+}
+
+void s16_to_f32(const int16_t *in, float *out, int n, float scale) {
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const int16x8_t s = vld1q_s16(in + i);
+        vst1q_f32(out + i, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(s))), scale));
+        vst1q_f32(out + i + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(s))), scale));
+    }
+    for (; i < n; i++) out[i] = in[i] * scale;
+}
+
+void f32_to_s16(const float *in, int16_t *out, int n, float scale) {
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        // vcvtn rounds to nearest and saturates; vqmovn saturates to int16
+        const int32x4_t lo = vcvtnq_s32_f32(vmulq_n_f32(vld1q_f32(in + i), scale));
+        const int32x4_t hi = vcvtnq_s32_f32(vmulq_n_f32(vld1q_f32(in + i + 4), scale));
+        vst1q_s16(out + i, vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi)));
+    }
+    for (; i < n; i++) out[i] = saturate_s16(in[i] * scale);
+}
+
+void mul_add(const float *a, const float *b, float *acc, int n) {
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        vst1q_f32(acc + i, vfmaq_f32(vld1q_f32(acc + i), vld1q_f32(a + i), vld1q_f32(b + i)));
+    }
+    for (; i < n; i++) acc[i] += a[i] * b[i];
+}
+
+float abs_max(const float *a, int n) {
+    float32x4_t m = vdupq_n_f32(0.0f);
+    int i = 0;
+    for (; i + 4 <= n; i += 4) m = vmaxq_f32(m, vabsq_f32(vld1q_f32(a + i)));
+    float r = vmaxvq_f32(m);
+    for (; i < n; i++) r = std::max(r, std::fabs(a[i]));
+    return r;
+}
+
+void gain_ramp(float *a, int n, float g0, float g1) {
+    if (n <= 0) return;
+    const float step = (g1 - g0) / n;
+    const float32x4_t one = vdupq_n_f32(1.0f), minusOne = vdupq_n_f32(-1.0f);
+    const float32x4_t vstep = vdupq_n_f32(4.0f * step);
+    const float lanes[4] = {g0 + step, g0 + 2.0f * step, g0 + 3.0f * step, g0 + 4.0f * step};
+    float32x4_t g = vld1q_f32(lanes);
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const float32x4_t v = vmulq_f32(vld1q_f32(a + i), g);
+        vst1q_f32(a + i, vminq_f32(vmaxq_f32(v, minusOne), one));
+        g = vaddq_f32(g, vstep);
+    }
+    for (; i < n; i++) a[i] = std::min(std::max(a[i] * (g0 + step * (i + 1)), -1.0f), 1.0f);
+}
+
+void scale_complex(float *c, const float *gain, int n) {
+    int k = 0;
+    for (; k + 4 <= n; k += 4) {
+        float32x4x2_t v = vld2q_f32(c + 2 * k);
+        const float32x4_t g = vld1q_f32(gain + k);
+        v.val[0] = vmulq_f32(v.val[0], g);
+        v.val[1] = vmulq_f32(v.val[1], g);
+        vst2q_f32(c + 2 * k, v);
+    }
+    for (; k < n; k++) {
+        c[2 * k] *= gain[k];
+        c[2 * k + 1] *= gain[k];
+    }
+}
+
+void noise_update(const float *power, float *noise, int n, float fall, float rise) {
+    const float32x4_t vfall = vdupq_n_f32(fall), vrise = vdupq_n_f32(rise), eps = vdupq_n_f32(NOISE_EPS);
+    int k = 0;
+    for (; k + 4 <= n; k += 4) {
+        const float32x4_t p = vld1q_f32(power + k), nz = vld1q_f32(noise + k);
+        const float32x4_t down = vfmaq_f32(nz, vsubq_f32(p, nz), vfall);
+        const float32x4_t up = vmaxq_f32(vmulq_f32(nz, vrise), eps);
+        vst1q_f32(noise + k, vbslq_f32(vcltq_f32(p, nz), down, up));
+    }
+    for (; k < n; k++) noise[k] = noise_bin(power[k], noise[k], fall, rise);
+}
+
+void wiener_gain(const float *power, const float *noise, float *clean, float *gain,
+                 int n, float noiseScale, float alpha, float floor) {
+    const float32x4_t valpha = vdupq_n_f32(alpha), vbeta = vdupq_n_f32(1.0f - alpha);
+    const float32x4_t one = vdupq_n_f32(1.0f), zero = vdupq_n_f32(0.0f);
+    const float32x4_t vfloor = vdupq_n_f32(floor), eps = vdupq_n_f32(NOISE_EPS);
+    const float32x4_t vscale = vdupq_n_f32(noiseScale);
+    int k = 0;
+    for (; k + 4 <= n; k += 4) {
+        const float32x4_t p = vld1q_f32(power + k);
+        const float32x4_t nz = vmaxq_f32(vmulq_f32(vld1q_f32(noise + k), vscale), eps);
+        const float32x4_t post = vmaxq_f32(vsubq_f32(vdivq_f32(p, nz), one), zero);
+        const float32x4_t xi = vfmaq_f32(vmulq_f32(vbeta, post), valpha, vdivq_f32(vld1q_f32(clean + k), nz));
+        const float32x4_t g = vmaxq_f32(vdivq_f32(xi, vaddq_f32(one, xi)), vfloor);
+        vst1q_f32(gain + k, g);
+        vst1q_f32(clean + k, vmulq_f32(vmulq_f32(g, g), p));
+    }
+    for (; k < n; k++) gain[k] = wiener_bin(power[k], noise[k] * noiseScale, clean[k], alpha, floor);
+}
+
+#elif defined(NOVA_SIMD_AVX2)
+
+const char *isa() { return "avx2"; }
+
+static inline float hsum(__m256 v) {
+    __m128 s = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    s = _mm_add_ss(s, _mm_movehdup_ps(s));
+    return _mm_cvtss_f32(s);
+}
+
+void mul(const float *a, const float *b, float *out, int n) {
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+    }
+    for (; i < n; i++) out[i] = a[i] * b[i];
+}
+
+void power(const float *c, float *out, int n) {
+    int k = 0;
+    for (; k + 8 <= n; k += 8) {
+        // squares of [re0 im0 re1 im1 ...], then pairwise add
+        const __m256 lo = _mm256_loadu_ps(c + 2 * k);
+        const __m256 hi = _mm256_loadu_ps(c + 2 * k + 8);
+        const __m256 sum = _mm256_hadd_ps(_mm256_mul_ps(lo, lo), _mm256_mul_ps(hi, hi));
+        // hadd works per 128-bit lane: fix the lane order
+        _mm256_storeu_ps(out + k, _mm256_castpd_ps(
+                _mm256_permute4x64_pd(_mm256_castps_pd(sum), 0xD8)));
+    }
+    for (; k < n; k++) out[k] = c[2 * k] * c[2 * k] + c[2 * k + 1] * c[2 * k + 1];
+}
+
+float dot(const float *a, const float *b, int n) {
+    __m256 acc = _mm256_setzero_ps();
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+    }
+    float sum = hsum(acc);
+    for (; i < n; i++) sum += a[i] * b[i];
+    return sum;
+}
+
+float max(const float *a, size_t n) {
+    __m256 m = _mm256_set1_ps(-FLT_MAX);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) m = _mm256_max_ps(m, _mm256_loadu_ps(a + i));
+    alignas(32) float lanes[8];
+    _mm256_store_ps(lanes, m);
+    float r = lanes[0];
+    for (int j = 1; j < 8; j++) r = std::max(r, lanes[j]);
+    for (; i < n; i++) r = std::max(r, a[i]);
+    return r;
+}
+
+void clamp_offset_scale(float *a, size_t n, float lo, float offset, float scale) {
+    const __m256 vlo = _mm256_set1_ps(lo), voff = _mm256_set1_ps(offset), vscale = _mm256_set1_ps(scale);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_ps(a + i, _mm256_mul_ps(
+                _mm256_add_ps(_mm256_max_ps(_mm256_loadu_ps(a + i), vlo), voff), vscale));
+    }
+    for (; i < n; i++) a[i] = (std::max(a[i], lo) + offset) * scale;
+}
+
+void s16_to_f32(const int16_t *in, float *out, int n, float scale) {
+    const __m256 vscale = _mm256_set1_ps(scale);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m256i s = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *) (in + i)));
+        _mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_cvtepi32_ps(s), vscale));
+    }
+    for (; i < n; i++) out[i] = in[i] * scale;
+}
+
+void f32_to_s16(const float *in, int16_t *out, int n, float scale) {
+    const __m256 vscale = _mm256_set1_ps(scale);
+    const __m256 lo = _mm256_set1_ps(-32768.0f), hi = _mm256_set1_ps(32767.0f);
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const __m256 a = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(in + i), vscale), lo), hi);
+        const __m256 b = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(in + i + 8), vscale), lo), hi);
+        // packs interleaves 128-bit lanes: restore sample order
+        const __m256i packed = _mm256_packs_epi32(_mm256_cvtps_epi32(a), _mm256_cvtps_epi32(b));
+        _mm256_storeu_si256((__m256i *) (out + i), _mm256_permute4x64_epi64(packed, 0xD8));
+    }
+    for (; i < n; i++) out[i] = saturate_s16(in[i] * scale);
+}
+
+void mul_add(const float *a, const float *b, float *acc, int n) {
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m256 p = _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i));
+        _mm256_storeu_ps(acc + i, _mm256_add_ps(_mm256_loadu_ps(acc + i), p));
+    }
+    for (; i < n; i++) acc[i] += a[i] * b[i];
+}
+
+float abs_max(const float *a, int n) {
+    const __m256 signMask = _mm256_set1_ps(-0.0f);
+    __m256 m = _mm256_setzero_ps();
+    int i = 0;
+    for (; i + 8 <= n; i += 8) m = _mm256_max_ps(m, _mm256_andnot_ps(signMask, _mm256_loadu_ps(a + i)));
+    alignas(32) float lanes[8];
+    _mm256_store_ps(lanes, m);
+    float r = 0.0f;
+    for (int j = 0; j < 8; j++) r = std::max(r, lanes[j]);
+    for (; i < n; i++) r = std::max(r, std::fabs(a[i]));
+    return r;
+}
+
+void gain_ramp(float *a, int n, float g0, float g1) {
+    if (n <= 0) return;
+    const float step = (g1 - g0) / n;
+    const __m256 one = _mm256_set1_ps(1.0f), minusOne = _mm256_set1_ps(-1.0f);
+    const __m256 vstep = _mm256_set1_ps(8.0f * step);
+    __m256 g = _mm256_add_ps(_mm256_set1_ps(g0),
+                             _mm256_mul_ps(_mm256_set_ps(8, 7, 6, 5, 4, 3, 2, 1), _mm256_set1_ps(step)));
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m256 v = _mm256_mul_ps(_mm256_loadu_ps(a + i), g);
+        _mm256_storeu_ps(a + i, _mm256_min_ps(_mm256_max_ps(v, minusOne), one));
+        g = _mm256_add_ps(g, vstep);
+    }
+    for (; i < n; i++) a[i] = std::min(std::max(a[i] * (g0 + step * (i + 1)), -1.0f), 1.0f);
+}
+
+void scale_complex(float *c, const float *gain, int n) {
+    const __m256i dup = _mm256_set_epi32(3, 3, 2, 2, 1, 1, 0, 0);
+    int k = 0;
+    for (; k + 4 <= n; k += 4) {
+        const __m256 g = _mm256_permutevar8x32_ps(_mm256_castps128_ps256(_mm_loadu_ps(gain + k)), dup);
+        _mm256_storeu_ps(c + 2 * k, _mm256_mul_ps(_mm256_loadu_ps(c + 2 * k), g));
+    }
+    for (; k < n; k++) {
+        c[2 * k] *= gain[k];
+        c[2 * k + 1] *= gain[k];
+    }
+}
+
+void noise_update(const float *power, float *noise, int n, float fall, float rise) {
+    const __m256 vfall = _mm256_set1_ps(fall), vrise = _mm256_set1_ps(rise), eps = _mm256_set1_ps(NOISE_EPS);
+    int k = 0;
+    for (; k + 8 <= n; k += 8) {
+        const __m256 p = _mm256_loadu_ps(power + k), nz = _mm256_loadu_ps(noise + k);
+        const __m256 down = _mm256_add_ps(nz, _mm256_mul_ps(_mm256_sub_ps(p, nz), vfall));
+        const __m256 up = _mm256_max_ps(_mm256_mul_ps(nz, vrise), eps);
+        _mm256_storeu_ps(noise + k, _mm256_blendv_ps(up, down, _mm256_cmp_ps(p, nz, _CMP_LT_OQ)));
+    }
+    for (; k < n; k++) noise[k] = noise_bin(power[k], noise[k], fall, rise);
+}
+
+void wiener_gain(const float *power, const float *noise, float *clean, float *gain,
+                 int n, float noiseScale, float alpha, float floor) {
+    const __m256 valpha = _mm256_set1_ps(alpha), vbeta = _mm256_set1_ps(1.0f - alpha);
+    const __m256 one = _mm256_set1_ps(1.0f), zero = _mm256_setzero_ps();
+    const __m256 vfloor = _mm256_set1_ps(floor), eps = _mm256_set1_ps(NOISE_EPS);
+    const __m256 vscale = _mm256_set1_ps(noiseScale);
+    int k = 0;
+    for (; k + 8 <= n; k += 8) {
+        const __m256 p = _mm256_loadu_ps(power + k);
+        const __m256 nz = _mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(noise + k), vscale), eps);
+        const __m256 post = _mm256_max_ps(_mm256_sub_ps(_mm256_div_ps(p, nz), one), zero);
+        const __m256 xi = _mm256_add_ps(_mm256_mul_ps(vbeta, post),
+                                        _mm256_mul_ps(valpha, _mm256_div_ps(_mm256_loadu_ps(clean + k), nz)));
+        const __m256 g = _mm256_max_ps(_mm256_div_ps(xi, _mm256_add_ps(one, xi)), vfloor);
+        _mm256_storeu_ps(gain + k, g);
+        _mm256_storeu_ps(clean + k, _mm256_mul_ps(_mm256_mul_ps(g, g), p));
+    }
+    for (; k < n; k++) gain[k] = wiener_bin(power[k], noise[k] * noiseScale, clean[k], alpha, floor);
+}
+
+#else
+
+const char *isa() { return "scalar"; }
+
+void mul(const float *a, const float *b, float *out, int n) {
+    for (int i = 0; i < n; i++) out[i] = a[i] * b[i];
+}
+
+void power(const float *c, float *out, int n) {
+    for (int k = 0; k < n; k++) out[k] = c[2 * k] * c[2 * k] + c[2 * k + 1] * c[2 * k + 1];
+}
+
+float dot(const float *a, const float *b, int n) {
+    float sum = 0.0f;
+    for (int i = 0; i < n; i++) sum += a[i] * b[i];
+    return sum;
+}
+
+float max(const float *a, size_t n) {
+    float r = -FLT_MAX;
+    for (size_t i = 0; i < n; i++) r = std::max(r, a[i]);
+    return r;
+}
+
+void clamp_offset_scale(float *a, size_t n, float lo, float offset, float scale) {
+    for (size_t i = 0; i < n; i++) a[i] = (std::max(a[i], lo) + offset) * scale;
+}
+
+void s16_to_f32(const int16_t *in, float *out, int n, float scale) {
+    for (int i = 0; i < n; i++) out[i] = in[i] * scale;
+}
+
+void f32_to_s16(const float *in, int16_t *out, int n, float scale) {
+    for (int i = 0; i < n; i++) out[i] = saturate_s16(in[i] * scale);
+}
+
+void mul_add(const float *a, const float *b, float *acc, int n) {
+    for (int i = 0; i < n; i++) acc[i] += a[i] * b[i];
+}
+
+float abs_max(const float *a, int n) {
+    float r = 0.0f;
+    for (int i = 0; i < n; i++) r = std::max(r, std::fabs(a[i]));
+    return r;
+}
+
+void gain_ramp(float *a, int n, float g0, float g1) {
+    if (n <= 0) return;
+    const float step = (g1 - g0) / n;
+    for (int i = 0; i < n; i++) a[i] = std::min(std::max(a[i] * (g0 + step * (i + 1)), -1.0f), 1.0f);
+}
+
+void scale_complex(float *c, const float *gain, int n) {
+    for (int k = 0; k < n; k++) {
+        c[2 * k] *= gain[k];
+        c[2 * k + 1] *= gain[k];
+    }
+}
+
+void noise_update(const float *power, float *noise, int n, float fall, float rise) {
+    for (int k = 0; k < n; k++) noise[k] = noise_bin(power[k], noise[k], fall, rise);
+}
+
+void wiener_gain(const float *power, const float *noise, float *clean, float *gain,
+                 int n, float noiseScale, float alpha, float floor) {
+    for (int k = 0; k < n; k++) gain[k] = wiener_bin(power[k], noise[k] * noiseScale, clean[k], alpha, floor);
+}
+
+#endif
+
+} // namespace simd
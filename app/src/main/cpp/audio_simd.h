@@ -0,0 +1,63 @@
+/**
+ * Vector kernels for the audio front end.
+ *
+ * NEON on arm64 (the shipped ABI), AVX2 when a host/x86 build enables it,
+ * scalar otherwise. All functions accept unaligned pointers and any length.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace simd {
+
+// out[i] = a[i] * b[i]
+void mul(const float *a, const float *b, float *out, int n);
+
+// out[k] = re^2 + im^2 for n interleaved complex values
+void power(const float *complexInterleaved, float *out, int n);
+
+// sum(a[i] * b[i])
+float dot(const float *a, const float *b, int n);
+
+// max(a[i]); returns -FLT_MAX for n == 0
+float max(const float *a, size_t n);
+
+// a[i] = (max(a[i], lo) + offset) * scale
+void clamp_offset_scale(float *a, size_t n, float lo, float offset, float scale);
+
+// out[i] = in[i] * scale
+void s16_to_f32(const int16_t *in, float *out, int n, float scale);
+
+// out[i] = saturate(round(in[i] * scale))
+void f32_to_s16(const float *in, int16_t *out, int n, float scale);
+
+// acc[i] += a[i] * b[i]
+void mul_add(const float *a, const float *b, float *acc, int n);
+
+// max(|a[i]|); 0 for n == 0
+float abs_max(const float *a, int n);
+
+// a[i] = clamp(a[i] * g(i), -1, 1), g ramping linearly from g0 to g1 over
+// the block (reaching g1 on the last sample)
+void gain_ramp(float *a, int n, float g0, float g1);
+
+// Scale n interleaved complex values by real gains
+void scale_complex(float *complexInterleaved, const float *gain, int n);
+
+// Noise power tracking: falls towards power at rate `fall` (0..1), rises
+// geometrically by `rise` (> 1) per call while power stays above it
+void noise_update(const float *power, float *noise, int n, float fall, float rise);
+
+// Decision-directed Wiener gain. For each bin, with
+// N = max(noise * noiseScale, 1e-10):
+//   xi = alpha * clean / N + (1 - alpha) * max(power / N - 1, 0)
+//   gain = max(xi / (1 + xi), floor);  clean = gain^2 * power
+void wiener_gain(const float *power, const float *noise, float *clean, float *gain,
+                 int n, float noiseScale, float alpha, float floor);
+
+// Name of the compiled-in path, for logs and benchmarks
+const char *isa();
+
+} // namespace simd
@@ -0,0 +1,100 @@
+/**
+ * End-of-turn policy — see endpointer.h.
+ */
+
+#include "endpointer.h"
+
+#include <cstring>
+
+// Lowercased words separated by single spaces. ASCII punctuation is dropped
+// so "call mom" -> "call mom." still counts as stable; bytes of multi-byte
+// UTF-8 characters are kept as-is. Bracketed annotations such as
+// [BLANK_AUDIO] or (music) aren't words and are skipped.
+static std::string normalize(const std::string &text) {
+    std::string out;
+    int depth = 0;
+    for (unsigned char c : text) {
+        if (c == '[' || c == '(') { depth++; continue; }
+        if (c == ']' || c == ')') { if (depth > 0) depth--; continue; }
+        if (depth > 0) continue;
+
+        if (c >= 0x80 || (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || c == '\'') {
+            out.push_back((char) c);
+        } else if (c >= 'A' && c <= 'Z') {
+            out.push_back((char) (c - 'A' + 'a'));
+        } else if (!out.empty() && out.back() != ' ') {
+            out.push_back(' ');
+        }
+    }
+    if (!out.empty() && out.back() == ' ') out.pop_back();
+    return out;
+}
+
+static bool ends_with(const std::string &s, const char *suffix) {
+    const size_t n = strlen(suffix);
+    return s.size() >= n && s.compare(s.size() - n, n, suffix) == 0;
+}
+
+// Terminal punctuation, ignoring trailing spaces and annotations. A trailing
+// ellipsis is whisper hedging on an unfinished thought, not an end.
+static bool ends_sentence(const std::string &text) {
+    std::string t;
+    int depth = 0;
+    for (char c : text) {
+        if (c == '[' || c == '(') { depth++; continue; }
+        if (c == ']' || c == ')') { if (depth > 0) depth--; continue; }
+        if (depth == 0) t.push_back(c);
+    }
+    while (!t.empty() && (t.back() == ' ' || t.back() == '"' || t.back() == '\'')) t.pop_back();
+    if (t.empty() || ends_with(t, "...") || ends_with(t, "\xE2\x80\xA6")) return false;
+
+    const char last = t.back();
+    if (last == '.' || last == '?' || last == '!') return true;
+    // CJK full stop / full-width question and exclamation marks
+    return ends_with(t, "\xE3\x80\x82") || ends_with(t, "\xEF\xBC\x9F") || ends_with(t, "\xEF\xBC\x81");
+}
+
+void Endpointer::reset(int64_t hangoverSamples) {
+    m_hangover = hangoverSamples;
+    m_words.clear();
+    m_firstSeen = -1;
+    m_lastCovered = -1;
+    m_endsSentence = false;
+    m_sentenceConfirmedAt = -1;
+}
+
+void Endpointer::onHypothesis(const std::string &text, int64_t coveredEnd) {
+    // A decode of older audio than the last one can't say anything new
+    if (coveredEnd <= m_lastCovered) return;
+
+    std::string words = normalize(text);
+    const bool changed = words.empty() || words != m_words;
+    if (changed) {
+        m_words = std::move(words);
+        m_firstSeen = coveredEnd;
+    }
+    const bool sentence = !m_words.empty() && ends_sentence(text);
+    m_sentenceConfirmedAt = sentence && m_endsSentence && !changed ? m_lastCovered : -1;
+    m_lastCovered = coveredEnd;
+    m_endsSentence = sentence;
+}
+
+int64_t Endpointer::stableSamples() const {
+    if (m_words.empty() || m_firstSeen < 0) return 0;
+    return m_lastCovered - m_firstSeen;
+}
+
+Endpointer::Decision Endpointer::update(int64_t silenceStart, int64_t now) {
+    if (silenceStart < 0) return CONTINUE;
+
+    const int64_t silence = now - silenceStart;
+    if (silence >= m_hangover) return HANGOVER;
+
+    // The hypothesis only vouches for the pause if it has actually seen it
+    if (m_lastCovered <= silenceStart || stableSamples() < msToSamples(STABLE_MS)) {
+        return CONTINUE;
+    }
+    // Both decodes that closed the sentence must have heard the pause
+    const int needMs = sentenceConfirmedAfter(silenceStart) ? SENTENCE_SILENCE_MS : STABLE_SILENCE_MS;
+    return silence >= msToSamples(needMs) ? END_OF_TURN : CONTINUE;
+}
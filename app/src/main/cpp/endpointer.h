@@ -0,0 +1,65 @@
+/**
+ * End-of-turn policy for the voice front end.
+ *
+ * The fixed VAD hangover (3 s of silence) is kept as the backstop, but the
+ * turn can end much earlier once the streaming hypothesis backs it up:
+ *
+ *   - the partial transcript stopped changing (same words over at least
+ *     STABLE_MS of newly decoded audio), and
+ *   - the latest decode already covered part of the pause, and
+ *   - the pause has lasted SENTENCE_SILENCE_MS when whisper closed the
+ *     sentence (. ? !), or STABLE_SILENCE_MS when it didn't.
+ *
+ * Whisper's decoder is the language model here, but greedy partials end in
+ * "." almost whatever was said, so one closed hypothesis proves little. The
+ * short sentence timeout needs two consecutive decodes that both covered
+ * the pause and both closed the same words. Without partial hypotheses the
+ * policy degrades to the plain hangover.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+class Endpointer {
+public:
+    enum Decision {
+        CONTINUE = 0,
+        HANGOVER = 1,      // silence alone reached the hangover
+        END_OF_TURN = 2,   // stable hypothesis + shorter silence
+    };
+
+    static constexpr int STABLE_MS = 300;
+    static constexpr int STABLE_SILENCE_MS = 700;
+    static constexpr int SENTENCE_SILENCE_MS = 250;
+
+    explicit Endpointer(int sampleRate = 16000) : m_sampleRate(sampleRate) {}
+
+    void reset(int64_t hangoverSamples);
+
+    // A partial transcript of the utterance audio up to coveredEnd
+    void onHypothesis(const std::string &text, int64_t coveredEnd);
+
+    // silenceStart < 0 while speech is ongoing; now is the end of the last hop
+    Decision update(int64_t silenceStart, int64_t now);
+
+    // How long the current hypothesis has survived unchanged, in samples
+    int64_t stableSamples() const;
+    bool endsSentence() const { return m_endsSentence; }
+    // The closed sentence was confirmed by a decode ending after position
+    bool sentenceConfirmedAfter(int64_t position) const {
+        return m_endsSentence && m_sentenceConfirmedAt > position;
+    }
+
+private:
+    int64_t msToSamples(int ms) const { return (int64_t) ms * m_sampleRate / 1000; }
+
+    int m_sampleRate;
+    int64_t m_hangover = 0;
+    std::string m_words;            // normalized hypothesis (see normalize())
+    int64_t m_firstSeen = -1;       // coveredEnd of the first decode with these words
+    int64_t m_lastCovered = -1;     // coveredEnd of the latest decode
+    bool m_endsSentence = false;
+    int64_t m_sentenceConfirmedAt = -1;   // coveredEnd of the decode before the latest, if both closed these words
+};
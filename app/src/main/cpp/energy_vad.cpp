@@ -0,0 +1,50 @@
+/**
+ * Adaptive energy VAD — see energy_vad.h.
+ */
+
+#include "energy_vad.h"
+
+#include <algorithm>
+#include <cmath>
+
+// How fast the ambient floor follows the room once calibrated (per hop)
+static constexpr float AMBIENT_TRACK_RATE = 0.002f;
+
+void EnergyVad::reset() {
+    m_calibratedSamples = 0;
+    m_ambientSum = 0.0;
+    m_ambientHops = 0;
+    m_ambient = 0.0f;
+    m_threshold = MIN_THRESHOLD;
+    m_lastRms = 0.0f;
+}
+
+bool EnergyVad::process(const int16_t *samples, int n) {
+    if (n <= 0) return false;
+
+    double sum = 0.0;
+    for (int i = 0; i < n; i++) {
+        const double s = samples[i];
+        sum += s * s;
+    }
+    const float rms = (float) std::sqrt(sum / n);
+    m_lastRms = rms;
+
+    if (!calibrated()) {
+        m_ambientSum += rms;
+        m_ambientHops++;
+        m_calibratedSamples += n;
+        if (calibrated()) {
+            m_ambient = (float) (m_ambientSum / m_ambientHops);
+            m_threshold = std::max(m_ambient * AMBIENT_MULTIPLIER, MIN_THRESHOLD);
+        }
+        return false;
+    }
+
+    const bool speech = rms > m_threshold;
+    if (!speech) {
+        m_ambient += AMBIENT_TRACK_RATE * (rms - m_ambient);
+        m_threshold = std::max(m_ambient * AMBIENT_MULTIPLIER, MIN_THRESHOLD);
+    }
+    return speech;
+}
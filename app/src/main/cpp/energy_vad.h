@@ -0,0 +1,43 @@
+/**
+ * Adaptive energy VAD — the native twin of AudioRecorder's Kotlin VAD.
+ *
+ * Calibrates on the first 500 ms of ambient audio (threshold = 2.5x ambient
+ * RMS, never below 300), then classifies each hop as speech / non-speech.
+ * The ambient estimate keeps tracking slowly during non-speech so an
+ * always-on pipeline adapts when the room gets louder or quieter.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+class EnergyVad {
+public:
+    static constexpr float MIN_THRESHOLD = 300.0f;     // int16 RMS
+    static constexpr float AMBIENT_MULTIPLIER = 2.5f;
+    static constexpr int CALIBRATION_MS = 500;
+
+    explicit EnergyVad(int sampleRate = 16000) : m_sampleRate(sampleRate) {}
+
+    // Feed one hop of int16 samples; returns true if it looks like speech
+    bool process(const int16_t *samples, int n);
+
+    // RMS of the last hop (int16 scale)
+    float lastRms() const { return m_lastRms; }
+
+    float threshold() const { return m_threshold; }
+    bool calibrated() const { return m_calibratedSamples >= calibrationSamples(); }
+
+    void reset();
+
+private:
+    int calibrationSamples() const { return m_sampleRate * CALIBRATION_MS / 1000; }
+
+    int m_sampleRate;
+    int m_calibratedSamples = 0;
+    double m_ambientSum = 0.0;
+    int m_ambientHops = 0;
+    float m_ambient = 0.0f;
+    float m_threshold = MIN_THRESHOLD;
+    float m_lastRms = 0.0f;
+};
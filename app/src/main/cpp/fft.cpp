@@ -0,0 +1,178 @@
+/**
+ * Mixed-radix FFT — see fft.h.
+ */
+
+#include "fft.h"
+
+#include <cmath>
+
+Fft::Fft(int n) : Fft(n, true) {}
+
+Fft::Fft(int n, bool realPlan) : m_n(n) {
+    // Factor into radix-4 first, then 2, 3, 5, ... (KissFFT ordering)
+    int remaining = n;
+    int p = 4;
+    const int floorSqrt = (int) std::floor(std::sqrt((double) n));
+    int maxRadix = 1;
+    do {
+        while (remaining % p) {
+            switch (p) {
+                case 4: p = 2; break;
+                case 2: p = 3; break;
+                default: p += 2; break;
+            }
+            if (p > floorSqrt) p = remaining;
+        }
+        remaining /= p;
+        m_factors.push_back(p);
+        m_factors.push_back(remaining);
+        if (p > maxRadix) maxRadix = p;
+    } while (remaining > 1);
+
+    m_twiddles.resize(n);
+    m_twiddlesInv.resize(n);
+    for (int i = 0; i < n; i++) {
+        const double phase = -2.0 * M_PI * i / n;
+        m_twiddles[i] = cpx((float) cos(phase), (float) sin(phase));
+        m_twiddlesInv[i] = std::conj(m_twiddles[i]);
+    }
+
+    m_scratch.resize(maxRadix);
+    m_bufIn.resize(n);
+    m_bufOut.resize(n);
+
+    if (realPlan && n % 2 == 0 && n >= 4) {
+        m_half.reset(new Fft(n / 2, false));
+        m_splitTwiddles.resize(n / 2);
+        for (int k = 0; k < n / 2; k++) m_splitTwiddles[k] = m_twiddles[k];
+    }
+}
+
+void Fft::forward(const cpx *in, cpx *out) {
+    work(out, in, 1, m_factors.data(), m_twiddles.data());
+}
+
+void Fft::inverse(const cpx *in, cpx *out) {
+    work(out, in, 1, m_factors.data(), m_twiddlesInv.data());
+    const float scale = 1.0f / (float) m_n;
+    for (int i = 0; i < m_n; i++) out[i] *= scale;
+}
+
+void Fft::forwardReal(const float *in, cpx *out) {
+    if (m_half) {
+        // z[j] = x[2j] + i*x[2j+1]; Z = FFT(z); split into even/odd spectra
+        const int h = m_n / 2;
+        for (int j = 0; j < h; j++) m_bufIn[j] = cpx(in[2 * j], in[2 * j + 1]);
+        m_half->forward(m_bufIn.data(), m_bufOut.data());
+        const cpx *z = m_bufOut.data();
+        out[0] = cpx(z[0].real() + z[0].imag(), 0.0f);
+        out[h] = cpx(z[0].real() - z[0].imag(), 0.0f);
+        for (int k = 1; k < h; k++) {
+            const cpx a = z[k];
+            const cpx b = std::conj(z[h - k]);
+            const cpx even = 0.5f * (a + b);
+            const cpx odd = cpx(0.0f, -0.5f) * (a - b);
+            out[k] = even + m_splitTwiddles[k] * odd;
+        }
+        return;
+    }
+
+    for (int i = 0; i < m_n; i++) m_bufIn[i] = cpx(in[i], 0.0f);
+    work(m_bufOut.data(), m_bufIn.data(), 1, m_factors.data(), m_twiddles.data());
+    for (int k = 0; k <= m_n / 2; k++) out[k] = m_bufOut[k];
+}
+
+void Fft::inverseReal(const cpx *in, float *out) {
+    if (m_half) {
+        // Rebuild the even/odd spectra, pack them as Z = E + i*O and run one
+        // half-length inverse: z[j] = x[2j] + i*x[2j+1]
+        const int h = m_n / 2;
+        for (int k = 0; k < h; k++) {
+            const cpx a = in[k];
+            const cpx b = std::conj(in[h - k]);
+            const cpx even = 0.5f * (a + b);
+            const cpx odd = 0.5f * (a - b) * std::conj(m_splitTwiddles[k]);
+            m_bufIn[k] = even + cpx(0.0f, 1.0f) * odd;
+        }
+        m_half->inverse(m_bufIn.data(), m_bufOut.data());
+        for (int j = 0; j < h; j++) {
+            out[2 * j] = m_bufOut[j].real();
+            out[2 * j + 1] = m_bufOut[j].imag();
+        }
+        return;
+    }
+
+    const int half = m_n / 2;
+    for (int k = 0; k <= half; k++) m_bufIn[k] = in[k];
+    for (int k = half + 1; k < m_n; k++) m_bufIn[k] = std::conj(in[m_n - k]);
+    work(m_bufOut.data(), m_bufIn.data(), 1, m_factors.data(), m_twiddlesInv.data());
+    const float scale = 1.0f / (float) m_n;
+    for (int i = 0; i < m_n; i++) out[i] = m_bufOut[i].real() * scale;
+}
+
+void Fft::work(cpx *out, const cpx *in, size_t fstride, const int *factors, const cpx *twiddles) {
+    const int p = factors[0];  // radix of this stage
+    const int m = factors[1];  // length of each sub-transform
+    cpx *const begin = out;
+    cpx *const end = out + p * m;
+
+    if (m == 1) {
+        for (; out != end; ++out, in += fstride) *out = *in;
+    } else {
+        for (; out != end; out += m, in += fstride) {
+            work(out, in, fstride * p, factors + 2, twiddles);
+        }
+    }
+
+    butterfly(begin, fstride, m, p, twiddles);
+}
+
+void Fft::butterfly(cpx *out, size_t fstride, int m, int p, const cpx *twiddles) {
+    if (p == 2) {
+        for (int u = 0; u < m; u++) {
+            const cpx t = out[u + m] * twiddles[u * fstride];
+            out[u + m] = out[u] - t;
+            out[u] += t;
+        }
+        return;
+    }
+
+    if (p == 4) {
+        // Forward/inverse differ in the sign of the +-i rotation; recover it
+        // from the quarter-turn twiddle of this table.
+        const bool inverse = twiddles[m_n / 4].imag() > 0.0f;
+        for (int u = 0; u < m; u++) {
+            const cpx s0 = out[u];
+            const cpx s1 = out[u + m] * twiddles[u * fstride];
+            const cpx s2 = out[u + 2 * m] * twiddles[2 * u * fstride];
+            const cpx s3 = out[u + 3 * m] * twiddles[3 * u * fstride];
+            const cpx a = s0 + s2;
+            const cpx b = s0 - s2;
+            const cpx c = s1 + s3;
+            cpx d = s1 - s3;
+            // multiply by -i (forward) or +i (inverse)
+            d = inverse ? cpx(-d.imag(), d.real()) : cpx(d.imag(), -d.real());
+            out[u] = a + c;
+            out[u + m] = b + d;
+            out[u + 2 * m] = a - c;
+            out[u + 3 * m] = b - d;
+        }
+        return;
+    }
+
+    // Generic radix-p butterfly
+    cpx *scratch = m_scratch.data();
+    for (int u = 0; u < m; u++) {
+        for (int q = 0, k = u; q < p; q++, k += m) scratch[q] = out[k];
+        for (int q1 = 0, k = u; q1 < p; q1++, k += m) {
+            size_t twidx = 0;
+            cpx acc = scratch[0];
+            for (int q = 1; q < p; q++) {
+                twidx += fstride * k;
+                if (twidx >= (size_t) m_n) twidx -= m_n;
+                acc += scratch[q] * twiddles[twidx];
+            }
+            out[k] = acc;
+        }
+    }
+}
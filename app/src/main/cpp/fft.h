@@ -0,0 +1,54 @@
+/**
+ * Mixed-radix complex FFT for the small, non power-of-two sizes used by the
+ * audio front end (400-point whisper STFT, 320-point noise suppression).
+ *
+ * Plain recursive decimation-in-time with precomputed twiddles — the same
+ * structure as KissFFT. Sizes factor into 4, 2, 3, 5 (anything else falls
+ * back to a generic butterfly). Real transforms of even length run as a
+ * half-length complex FFT plus a split pass.
+ */
+
+#pragma once
+
+#include <complex>
+#include <memory>
+#include <vector>
+
+class Fft {
+public:
+    using cpx = std::complex<float>;
+
+    explicit Fft(int n);
+
+    int size() const { return m_n; }
+
+    // out[k] = sum_j in[j] * exp(-2*pi*i*j*k/n)
+    void forward(const cpx *in, cpx *out);
+
+    // Real input of length n; writes the n/2 + 1 non-redundant bins
+    void forwardReal(const float *in, cpx *out);
+
+    // Inverse of forward (scaled by 1/n)
+    void inverse(const cpx *in, cpx *out);
+
+    // Inverse of forwardReal: n/2 + 1 bins in, n real samples out (scaled by 1/n)
+    void inverseReal(const cpx *in, float *out);
+
+private:
+    Fft(int n, bool realPlan);
+
+    void work(cpx *out, const cpx *in, size_t fstride, const int *factors, const cpx *twiddles);
+    void butterfly(cpx *out, size_t fstride, int m, int p, const cpx *twiddles);
+
+    int m_n;
+    std::vector<int> m_factors;      // (radix, remaining length) pairs
+    std::vector<cpx> m_twiddles;     // exp(-2*pi*i*k/n)
+    std::vector<cpx> m_twiddlesInv;  // exp(+2*pi*i*k/n)
+    std::vector<cpx> m_scratch;      // per-butterfly temporaries
+    std::vector<cpx> m_bufIn;
+    std::vector<cpx> m_bufOut;
+
+    // Even n: forwardReal packs pairs of samples into an n/2-point FFT
+    std::unique_ptr<Fft> m_half;
+    std::vector<cpx> m_splitTwiddles;  // exp(-2*pi*i*k/n), k < n/2
+};
@@ -0,0 +1,148 @@
+/**
+ * JNI bridge for the native voice front end (AAudio capture, VAD,
+ * wake word, utterance capture).
+ *
+ * Provides native methods for the AudioFrontendJNI Kotlin class. Built into
+ * libnova_whisper so captured utterances stay next to the decoder.
+ */
+
+#include <jni.h>
+#include <android/log.h>
+
+#include "voice_frontend.h"
+
+#define LOG_TAG "FrontendJNI"
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+
+extern "C" {
+
+// ============================================================
+// start / stop - mic ownership
+// ============================================================
+JNIEXPORT jboolean JNICALL
+Java_com_nova_companion_voice_AudioFrontendJNI_start(
+        JNIEnv *env,
+        jobject /* this */) {
+    return VoiceFrontend::instance().start() ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT void JNICALL
+Java_com_nova_companion_voice_AudioFrontendJNI_stop(
+        JNIEnv *env,
+        jobject /* this */) {
+    VoiceFrontend::instance().stop();
+}
+
+JNIEXPORT jboolean JNICALL
+Java_com_nova_companion_voice_AudioFrontendJNI_isRunning(
+        JNIEnv *env,
+        jobject /* this */) {
+    return VoiceFrontend::instance().running() ? JNI_TRUE : JNI_FALSE;
+}
+
+// ============================================================
+// Wake word
+// ============================================================
+JNIEXPORT jboolean JNICALL
+Java_com_nova_companion_voice_AudioFrontendJNI_loadKeywordModel(
+        JNIEnv *env,
+        jobject /* this */,
+        jstring modelPath,
+        jfloat threshold) {
+
+    const char *path = env->GetStringUTFChars(modelPath, nullptr);
+    LOGI("Loading keyword model: %s (threshold=%.2f)", path, threshold);
+    const bool ok = VoiceFrontend::instance().loadKeywordModel(path, threshold);
+    env->ReleaseStringUTFChars(modelPath, path);
+
+    if (!ok) LOGE("Keyword model failed to load");
+    return ok ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT void JNICALL
+Java_com_nova_companion_voice_AudioFrontendJNI_setWakeWordEnabled(
+        JNIEnv *env,
+        jobject /* this */,
+        jboolean enabled) {
+    VoiceFrontend::instance().setWakeEnabled(enabled == JNI_TRUE);
+}
+
+// ============================================================
+// Preprocessing (noise suppression + AGC)
+// ============================================================
+JNIEXPORT void JNICALL
+Java_com_nova_companion_voice_AudioFrontendJNI_setPreprocessing(
+        JNIEnv *env,
+        jobject /* this */,
+        jboolean noiseSuppression,
+        jboolean agc) {
+    VoiceFrontend::instance().setPreprocessing(noiseSuppression == JNI_TRUE, agc == JNI_TRUE);
+}
+
+// [hops, avg us, max us, hops over budget]
+JNIEXPORT jfloatArray JNICALL
+Java_com_nova_companion_voice_AudioFrontendJNI_getPreprocessStats(
+        JNIEnv *env,
+        jobject /* this */) {
+
+    const frontend::PreprocessStats stats = VoiceFrontend::instance().preprocessStats();
+    const jfloat values[4] = {
+            (jfloat) stats.hops, stats.avgUs, stats.maxUs, (jfloat) stats.overBudget,
+    };
+    jfloatArray result = env->NewFloatArray(4);
+    if (result) env->SetFloatArrayRegion(result, 0, 4, values);
+    return result;
+}
+
+// ============================================================
+// Utterance capture
+// ============================================================
+JNIEXPORT void JNICALL
+Java_com_nova_companion_voice_AudioFrontendJNI_beginUtterance(
+        JNIEnv *env,
+        jobject /* this */,
+        jint preRollMs,
+        jint silenceMs,
+        jint minSpeechMs,
+        jint maxMs) {
+    VoiceFrontend::instance().beginUtterance(preRollMs, silenceMs, minSpeechMs, maxMs);
+}
+
+JNIEXPORT jfloatArray JNICALL
+Java_com_nova_companion_voice_AudioFrontendJNI_endUtterance(
+        JNIEnv *env,
+        jobject /* this */) {
+
+    std::vector<float> samples = VoiceFrontend::instance().endUtterance();
+    jfloatArray result = env->NewFloatArray((jsize) samples.size());
+    if (result && !samples.empty()) {
+        env->SetFloatArrayRegion(result, 0, (jsize) samples.size(), samples.data());
+    }
+    return result;
+}
+
+// ============================================================
+// Events + level
+// ============================================================
+JNIEXPORT jint JNICALL
+Java_com_nova_companion_voice_AudioFrontendJNI_nextEvent(
+        JNIEnv *env,
+        jobject /* this */,
+        jint timeoutMs) {
+
+    frontend::Event event;
+    if (!VoiceFrontend::instance().waitEvent(event, timeoutMs)) {
+        return frontend::EVENT_NONE;
+    }
+    return event.type;
+}
+
+JNIEXPORT jfloat JNICALL
+Java_com_nova_companion_voice_AudioFrontendJNI_getLevel(
+        JNIEnv *env,
+        jobject /* this */) {
+    return VoiceFrontend::instance().level();
+}
+
+} // extern "C"
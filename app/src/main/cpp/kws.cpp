@@ -0,0 +1,189 @@
+/**
+ * Streaming keyword spotter — see kws.h.
+ */
+
+#include "kws.h"
+
+#include <android/log.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "ggml.h"
+#include "ggml-cpu.h"
+#include "gguf.h"
+#include "log_mel.h"
+
+#define LOG_TAG "NovaKWS"
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+
+static constexpr size_t KWS_GRAPH_TENSORS = 512;
+static constexpr size_t KWS_ARENA_DATA = 256 * 1024;
+
+KeywordSpotter::~KeywordSpotter() {
+    unload();
+}
+
+void KeywordSpotter::unload() {
+    if (m_weights) {
+        ggml_free(m_weights);
+        m_weights = nullptr;
+    }
+    m_inW = m_inB = m_wIh = m_bIh = m_wHh = m_bHh = m_outW = m_outB = nullptr;
+}
+
+bool KeywordSpotter::load(const char *path) {
+    unload();
+
+    ggml_context *weights = nullptr;
+    gguf_init_params params = { /*no_alloc =*/ false, /*ctx =*/ &weights };
+    gguf_context *gguf = gguf_init_from_file(path, params);
+    if (!gguf) {
+        LOGE("Failed to read KWS model: %s", path);
+        return false;
+    }
+
+    int64_t key = gguf_find_key(gguf, "kws.context");
+    m_context = key >= 0 ? (int) gguf_get_val_u32(gguf, key) : 3;
+    key = gguf_find_key(gguf, "kws.keyword_class");
+    m_keywordClass = key >= 0 ? (int) gguf_get_val_u32(gguf, key) : 1;
+    gguf_free(gguf);
+
+    m_weights = weights;
+    m_inW = ggml_get_tensor(weights, "kws.in.weight");
+    m_inB = ggml_get_tensor(weights, "kws.in.bias");
+    m_wIh = ggml_get_tensor(weights, "kws.gru.w_ih");
+    m_bIh = ggml_get_tensor(weights, "kws.gru.b_ih");
+    m_wHh = ggml_get_tensor(weights, "kws.gru.w_hh");
+    m_bHh = ggml_get_tensor(weights, "kws.gru.b_hh");
+    m_outW = ggml_get_tensor(weights, "kws.out.weight");
+    m_outB = ggml_get_tensor(weights, "kws.out.bias");
+
+    if (!m_inW || !m_inB || !m_wIh || !m_bIh || !m_wHh || !m_bHh || !m_outW || !m_outB) {
+        LOGE("KWS model is missing tensors");
+        unload();
+        return false;
+    }
+
+    const int64_t channels = m_inW->ne[1];
+    m_hidden = (int) m_wHh->ne[0];
+    m_classes = (int) m_outW->ne[1];
+    const bool shapesOk =
+        m_context > 0 &&
+        m_inW->ne[0] == (int64_t) logmel::N_MEL * m_context &&
+        m_wIh->ne[0] == channels && m_wIh->ne[1] == 3 * m_hidden &&
+        m_wHh->ne[1] == 3 * m_hidden &&
+        m_outW->ne[0] == m_hidden &&
+        m_keywordClass >= 0 && m_keywordClass < m_classes;
+    if (!shapesOk) {
+        LOGE("KWS model has unexpected shapes (context=%d, hidden=%d, classes=%d)",
+             m_context, m_hidden, m_classes);
+        unload();
+        return false;
+    }
+
+    m_arena.resize(ggml_tensor_overhead() * KWS_GRAPH_TENSORS + ggml_graph_overhead() + KWS_ARENA_DATA);
+    m_state.assign(m_hidden, 0.0f);
+    m_frames.assign((size_t) logmel::N_MEL * m_context, 0.0f);
+    m_batch.resize((size_t) logmel::N_MEL * m_context * BATCH_FRAMES);
+    reset();
+
+    LOGI("KWS model loaded: context=%d channels=%lld hidden=%d classes=%d",
+         m_context, (long long) channels, m_hidden, m_classes);
+    return true;
+}
+
+void KeywordSpotter::reset() {
+    std::fill(m_state.begin(), m_state.end(), 0.0f);
+    m_framesSeen = 0;
+    m_batchFrames = 0;
+    std::fill(std::begin(m_scores), std::end(m_scores), 0.0f);
+    m_scoreIndex = 0;
+    m_smoothed = 0.0f;
+}
+
+bool KeywordSpotter::push(const float *melFrame) {
+    if (!loaded()) return false;
+
+    // Slide the context window and append the normalized frame
+    const int n = logmel::N_MEL;
+    memmove(m_frames.data(), m_frames.data() + n, (size_t) n * (m_context - 1) * sizeof(float));
+    float *newest = m_frames.data() + (size_t) n * (m_context - 1);
+    for (int i = 0; i < n; i++) newest[i] = (std::max(melFrame[i], -8.0f) + 4.0f) / 4.0f;
+    if (++m_framesSeen < m_context) return false;
+
+    memcpy(m_batch.data() + (size_t) m_batchFrames * n * m_context, m_frames.data(),
+           m_frames.size() * sizeof(float));
+    if (++m_batchFrames < BATCH_FRAMES) return false;
+    m_batchFrames = 0;
+
+    m_scores[m_scoreIndex] = evaluate();
+    m_scoreIndex = (m_scoreIndex + 1) % SMOOTH_EVALS;
+    float sum = 0.0f;
+    for (float s : m_scores) sum += s;
+    m_smoothed = sum / SMOOTH_EVALS;
+
+    if (m_smoothed >= m_threshold) {
+        const float score = m_smoothed;
+        LOGI("Keyword detected (score=%.3f)", score);
+        reset();
+        m_smoothed = score;  // keep lastScore() meaningful for the caller
+        return true;
+    }
+    return false;
+}
+
+float KeywordSpotter::evaluate() {
+    ggml_init_params params = { m_arena.size(), m_arena.data(), /*no_alloc =*/ false };
+    ggml_context *ctx = ggml_init(params);
+    if (!ctx) return 0.0f;
+
+    const int H = m_hidden;
+    const int T = BATCH_FRAMES;
+
+    ggml_tensor *x = ggml_new_tensor_2d(ctx, GGML_TYPE_F32, m_inW->ne[0], T);
+    memcpy(x->data, m_batch.data(), ggml_nbytes(x));
+    ggml_tensor *h = ggml_new_tensor_1d(ctx, GGML_TYPE_F32, H);
+    memcpy(h->data, m_state.data(), ggml_nbytes(h));
+
+    // Input projection and the GRU input gates for the whole batch at once
+    ggml_tensor *c = ggml_relu(ctx, ggml_add(ctx, ggml_mul_mat(ctx, m_inW, x), m_inB));
+    ggml_tensor *gi = ggml_add(ctx, ggml_mul_mat(ctx, m_wIh, c), m_bIh);  // [3H, T]
+
+    const size_t fsz = ggml_element_size(gi);
+    for (int t = 0; t < T; t++) {
+        const size_t base = t * gi->nb[1];
+        ggml_tensor *gh = ggml_add(ctx, ggml_mul_mat(ctx, m_wHh, h), m_bHh);  // [3H]
+        ggml_tensor *r = ggml_sigmoid(ctx, ggml_add(ctx,
+                ggml_view_1d(ctx, gi, H, base),
+                ggml_view_1d(ctx, gh, H, 0)));
+        ggml_tensor *z = ggml_sigmoid(ctx, ggml_add(ctx,
+                ggml_view_1d(ctx, gi, H, base + H * fsz),
+                ggml_view_1d(ctx, gh, H, H * fsz)));
+        ggml_tensor *nn = ggml_tanh(ctx, ggml_add(ctx,
+                ggml_view_1d(ctx, gi, H, base + 2 * H * fsz),
+                ggml_mul(ctx, r, ggml_view_1d(ctx, gh, H, 2 * H * fsz))));
+        // h' = n + z * (h - n)
+        h = ggml_add(ctx, nn, ggml_mul(ctx, z, ggml_sub(ctx, h, nn)));
+    }
+
+    ggml_tensor *logits = ggml_add(ctx, ggml_mul_mat(ctx, m_outW, h), m_outB);
+
+    ggml_cgraph *gf = ggml_new_graph(ctx);
+    ggml_build_forward_expand(gf, logits);
+    ggml_graph_compute_with_ctx(ctx, gf, 1);
+
+    memcpy(m_state.data(), h->data, (size_t) H * sizeof(float));
+
+    // Softmax over classes, keep the keyword posterior
+    const float *l = (const float *) logits->data;
+    float maxLogit = l[0];
+    for (int i = 1; i < m_classes; i++) maxLogit = std::max(maxLogit, l[i]);
+    float denom = 0.0f;
+    for (int i = 0; i < m_classes; i++) denom += std::exp(l[i] - maxLogit);
+    const float p = std::exp(l[m_keywordClass] - maxLogit) / denom;
+
+    ggml_free(ctx);
+    return p;
+}
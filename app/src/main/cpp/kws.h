@@ -0,0 +1,81 @@
+/**
+ * Streaming keyword spotter ("Hey Nova") run by ggml on log-mel frames.
+ *
+ * Model (GGUF, weights F32 or F16, ggml ne order):
+ *   kws.in.weight   [N_MEL * context, C]   dense over stacked context frames, ReLU
+ *   kws.in.bias     [C]
+ *   kws.gru.w_ih    [C, 3H]                GRU, PyTorch gate order (r, z, n)
+ *   kws.gru.b_ih    [3H]
+ *   kws.gru.w_hh    [H, 3H]
+ *   kws.gru.b_hh    [3H]
+ *   kws.out.weight  [H, n_classes]
+ *   kws.out.bias    [n_classes]
+ * Metadata: kws.context (u32, frames stacked per step), kws.keyword_class (u32).
+ *
+ * Features are whisper log-mel frames normalized with the fixed (x + 4) / 4
+ * whisper uses after its max clamp. Frames are evaluated in small batches
+ * so the graph cost is amortized; the keyword posterior is smoothed over a
+ * short window before thresholding.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+struct ggml_context;
+struct ggml_tensor;
+
+class KeywordSpotter {
+public:
+    static constexpr int BATCH_FRAMES = 4;       // 40 ms per evaluation
+    static constexpr int SMOOTH_EVALS = 6;       // ~240 ms posterior window
+    static constexpr float DEFAULT_THRESHOLD = 0.8f;
+
+    KeywordSpotter() = default;
+    ~KeywordSpotter();
+    KeywordSpotter(const KeywordSpotter &) = delete;
+    KeywordSpotter &operator=(const KeywordSpotter &) = delete;
+
+    bool load(const char *path);
+    void unload();
+    bool loaded() const { return m_weights != nullptr; }
+
+    // 0..1 — higher means fewer false accepts
+    void setThreshold(float threshold) { m_threshold = threshold; }
+
+    // Feed one raw log10 mel frame (logmel::N_MEL values).
+    // Returns true when the smoothed keyword posterior crosses the threshold.
+    bool push(const float *melFrame);
+
+    float lastScore() const { return m_smoothed; }
+
+    // Forget context, recurrent state and smoothing (e.g. after a long
+    // stretch of silence, or after a detection)
+    void reset();
+
+private:
+    float evaluate();
+
+    ggml_context *m_weights = nullptr;
+    ggml_tensor *m_inW = nullptr, *m_inB = nullptr;
+    ggml_tensor *m_wIh = nullptr, *m_bIh = nullptr;
+    ggml_tensor *m_wHh = nullptr, *m_bHh = nullptr;
+    ggml_tensor *m_outW = nullptr, *m_outB = nullptr;
+
+    int m_context = 3;
+    int m_hidden = 0;
+    int m_classes = 0;
+    int m_keywordClass = 1;
+    float m_threshold = DEFAULT_THRESHOLD;
+
+    std::vector<uint8_t> m_arena;          // per-evaluation graph memory
+    std::vector<float> m_state;            // GRU hidden state
+    std::vector<float> m_frames;           // last `context` normalized frames
+    int m_framesSeen = 0;
+    std::vector<float> m_batch;            // stacked inputs awaiting evaluation
+    int m_batchFrames = 0;
+    float m_scores[SMOOTH_EVALS] = {};
+    int m_scoreIndex = 0;
+    float m_smoothed = 0.0f;
+};
@@ -4,9 +4,12 @@
 #include <vector>
 #include <mutex>
 #include <atomic>
+#include <functional>
 #include <thread>
 
 #include "llama.h"
+#include "stage_api.h"
+#include "trace.h"
 
 #define TAG "NovaLlama"
 #define LOGI(...) __android_log_print(ANDROID_LOG_INFO, TAG, __VA_ARGS__)
@@ -41,6 +44,134 @@ static void batch_add_token(llama_batch &batch, llama_token id, llama_pos pos, b
     batch.n_tokens++;
 }
 
+// llama_decode as one trace span; prefill and per-token steps differ by name
+static int decode_traced(const char *name, const llama_batch &batch) {
+    trace::Scope span("llama", name);
+    span.arg("tokens", batch.n_tokens);
+    return llama_decode(g_ctx, batch);
+}
+
+// Streaming generation shared by generateStreaming and the pipeline entry
+// point. Caller holds g_mutex with a model loaded. Each non-empty piece goes
+// to onPiece; returning false stops. Returns the tokens generated, or -1 if
+// the prompt could not be tokenized or evaluated.
+static int stream_tokens(const std::string &prompt_str, int maxTokens, float temperature, float topP,
+                         const std::vector<std::string> &stop_strs,
+                         const std::function<bool(const std::string &)> &onPiece) {
+    trace::Scope span("llama", "llama.generate");
+    g_is_generating.store(true);
+    g_cancel_generation.store(false);
+
+    // Tokenize
+    const llama_vocab *vocab = llama_model_get_vocab(g_model);
+    std::vector<llama_token> tokens(prompt_str.size() + 128);
+    int n_tokens;
+    {
+        NOVA_TRACE_SCOPE("llama", "llama.tokenize");
+        n_tokens = llama_tokenize(vocab, prompt_str.c_str(), prompt_str.size(),
+                                  tokens.data(), tokens.size(), true, true);
+    }
+    if (n_tokens < 0) {
+        LOGE("Failed to tokenize prompt (result: %d)", n_tokens);
+        g_is_generating.store(false);
+        return -1;
+    }
+    tokens.resize(n_tokens);
+    LOGI("Streaming: prompt tokens=%d, max=%d", n_tokens, maxTokens);
+
+    // Clear KV cache and evaluate prompt
+    llama_memory_clear(llama_get_memory(g_ctx), true);
+
+    llama_batch batch = llama_batch_init(tokens.size(), 0, 1);
+    for (int i = 0; i < n_tokens; i++) {
+        batch_add_token(batch, tokens[i], i, false);
+    }
+    batch.logits[batch.n_tokens - 1] = true;
+
+    LOGI("Evaluating prompt batch (%d tokens)...", n_tokens);
+    if (decode_traced("llama.prefill", batch) != 0) {
+        LOGE("Failed to evaluate prompt");
+        llama_batch_free(batch);
+        g_is_generating.store(false);
+        return -1;
+    }
+    llama_batch_free(batch);
+    LOGI("Prompt evaluated, starting generation...");
+
+    // Sampler
+    llama_sampler *smpl = llama_sampler_chain_init(llama_sampler_chain_default_params());
+    llama_sampler_chain_add(smpl, llama_sampler_init_top_p(topP, 1));
+    llama_sampler_chain_add(smpl, llama_sampler_init_temp(temperature));
+    llama_sampler_chain_add(smpl, llama_sampler_init_dist(42));
+
+    std::string accumulated;
+    int n_cur = n_tokens;
+
+    for (int i = 0; i < maxTokens; i++) {
+        if (g_cancel_generation.load()) {
+            LOGI("Streaming generation cancelled at token %d", i);
+            break;
+        }
+
+        llama_token new_token;
+        {
+            NOVA_TRACE_SCOPE("llama", "llama.sample");
+            new_token = llama_sampler_sample(smpl, g_ctx, -1);
+        }
+
+        if (llama_vocab_is_eog(vocab, new_token)) {
+            LOGI("EOG reached at token %d", i);
+            break;
+        }
+
+        char buf[256];
+        int n = llama_token_to_piece(vocab, new_token, buf, sizeof(buf), 0, true);
+        if (n > 0) {
+            std::string piece(buf, n);
+            accumulated += piece;
+
+            // Check stop strings
+            bool should_stop = false;
+            for (const auto &stop : stop_strs) {
+                size_t pos = accumulated.rfind(stop);
+                if (pos != std::string::npos) {
+                    piece = "";
+                    should_stop = true;
+                    break;
+                }
+            }
+
+            if (!piece.empty() && !onPiece(piece)) {
+                LOGI("Token consumer stopped generation at token %d", i);
+                break;
+            }
+
+            if (should_stop) {
+                LOGI("Stop string hit at token %d", i);
+                break;
+            }
+        }
+
+        // Evaluate new token
+        llama_batch single = llama_batch_init(1, 0, 1);
+        batch_add_token(single, new_token, n_cur, true);
+        if (decode_traced("llama.decode", single) != 0) {
+            LOGE("Decode failed at position %d", n_cur);
+            llama_batch_free(single);
+            break;
+        }
+        llama_batch_free(single);
+        n_cur++;
+    }
+
+    llama_sampler_free(smpl);
+    g_is_generating.store(false);
+    LOGI("Streaming complete: generated %d tokens, %d chars", n_cur - n_tokens, (int)accumulated.size());
+    span.arg("prompt_tokens", n_tokens);
+    span.arg("tokens", n_cur - n_tokens);
+    return n_cur - n_tokens;
+}
+
 // ============================================================
 // JNI Functions
 // ============================================================
@@ -54,6 +185,7 @@ Java_com_nova_companion_inference_LlamaJNI_loadModel(
         jint nThreads) {
 
     std::lock_guard<std::mutex> lock(g_mutex);
+    NOVA_TRACE_SCOPE("llama", "llama.load");
 
     // Unload existing model if any
     if (g_ctx) {
@@ -123,6 +255,7 @@ Java_com_nova_companion_inference_LlamaJNI_generate(
         jobjectArray stopStrings) {
 
     std::lock_guard<std::mutex> lock(g_mutex);
+    NOVA_TRACE_SCOPE("llama", "llama.generate");
 
     if (!g_model || !g_ctx) {
         LOGE("Model not loaded");
@@ -172,7 +305,7 @@ Java_com_nova_companion_inference_LlamaJNI_generate(
     }
     batch.logits[batch.n_tokens - 1] = true; // Only compute logits for last token
 
-    if (llama_decode(g_ctx, batch) != 0) {
+    if (decode_traced("llama.prefill", batch) != 0) {
         LOGE("Failed to evaluate prompt");
         llama_batch_free(batch);
         g_is_generating.store(false);
@@ -232,7 +365,7 @@ Java_com_nova_companion_inference_LlamaJNI_generate(
         // Evaluate the new token
         llama_batch single = llama_batch_init(1, 0, 1);
         batch_add_token(single, new_token, n_cur, true);
-        if (llama_decode(g_ctx, single) != 0) {
+        if (decode_traced("llama.decode", single) != 0) {
             LOGE("Failed to evaluate token at position %d", n_cur);
             llama_batch_free(single);
             break;
@@ -266,9 +399,6 @@ Java_com_nova_companion_inference_LlamaJNI_generateStreaming(
         return;
     }
 
-    g_is_generating.store(true);
-    g_cancel_generation.store(false);
-
     const char *prompt_cstr = env->GetStringUTFChars(prompt, nullptr);
     std::string prompt_str(prompt_cstr);
     env->ReleaseStringUTFChars(prompt, prompt_cstr);
@@ -290,117 +420,24 @@ Java_com_nova_companion_inference_LlamaJNI_generateStreaming(
     jmethodID onToken = env->GetMethodID(callbackClass, "onToken", "(Ljava/lang/String;)V");
     if (!onToken) {
         LOGE("Failed to find onToken callback method");
-        g_is_generating.store(false);
         return;
     }
 
-    // Tokenize
-    const llama_vocab *vocab = llama_model_get_vocab(g_model);
-    std::vector<llama_token> tokens(prompt_str.size() + 128);
-    int n_tokens = llama_tokenize(vocab, prompt_str.c_str(), prompt_str.size(),
-                                   tokens.data(), tokens.size(), true, true);
-    if (n_tokens < 0) {
-        LOGE("Failed to tokenize prompt (result: %d)", n_tokens);
-        g_is_generating.store(false);
-        return;
-    }
-    tokens.resize(n_tokens);
-    LOGI("Streaming: prompt tokens=%d, max=%d", n_tokens, maxTokens);
-
-    // Clear KV cache and evaluate prompt
-    llama_memory_clear(llama_get_memory(g_ctx), true);
-
-    llama_batch batch = llama_batch_init(tokens.size(), 0, 1);
-    for (int i = 0; i < n_tokens; i++) {
-        batch_add_token(batch, tokens[i], i, false);
-    }
-    batch.logits[batch.n_tokens - 1] = true;
-
-    LOGI("Evaluating prompt batch (%d tokens)...", n_tokens);
-    if (llama_decode(g_ctx, batch) != 0) {
-        LOGE("Failed to evaluate prompt");
-        llama_batch_free(batch);
-        g_is_generating.store(false);
-        return;
-    }
-    llama_batch_free(batch);
-    LOGI("Prompt evaluated, starting generation...");
-
-    // Sampler
-    llama_sampler *smpl = llama_sampler_chain_init(llama_sampler_chain_default_params());
-    llama_sampler_chain_add(smpl, llama_sampler_init_top_p(topP, 1));
-    llama_sampler_chain_add(smpl, llama_sampler_init_temp(temperature));
-    llama_sampler_chain_add(smpl, llama_sampler_init_dist(42));
-
-    std::string accumulated;
-    int n_cur = n_tokens;
-
-    for (int i = 0; i < maxTokens; i++) {
-        if (g_cancel_generation.load()) {
-            LOGI("Streaming generation cancelled at token %d", i);
-            break;
-        }
-
-        llama_token new_token = llama_sampler_sample(smpl, g_ctx, -1);
-
-        if (llama_vocab_is_eog(vocab, new_token)) {
-            LOGI("EOG reached at token %d", i);
-            break;
-        }
-
-        char buf[256];
-        int n = llama_token_to_piece(vocab, new_token, buf, sizeof(buf), 0, true);
-        if (n > 0) {
-            std::string piece(buf, n);
-            accumulated += piece;
-
-            // Check stop strings
-            bool should_stop = false;
-            for (const auto &stop : stop_strs) {
-                size_t pos = accumulated.rfind(stop);
-                if (pos != std::string::npos) {
-                    piece = "";
-                    should_stop = true;
-                    break;
-                }
-            }
-
-            // Send token to Kotlin callback
-            if (!piece.empty()) {
-                jstring jPiece = env->NewStringUTF(piece.c_str());
-                if (jPiece) {
-                    env->CallVoidMethod(callback, onToken, jPiece);
-                    env->DeleteLocalRef(jPiece);
-                    // Check for Java exception
-                    if (env->ExceptionCheck()) {
-                        LOGE("Java exception during onToken callback at token %d", i);
-                        env->ExceptionClear();
-                        break;
-                    }
-                }
-            }
-
-            if (should_stop) {
-                LOGI("Stop string hit at token %d", i);
-                break;
+    stream_tokens(prompt_str, maxTokens, temperature, topP, stop_strs, [&](const std::string &piece) {
+        // Send token to Kotlin callback
+        jstring jPiece = env->NewStringUTF(piece.c_str());
+        if (jPiece) {
+            env->CallVoidMethod(callback, onToken, jPiece);
+            env->DeleteLocalRef(jPiece);
+            // Check for Java exception
+            if (env->ExceptionCheck()) {
+                LOGE("Java exception during onToken callback");
+                env->ExceptionClear();
+                return false;
             }
         }
-
-        // Evaluate new token
-        llama_batch single = llama_batch_init(1, 0, 1);
-        batch_add_token(single, new_token, n_cur, true);
-        if (llama_decode(g_ctx, single) != 0) {
-            LOGE("Decode failed at position %d", n_cur);
-            llama_batch_free(single);
-            break;
-        }
-        llama_batch_free(single);
-        n_cur++;
-    }
-
-    llama_sampler_free(smpl);
-    g_is_generating.store(false);
-    LOGI("Streaming complete: generated %d tokens, %d chars", n_cur - n_tokens, (int)accumulated.size());
+        return true;
+    });
 }
 
 JNIEXPORT void JNICALL
@@ -452,4 +489,54 @@ Java_com_nova_companion_inference_LlamaJNI_isGenerating(
     return g_is_generating.load() ? JNI_TRUE : JNI_FALSE;
 }
 
+// ============================================================
+// Tracing (trace.h)
+// ============================================================
+JNIEXPORT void JNICALL
+Java_com_nova_companion_inference_LlamaJNI_setTraceMode(
+        JNIEnv * /*env*/,
+        jobject /* this */,
+        jint mode) {
+    trace::set_mode(mode);
+}
+
+JNIEXPORT jstring JNICALL
+Java_com_nova_companion_inference_LlamaJNI_dumpTrace(
+        JNIEnv *env,
+        jobject /* this */) {
+    return env->NewStringUTF(trace::dump_events().c_str());
+}
+
 } // extern "C"
+
+// ============================================================
+// Stage entry points for the native voice pipeline (stage_api.h)
+// ============================================================
+
+NOVA_STAGE_API int nova_llama_ready(void) {
+    return (g_model != nullptr && g_ctx != nullptr) ? 1 : 0;
+}
+
+NOVA_STAGE_API int nova_llama_generate(const char *prompt, int maxTokens, float temperature, float topP,
+                                       const char *const *stops, int nStops,
+                                       nova_token_fn onToken, void *user) {
+    std::lock_guard<std::mutex> lock(g_mutex);
+
+    if (!g_model || !g_ctx || !prompt || !onToken) {
+        LOGE("Model not loaded");
+        return -1;
+    }
+
+    std::vector<std::string> stop_strs;
+    for (int i = 0; i < nStops; i++) {
+        if (stops[i]) stop_strs.emplace_back(stops[i]);
+    }
+    return stream_tokens(prompt, maxTokens, temperature, topP, stop_strs, [&](const std::string &piece) {
+        return onToken(user, piece.c_str()) != 0;
+    });
+}
+
+NOVA_STAGE_API void nova_llama_cancel(void) {
+    g_cancel_generation.store(true);
+    LOGI("Generation cancel requested (pipeline)");
+}
@@ -0,0 +1,119 @@
+/**
+ * Whisper-compatible log-mel frames — see log_mel.h.
+ */
+
+#include "log_mel.h"
+
+#include "audio_simd.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+using namespace logmel;
+
+namespace {
+
+// Slaney-style mel scale (librosa htk=False), as used by whisper's filters
+double hz_to_mel(double hz) {
+    const double f_sp = 200.0 / 3.0;
+    const double min_log_hz = 1000.0;
+    const double min_log_mel = min_log_hz / f_sp;
+    const double logstep = std::log(6.4) / 27.0;
+    if (hz >= min_log_hz) return min_log_mel + std::log(hz / min_log_hz) / logstep;
+    return hz / f_sp;
+}
+
+double mel_to_hz(double mel) {
+    const double f_sp = 200.0 / 3.0;
+    const double min_log_hz = 1000.0;
+    const double min_log_mel = min_log_hz / f_sp;
+    const double logstep = std::log(6.4) / 27.0;
+    if (mel >= min_log_mel) return min_log_hz * std::exp(logstep * (mel - min_log_mel));
+    return f_sp * mel;
+}
+
+} // namespace
+
+LogMel::LogMel()
+    : m_fft(N_FFT),
+      m_window(N_FFT),
+      m_history(HISTORY, 0.0f),
+      m_windowed(N_FFT),
+      m_spectrum(N_BINS),
+      m_power(N_BINS) {
+
+    for (int i = 0; i < N_FFT; i++) {
+        m_window[i] = 0.5f * (1.0f - (float) cos(2.0 * M_PI * i / N_FFT));
+    }
+
+    // Triangular filters between N_MEL + 2 mel-spaced edges, area-normalized
+    std::vector<double> edges(N_MEL + 2);
+    const double melMin = hz_to_mel(0.0);
+    const double melMax = hz_to_mel(SAMPLE_RATE / 2.0);
+    for (int i = 0; i < N_MEL + 2; i++) {
+        edges[i] = mel_to_hz(melMin + (melMax - melMin) * i / (N_MEL + 1));
+    }
+
+    m_filters.resize(N_MEL);
+    for (int m = 0; m < N_MEL; m++) {
+        const double lo = edges[m], mid = edges[m + 1], hi = edges[m + 2];
+        const double enorm = 2.0 / (hi - lo);
+        Filter &f = m_filters[m];
+        f.start = -1;
+        for (int k = 0; k < N_BINS; k++) {
+            const double hz = (double) k * SAMPLE_RATE / N_FFT;
+            const double w = std::max(0.0, std::min((hz - lo) / (mid - lo), (hi - hz) / (hi - mid)));
+            if (w <= 0.0) {
+                if (f.start >= 0) break;
+                continue;
+            }
+            if (f.start < 0) f.start = k;
+            f.weights.push_back((float) (w * enorm));
+        }
+        if (f.start < 0) f.start = 0;
+    }
+}
+
+void LogMel::reset() {
+    std::fill(m_history.begin(), m_history.end(), 0.0f);
+    m_hops = 0;
+}
+
+bool LogMel::push(const float *hop, float *out) {
+    memmove(m_history.data(), m_history.data() + HOP, (HISTORY - HOP) * sizeof(float));
+    memcpy(m_history.data() + (HISTORY - HOP), hop, HOP * sizeof(float));
+    if (++m_hops < FRAME_DELAY) return false;
+
+    // The oldest N_FFT samples are centred on the frame FRAME_DELAY hops back
+    frame(m_history.data(), out);
+    return true;
+}
+
+void LogMel::frame(const float *window, float *out) {
+    simd::mul(window, m_window.data(), m_windowed.data(), N_FFT);
+
+    m_fft.forwardReal(m_windowed.data(), m_spectrum.data());
+    simd::power(reinterpret_cast<const float *>(m_spectrum.data()), m_power.data(), N_BINS);
+
+    for (int m = 0; m < N_MEL; m++) {
+        const Filter &f = m_filters[m];
+        const float sum = simd::dot(f.weights.data(), m_power.data() + f.start, (int) f.weights.size());
+        out[m] = std::log10(std::max(sum, 1e-10f));
+    }
+}
+
+void LogMel::toWhisperMel(const float *frames, int nFrames, std::vector<float> &out, float gain) {
+    const int nLen = nFrames + WHISPER_CHUNK_FRAMES;
+    out.assign((size_t) N_MEL * nLen, LOG_FLOOR);
+    for (int t = 0; t < nFrames; t++) {
+        const float *frame = frames + (size_t) t * N_MEL;
+        for (int m = 0; m < N_MEL; m++) out[(size_t) m * nLen + t] = frame[m];
+    }
+
+    // Same normalization as whisper's log_mel_spectrogram. The gain offset
+    // shifts the max along with every frame, so it only enters the final +4.
+    const float mmax = nFrames > 0 ? simd::max(frames, (size_t) nFrames * N_MEL) : LOG_FLOOR;
+    const float logGain = gain > 0.0f ? 2.0f * std::log10(gain) : 0.0f;
+    simd::clamp_offset_scale(out.data(), out.size(), mmax - 8.0f, 4.0f + logGain, 0.25f);
+}
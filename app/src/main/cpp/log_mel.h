@@ -0,0 +1,72 @@
+/**
+ * Incremental whisper-compatible log-mel front end.
+ *
+ * Produces one 80-bin frame per 10 ms hop using the exact whisper recipe
+ * (400-point periodic Hann STFT, Slaney mel filters, log10 with 1e-10 floor)
+ * and whisper's centred frame alignment, so the same frames feed the
+ * keyword spotter and whisper itself (see MelRing). Window-level
+ * normalization (clamp to max - 8, (x + 4) / 4) depends on the span being
+ * decoded and is applied by toWhisperMel().
+ */
+
+#pragma once
+
+#include <complex>
+#include <vector>
+
+#include "fft.h"
+
+namespace logmel {
+constexpr int SAMPLE_RATE = 16000;
+constexpr int N_FFT = 400;
+constexpr int HOP = 160;
+constexpr int N_MEL = 80;
+constexpr int N_BINS = N_FFT / 2 + 1;
+constexpr float LOG_FLOOR = -10.0f;  // log10(1e-10)
+constexpr int WHISPER_CHUNK_FRAMES = 3000;  // 30 s
+}
+
+class LogMel {
+public:
+    // Frames lag the newest hop by this many frames: frame i is centred on
+    // sample i * HOP and needs audio up to i * HOP + N_FFT / 2.
+    static constexpr int FRAME_DELAY = 2;
+
+    LogMel();
+
+    // Push one hop (HOP samples, [-1, 1]). Once enough audio is buffered,
+    // writes the frame centred FRAME_DELAY hops back into out[N_MEL] and
+    // returns true. Audio before the first hop counts as silence.
+    bool push(const float *hop, float *out);
+
+    // Compute a frame from an explicit N_FFT-sample window
+    void frame(const float *window, float *out);
+
+    void reset();
+
+    // Build a whisper mel input [N_MEL][nFrames + WHISPER_CHUNK_FRAMES] from
+    // frame-major log10 frames[nFrames][N_MEL]: transposed, padded with
+    // silence like whisper_pcm_to_mel, clamped to max - 8 and scaled.
+    // gain is a linear amplitude gain applied to the underlying audio; in
+    // the log-power domain it is just an offset of 2 * log10(gain).
+    static void toWhisperMel(const float *frames, int nFrames, std::vector<float> &out,
+                             float gain = 1.0f);
+
+private:
+    struct Filter {
+        int start;                 // first FFT bin with non-zero weight
+        std::vector<float> weights;
+    };
+
+    // Audio kept for the next frame: its window is the oldest N_FFT samples
+    static constexpr int HISTORY = FRAME_DELAY * logmel::HOP + logmel::N_FFT / 2;
+
+    Fft m_fft;
+    std::vector<float> m_window;         // periodic Hann
+    std::vector<Filter> m_filters;
+    std::vector<float> m_history;        // last HISTORY samples
+    int m_hops = 0;
+    std::vector<float> m_windowed;
+    std::vector<std::complex<float>> m_spectrum;
+    std::vector<float> m_power;
+};
@@ -0,0 +1,102 @@
+/**
+ * Overlapping 30 s windows for long-form transcription (files longer than
+ * one whisper window).
+ *
+ * WindowFeed pulls 16 kHz mono audio from a SampleSource as it needs it
+ * and cuts it into LONG_WINDOW_MS windows that overlap by LONG_OVERLAP_MS.
+ * Each window carries the span of words it owns: a word belongs to the
+ * window whose half of the overlap its midpoint falls in, so stitching the
+ * windows' words back together by timestamp neither drops nor repeats any.
+ * Only the samples the next window still needs are kept between calls.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+static const int LONG_SAMPLE_RATE = 16000;   // WHISPER_SAMPLE_RATE
+static const int LONG_WINDOW_MS = 30000;
+static const int LONG_OVERLAP_MS = 2000;
+
+// Word-keeping bounds that keep everything
+static const int32_t KEEP_ALL_FROM = INT32_MIN;
+static const int32_t KEEP_ALL_TO = INT32_MAX;
+
+// Appends the next block of 16 kHz mono audio to `out`.
+// Returns the samples appended, 0 at end of stream, -1 on error.
+using SampleSource = std::function<int(std::vector<float> &out)>;
+
+struct LongWindow {
+    size_t index = 0;
+    int64_t start = 0;      // samples
+    int32_t keepFromMs = KEEP_ALL_FROM;
+    int32_t keepToMs = KEEP_ALL_TO;
+    std::vector<float> audio;
+};
+
+class WindowFeed {
+public:
+    explicit WindowFeed(SampleSource source) : m_source(std::move(source)) {}
+
+    // Next window (with its own copy of the audio); false at the end or on error
+    bool next(LongWindow &w) {
+        const int64_t msSamples = LONG_SAMPLE_RATE / 1000;
+        const int64_t window = LONG_WINDOW_MS * msSamples;
+        const int64_t stride = (LONG_WINDOW_MS - LONG_OVERLAP_MS) * msSamples;
+        if (m_done) return false;
+
+        // One sample past the window tells us whether another window follows
+        while (!m_eof && bufferEnd() <= m_start + window) {
+            const int n = m_source(m_buf);
+            if (n < 0) {
+                m_failed = true;
+                m_done = true;
+                return false;
+            }
+            if (n == 0) m_eof = true;
+        }
+        const int64_t end = std::min(bufferEnd(), m_start + window);
+        if (end <= m_start) {
+            m_done = true;
+            return false;
+        }
+
+        const bool last = bufferEnd() <= m_start + window;
+        w.index = m_index;
+        w.start = m_start;
+        w.keepFromMs = m_index > 0 ? (int32_t) (m_start / msSamples + LONG_OVERLAP_MS / 2) : KEEP_ALL_FROM;
+        w.keepToMs = last ? KEEP_ALL_TO : (int32_t) ((m_start + stride) / msSamples + LONG_OVERLAP_MS / 2);
+        w.audio.assign(m_buf.begin() + (m_start - m_bufStart), m_buf.begin() + (end - m_bufStart));
+
+        m_index++;
+        if (last) {
+            m_done = true;
+        } else {
+            m_start += stride;
+            m_buf.erase(m_buf.begin(), m_buf.begin() + (m_start - m_bufStart));
+            m_bufStart = m_start;
+        }
+        return true;
+    }
+
+    bool failed() const { return m_failed; }
+
+    // Samples pulled from the source so far (the whole stream once done)
+    int64_t samples() const { return bufferEnd(); }
+
+private:
+    int64_t bufferEnd() const { return m_bufStart + (int64_t) m_buf.size(); }
+
+    SampleSource m_source;
+    std::vector<float> m_buf;   // m_buf[0] is sample m_bufStart
+    int64_t m_bufStart = 0;
+    int64_t m_start = 0;        // start of the next window
+    size_t m_index = 0;
+    bool m_eof = false;
+    bool m_done = false;
+    bool m_failed = false;
+};
@@ -0,0 +1,76 @@
+/**
+ * Single-writer ring of log-mel frames, the feature-side twin of AudioRing.
+ *
+ * Frame i is centred on PCM sample i * HOP of the AudioRing, so any consumer
+ * can map an audio span to its frames. The front end computes every frame
+ * exactly once; wake word, VAD gating and whisper windows all read from here.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "log_mel.h"
+
+class MelRing {
+public:
+    // capacity is rounded up to a power of two
+    explicit MelRing(size_t capacityFrames) {
+        size_t cap = 1;
+        while (cap < capacityFrames) cap <<= 1;
+        m_data.resize(cap * logmel::N_MEL);
+        m_mask = cap - 1;
+    }
+
+    size_t capacity() const { return m_mask + 1; }
+
+    // One past the newest frame
+    int64_t writeIndex() const { return m_writeIndex.load(std::memory_order_acquire); }
+
+    int64_t oldestIndex() const {
+        const int64_t wi = writeIndex();
+        return std::max<int64_t>(m_firstIndex.load(std::memory_order_relaxed), wi - (int64_t) capacity());
+    }
+
+    // Writer thread only. Frames skipped since the last write (e.g. while
+    // capture was stopped) are filled with silence.
+    void write(int64_t index, const float *frame) {
+        int64_t wi = m_writeIndex.load(std::memory_order_relaxed);
+        if (wi == 0 && m_firstIndex.load(std::memory_order_relaxed) < 0) {
+            m_firstIndex.store(index, std::memory_order_relaxed);
+            wi = index;
+        }
+        if (index < wi) return;
+        for (; wi < index; wi++) {
+            std::fill_n(slot(wi), logmel::N_MEL, logmel::LOG_FLOOR);
+        }
+        memcpy(slot(index), frame, logmel::N_MEL * sizeof(float));
+        m_writeIndex.store(index + 1, std::memory_order_release);
+    }
+
+    // Copy frames [from, from + n) frame-major into out[n][N_MEL]. Returns
+    // false if the range isn't fully written or was overwritten meanwhile.
+    bool read(int64_t from, size_t n, float *out) const {
+        const int64_t wi = writeIndex();
+        if (from < oldestIndex() || from + (int64_t) n > wi) return false;
+        for (size_t i = 0; i < n; i++) {
+            memcpy(out + i * logmel::N_MEL, slot(from + (int64_t) i), logmel::N_MEL * sizeof(float));
+        }
+        return from >= writeIndex() - (int64_t) capacity();
+    }
+
+private:
+    float *slot(int64_t index) { return m_data.data() + ((size_t) index & m_mask) * logmel::N_MEL; }
+    const float *slot(int64_t index) const {
+        return m_data.data() + ((size_t) index & m_mask) * logmel::N_MEL;
+    }
+
+    std::vector<float> m_data;
+    size_t m_mask = 0;
+    std::atomic<int64_t> m_writeIndex{0};
+    std::atomic<int64_t> m_firstIndex{-1};
+};
@@ -0,0 +1,97 @@
+/**
+ * Spectral noise suppression — see noise_suppressor.h.
+ */
+
+#include "noise_suppressor.h"
+
+#include "audio_simd.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// Frames averaged into the initial noise estimate (~250 ms)
+static constexpr int INIT_FRAMES = 25;
+// Per-bin power smoothing before tracking; the tracker follows minima of
+// the smoothed spectrum, so NOISE_BIAS lifts it back to the mean level
+static constexpr float POWER_SMOOTH = 0.3f;
+static constexpr float NOISE_BIAS = 1.5f;
+// Noise floor: fraction of the gap closed per frame when power drops below
+// it, and how fast it may creep up while power stays above (dB / second)
+static constexpr float NOISE_FALL = 0.1f;
+static constexpr float NOISE_RISE_DB_PER_S = 1.5f;
+// Decision-directed smoothing and minimum gain (-16 dB). A higher floor
+// leaves some noise but avoids musical artifacts that hurt whisper more.
+static constexpr float DD_ALPHA = 0.98f;
+static constexpr float GAIN_FLOOR = 0.16f;
+
+NoiseSuppressor::NoiseSuppressor(int sampleRate)
+    : m_fft(FRAME),
+      m_noiseRise(std::pow(10.0f, NOISE_RISE_DB_PER_S / 10.0f * HOP / sampleRate)),
+      m_window(FRAME),
+      m_input(FRAME, 0.0f),
+      m_frame(FRAME),
+      m_spectrum(N_BINS),
+      m_power(N_BINS),
+      m_smoothed(N_BINS, 0.0f),
+      m_noise(N_BINS, 0.0f),
+      m_clean(N_BINS, 0.0f),
+      m_gain(N_BINS, 1.0f),
+      m_overlap(HOP, 0.0f) {
+
+    // sqrt of a periodic Hann: analysis * synthesis sums to 1 at 50% overlap
+    for (int i = 0; i < FRAME; i++) {
+        m_window[i] = (float) std::sqrt(0.5 * (1.0 - std::cos(2.0 * M_PI * i / FRAME)));
+    }
+}
+
+void NoiseSuppressor::reset() {
+    std::fill(m_input.begin(), m_input.end(), 0.0f);
+    std::fill(m_smoothed.begin(), m_smoothed.end(), 0.0f);
+    std::fill(m_noise.begin(), m_noise.end(), 0.0f);
+    std::fill(m_clean.begin(), m_clean.end(), 0.0f);
+    std::fill(m_overlap.begin(), m_overlap.end(), 0.0f);
+    m_frames = 0;
+    m_frameSnr = 0.0f;
+}
+
+void NoiseSuppressor::process(const float *in, float *out) {
+    memmove(m_input.data(), m_input.data() + HOP, (FRAME - HOP) * sizeof(float));
+    memcpy(m_input.data() + (FRAME - HOP), in, HOP * sizeof(float));
+
+    simd::mul(m_input.data(), m_window.data(), m_frame.data(), FRAME);
+    m_fft.forwardReal(m_frame.data(), m_spectrum.data());
+    float *spectrum = reinterpret_cast<float *>(m_spectrum.data());
+    simd::power(spectrum, m_power.data(), N_BINS);
+
+    for (int k = 0; k < N_BINS; k++) m_smoothed[k] += POWER_SMOOTH * (m_power[k] - m_smoothed[k]);
+
+    if (m_frames < INIT_FRAMES) {
+        // Running mean over the first frames: assume the session opens on
+        // room noise, which the fast-falling tracker corrects if it didn't
+        const float w = 1.0f / (float) (m_frames + 1);
+        for (int k = 0; k < N_BINS; k++) m_noise[k] += w * (m_power[k] / NOISE_BIAS - m_noise[k]);
+        m_frames++;
+    } else {
+        simd::noise_update(m_smoothed.data(), m_noise.data(), N_BINS, NOISE_FALL, m_noiseRise);
+    }
+
+    float power = 0.0f, noise = 0.0f;
+    for (int k = 0; k < N_BINS; k++) {
+        power += m_power[k];
+        noise += m_noise[k];
+    }
+    m_frameSnr = noise > 0.0f ? power / (noise * NOISE_BIAS) : 0.0f;
+
+    simd::wiener_gain(m_power.data(), m_noise.data(), m_clean.data(), m_gain.data(),
+                      N_BINS, NOISE_BIAS, DD_ALPHA, GAIN_FLOOR);
+    simd::scale_complex(spectrum, m_gain.data(), N_BINS);
+    m_fft.inverseReal(m_spectrum.data(), m_frame.data());
+
+    // Overlap-add: the first half completes the hop that entered one call ago
+    float hop[HOP];
+    memcpy(hop, m_overlap.data(), HOP * sizeof(float));
+    simd::mul_add(m_frame.data(), m_window.data(), hop, HOP);
+    simd::mul(m_frame.data() + HOP, m_window.data() + HOP, m_overlap.data(), HOP);
+    memcpy(out, hop, HOP * sizeof(float));
+}
@@ -0,0 +1,54 @@
+/**
+ * Single-channel spectral noise suppression for the voice front end.
+ *
+ * 20 ms sqrt-Hann frames at a 10 ms hop (perfect reconstruction by
+ * overlap-add), a per-bin noise floor that drops quickly and rises slowly
+ * (~1.5 dB/s) so it follows the minimum of the spectrum through speech, and
+ * a decision-directed Wiener gain with a fixed floor. Deterministic and
+ * device-independent, unlike the platform NoiseSuppressor effect.
+ *
+ * Output lags the input by one hop (10 ms).
+ */
+
+#pragma once
+
+#include <complex>
+#include <vector>
+
+#include "fft.h"
+
+class NoiseSuppressor {
+public:
+    static constexpr int HOP = 160;
+    static constexpr int FRAME = 2 * HOP;
+    static constexpr int N_BINS = FRAME / 2 + 1;
+
+    explicit NoiseSuppressor(int sampleRate = 16000);
+
+    // One hop in, one (delayed) hop out. in and out may alias.
+    void process(const float *in, float *out);
+
+    // Frame power over the noise estimate (a posteriori SNR, linear) of the
+    // last processed frame — cheap speech-presence cue for the AGC
+    float frameSnr() const { return m_frameSnr; }
+
+    void reset();
+
+private:
+    using cpx = std::complex<float>;
+
+    Fft m_fft;
+    float m_noiseRise;
+    std::vector<float> m_window;     // sqrt periodic Hann, analysis + synthesis
+    std::vector<float> m_input;      // last FRAME input samples
+    std::vector<float> m_frame;
+    std::vector<cpx> m_spectrum;
+    std::vector<float> m_power;
+    std::vector<float> m_smoothed;   // recursively averaged power
+    std::vector<float> m_noise;
+    std::vector<float> m_clean;      // previous frame's clean power estimate
+    std::vector<float> m_gain;
+    std::vector<float> m_overlap;    // second half of the previous output frame
+    int m_frames = 0;
+    float m_frameSnr = 0.0f;
+};
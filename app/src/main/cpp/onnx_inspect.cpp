@@ -0,0 +1,277 @@
+/**
+ * ONNX quantization check — see onnx_inspect.h.
+ */
+
+#include "onnx_inspect.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <set>
+#include <stdexcept>
+
+namespace {
+
+// onnx.proto field numbers used here
+constexpr int MODEL_GRAPH = 7;
+constexpr int GRAPH_NODE = 1;
+constexpr int GRAPH_INITIALIZER = 5;
+constexpr int NODE_OP_TYPE = 4;
+constexpr int NODE_ATTRIBUTE = 5;
+constexpr int ATTRIBUTE_T = 5;
+constexpr int ATTRIBUTE_G = 6;
+constexpr int ATTRIBUTE_TENSORS = 10;
+constexpr int ATTRIBUTE_GRAPHS = 11;
+constexpr int TENSOR_DIMS = 1;
+constexpr int TENSOR_DATA_TYPE = 2;
+
+constexpr int WIRE_VARINT = 0;
+constexpr int WIRE_FIXED64 = 1;
+constexpr int WIRE_BYTES = 2;
+constexpr int WIRE_FIXED32 = 5;
+
+// Nested graphs (If / Loop bodies) deeper than this are not followed
+constexpr int MAX_DEPTH = 8;
+
+const std::set<std::string> DYNAMIC_OPS = {
+    "DynamicQuantizeLinear", "MatMulInteger", "ConvInteger", "MatMulIntegerToFloat",
+    "DynamicQuantizeMatMul", "DynamicQuantizeLSTM",
+};
+
+const std::set<std::string> INTEGER_OPS = {
+    "MatMulInteger", "ConvInteger", "MatMulIntegerToFloat", "DynamicQuantizeMatMul",
+    "DynamicQuantizeLSTM", "QGemm", "QAttention",
+};
+
+const std::set<std::string> FLOAT_COMPUTE_OPS = {
+    "Conv", "ConvTranspose", "MatMul", "Gemm", "LSTM", "GRU", "RNN", "Attention", "Einsum",
+    "FusedConv", "FusedGemm", "FusedMatMul", "NhwcFusedConv",
+};
+
+bool is_qoperator(const std::string &op) {
+    return op.compare(0, 7, "QLinear") == 0 || op == "QGemm" || op == "QAttention";
+}
+
+// Bits per element for TensorProto.DataType, 0 if not a weight type we track
+int element_bits(int64_t dataType, bool &integer) {
+    integer = false;
+    switch (dataType) {
+        case 1: return 32;                          // FLOAT
+        case 10: case 16: return 16;                // FLOAT16, BFLOAT16
+        case 11: return 64;                         // DOUBLE
+        case 2: case 3: integer = true; return 8;   // UINT8, INT8
+        case 21: case 22: integer = true; return 4; // UINT4, INT4
+        default: return 0;
+    }
+}
+
+// Sequential protobuf reader over the file; payloads are skipped by seeking
+class ProtoReader {
+public:
+    explicit ProtoReader(std::ifstream &in) : m_in(in) {}
+
+    uint64_t pos() { return (uint64_t) m_in.tellg(); }
+
+    bool varint(uint64_t &value) {
+        value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            const int c = m_in.get();
+            if (c == EOF) return false;
+            value |= (uint64_t) (c & 0x7f) << shift;
+            if (!(c & 0x80)) return true;
+        }
+        return false;
+    }
+
+    bool key(int &field, int &wire) {
+        uint64_t k;
+        if (!varint(k)) return false;
+        field = (int) (k >> 3);
+        wire = (int) (k & 7);
+        return true;
+    }
+
+    bool skip(int wire) {
+        uint64_t n;
+        switch (wire) {
+            case WIRE_VARINT: return varint(n);
+            case WIRE_FIXED64: return seek(8);
+            case WIRE_FIXED32: return seek(4);
+            case WIRE_BYTES: return varint(n) && seek(n);
+            default: return false;   // groups are not used by onnx.proto
+        }
+    }
+
+    bool string(std::string &out) {
+        uint64_t n;
+        if (!varint(n) || n > 4096) return false;
+        out.resize((size_t) n);
+        return n == 0 || (bool) m_in.read(&out[0], (std::streamsize) n);
+    }
+
+    // Length prefix of an embedded message; returns its end offset
+    bool message(uint64_t &end) {
+        uint64_t n;
+        if (!varint(n)) return false;
+        end = pos() + n;
+        return true;
+    }
+
+private:
+    bool seek(uint64_t n) { return (bool) m_in.seekg((std::streamoff) n, std::ios::cur); }
+
+    std::ifstream &m_in;
+};
+
+class Scanner {
+public:
+    Scanner(ProtoReader &reader, QuantizationReport &report) : r(reader), m_report(report) {}
+
+    bool model(uint64_t end) {
+        int field, wire;
+        bool sawGraph = false;
+        while (r.pos() < end && r.key(field, wire)) {
+            if (field == MODEL_GRAPH && wire == WIRE_BYTES) {
+                uint64_t graphEnd;
+                if (!r.message(graphEnd) || !graph(graphEnd, 0)) return false;
+                sawGraph = true;
+            } else if (!r.skip(wire)) {
+                return false;
+            }
+        }
+        return sawGraph;
+    }
+
+private:
+    bool graph(uint64_t end, int depth) {
+        int field, wire;
+        while (r.pos() < end && r.key(field, wire)) {
+            uint64_t sub;
+            if (field == GRAPH_NODE && wire == WIRE_BYTES) {
+                if (!r.message(sub) || !node(sub, depth)) return false;
+            } else if (field == GRAPH_INITIALIZER && wire == WIRE_BYTES) {
+                if (!r.message(sub) || !tensor(sub)) return false;
+            } else if (!r.skip(wire)) {
+                return false;
+            }
+        }
+        return r.pos() == end;
+    }
+
+    bool node(uint64_t end, int depth) {
+        int field, wire;
+        while (r.pos() < end && r.key(field, wire)) {
+            if (field == NODE_OP_TYPE && wire == WIRE_BYTES) {
+                std::string op;
+                if (!r.string(op)) return false;
+                m_report.ops[op]++;
+            } else if (field == NODE_ATTRIBUTE && wire == WIRE_BYTES) {
+                uint64_t sub;
+                if (!r.message(sub) || !attribute(sub, depth)) return false;
+            } else if (!r.skip(wire)) {
+                return false;
+            }
+        }
+        return r.pos() == end;
+    }
+
+    // Constant tensors and control-flow subgraphs live in attributes
+    bool attribute(uint64_t end, int depth) {
+        int field, wire;
+        while (r.pos() < end && r.key(field, wire)) {
+            uint64_t sub;
+            if ((field == ATTRIBUTE_T || field == ATTRIBUTE_TENSORS) && wire == WIRE_BYTES) {
+                if (!r.message(sub) || !tensor(sub)) return false;
+            } else if ((field == ATTRIBUTE_G || field == ATTRIBUTE_GRAPHS) && wire == WIRE_BYTES &&
+                       depth < MAX_DEPTH) {
+                if (!r.message(sub) || !graph(sub, depth + 1)) return false;
+            } else if (!r.skip(wire)) {
+                return false;
+            }
+        }
+        return r.pos() == end;
+    }
+
+    // Size from dims × element type, so raw_data / typed fields / external
+    // data all count the same and never have to be read
+    bool tensor(uint64_t end) {
+        int field, wire;
+        int64_t dataType = 0;
+        uint64_t elements = 1;
+        while (r.pos() < end && r.key(field, wire)) {
+            uint64_t v;
+            if (field == TENSOR_DIMS && wire == WIRE_VARINT) {
+                if (!r.varint(v)) return false;
+                elements *= v;
+            } else if (field == TENSOR_DIMS && wire == WIRE_BYTES) {
+                uint64_t packedEnd;
+                if (!r.message(packedEnd)) return false;
+                while (r.pos() < packedEnd) {
+                    if (!r.varint(v)) return false;
+                    elements *= v;
+                }
+            } else if (field == TENSOR_DATA_TYPE && wire == WIRE_VARINT) {
+                if (!r.varint(v)) return false;
+                dataType = (int64_t) v;
+            } else if (!r.skip(wire)) {
+                return false;
+            }
+        }
+        bool integer;
+        const int bits = element_bits(dataType, integer);
+        const size_t bytes = (size_t) (elements * bits / 8);
+        (integer ? m_report.int8WeightBytes : m_report.floatWeightBytes) += bytes;
+        return r.pos() == end;
+    }
+
+    ProtoReader &r;
+    QuantizationReport &m_report;
+};
+
+} // namespace
+
+std::string QuantizationReport::format() const {
+    if (!quantized()) return "fp32";
+    std::string out;
+    if (dynamic) out += "+dynamic";
+    if (staticOps) out += "+static";
+    if (qdq) out += "+qdq";
+    return "int8-" + out.substr(1);
+}
+
+std::string QuantizationReport::summary() const {
+    char buf[160];
+    std::snprintf(buf, sizeof(buf), "%s, %d integer op(s), weights %.1f MB int8 / %.1f MB float",
+                  format().c_str(), integerOps, int8WeightBytes / 1048576.0, floatWeightBytes / 1048576.0);
+    std::string out = buf;
+    if (!fp32Fallbacks.empty()) {
+        out += ", fp32 fallbacks:";
+        for (const auto &op : fp32Fallbacks) out += " " + op.first + "×" + std::to_string(op.second);
+    }
+    return out;
+}
+
+QuantizationReport inspect_quantization(const std::string &onnxPath) {
+    std::ifstream in(onnxPath, std::ios::binary | std::ios::ate);
+    if (!in) throw std::runtime_error("Cannot open model: " + onnxPath);
+    const uint64_t size = (uint64_t) in.tellg();
+    in.seekg(0);
+
+    QuantizationReport report;
+    ProtoReader reader(in);
+    Scanner scanner(reader, report);
+    if (!scanner.model(size)) throw std::runtime_error("Not an ONNX model: " + onnxPath);
+
+    for (const auto &op : report.ops) {
+        if (DYNAMIC_OPS.count(op.first)) report.dynamic = true;
+        if (is_qoperator(op.first)) report.staticOps = true;
+        if (op.first == "QuantizeLinear" || op.first == "DequantizeLinear") report.qdq = true;
+        if (INTEGER_OPS.count(op.first) || is_qoperator(op.first)) report.integerOps += op.second;
+    }
+    if (report.quantized()) {
+        for (const auto &op : report.ops) {
+            if (FLOAT_COMPUTE_OPS.count(op.first)) report.fp32Fallbacks[op.first] = op.second;
+        }
+    }
+    return report;
+}
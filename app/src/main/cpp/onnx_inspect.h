@@ -0,0 +1,47 @@
+/**
+ * Quantization check for ONNX voice models.
+ *
+ * Reads the model's protobuf directly (no ONNX / protobuf library; weight
+ * payloads are seeked over, so a 60 MB voice scans in a few milliseconds)
+ * and counts node op types, subgraphs included, plus initializer bytes by
+ * element type. From that:
+ *   dynamic   DynamicQuantizeLinear / MatMulInteger / ConvInteger (onnxruntime
+ *             quantize_dynamic): weights int8, activations quantized per run
+ *   static    QLinear* / QGemm / QAttention operators (QOperator format)
+ *   qdq       QuantizeLinear / DequantizeLinear around float ops (QDQ format);
+ *             ONNX Runtime fuses these into integer kernels at session creation
+ *   fp32Fallbacks  heavy compute ops (Conv, ConvTranspose, MatMul, Gemm, LSTM, ...)
+ *             still running in float in a quantized model
+ *
+ * For QDQ models the source graph shows every Conv as float, so fallbacks
+ * are only meaningful on the graph ONNX Runtime actually runs:
+ * VoiceRegistry::inspectOptimized saves it and inspects that.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <string>
+
+struct QuantizationReport {
+    std::map<std::string, int> ops;              // op_type → node count
+    size_t int8WeightBytes = 0;                  // 8- and 4-bit initializers
+    size_t floatWeightBytes = 0;                 // fp32 / fp16 initializers
+    int integerOps = 0;                          // nodes computing in integer
+    bool dynamic = false;
+    bool staticOps = false;
+    bool qdq = false;
+    std::map<std::string, int> fp32Fallbacks;    // empty for fp32 models
+
+    bool quantized() const { return dynamic || staticOps || qdq; }
+
+    // "fp32", "int8-dynamic", "int8-static", "int8-qdq" (joined with '+' if mixed)
+    std::string format() const;
+
+    // One log line: format, integer ops, weight split, fallbacks
+    std::string summary() const;
+};
+
+// Throws std::runtime_error if the file can't be read or isn't an ONNX model
+QuantizationReport inspect_quantization(const std::string &onnxPath);
@@ -0,0 +1,60 @@
+/**
+ * Phoneme id splitting — see phoneme_split.h.
+ */
+
+#include "phoneme_split.h"
+
+#include <algorithm>
+
+std::vector<std::vector<int64_t>> split_phoneme_ids(const std::vector<int64_t> &ids, size_t maxIds,
+                                                    const PhonemeMarks &marks) {
+    if (maxIds == 0 || ids.size() <= maxIds + maxIds / 2) return {ids};
+
+    // Cut the middle, re-wrap each piece in the same head and EOS
+    std::vector<int64_t> head;
+    size_t begin = 0, end = ids.size();
+    if (begin < end && ids[begin] == marks.bos) {
+        head.push_back(ids[begin++]);
+        if (marks.interspersePad && begin < end && ids[begin] == marks.pad) head.push_back(ids[begin++]);
+    }
+    const bool hasEos = end > begin && ids[end - 1] == marks.eos;
+    if (hasEos) end--;
+
+    // Index just past the pad after i, if the voice intersperses one
+    auto skipPad = [&](size_t i) {
+        return marks.interspersePad && i < end && ids[i] == marks.pad ? i + 1 : i;
+    };
+    auto isClause = [&](int64_t id) {
+        return std::find(marks.clause.begin(), marks.clause.end(), id) != marks.clause.end();
+    };
+
+    std::vector<std::vector<int64_t>> pieces;
+    auto emit = [&](size_t from, size_t to) {
+        std::vector<int64_t> piece(head);
+        piece.insert(piece.end(), ids.begin() + (long) from, ids.begin() + (long) to);
+        if (hasEos) piece.push_back(marks.eos);
+        pieces.push_back(std::move(piece));
+    };
+
+    size_t start = begin;
+    size_t target = maxIds / 2;   // short first piece: audio starts sooner
+    for (size_t i = begin; i < end; i++) {
+        size_t cut = 0;
+        if (isClause(ids[i]) && i - start + 1 >= target) {
+            // Mark and the space after it stay with the clause; the next
+            // piece starts at the word
+            cut = skipPad(i + 1);
+            if (cut < end && ids[cut] == marks.space) cut = skipPad(cut + 1);
+        } else if (ids[i] == marks.space && i - start + 1 >= target * WORD_SPLIT_FACTOR) {
+            cut = skipPad(i + 1);
+        }
+        if (cut == 0) continue;
+        if (end - cut < maxIds / 2) break;   // don't leave a fragment at the end
+        emit(start, cut);
+        start = cut;
+        i = cut - 1;
+        target = maxIds;
+    }
+    emit(start, end);
+    return pieces;
+}
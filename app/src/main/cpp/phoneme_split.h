@@ -0,0 +1,35 @@
+/**
+ * Cutting one sentence's phoneme ids into pieces for intra-sentence
+ * streaming (PiperVoice::synthesizeChunked).
+ *
+ * Every piece is rendered as its own utterance, wrapped in BOS / EOS, and
+ * the voice ends each one with a closing contour. Pieces are therefore cut
+ * only after clause punctuation (, ; :), where a speaker would pause and
+ * reset the pitch anyway. A run with no clause mark is cut at a word
+ * boundary only once it passes WORD_SPLIT_FACTOR times the piece size,
+ * about six seconds of speech at the default size.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct PhonemeMarks {
+    int64_t bos = -1;
+    int64_t pad = -1;
+    int64_t eos = -1;
+    bool interspersePad = false;
+    int64_t space = -1;
+    std::vector<int64_t> clause;   // ids of , ; :
+};
+
+static constexpr size_t WORD_SPLIT_FACTOR = 3;
+
+// ids is [BOS (PAD)] phonemes... [EOS]. Pieces hold about maxIds (the
+// first about half that, so audio starts sooner) and the remainder is never
+// left as a fragment under maxIds / 2. maxIds 0 or a short sentence gives
+// back the whole sentence.
+std::vector<std::vector<int64_t>> split_phoneme_ids(const std::vector<int64_t> &ids, size_t maxIds,
+                                                    const PhonemeMarks &marks);
@@ -0,0 +1,134 @@
+/**
+ * JNI bridge for the native voice pipeline (VAD → STT → LLM → TTS).
+ *
+ * Provides native methods for the VoicePipelineJNI Kotlin class. Built into
+ * libnova_whisper next to the front end and decoder it drives.
+ */
+
+#include <jni.h>
+#include <android/log.h>
+
+#include <mutex>
+
+#include "voice_pipeline.h"
+
+#define LOG_TAG "PipelineJNI"
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+
+// Last event returned by nextEvent; its text and value are read separately
+// so events cross JNI as plain ints / strings / floats
+static std::mutex g_event_mutex;
+static pipeline::Event g_event;
+
+static std::string to_string(JNIEnv *env, jstring value) {
+    if (!value) return std::string();
+    const char *chars = env->GetStringUTFChars(value, nullptr);
+    std::string result(chars ? chars : "");
+    if (chars) env->ReleaseStringUTFChars(value, chars);
+    return result;
+}
+
+extern "C" {
+
+// ============================================================
+// start / stop
+// ============================================================
+JNIEXPORT jint JNICALL
+Java_com_nova_companion_voice_VoicePipelineJNI_start(
+        JNIEnv *env,
+        jobject /* this */,
+        jstring systemPrompt,
+        jstring language,
+        jobjectArray stopStrings,
+        jint maxTokens,
+        jfloat temperature,
+        jfloat topP,
+        jboolean bargeIn) {
+
+    pipeline::Config config;
+    config.systemPrompt = to_string(env, systemPrompt);
+    config.language = to_string(env, language);
+    if (config.language.empty()) config.language = "auto";
+    if (stopStrings) {
+        const int count = env->GetArrayLength(stopStrings);
+        for (int i = 0; i < count; i++) {
+            auto stop = (jstring) env->GetObjectArrayElement(stopStrings, i);
+            config.stopStrings.push_back(to_string(env, stop));
+            env->DeleteLocalRef(stop);
+        }
+    }
+    config.maxTokens = maxTokens;
+    config.temperature = temperature;
+    config.topP = topP;
+    config.bargeIn = bargeIn == JNI_TRUE;
+
+    const int result = VoicePipeline::instance().start(config);
+    if (result != pipeline::START_OK) LOGE("Pipeline failed to start (%d)", result);
+    return result;
+}
+
+JNIEXPORT void JNICALL
+Java_com_nova_companion_voice_VoicePipelineJNI_stop(
+        JNIEnv *env,
+        jobject /* this */) {
+    VoicePipeline::instance().stop();
+}
+
+JNIEXPORT jboolean JNICALL
+Java_com_nova_companion_voice_VoicePipelineJNI_isRunning(
+        JNIEnv *env,
+        jobject /* this */) {
+    return VoicePipeline::instance().running() ? JNI_TRUE : JNI_FALSE;
+}
+
+// ============================================================
+// Events
+// ============================================================
+JNIEXPORT jint JNICALL
+Java_com_nova_companion_voice_VoicePipelineJNI_nextEvent(
+        JNIEnv *env,
+        jobject /* this */,
+        jint timeoutMs) {
+
+    pipeline::Event event;
+    if (!VoicePipeline::instance().waitEvent(event, timeoutMs)) {
+        return pipeline::EVENT_NONE;
+    }
+    std::lock_guard<std::mutex> lock(g_event_mutex);
+    g_event = std::move(event);
+    return g_event.type;
+}
+
+JNIEXPORT jstring JNICALL
+Java_com_nova_companion_voice_VoicePipelineJNI_eventText(
+        JNIEnv *env,
+        jobject /* this */) {
+    std::lock_guard<std::mutex> lock(g_event_mutex);
+    return env->NewStringUTF(g_event.text.c_str());
+}
+
+JNIEXPORT jfloat JNICALL
+Java_com_nova_companion_voice_VoicePipelineJNI_eventValue(
+        JNIEnv *env,
+        jobject /* this */) {
+    std::lock_guard<std::mutex> lock(g_event_mutex);
+    return g_event.value;
+}
+
+// [STT ms, first token ms, first audio ms, mouth-to-ear ms] after the endpoint
+JNIEXPORT jfloatArray JNICALL
+Java_com_nova_companion_voice_VoicePipelineJNI_getTurnLatency(
+        JNIEnv *env,
+        jobject /* this */) {
+
+    const pipeline::TurnLatency latency = VoicePipeline::instance().lastTurnLatency();
+    const jfloat values[4] = {
+            latency.sttMs, latency.firstTokenMs, latency.firstAudioMs, latency.mouthToEarMs,
+    };
+    jfloatArray result = env->NewFloatArray(4);
+    if (result) env->SetFloatArrayRegion(result, 0, 4, values);
+    return result;
+}
+
+} // extern "C"
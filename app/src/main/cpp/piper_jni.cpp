@@ -2,17 +2,37 @@
  * JNI bridge for Piper TTS - Text-to-Speech
  *
  * Provides native methods for the PiperJNI Kotlin class.
- * Handles speech synthesis using Piper with ONNX Runtime.
+ * Handles speech synthesis using Piper with ONNX Runtime: voices are
+ * resident in a VoiceRegistry (one shared ORT environment), every request
+ * carries its own SynthParams.
  */
 
 #include <jni.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 #include <android/log.h>
-#include <fstream>
-#include <sstream>
 
-#include "piper.hpp"
+#include "audio_simd.h"
+#include "onnx_inspect.h"
+#include "piper_voice.h"
+#include "resampler.h"
+#include "stage_api.h"
+#include "text_chunker.h"
+#include "text_normalizer.h"
+#include "trace.h"
+#include "tts_cache.h"
+#include "tts_queue.h"
+#include "tts_ring.h"
+#include "voice_registry.h"
 
 #define LOG_TAG "PiperJNI"
 #define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
@@ -20,28 +40,506 @@
 #define LOGD(...) __android_log_print(ANDROID_LOG_DEBUG, LOG_TAG, __VA_ARGS__)
 
 // Global Piper state
-static piper::PiperConfig g_piperConfig;
-static piper::Voice g_voice;
-static bool g_initialized = false;
-static int g_sampleRate = 22050;
+static VoiceRegistry g_voices;
+// Finished sentences allowed to wait for playback during streaming
+static std::atomic<int> g_lookahead{2};
+
+// Sentences longer than this many phoneme ids (~2 s of speech) stream in
+// pieces cut after clause marks; 0 renders every sentence whole
+static std::atomic<int> g_chunk_ids{96};
+
+// Rate streamed audio is resampled to (the device's native output rate,
+// so playback stays on the low-latency path); 0 keeps the voice's rate
+static std::atomic<int> g_output_rate{0};
+
+// Rendered short phrases; keyed by voice, so it survives voice switches
+static TtsCache g_cache;
+// Longer text is almost never repeated verbatim
+static const size_t MAX_CACHED_CHARS = 160;
+
+// Synthesize one sentence / chunk, serving short text from the phrase cache.
+// Text is normalized to its spoken form first (and cached under it).
+// persist writes a fresh render through to the disk tier. Returns true on a
+// cache hit.
+static bool synthesize_text(PiperVoice &voice, const SynthParams &params, const std::string &written,
+                            std::vector<int16_t> &pcm, SynthStats *stats = nullptr, bool persist = false) {
+    trace::Scope span("piper", "piper.synthesize");
+    span.arg("chars", (int64_t) written.size());
+    std::string text;
+    {
+        NOVA_TRACE_SCOPE("piper", "piper.normalize");
+        text = normalize_for_speech(written);
+    }
+    if (text.empty()) return false;
+    const SynthParams resolved = voice.resolve(params);
+    const bool cacheable = text.size() <= MAX_CACHED_CHARS;
+    std::string key;
+    if (cacheable) {
+        key = TtsCache::key(text, voice.id(), resolved.speakerId,
+                            resolved.lengthScale, resolved.noiseScale, resolved.noiseW);
+        if (TtsCache::Pcm hit = g_cache.get(key, voice.sampleRate())) {
+            trace::instant("piper", "piper.cache_hit", "samples", (int64_t) hit->size());
+            pcm.assign(hit->begin(), hit->end());
+            if (stats) stats->audioSeconds += (double) pcm.size() / voice.sampleRate();
+            return true;
+        }
+    }
+
+    voice.synthesize(text, resolved, pcm, stats);
+    if (cacheable) g_cache.put(key, voice.sampleRate(), pcm, persist);
+    return false;
+}
+
+// Receives each chunk of streamed audio; false once playback has gone away
+using ChunkSink = std::function<bool(TtsChunk &&chunk)>;
+
+// Streaming counterpart of synthesize_text: hands audio to push as it is
+// rendered, so a long sentence starts playing after its first piece.
+// Cache hits go out as one chunk; a fresh render is also stored whole.
+// Only the final piece carries `last`. False once push refused a chunk.
+static bool synthesize_chunks(PiperVoice &voice, const SynthParams &params, const std::string &written,
+                              bool last, const ChunkSink &push, SynthStats *stats = nullptr,
+                              const CancelToken *cancel = nullptr) {
+    trace::Scope span("piper", "piper.chunk");
+    span.arg("chars", (int64_t) written.size());
+    std::string text;
+    {
+        NOVA_TRACE_SCOPE("piper", "piper.normalize");
+        text = normalize_for_speech(written);
+    }
+    const SynthParams resolved = voice.resolve(params);
+    const bool cacheable = text.size() <= MAX_CACHED_CHARS;
+    std::string key;
+    if (cacheable) {
+        key = TtsCache::key(text, voice.id(), resolved.speakerId,
+                            resolved.lengthScale, resolved.noiseScale, resolved.noiseW);
+        if (TtsCache::Pcm hit = g_cache.get(key, voice.sampleRate())) {
+            trace::instant("piper", "piper.cache_hit", "samples", (int64_t) hit->size());
+            TtsChunk chunk;
+            chunk.last = last;
+            chunk.sampleRate = voice.sampleRate();
+            chunk.pcm.assign(hit->begin(), hit->end());
+            if (stats) stats->audioSeconds += (double) chunk.pcm.size() / voice.sampleRate();
+            return push(std::move(chunk));
+        }
+    }
+
+    // Hold one piece back so the final one can be flagged
+    TtsChunk pending;
+    bool havePending = false;
+    std::vector<int16_t> whole;
+    const int maxIds = g_chunk_ids.load();
+    // Each piece is rendered between two callbacks; time it from the last one
+    uint64_t pieceStart = trace::enabled() ? trace::now_ns() : 0;
+    const bool open = voice.synthesizeChunked(text, resolved, (size_t) std::max(0, maxIds),
+                                              [&](std::vector<int16_t> &&pcm) {
+        if (pieceStart) trace::complete("piper", "piper.piece", pieceStart, trace::now_ns(),
+                                        "samples", (int64_t) pcm.size());
+        if (havePending && !push(std::move(pending))) return false;
+        if (cacheable) whole.insert(whole.end(), pcm.begin(), pcm.end());
+        pending = TtsChunk();
+        pending.sampleRate = voice.sampleRate();
+        pending.pcm = std::move(pcm);
+        havePending = true;
+        if (pieceStart) pieceStart = trace::now_ns();
+        return true;
+    }, stats, cancel);
+    if (!open) return false;
+    if (cacheable) g_cache.put(key, voice.sampleRate(), std::move(whole), false);
+    if (!havePending && !last) return true;
+    pending.sampleRate = voice.sampleRate();
+    pending.last = last;
+    return push(std::move(pending));
+}
+
+// Active voice, logging when there is none
+static std::shared_ptr<PiperVoice> active_voice() {
+    std::shared_ptr<PiperVoice> voice = g_voices.active();
+    if (!voice) LOGE("Piper not initialized");
+    return voice;
+}
+
+static SynthParams make_params(jint speakerId, jfloat lengthScale, jfloat noiseScale, jfloat noiseW) {
+    SynthParams params;
+    params.speakerId = speakerId;
+    params.lengthScale = lengthScale;
+    params.noiseScale = noiseScale;
+    params.noiseW = noiseW;
+    return params;
+}
+
+static jmethodID audio_chunk_method(JNIEnv *env, jobject callback) {
+    jclass callbackClass = env->GetObjectClass(callback);
+    jmethodID method = env->GetMethodID(callbackClass, "onAudioChunk", "([SIZ)V");
+    env->DeleteLocalRef(callbackClass);
+    if (method == nullptr) LOGE("Could not find onAudioChunk callback method");
+    return method;
+}
+
+// Consumer side of a TtsQueue: hand every chunk to the callback on this
+// (JNI) thread until the producer closes the queue. delivered counts the
+// samples the callback has taken.
+static void deliver(JNIEnv *env, jobject callback, jmethodID onAudioChunk, TtsQueue &queue,
+                    std::atomic<int64_t> &delivered) {
+    TtsChunk chunk;
+    while (queue.pop(chunk)) {
+        jshortArray jAudio = env->NewShortArray(chunk.pcm.size());
+        env->SetShortArrayRegion(jAudio, 0, chunk.pcm.size(), chunk.pcm.data());
+
+        env->CallVoidMethod(callback, onAudioChunk,
+                          jAudio, (jint)chunk.sampleRate, (jboolean)chunk.last);
+
+        env->DeleteLocalRef(jAudio);
+        delivered += (int64_t) chunk.pcm.size();
+        if (env->ExceptionCheck()) {
+            LOGE("onAudioChunk threw; stopping synthesis");
+            queue.close();
+            break;
+        }
+    }
+}
+
+// ============================================================
+// Incremental (token-to-speech) session
+// ============================================================
+// Text arrives in fragments straight from the LLM token callback. The
+// TextChunker releases a chunk at each confirmed clause / sentence boundary
+// and a producer thread synthesizes chunks in order into the audio queue,
+// so the first clause is already playing while the model keeps generating.
+
+struct TtsStream {
+    std::shared_ptr<PiperVoice> voice;
+    SynthParams params;
+    std::mutex mutex;
+    std::condition_variable textReady;
+    TextChunker chunker;
+    std::deque<std::string> texts;
+    bool finished = false;
+    TtsQueue audio;
+    CancelToken cancel;
+    std::atomic<int64_t> delivered{0};   // samples handed to the callback
+    std::unique_ptr<Resampler> resampler;   // voice rate → output rate, if they differ
+    std::thread producer;
+
+    TtsStream(std::shared_ptr<PiperVoice> voice, const SynthParams &params, size_t lookahead, int outputRate)
+        : voice(std::move(voice)), params(params), audio(lookahead) {
+        const int voiceRate = this->voice->sampleRate();
+        if (outputRate > 0 && outputRate != voiceRate) {
+            resampler = std::make_unique<Resampler>(voiceRate, outputRate);
+        }
+    }
+
+    int outputRate() const { return resampler ? resampler->outRate() : voice->sampleRate(); }
+
+    // Queue a chunk for playback at the output rate. One filter runs across
+    // the session's chunks, so seams stay continuous; the last one flushes it.
+    bool push(TtsChunk &&chunk) {
+        if (resampler) {
+            NOVA_TRACE_SCOPE("piper", "piper.resample");
+            std::vector<float> in(chunk.pcm.size()), out;
+            simd::s16_to_f32(chunk.pcm.data(), in.data(), (int) in.size(), 1.0f / 32768.0f);
+            out.reserve(in.size() * (size_t) resampler->outRate() / (size_t) resampler->inRate() + (size_t) resampler->taps());
+            resampler->process(in.data(), (int) in.size(), out);
+            if (chunk.last) resampler->flush(out);
+            chunk.pcm.resize(out.size());
+            simd::f32_to_s16(out.data(), chunk.pcm.data(), (int) out.size(), 32768.0f);
+            chunk.sampleRate = resampler->outRate();
+            if (chunk.pcm.empty() && !chunk.last) return true;
+        }
+        return audio.push(std::move(chunk));
+    }
+
+    void run() {
+        try {
+            for (;;) {
+                std::string text;
+                bool last;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    textReady.wait(lock, [&] { return finished || !texts.empty(); });
+                    if (texts.empty()) break;
+                    text = std::move(texts.front());
+                    texts.pop_front();
+                    last = finished && texts.empty();
+                }
+                LOGD("Stream chunk: \"%s\"", text.c_str());
+                const ChunkSink sink = [this](TtsChunk &&chunk) { return push(std::move(chunk)); };
+                if (!synthesize_chunks(*voice, params, text, last, sink, nullptr, &cancel)) break;
+            }
+        } catch (const SynthesisCancelled &) {
+            LOGD("Stream synthesis cancelled");
+        } catch (const std::exception &e) {
+            LOGE("Stream synthesis failed: %s", e.what());
+        }
+        audio.close();
+    }
+
+    // Chunk a fragment; completed chunks go to the producer
+    void append(const std::string &fragment) {
+        std::vector<std::string> ready;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (finished) return;
+            chunker.append(fragment, ready);
+            for (auto &text : ready) texts.push_back(std::move(text));
+        }
+        if (!ready.empty()) textReady.notify_one();
+    }
+
+    // Stop accepting text; the producer finishes what's queued
+    void finish() {
+        std::vector<std::string> rest;
+        std::lock_guard<std::mutex> lock(mutex);
+        if (finished) return;
+        chunker.flush(rest);
+        for (auto &text : rest) texts.push_back(std::move(text));
+        finished = true;
+        textReady.notify_one();
+    }
+
+    // Drop everything not yet synthesized (the current chunk still completes)
+    void abort() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            texts.clear();
+            finished = true;
+            textReady.notify_one();
+        }
+        audio.close();
+    }
+
+    // Barge-in: stop the model run in progress and drop unplayed audio
+    void cancelNow() {
+        cancel.cancel();
+        abort();
+        audio.cancel();
+    }
+
+    ~TtsStream() {
+        cancelNow();
+        if (producer.joinable()) producer.join();
+    }
+};
+
+static double ms_since(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+
+static SessionConfig make_session_config(jint threads, jint optimization, jboolean cpuArena,
+                                         jboolean memPattern, jboolean xnnpack) {
+    SessionConfig config;
+    config.threads = threads;
+    config.optimization = optimization;
+    config.cpuArena = cpuArena == JNI_TRUE;
+    config.memPattern = memPattern == JNI_TRUE;
+    config.xnnpack = xnnpack == JNI_TRUE;
+    return config;
+}
+
+// ============================================================
+// Warm-up
+// ============================================================
+// ONNX Runtime picks kernels and grows its arena on a session's first runs,
+// and eSpeak loads its data on first use, so the first reply would be
+// several times slower than steady state. initialize() can render a
+// throwaway sentence on a background thread instead; readiness says when
+// that's done. Requests made meanwhile just run (cold) alongside it.
+
+// Values of PiperJNI.READINESS_*
+enum Readiness { READINESS_NONE = 0, READINESS_LOADING = 1, READINESS_WARMING = 2, READINESS_READY = 3 };
+
+// Long enough to be cut into two pieces at the default chunk size, so the
+// warm-up covers phonemization, both piece shapes and the crossfade path
+static const char *WARMUP_TEXT =
+        "Hello there, I'm getting my voice ready so that the very first thing I say to you "
+        "comes out just as quickly as everything after it.";
+
+static std::mutex g_warmup_mutex;
+static std::condition_variable g_warmup_cv;
+static int g_readiness = READINESS_NONE;   // guarded by g_warmup_mutex
+static std::thread g_warmup_thread;
+static std::shared_ptr<CancelToken> g_warmup_cancel;
+
+static void set_readiness(int readiness) {
+    {
+        std::lock_guard<std::mutex> lock(g_warmup_mutex);
+        g_readiness = readiness;
+    }
+    g_warmup_cv.notify_all();
+}
+
+// Cancel a warm-up in progress and wait for its thread
+static void stop_warmup() {
+    std::thread thread;
+    {
+        std::lock_guard<std::mutex> lock(g_warmup_mutex);
+        if (g_warmup_cancel) g_warmup_cancel->cancel();
+        thread = std::move(g_warmup_thread);
+    }
+    if (thread.joinable()) thread.join();
+}
+
+static void start_warmup(std::shared_ptr<PiperVoice> voice) {
+    stop_warmup();
+    auto cancel = std::make_shared<CancelToken>();
+    std::lock_guard<std::mutex> lock(g_warmup_mutex);
+    g_readiness = READINESS_WARMING;
+    g_warmup_cancel = cancel;
+    g_warmup_thread = std::thread([voice, cancel] {
+        const auto t0 = std::chrono::steady_clock::now();
+        NOVA_TRACE_SCOPE("piper", "piper.warmup");
+        try {
+            voice->preparePhonemizer();
+            SynthStats stats;
+            const int maxIds = g_chunk_ids.load();
+            voice->synthesizeChunked(WARMUP_TEXT, voice->resolve(SynthParams()), (size_t) std::max(0, maxIds),
+                                     [](std::vector<int16_t> &&) { return true; }, &stats, cancel.get());
+            LOGI("Warm-up done in %.0f ms (phonemize %.0f ms, infer %.0f ms for %.2f s audio)",
+                 ms_since(t0), stats.phonemizeMs, stats.inferMs, stats.audioSeconds);
+        } catch (const SynthesisCancelled &) {
+            LOGD("Warm-up cancelled");
+            return;
+        } catch (const std::exception &e) {
+            // Still usable; the first request just pays the cold start
+            LOGE("Warm-up failed: %s", e.what());
+        }
+        set_readiness(READINESS_READY);
+    });
+}
+
+static std::mutex g_stream_mutex;
+static std::shared_ptr<TtsStream> g_stream;
+
+static std::shared_ptr<TtsStream> current_stream() {
+    std::lock_guard<std::mutex> lock(g_stream_mutex);
+    return g_stream;
+}
+
+// New session with its producer running; cancels the one it replaces.
+// outputRate < 0 uses the rate set by setOutputSampleRate.
+static std::shared_ptr<TtsStream> start_stream(std::shared_ptr<PiperVoice> voice, const SynthParams &params,
+                                               int outputRate = -1) {
+    auto stream = std::make_shared<TtsStream>(std::move(voice), params, (size_t) g_lookahead.load(),
+                                              outputRate < 0 ? g_output_rate.load() : outputRate);
+    stream->producer = std::thread(&TtsStream::run, stream.get());
+
+    std::shared_ptr<TtsStream> previous;
+    {
+        std::lock_guard<std::mutex> lock(g_stream_mutex);
+        previous = std::move(g_stream);
+        g_stream = stream;
+    }
+    if (previous) previous->cancelNow();
+    return stream;
+}
+
+// ============================================================
+// Zero-copy output ring
+// ============================================================
+// A pump thread moves a stream's audio from its TtsQueue into the TtsRing
+// over the Kotlin-owned direct ByteBuffer; playback reads it in place.
+
+static std::mutex g_ring_mutex;
+static std::shared_ptr<TtsRing> g_ring;
+static std::thread g_ring_pump;
+static std::shared_ptr<TtsStream> g_ring_stream;   // the session being pumped
+
+static std::shared_ptr<TtsRing> current_ring() {
+    std::lock_guard<std::mutex> lock(g_ring_mutex);
+    return g_ring;
+}
+
+// Caller holds g_ring_mutex
+static void stop_ring_pump() {
+    if (g_ring) g_ring->cancel();
+    if (g_ring_stream) g_ring_stream->cancelNow();   // wakes a pump waiting for audio
+    if (g_ring_pump.joinable()) g_ring_pump.join();
+    g_ring_stream.reset();
+}
+
+static void pump_to_ring(std::shared_ptr<TtsStream> stream, std::shared_ptr<TtsRing> ring) {
+    TtsChunk chunk;
+    while (stream->audio.pop(chunk)) {
+        if (!ring->write(chunk.pcm.data(), chunk.pcm.size())) {
+            // Playback was cancelled: stop synthesizing the rest
+            stream->abort();
+            break;
+        }
+    }
+    ring->close();
+
+    std::lock_guard<std::mutex> lock(g_stream_mutex);
+    if (g_stream == stream) g_stream.reset();
+}
+
+// ============================================================
+// Native pipeline sink
+// ============================================================
+// The voice pipeline in libnova_whisper plays audio itself (stage_api.h):
+// a pump thread hands the session's chunks to its callback instead of the
+// ring or a Kotlin callback.
+
+static std::mutex g_sink_mutex;
+static std::thread g_sink_pump;
+static std::shared_ptr<TtsStream> g_sink_stream;   // the session being pumped
+static std::atomic<bool> g_sink_detached{false};   // the pipeline let go of the callback
+
+static std::shared_ptr<TtsStream> current_sink_stream() {
+    std::lock_guard<std::mutex> lock(g_sink_mutex);
+    return g_sink_stream;
+}
+
+// Caller holds g_sink_mutex
+static void stop_sink_pump() {
+    g_sink_detached.store(true);
+    if (g_sink_stream) g_sink_stream->cancelNow();   // wakes a pump waiting for audio
+    if (g_sink_pump.joinable()) g_sink_pump.join();
+    g_sink_stream.reset();
+    g_sink_detached.store(false);
+}
+
+static void pump_to_sink(std::shared_ptr<TtsStream> stream, nova_pcm_fn onAudio, void *user) {
+    TtsChunk chunk;
+    bool accepted = true;
+    while (stream->audio.pop(chunk)) {
+        if (!chunk.pcm.empty() && !onAudio(user, chunk.pcm.data(), chunk.pcm.size(), 0)) {
+            // The pipeline dropped this reply: stop synthesizing the rest
+            stream->abort();
+            accepted = false;
+            break;
+        }
+        stream->delivered += (int64_t) chunk.pcm.size();
+    }
+    // Always end the reply, even when a Kotlin session replaced this one:
+    // the pipeline waits for `last` before re-arming the mic. Only a
+    // pipeline that cancelled (and may have freed `user`) gets nothing.
+    if (accepted && !g_sink_detached.load()) onAudio(user, nullptr, 0, 1);
+
+    std::lock_guard<std::mutex> lock(g_stream_mutex);
+    if (g_stream == stream) g_stream.reset();
+}
 
 extern "C" {
 
 // ============================================================
 // initialize - Load Piper voice model
+// threads / optimization / arena / memPattern / xnnpack configure
+// the ONNX Runtime sessions; changing them reloads resident voices.
+// With warmup, returns once the session exists and renders a throwaway
+// sentence on a background thread (see getReadiness / awaitReady).
 // ============================================================
 JNIEXPORT jboolean JNICALL
 Java_com_nova_companion_voice_PiperJNI_initialize(
         JNIEnv *env,
         jobject /* this */,
         jstring modelPath,
-        jstring configPath) {
-
-    if (g_initialized) {
-        LOGI("Releasing existing Piper voice");
-        // Piper cleanup handled by destructor
-        g_initialized = false;
-    }
+        jstring configPath,
+        jint threads,
+        jint optimization,
+        jboolean cpuArena,
+        jboolean memPattern,
+        jboolean xnnpack,
+        jboolean warmup) {
 
     const char *model = env->GetStringUTFChars(modelPath, nullptr);
     const char *config = env->GetStringUTFChars(configPath, nullptr);
@@ -49,30 +547,31 @@ Java_com_nova_companion_voice_PiperJNI_initialize(
     LOGI("Loading Piper voice model: %s", model);
     LOGI("Config: %s", config);
 
+    stop_warmup();
+    set_readiness(READINESS_LOADING);
+    bool loaded = false;
     try {
-        // Initialize Piper config (eSpeakNG data path not needed for ONNX models
-        // that have their own phonemizer built-in)
-        g_piperConfig.useESpeak = false;
-
-        // Load voice model
-        std::optional<piper::SpeakerId> speakerId;
-        piper::loadVoice(g_piperConfig, model, config, g_voice, speakerId, false);
-
-        // Get sample rate from voice config
-        g_sampleRate = g_voice.synthesisConfig.sampleRate;
-
-        g_initialized = true;
-        LOGI("Piper voice loaded. Sample rate: %d Hz", g_sampleRate);
+        g_voices.configure(make_session_config(threads, optimization, cpuArena, memPattern, xnnpack));
+        // Already-resident voices are just made active again
+        NOVA_TRACE_SCOPE("piper", "piper.load");
+        std::shared_ptr<PiperVoice> voice = g_voices.load(model, config);
+        loaded = g_voices.setActive(voice->id());
+        LOGI("Piper voice loaded. Sample rate: %d Hz", voice->sampleRate());
+        if (warmup == JNI_TRUE) {
+            start_warmup(voice);
+        } else {
+            set_readiness(READINESS_READY);
+        }
 
     } catch (const std::exception &e) {
         LOGE("Failed to load Piper voice: %s", e.what());
-        g_initialized = false;
     }
+    if (!loaded) set_readiness(g_voices.active() ? READINESS_READY : READINESS_NONE);
 
     env->ReleaseStringUTFChars(modelPath, model);
     env->ReleaseStringUTFChars(configPath, config);
 
-    return g_initialized ? JNI_TRUE : JNI_FALSE;
+    return loaded ? JNI_TRUE : JNI_FALSE;
 }
 
 // ============================================================
@@ -88,35 +587,23 @@ Java_com_nova_companion_voice_PiperJNI_synthesize(
         jfloat noiseScale,
         jfloat noiseW) {
 
-    if (!g_initialized) {
-        LOGE("Piper not initialized");
-        return env->NewShortArray(0);
-    }
+    auto voice = active_voice();
+    if (!voice) return env->NewShortArray(0);
 
     const char *inputText = env->GetStringUTFChars(text, nullptr);
     LOGI("Synthesizing: \"%s\"", inputText);
 
     try {
-        // Configure synthesis parameters
-        piper::SynthesisConfig synthConfig = g_voice.synthesisConfig;
-        synthConfig.lengthScale = lengthScale;
-        synthConfig.noiseScale = noiseScale;
-        synthConfig.noiseW = noiseW;
-
-        if (speakerId > 0) {
-            synthConfig.speakerId = speakerId;
-        }
-
-        // Synthesize
+        // Per-request parameters; the voice itself is never modified
+        const SynthParams params = make_params(speakerId, lengthScale, noiseScale, noiseW);
         std::vector<int16_t> audioBuffer;
-        piper::SynthesisResult result;
-        piper::textToAudio(g_piperConfig, g_voice, inputText, audioBuffer, result);
+        synthesize_text(*voice, params, inputText, audioBuffer);
 
         env->ReleaseStringUTFChars(text, inputText);
 
         LOGI("Synthesis complete: %zu samples (%.2f seconds)",
              audioBuffer.size(),
-             (float)audioBuffer.size() / g_sampleRate);
+             (float)audioBuffer.size() / voice->sampleRate());
 
         // Copy to Java array
         jshortArray output = env->NewShortArray(audioBuffer.size());
@@ -134,93 +621,594 @@ Java_com_nova_companion_voice_PiperJNI_synthesize(
 // ============================================================
 // synthesizeStreaming - Generate audio with chunk callbacks
 // ============================================================
+// Runs as a one-shot stream session: all of the text is chunked up front,
+// the session's producer synthesizes chunks into its bounded TtsQueue and
+// the calling thread hands finished ones to the callback. The callback
+// blocks in AudioTrack.write for as long as the audio takes to play, so
+// chunk N+1 is synthesized during chunk N's playback and the gaps between
+// sentences disappear. setLookahead caps how many chunks run ahead. Being
+// the current session, it stops on cancel() like an incremental one.
 JNIEXPORT void JNICALL
 Java_com_nova_companion_voice_PiperJNI_synthesizeStreaming(
         JNIEnv *env,
         jobject /* this */,
         jstring text,
+        jint speakerId,
+        jfloat lengthScale,
+        jfloat noiseScale,
+        jfloat noiseW,
         jobject callback) {
 
-    if (!g_initialized) {
-        LOGE("Piper not initialized");
-        return;
+    auto voice = active_voice();
+    if (!voice) return;
+
+    jmethodID onAudioChunkMethod = audio_chunk_method(env, callback);
+    if (onAudioChunkMethod == nullptr) return;
+
+    const char *inputText = env->GetStringUTFChars(text, nullptr);
+    LOGI("Streaming synthesis: \"%s\"", inputText);
+    auto stream = start_stream(voice, make_params(speakerId, lengthScale, noiseScale, noiseW));
+    stream->append(inputText);
+    env->ReleaseStringUTFChars(text, inputText);
+    stream->finish();
+
+    // Consumer: deliver at playback speed on the JNI thread
+    deliver(env, callback, onAudioChunkMethod, stream->audio, stream->delivered);
+
+    std::lock_guard<std::mutex> lock(g_stream_mutex);
+    if (g_stream == stream) g_stream.reset();
+}
+
+// ============================================================
+// cancel - Barge-in
+// Stops the current session at once: the model run in progress is
+// terminated through its RunOptions, queued text and audio are
+// dropped and the ring is flushed, so the cores are free for STT.
+// Returns the samples of the session handed to playback so far
+// (ring: released by the player), or -1 if nothing was playing.
+// ============================================================
+JNIEXPORT jlong JNICALL
+Java_com_nova_companion_voice_PiperJNI_cancel(
+        JNIEnv *env,
+        jobject /* this */) {
+
+    std::shared_ptr<TtsStream> stream;
+    {
+        std::lock_guard<std::mutex> lock(g_stream_mutex);
+        stream = std::move(g_stream);
+    }
+    jlong position = -1;
+    if (stream) {
+        stream->cancelNow();
+        position = stream->delivered.load();
     }
 
-    // Get callback method
-    jclass callbackClass = env->GetObjectClass(callback);
-    jmethodID onAudioChunkMethod = env->GetMethodID(
-            callbackClass, "onAudioChunk", "([SIZ)V");
+    {
+        std::lock_guard<std::mutex> lock(g_ring_mutex);
+        if (g_ring_stream) {
+            g_ring->cancel();
+            position = g_ring->readPos();
+            stop_ring_pump();
+        }
+    }
+    LOGI("Cancelled synthesis at sample %lld", (long long) position);
+    return position;
+}
+
+// ============================================================
+// attachRing - Use a direct ByteBuffer as the playback ring
+// The buffer must stay referenced on the Kotlin side while attached.
+// Returns the capacity in samples, or 0 if it isn't a direct buffer.
+// ============================================================
+JNIEXPORT jint JNICALL
+Java_com_nova_companion_voice_PiperJNI_attachRing(
+        JNIEnv *env,
+        jobject /* this */,
+        jobject buffer) {
+
+    auto *data = static_cast<int16_t *>(env->GetDirectBufferAddress(buffer));
+    const jlong capacity = env->GetDirectBufferCapacity(buffer);
+    if (data == nullptr || capacity < (jlong) sizeof(int16_t)) {
+        LOGE("attachRing needs a direct ByteBuffer");
+        return 0;
+    }
+
+    std::lock_guard<std::mutex> lock(g_ring_mutex);
+    stop_ring_pump();
+    g_ring = std::make_shared<TtsRing>(data, (size_t) capacity / sizeof(int16_t));
+    LOGI("Playback ring: %zu samples", g_ring->capacity());
+    return (jint) g_ring->capacity();
+}
+
+// ============================================================
+// streamDrainToRing - Play the current session through the ring
+// Returns immediately; a native pump thread fills the ring while
+// the caller plays it with ringAcquire / ringRelease.
+// ============================================================
+JNIEXPORT jboolean JNICALL
+Java_com_nova_companion_voice_PiperJNI_streamDrainToRing(
+        JNIEnv *env,
+        jobject /* this */) {
+
+    auto stream = current_stream();
+    std::lock_guard<std::mutex> lock(g_ring_mutex);
+    if (!stream || !g_ring) return JNI_FALSE;
+
+    stop_ring_pump();
+    g_ring->reset();
+    g_ring_stream = stream;
+    g_ring_pump = std::thread(pump_to_ring, stream, g_ring);
+    return JNI_TRUE;
+}
+
+// ============================================================
+// ringAcquire - Next run of audio to play
+// Returns (byteOffset << 32) | byteCount, 0 if nothing arrived
+// within timeoutMs, or -1 once the stream has ended.
+// ============================================================
+JNIEXPORT jlong JNICALL
+Java_com_nova_companion_voice_PiperJNI_ringAcquire(
+        JNIEnv *env,
+        jobject /* this */,
+        jint timeoutMs) {
+
+    auto ring = current_ring();
+    if (!ring) return -1;
+    size_t offset = 0;
+    const long count = ring->acquire(offset, timeoutMs);
+    if (count <= 0) return count;
+    return ((jlong) (offset * sizeof(int16_t)) << 32) | (jlong) (count * sizeof(int16_t));
+}
+
+// ============================================================
+// ringRelease - Bytes from the last ringAcquire have been played
+// ============================================================
+JNIEXPORT void JNICALL
+Java_com_nova_companion_voice_PiperJNI_ringRelease(
+        JNIEnv *env,
+        jobject /* this */,
+        jint bytes) {
+
+    if (auto ring = current_ring()) ring->release((size_t) std::max(0, (int) bytes) / sizeof(int16_t));
+}
+
+// ============================================================
+// ringCancel - Drop unplayed audio and stop the pump
+// ============================================================
+JNIEXPORT void JNICALL
+Java_com_nova_companion_voice_PiperJNI_ringCancel(
+        JNIEnv *env,
+        jobject /* this */) {
+
+    std::lock_guard<std::mutex> lock(g_ring_mutex);
+    if (g_ring) g_ring->cancel();
+    if (g_ring_stream) g_ring_stream->cancelNow();
+}
+
+// ============================================================
+// setLookahead - Sentences synthesized ahead of playback
+// ============================================================
+JNIEXPORT void JNICALL
+Java_com_nova_companion_voice_PiperJNI_setLookahead(
+        JNIEnv *env,
+        jobject /* this */,
+        jint sentences) {
+    g_lookahead.store(std::max(1, (int) sentences));
+}
+
+// ============================================================
+// setChunking - Intra-sentence streaming threshold
+// Sentences longer than maxPhonemeIds stream in pieces cut after clause marks;
+// 0 disables.
+// ============================================================
+JNIEXPORT void JNICALL
+Java_com_nova_companion_voice_PiperJNI_setChunking(
+        JNIEnv *env,
+        jobject /* this */,
+        jint maxPhonemeIds) {
+    g_chunk_ids.store(std::max(0, (int) maxPhonemeIds));
+}
+
+// ============================================================
+// streamBegin - Start an incremental synthesis session
+// ============================================================
+// Replaces any session still running (its unsynthesized text is dropped).
+JNIEXPORT jboolean JNICALL
+Java_com_nova_companion_voice_PiperJNI_streamBegin(
+        JNIEnv *env,
+        jobject /* this */,
+        jint speakerId,
+        jfloat lengthScale,
+        jfloat noiseScale,
+        jfloat noiseW) {
+
+    auto voice = active_voice();
+    if (!voice) return JNI_FALSE;
+
+    start_stream(voice, make_params(speakerId, lengthScale, noiseScale, noiseW));
+    return JNI_TRUE;
+}
+
+// ============================================================
+// streamAppend - Feed a text fragment (e.g. one LLM token)
+// ============================================================
+JNIEXPORT void JNICALL
+Java_com_nova_companion_voice_PiperJNI_streamAppend(
+        JNIEnv *env,
+        jobject /* this */,
+        jstring fragment) {
+
+    auto stream = current_stream();
+    if (!stream) return;
+
+    const char *chars = env->GetStringUTFChars(fragment, nullptr);
+    stream->append(chars);
+    env->ReleaseStringUTFChars(fragment, chars);
+}
+
+// ============================================================
+// streamFinish - No more text; speak whatever is left
+// ============================================================
+JNIEXPORT void JNICALL
+Java_com_nova_companion_voice_PiperJNI_streamFinish(
+        JNIEnv *env,
+        jobject /* this */) {
+    auto stream = current_stream();
+    if (stream) stream->finish();
+}
+
+// ============================================================
+// streamDrain - Deliver session audio to a callback (blocking)
+// ============================================================
+// Runs on the playback thread: returns once the session has finished and
+// all its audio was handed over, or was replaced by another streamBegin.
+JNIEXPORT void JNICALL
+Java_com_nova_companion_voice_PiperJNI_streamDrain(
+        JNIEnv *env,
+        jobject /* this */,
+        jobject callback) {
+
+    auto stream = current_stream();
+    if (!stream) return;
 
+    jmethodID onAudioChunkMethod = audio_chunk_method(env, callback);
     if (onAudioChunkMethod == nullptr) {
-        LOGE("Could not find onAudioChunk callback method");
+        stream->abort();
         return;
     }
+    deliver(env, callback, onAudioChunkMethod, stream->audio, stream->delivered);
 
-    const char *inputText = env->GetStringUTFChars(text, nullptr);
-    LOGI("Streaming synthesis: \"%s\"", inputText);
+    std::lock_guard<std::mutex> lock(g_stream_mutex);
+    if (g_stream == stream) g_stream.reset();
+}
 
-    try {
-        // Split text into sentences for streaming
-        std::string fullText(inputText);
-        std::vector<std::string> sentences;
-
-        // Simple sentence splitting on . ! ?
-        std::string current;
-        for (char c : fullText) {
-            current += c;
-            if (c == '.' || c == '!' || c == '?') {
-                // Trim whitespace
-                size_t start = current.find_first_not_of(" \t\n");
-                if (start != std::string::npos) {
-                    sentences.push_back(current.substr(start));
-                }
-                current.clear();
-            }
-        }
-        // Add remaining text if any
-        if (!current.empty()) {
-            size_t start = current.find_first_not_of(" \t\n");
-            if (start != std::string::npos) {
-                sentences.push_back(current.substr(start));
-            }
-        }
+// ============================================================
+// setCacheDirectory - Enable the on-disk phrase cache tier
+// ============================================================
+JNIEXPORT void JNICALL
+Java_com_nova_companion_voice_PiperJNI_setCacheDirectory(
+        JNIEnv *env,
+        jobject /* this */,
+        jstring path) {
+    const char *dir = env->GetStringUTFChars(path, nullptr);
+    g_cache.setDirectory(dir);
+    env->ReleaseStringUTFChars(path, dir);
+}
+
+// ============================================================
+// prerender - Render phrases into the cache ahead of time
+// ============================================================
+// Phrases already cached (in memory or on disk) are skipped, so calling this
+// at every startup only synthesizes new ones. Returns how many were rendered.
+JNIEXPORT jint JNICALL
+Java_com_nova_companion_voice_PiperJNI_prerender(
+        JNIEnv *env,
+        jobject /* this */,
+        jobjectArray phrases) {
+
+    auto voice = active_voice();
+    if (!voice) return 0;
 
-        // If no sentence breaks found, treat whole text as one chunk
-        if (sentences.empty()) {
-            sentences.push_back(fullText);
+    int rendered = 0;
+    const jsize count = env->GetArrayLength(phrases);
+    for (jsize i = 0; i < count; i++) {
+        auto phrase = (jstring) env->GetObjectArrayElement(phrases, i);
+        const char *chars = env->GetStringUTFChars(phrase, nullptr);
+        try {
+            std::vector<int16_t> pcm;
+            if (!synthesize_text(*voice, SynthParams(), chars, pcm, nullptr, true)) rendered++;
+        } catch (const std::exception &e) {
+            LOGE("Pre-render failed for \"%s\": %s", chars, e.what());
         }
+        env->ReleaseStringUTFChars(phrase, chars);
+        env->DeleteLocalRef(phrase);
+    }
+    LOGI("Phrase cache: %d of %d pre-rendered, %zu entries / %zu KB",
+         rendered, (int) count, g_cache.entries(), g_cache.bytes() / 1024);
+    return rendered;
+}
 
-        LOGD("Split into %zu sentences for streaming", sentences.size());
+// ============================================================
+// clearCache - Drop the in-memory phrase cache
+// ============================================================
+JNIEXPORT void JNICALL
+Java_com_nova_companion_voice_PiperJNI_clearCache(
+        JNIEnv *env,
+        jobject /* this */) {
+    g_cache.clear();
+}
+
+// ============================================================
+// loadVoice - Make a voice resident without switching to it
+// ============================================================
+JNIEXPORT jboolean JNICALL
+Java_com_nova_companion_voice_PiperJNI_loadVoice(
+        JNIEnv *env,
+        jobject /* this */,
+        jstring modelPath,
+        jstring configPath) {
 
-        // Synthesize each sentence and callback
-        for (size_t i = 0; i < sentences.size(); i++) {
-            std::vector<int16_t> audioBuffer;
-            piper::SynthesisResult result;
+    const char *model = env->GetStringUTFChars(modelPath, nullptr);
+    const char *config = env->GetStringUTFChars(configPath, nullptr);
+    bool loaded = false;
+    try {
+        NOVA_TRACE_SCOPE("piper", "piper.load");
+        std::shared_ptr<PiperVoice> voice = g_voices.load(model, config);
+        loaded = true;
+        // First voice loaded becomes the active one (cold: no warm-up here)
+        if (!g_voices.active() && g_voices.setActive(voice->id())) set_readiness(READINESS_READY);
+    } catch (const std::exception &e) {
+        LOGE("Failed to load Piper voice %s: %s", model, e.what());
+    }
+    env->ReleaseStringUTFChars(modelPath, model);
+    env->ReleaseStringUTFChars(configPath, config);
+    return loaded ? JNI_TRUE : JNI_FALSE;
+}
 
-            piper::textToAudio(g_piperConfig, g_voice,
-                             sentences[i], audioBuffer, result);
+// ============================================================
+// selectVoice - Switch to a resident voice (no load)
+// ============================================================
+JNIEXPORT jboolean JNICALL
+Java_com_nova_companion_voice_PiperJNI_selectVoice(
+        JNIEnv *env,
+        jobject /* this */,
+        jstring modelPath) {
+    const char *model = env->GetStringUTFChars(modelPath, nullptr);
+    const bool ok = g_voices.setActive(model);
+    if (!ok) LOGE("Voice not resident: %s", model);
+    env->ReleaseStringUTFChars(modelPath, model);
+    return ok ? JNI_TRUE : JNI_FALSE;
+}
+
+// ============================================================
+// unloadVoice - Drop a resident voice and its cached phrases
+// ============================================================
+JNIEXPORT void JNICALL
+Java_com_nova_companion_voice_PiperJNI_unloadVoice(
+        JNIEnv *env,
+        jobject /* this */,
+        jstring modelPath) {
+    const char *model = env->GetStringUTFChars(modelPath, nullptr);
+    g_voices.unload(model);
+    g_cache.removeVoice(model);
+    env->ReleaseStringUTFChars(modelPath, model);
+}
+
+// ============================================================
+// setVoiceMemoryBudget - Resident voice budget in bytes
+// ============================================================
+JNIEXPORT void JNICALL
+Java_com_nova_companion_voice_PiperJNI_setVoiceMemoryBudget(
+        JNIEnv *env,
+        jobject /* this */,
+        jlong bytes) {
+    g_voices.setBudget((size_t) std::max<jlong>(0, bytes));
+}
+
+// ============================================================
+// getResidentVoices - Model paths of loaded voices, most recent first
+// ============================================================
+JNIEXPORT jobjectArray JNICALL
+Java_com_nova_companion_voice_PiperJNI_getResidentVoices(
+        JNIEnv *env,
+        jobject /* this */) {
+    const std::vector<std::string> ids = g_voices.resident();
+    jclass stringClass = env->FindClass("java/lang/String");
+    jobjectArray out = env->NewObjectArray((jsize) ids.size(), stringClass, nullptr);
+    for (size_t i = 0; i < ids.size(); i++) {
+        jstring id = env->NewStringUTF(ids[i].c_str());
+        env->SetObjectArrayElement(out, (jsize) i, id);
+        env->DeleteLocalRef(id);
+    }
+    return out;
+}
 
-            if (audioBuffer.empty()) continue;
+// ============================================================
+// getResidentBytes - Estimated memory held by resident voices
+// ============================================================
+JNIEXPORT jlong JNICALL
+Java_com_nova_companion_voice_PiperJNI_getResidentBytes(
+        JNIEnv *env,
+        jobject /* this */) {
+    return (jlong) g_voices.residentBytes();
+}
 
-            bool isLast = (i == sentences.size() - 1);
+// ============================================================
+// benchmarkSession - Time one session configuration
+// Loads the voice standalone (own thread pool, not resident) and
+// synthesizes text once to warm up, then `runs` more times.
+// Returns [loadMs, firstMs, meanMs, audioSeconds, rtf] where rtf is
+// mean synthesis time over audio duration; empty on failure.
+// ============================================================
+JNIEXPORT jfloatArray JNICALL
+Java_com_nova_companion_voice_PiperJNI_benchmarkSession(
+        JNIEnv *env,
+        jobject /* this */,
+        jstring modelPath,
+        jstring configPath,
+        jstring text,
+        jint threads,
+        jint optimization,
+        jboolean cpuArena,
+        jboolean memPattern,
+        jboolean xnnpack,
+        jint runs) {
 
-            // Create Java short array and callback
-            jshortArray jAudio = env->NewShortArray(audioBuffer.size());
-            env->SetShortArrayRegion(jAudio, 0, audioBuffer.size(), audioBuffer.data());
+    const char *model = env->GetStringUTFChars(modelPath, nullptr);
+    const char *config = env->GetStringUTFChars(configPath, nullptr);
+    const char *chars = env->GetStringUTFChars(text, nullptr);
+    const std::string input(chars);
+    env->ReleaseStringUTFChars(text, chars);
 
-            env->CallVoidMethod(callback, onAudioChunkMethod,
-                              jAudio, (jint)g_sampleRate, (jboolean)isLast);
+    const SessionConfig session = make_session_config(threads, optimization, cpuArena, memPattern, xnnpack);
+    std::vector<float> result;
+    try {
+        auto t0 = std::chrono::steady_clock::now();
+        std::unique_ptr<PiperVoice> voice = g_voices.openStandalone(model, config, session);
+        const double loadMs = ms_since(t0);
 
-            env->DeleteLocalRef(jAudio);
+        std::vector<int16_t> pcm;
+        t0 = std::chrono::steady_clock::now();
+        voice->synthesize(input, SynthParams(), pcm);
+        const double firstMs = ms_since(t0);
+        const double audioSeconds = (double) pcm.size() / voice->sampleRate();
 
-            LOGD("Sentence %zu/%zu: %zu samples", i + 1, sentences.size(), audioBuffer.size());
+        const int n = std::max(1, (int) runs);
+        double totalMs = 0.0;
+        for (int i = 0; i < n; i++) {
+            pcm.clear();
+            t0 = std::chrono::steady_clock::now();
+            voice->synthesize(input, SynthParams(), pcm);
+            totalMs += ms_since(t0);
         }
+        const double meanMs = totalMs / n;
+        const double rtf = audioSeconds > 0.0 ? meanMs / 1000.0 / audioSeconds : 0.0;
+        LOGI("Benchmark %d thread(s), opt %d, arena %d, mem pattern %d, xnnpack %d: "
+             "load %.0f ms, first %.0f ms, mean %.0f ms for %.2f s audio, RTF %.3f",
+             session.threads, session.optimization, session.cpuArena, session.memPattern, session.xnnpack,
+             loadMs, firstMs, meanMs, audioSeconds, rtf);
+        result = {(float) loadMs, (float) firstMs, (float) meanMs, (float) audioSeconds, (float) rtf};
 
     } catch (const std::exception &e) {
-        LOGE("Streaming synthesis failed: %s", e.what());
+        LOGE("Benchmark failed: %s", e.what());
     }
 
-    env->ReleaseStringUTFChars(text, inputText);
+    env->ReleaseStringUTFChars(modelPath, model);
+    env->ReleaseStringUTFChars(configPath, config);
+
+    jfloatArray out = env->NewFloatArray((jsize) result.size());
+    if (!result.empty()) env->SetFloatArrayRegion(out, 0, (jsize) result.size(), result.data());
+    return out;
+}
+
+// ============================================================
+// inspectQuantization - int8 / fp32 check of a voice model
+// With scratchPath, inspects the graph ONNX Runtime runs under the
+// current session config (written there and deleted); otherwise the
+// model file as stored. Returns [format, integerOps, int8WeightBytes,
+// floatWeightBytes, "Op=count" per fp32 fallback...]; empty on failure.
+// ============================================================
+JNIEXPORT jobjectArray JNICALL
+Java_com_nova_companion_voice_PiperJNI_inspectQuantization(
+        JNIEnv *env,
+        jobject /* this */,
+        jstring modelPath,
+        jstring scratchPath) {
+
+    const char *model = env->GetStringUTFChars(modelPath, nullptr);
+    const char *scratch = env->GetStringUTFChars(scratchPath, nullptr);
+
+    std::vector<std::string> fields;
+    try {
+        const QuantizationReport report = scratch[0] != '\0'
+                                          ? g_voices.inspectOptimized(model, scratch)
+                                          : inspect_quantization(model);
+        fields = {report.format(), std::to_string(report.integerOps),
+                  std::to_string(report.int8WeightBytes), std::to_string(report.floatWeightBytes)};
+        for (const auto &op : report.fp32Fallbacks) fields.push_back(op.first + "=" + std::to_string(op.second));
+    } catch (const std::exception &e) {
+        LOGE("Quantization check failed for %s: %s", model, e.what());
+    }
+
+    env->ReleaseStringUTFChars(modelPath, model);
+    env->ReleaseStringUTFChars(scratchPath, scratch);
+
+    jclass stringClass = env->FindClass("java/lang/String");
+    jobjectArray out = env->NewObjectArray((jsize) fields.size(), stringClass, nullptr);
+    for (size_t i = 0; i < fields.size(); i++) {
+        jstring field = env->NewStringUTF(fields[i].c_str());
+        env->SetObjectArrayElement(out, (jsize) i, field);
+        env->DeleteLocalRef(field);
+    }
+    return out;
+}
+
+// ============================================================
+// setOutputSampleRate - Resample streamed audio to this rate
+// Pass the device's native output rate (e.g. 48000) so AudioTrack
+// needs no mixer resampling; 0 plays at the voice's own rate.
+// Applies to sessions started afterwards.
+// ============================================================
+JNIEXPORT void JNICALL
+Java_com_nova_companion_voice_PiperJNI_setOutputSampleRate(
+        JNIEnv *env,
+        jobject /* this */,
+        jint sampleRate) {
+    g_output_rate.store(std::max(0, (int) sampleRate));
+}
+
+// ============================================================
+// getOutputSampleRate - Rate of streamed audio
+// ============================================================
+JNIEXPORT jint JNICALL
+Java_com_nova_companion_voice_PiperJNI_getOutputSampleRate(
+        JNIEnv *env,
+        jobject /* this */) {
+    const int rate = g_output_rate.load();
+    if (rate > 0) return rate;
+    std::shared_ptr<PiperVoice> voice = g_voices.active();
+    return voice ? voice->sampleRate() : 22050;
+}
+
+// ============================================================
+// setESpeakDataPath - espeak-ng-data directory for the phonemizer
+// eSpeak itself loads on first use (or during warm-up).
+// ============================================================
+JNIEXPORT void JNICALL
+Java_com_nova_companion_voice_PiperJNI_setESpeakDataPath(
+        JNIEnv *env,
+        jobject /* this */,
+        jstring path) {
+    const char *chars = env->GetStringUTFChars(path, nullptr);
+    PiperVoice::setESpeakDataPath(chars);
+    env->ReleaseStringUTFChars(path, chars);
+}
+
+// ============================================================
+// getReadiness - READINESS_NONE / LOADING / WARMING / READY
+// ============================================================
+JNIEXPORT jint JNICALL
+Java_com_nova_companion_voice_PiperJNI_getReadiness(
+        JNIEnv *env,
+        jobject /* this */) {
+    std::lock_guard<std::mutex> lock(g_warmup_mutex);
+    return g_readiness;
+}
+
+// ============================================================
+// awaitReady - Block until warm-up finishes or timeoutMs passes
+// Returns true if ready.
+// ============================================================
+JNIEXPORT jboolean JNICALL
+Java_com_nova_companion_voice_PiperJNI_awaitReady(
+        JNIEnv *env,
+        jobject /* this */,
+        jint timeoutMs) {
+    std::unique_lock<std::mutex> lock(g_warmup_mutex);
+    const bool ready = g_warmup_cv.wait_for(lock, std::chrono::milliseconds(std::max(0, (int) timeoutMs)), [] {
+        return g_readiness == READINESS_READY || g_readiness == READINESS_NONE;
+    });
+    return ready && g_readiness == READINESS_READY ? JNI_TRUE : JNI_FALSE;
 }
 
 // ============================================================
@@ -230,7 +1218,8 @@ JNIEXPORT jint JNICALL
 Java_com_nova_companion_voice_PiperJNI_getSampleRate(
         JNIEnv *env,
         jobject /* this */) {
-    return g_sampleRate;
+    std::shared_ptr<PiperVoice> voice = g_voices.active();
+    return voice ? voice->sampleRate() : 22050;
 }
 
 // ============================================================
@@ -240,7 +1229,7 @@ JNIEXPORT jboolean JNICALL
 Java_com_nova_companion_voice_PiperJNI_isInitialized(
         JNIEnv *env,
         jobject /* this */) {
-    return g_initialized ? JNI_TRUE : JNI_FALSE;
+    return g_voices.active() ? JNI_TRUE : JNI_FALSE;
 }
 
 // ============================================================
@@ -250,10 +1239,87 @@ JNIEXPORT void JNICALL
 Java_com_nova_companion_voice_PiperJNI_release(
         JNIEnv *env,
         jobject /* this */) {
-    if (g_initialized) {
-        g_initialized = false;
+    stop_warmup();
+    set_readiness(READINESS_NONE);
+    {
+        // Stops the producer; destroyed (joined) when the last reference drops
+        std::lock_guard<std::mutex> lock(g_stream_mutex);
+        if (g_stream) g_stream->abort();
+        g_stream.reset();
+    }
+    {
+        std::lock_guard<std::mutex> lock(g_ring_mutex);
+        stop_ring_pump();
+        g_ring.reset();
+    }
+    {
+        std::lock_guard<std::mutex> lock(g_sink_mutex);
+        stop_sink_pump();
+    }
+    if (g_voices.active()) {
+        g_voices.clear();
         LOGI("Piper resources released");
     }
 }
 
+// ============================================================
+// Tracing (trace.h)
+// ============================================================
+JNIEXPORT void JNICALL
+Java_com_nova_companion_voice_PiperJNI_setTraceMode(
+        JNIEnv *env,
+        jobject /* this */,
+        jint mode) {
+    trace::set_mode(mode);
+}
+
+JNIEXPORT jstring JNICALL
+Java_com_nova_companion_voice_PiperJNI_dumpTrace(
+        JNIEnv *env,
+        jobject /* this */) {
+    return env->NewStringUTF(trace::dump_events().c_str());
+}
+
 } // extern "C"
+
+// ============================================================
+// Stage entry points for the native voice pipeline (stage_api.h)
+// ============================================================
+
+NOVA_STAGE_API int nova_piper_ready(void) {
+    return g_voices.active() ? 1 : 0;
+}
+
+NOVA_STAGE_API int nova_piper_stream_begin(int outputRate, nova_pcm_fn onAudio, void *user) {
+    auto voice = active_voice();
+    if (!voice || !onAudio) return 0;
+
+    std::lock_guard<std::mutex> lock(g_sink_mutex);
+    stop_sink_pump();
+    g_sink_stream = start_stream(voice, SynthParams(), std::max(0, outputRate));
+    g_sink_pump = std::thread(pump_to_sink, g_sink_stream, onAudio, user);
+    return 1;
+}
+
+// The pipeline's own session: a Kotlin stream started since then must not
+// receive its tokens
+NOVA_STAGE_API void nova_piper_stream_append(const char *text) {
+    auto stream = current_sink_stream();
+    if (stream && text) stream->append(text);
+}
+
+NOVA_STAGE_API void nova_piper_stream_finish(void) {
+    auto stream = current_sink_stream();
+    if (stream) stream->finish();
+}
+
+NOVA_STAGE_API void nova_piper_stream_cancel(void) {
+    std::lock_guard<std::mutex> lock(g_sink_mutex);
+    if (!g_sink_stream) return;
+    {
+        std::lock_guard<std::mutex> streamLock(g_stream_mutex);
+        if (g_stream == g_sink_stream) g_stream.reset();
+    }
+    stop_sink_pump();
+    LOGI("Pipeline synthesis cancelled");
+}
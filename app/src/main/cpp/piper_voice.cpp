@@ -0,0 +1,319 @@
+/**
+ * Piper voice inference — see piper_voice.h.
+ */
+
+#include "piper_voice.h"
+
+#include <android/log.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <sys/stat.h>
+
+#include "phoneme_ids.hpp"
+#include "phonemize.hpp"
+
+#define LOG_TAG "PiperVoice"
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
+#define LOGW(...) __android_log_print(ANDROID_LOG_WARN, LOG_TAG, __VA_ARGS__)
+
+// Config parsers from piper.cpp (external linkage, not declared in piper.hpp)
+namespace piper {
+void parsePhonemizeConfig(json &configRoot, PhonemizeConfig &phonemizeConfig);
+void parseSynthesisConfig(json &configRoot, SynthesisConfig &synthesisConfig);
+void parseModelConfig(json &configRoot, ModelConfig &modelConfig);
+}
+
+static const float MAX_WAV_VALUE = 32767.0f;
+// Seam between pieces of a chunked sentence
+static const int CROSSFADE_MS = 8;
+// Activations + arena on top of the weights, for memory accounting
+static const size_t RUNTIME_OVERHEAD_BYTES = 16 * 1024 * 1024;
+
+// eSpeak keeps global state; phonemize one text at a time across all voices
+static std::mutex g_phonemize_mutex;
+// Guarded by g_phonemize_mutex
+static std::string g_espeak_data_path;
+static bool g_espeak_ready = false;
+
+static double ms_since(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+
+void PiperVoice::setESpeakDataPath(const std::string &path) {
+    std::lock_guard<std::mutex> lock(g_phonemize_mutex);
+    if (g_espeak_ready && path != g_espeak_data_path) {
+        LOGW("eSpeak already loaded from %s; keeping it", g_espeak_data_path.c_str());
+        return;
+    }
+    g_espeak_data_path = path;
+}
+
+// Caller holds g_phonemize_mutex
+static void ensure_espeak() {
+    if (g_espeak_ready) return;
+    const auto t0 = std::chrono::steady_clock::now();
+    piper::PiperConfig config;
+    config.eSpeakDataPath = g_espeak_data_path;
+    config.useESpeak = true;
+    piper::initialize(config);
+    g_espeak_ready = true;
+    LOGI("eSpeak loaded from %s in %.0f ms", g_espeak_data_path.c_str(), ms_since(t0));
+}
+
+void PiperVoice::preparePhonemizer() const {
+    if (m_voice.phonemizeConfig.phonemeType != piper::eSpeakPhonemes) return;
+    std::lock_guard<std::mutex> lock(g_phonemize_mutex);
+    ensure_espeak();
+}
+
+std::unique_ptr<PiperVoice> PiperVoice::load(const std::string &modelPath, const std::string &configPath,
+                                             std::shared_ptr<Ort::Env> env,
+                                             const Ort::SessionOptions &options) {
+    std::unique_ptr<PiperVoice> voice(new PiperVoice());
+    voice->m_id = modelPath;
+
+    std::ifstream configFile(configPath);
+    if (!configFile) throw std::runtime_error("Cannot open voice config: " + configPath);
+    voice->m_voice.configRoot = json::parse(configFile);
+    piper::parsePhonemizeConfig(voice->m_voice.configRoot, voice->m_voice.phonemizeConfig);
+    piper::parseSynthesisConfig(voice->m_voice.configRoot, voice->m_voice.synthesisConfig);
+    piper::parseModelConfig(voice->m_voice.configRoot, voice->m_voice.modelConfig);
+    voice->m_hasSpeakerInput = voice->m_voice.modelConfig.numSpeakers > 1;
+    voice->m_phonemeIdMap = std::make_shared<piper::PhonemeIdMap>(voice->m_voice.phonemizeConfig.phonemeIdMap);
+
+    const auto t0 = std::chrono::steady_clock::now();
+    voice->m_env = std::move(env);
+    voice->m_session = std::make_unique<Ort::Session>(*voice->m_env, modelPath.c_str(), options);
+
+    struct stat st {};
+    const size_t weights = stat(modelPath.c_str(), &st) == 0 ? (size_t) st.st_size : 0;
+    voice->m_memoryBytes = weights + RUNTIME_OVERHEAD_BYTES;
+
+    LOGI("Loaded %s in %.0f ms (%d Hz, %d speaker(s), ~%zu MB)", modelPath.c_str(), ms_since(t0),
+         voice->sampleRate(), voice->numSpeakers(), voice->m_memoryBytes >> 20);
+
+    // Quantized voices load like any other; the report just says what runs in int8
+    try {
+        voice->m_quantization = inspect_quantization(modelPath);
+        LOGI("Model: %s", voice->m_quantization.summary().c_str());
+    } catch (const std::exception &e) {
+        LOGW("Quantization check failed: %s", e.what());
+    }
+    return voice;
+}
+
+SynthParams PiperVoice::resolve(const SynthParams &params) const {
+    const piper::SynthesisConfig &defaults = m_voice.synthesisConfig;
+    SynthParams out;
+    out.speakerId = params.speakerId >= 0 ? params.speakerId : defaults.speakerId.value_or(0);
+    out.lengthScale = params.lengthScale > 0.0f ? params.lengthScale : defaults.lengthScale;
+    out.noiseScale = params.noiseScale >= 0.0f ? params.noiseScale : defaults.noiseScale;
+    out.noiseW = params.noiseW >= 0.0f ? params.noiseW : defaults.noiseW;
+    if (out.speakerId >= numSpeakers()) {
+        LOGW("Speaker %lld out of range (%d speakers), using 0", (long long) out.speakerId, numSpeakers());
+        out.speakerId = 0;
+    }
+    return out;
+}
+
+size_t PiperVoice::sentenceSilenceSamples() const {
+    const piper::SynthesisConfig &config = m_voice.synthesisConfig;
+    return config.sentenceSilenceSeconds > 0.0f
+           ? (size_t) (config.sentenceSilenceSeconds * (float) config.sampleRate * (float) config.channels)
+           : 0;
+}
+
+void PiperVoice::phonemize(const std::string &text, std::vector<std::vector<int64_t>> &sentences) const {
+    const piper::PhonemizeConfig &config = m_voice.phonemizeConfig;
+    std::vector<std::vector<piper::Phoneme>> phonemes;
+    {
+        std::lock_guard<std::mutex> lock(g_phonemize_mutex);
+        if (config.phonemeType == piper::eSpeakPhonemes) {
+            ensure_espeak();
+            piper::eSpeakPhonemeConfig eSpeakConfig;
+            eSpeakConfig.voice = config.eSpeak.voice;
+            piper::phonemize_eSpeak(text, eSpeakConfig, phonemes);
+        } else {
+            piper::CodepointsPhonemeConfig codepointsConfig;
+            piper::phonemize_codepoints(text, codepointsConfig, phonemes);
+        }
+    }
+
+    piper::PhonemeIdConfig idConfig;
+    idConfig.phonemeIdMap = m_phonemeIdMap;
+    std::map<piper::Phoneme, std::size_t> missing;
+
+    for (auto &sentence : phonemes) {
+        if (config.phonemeMap) {
+            // Voice-specific phoneme substitutions
+            std::vector<piper::Phoneme> mapped;
+            for (piper::Phoneme p : sentence) {
+                auto it = config.phonemeMap->find(p);
+                if (it == config.phonemeMap->end()) {
+                    mapped.push_back(p);
+                } else {
+                    mapped.insert(mapped.end(), it->second.begin(), it->second.end());
+                }
+            }
+            sentence.swap(mapped);
+        }
+        std::vector<int64_t> ids;
+        piper::phonemes_to_ids(sentence, idConfig, ids, missing);
+        if (!ids.empty()) sentences.push_back(std::move(ids));
+    }
+    if (!missing.empty()) LOGW("%zu phoneme(s) missing from the voice's id map", missing.size());
+}
+
+void PiperVoice::infer(std::vector<int64_t> &phonemeIds, const SynthParams &params,
+                       std::vector<int16_t> &pcm, double *inferMs, float *runningPeak,
+                       const CancelToken *cancel) {
+    static const Ort::RunOptions NO_RUN_OPTIONS{nullptr};
+    if (cancel && cancel->cancelled()) throw SynthesisCancelled();
+
+    auto memoryInfo = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
+
+    std::array<int64_t, 2> idsShape{1, (int64_t) phonemeIds.size()};
+    std::array<int64_t, 1> lengths{(int64_t) phonemeIds.size()};
+    std::array<int64_t, 1> lengthsShape{1};
+    std::array<float, 3> scales{params.noiseScale, params.lengthScale, params.noiseW};
+    std::array<int64_t, 1> scalesShape{3};
+    std::array<int64_t, 1> speaker{params.speakerId};
+    std::array<int64_t, 1> speakerShape{1};
+
+    std::vector<Ort::Value> inputs;
+    inputs.push_back(Ort::Value::CreateTensor<int64_t>(memoryInfo, phonemeIds.data(), phonemeIds.size(),
+                                                       idsShape.data(), idsShape.size()));
+    inputs.push_back(Ort::Value::CreateTensor<int64_t>(memoryInfo, lengths.data(), lengths.size(),
+                                                       lengthsShape.data(), lengthsShape.size()));
+    inputs.push_back(Ort::Value::CreateTensor<float>(memoryInfo, scales.data(), scales.size(),
+                                                     scalesShape.data(), scalesShape.size()));
+    if (m_hasSpeakerInput) {
+        inputs.push_back(Ort::Value::CreateTensor<int64_t>(memoryInfo, speaker.data(), speaker.size(),
+                                                           speakerShape.data(), speakerShape.size()));
+    }
+
+    static const std::array<const char *, 4> inputNames{"input", "input_lengths", "scales", "sid"};
+    static const std::array<const char *, 1> outputNames{"output"};
+
+    const auto t0 = std::chrono::steady_clock::now();
+    std::vector<Ort::Value> outputs;
+    try {
+        outputs = m_session->Run(cancel ? cancel->runOptions() : NO_RUN_OPTIONS, inputNames.data(),
+                                 inputs.data(), inputs.size(), outputNames.data(), outputNames.size());
+    } catch (const Ort::Exception &) {
+        // A terminated run surfaces as an ORT error
+        if (cancel && cancel->cancelled()) throw SynthesisCancelled();
+        throw;
+    }
+    if (inferMs) *inferMs += ms_since(t0);
+    if (outputs.size() != 1 || !outputs.front().IsTensor()) {
+        throw std::runtime_error("Invalid output tensors");
+    }
+
+    const float *audio = outputs.front().GetTensorData<float>();
+    const auto shape = outputs.front().GetTensorTypeAndShapeInfo().GetShape();
+    const int64_t count = shape.empty() ? 0 : shape.back();
+
+    // Scale the sentence to fill the int16 range, as piper does
+    float peak = 0.01f;
+    for (int64_t i = 0; i < count; i++) peak = std::max(peak, std::fabs(audio[i]));
+    if (runningPeak) {
+        peak = std::max(peak, *runningPeak);
+        *runningPeak = peak;
+    }
+    const float scale = MAX_WAV_VALUE / peak;
+
+    pcm.reserve(pcm.size() + (size_t) count);
+    for (int64_t i = 0; i < count; i++) {
+        pcm.push_back((int16_t) std::clamp(audio[i] * scale,
+                                           (float) std::numeric_limits<int16_t>::min(),
+                                           (float) std::numeric_limits<int16_t>::max()));
+    }
+}
+
+void PiperVoice::synthesize(const std::string &text, const SynthParams &params,
+                            std::vector<int16_t> &pcm, SynthStats *stats, const CancelToken *cancel) {
+    const SynthParams resolved = resolve(params);
+    const auto t0 = std::chrono::steady_clock::now();
+    std::vector<std::vector<int64_t>> sentences;
+    phonemize(text, sentences);
+    const double phonemizeMs = ms_since(t0);
+
+    const size_t start = pcm.size();
+    const size_t silence = sentenceSilenceSamples();
+    double inferMs = 0.0;
+    for (auto &ids : sentences) {
+        infer(ids, resolved, pcm, &inferMs, nullptr, cancel);
+        pcm.insert(pcm.end(), silence, 0);
+    }
+
+    if (stats) {
+        stats->phonemizeMs += phonemizeMs;
+        stats->inferMs += inferMs;
+        stats->audioSeconds += (double) (pcm.size() - start) / sampleRate();
+    }
+}
+
+std::vector<std::vector<int64_t>> PiperVoice::splitAtClauses(const std::vector<int64_t> &ids, size_t maxIds) const {
+    const piper::PhonemizeConfig &config = m_voice.phonemizeConfig;
+    PhonemeMarks marks;
+    marks.bos = config.idBos;
+    marks.pad = config.idPad;
+    marks.eos = config.idEos;
+    marks.interspersePad = config.interspersePad;
+    auto first = [&](char32_t phoneme) -> int64_t {
+        auto it = config.phonemeIdMap.find(phoneme);
+        return it == config.phonemeIdMap.end() || it->second.empty() ? -1 : it->second.front();
+    };
+    marks.space = first(U' ');
+    for (char32_t mark : {U',', U';', U':'}) {
+        const int64_t id = first(mark);
+        if (id >= 0) marks.clause.push_back(id);
+    }
+    return split_phoneme_ids(ids, maxIds, marks);
+}
+
+bool PiperVoice::synthesizeChunked(const std::string &text, const SynthParams &params, size_t maxIds,
+                                   const PcmSink &sink, SynthStats *stats, const CancelToken *cancel) {
+    const SynthParams resolved = resolve(params);
+    const auto t0 = std::chrono::steady_clock::now();
+    std::vector<std::vector<int64_t>> sentences;
+    phonemize(text, sentences);
+    if (stats) stats->phonemizeMs += ms_since(t0);
+
+    const size_t fade = (size_t) (CROSSFADE_MS * sampleRate() / 1000);
+    const size_t silence = sentenceSilenceSamples();
+    for (auto &ids : sentences) {
+        std::vector<std::vector<int64_t>> pieces = splitAtClauses(ids, maxIds);
+        float peak = 0.0f;
+        std::vector<int16_t> tail;   // end of the previous piece, faded into the next
+        for (size_t p = 0; p < pieces.size(); p++) {
+            std::vector<int16_t> pcm;
+            infer(pieces[p], resolved, pcm, stats ? &stats->inferMs : nullptr, &peak, cancel);
+
+            const size_t n = std::min(tail.size(), pcm.size());
+            for (size_t i = 0; i < n; i++) {
+                const float w = ((float) i + 0.5f) / (float) n;
+                pcm[i] = (int16_t) std::lrint((float) tail[i] * (1.0f - w) + (float) pcm[i] * w);
+            }
+            tail.clear();
+            if (p + 1 < pieces.size() && pcm.size() > fade * 2) {
+                tail.assign(pcm.end() - (long) fade, pcm.end());
+                pcm.resize(pcm.size() - fade);
+            }
+            if (p + 1 == pieces.size()) pcm.insert(pcm.end(), silence, 0);
+
+            if (stats) stats->audioSeconds += (double) pcm.size() / sampleRate();
+            if (!sink(std::move(pcm))) return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,152 @@
+/**
+ * One loaded Piper voice: its JSON config plus an ONNX Runtime session.
+ *
+ * Synthesis runs here instead of through piper::textToAudio, which always
+ * reads the voice's own synthesisConfig and owns its session. Here every
+ * call takes its own SynthParams (speaker, length / noise / noise-w scales)
+ * and nothing shared is mutated. Sessions are created against an
+ * Ort::Env owned by the VoiceRegistry, so resident voices share one
+ * environment and its thread pools; each voice holds a reference to the
+ * env, which must outlive its session.
+ *
+ * Pipeline per call: text → phonemes per sentence (eSpeak or codepoints,
+ * as the voice config says) → phoneme ids → one model run per sentence →
+ * peak-normalized int16 PCM, with the voice's sentence silence in between.
+ *
+ * eSpeak is initialized lazily, by the first voice that phonemizes with it
+ * (or preparePhonemizer, e.g. from a background warm-up), from the data
+ * directory given to setESpeakDataPath; voices that phonemize by codepoint
+ * never load it. Each voice builds its phoneme id map once, at load.
+ *
+ * The model is end to end (there is no separate vocoder stage to window),
+ * so synthesizeChunked streams long sentences by cutting their phoneme ids
+ * after clause marks (phoneme_split.h) and running each piece on its own.
+ * Seams are joined with a short crossfade, and the normalization gain
+ * follows the running peak of the sentence so the level doesn't jump from
+ * piece to piece.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <onnxruntime_cxx_api.h>
+
+#include "onnx_inspect.h"
+#include "phoneme_split.h"
+#include "phoneme_ids.hpp"
+#include "piper.hpp"
+
+// Per-request synthesis parameters; negative values mean "voice default"
+struct SynthParams {
+    int64_t speakerId = -1;
+    float lengthScale = -1.0f;
+    float noiseScale = -1.0f;
+    float noiseW = -1.0f;
+};
+
+struct SynthStats {
+    double phonemizeMs = 0.0;
+    double inferMs = 0.0;
+    double audioSeconds = 0.0;
+};
+
+// Stops a synthesis from another thread: checked between sentences and
+// pieces, and the terminate flag on its RunOptions aborts a model run
+// already in progress
+class CancelToken {
+public:
+    void cancel() {
+        m_cancelled.store(true);
+        m_runOptions.SetTerminate();
+    }
+    bool cancelled() const { return m_cancelled.load(); }
+    const Ort::RunOptions &runOptions() const { return m_runOptions; }
+
+private:
+    std::atomic<bool> m_cancelled{false};
+    Ort::RunOptions m_runOptions;
+};
+
+// Thrown out of synthesis once its CancelToken fires
+struct SynthesisCancelled : std::runtime_error {
+    SynthesisCancelled() : std::runtime_error("Synthesis cancelled") {}
+};
+
+class PiperVoice {
+public:
+    // Throws std::exception on a missing / malformed model or config
+    static std::unique_ptr<PiperVoice> load(const std::string &modelPath, const std::string &configPath,
+                                            std::shared_ptr<Ort::Env> env,
+                                            const Ort::SessionOptions &options);
+
+    // espeak-ng-data directory; eSpeak itself loads on first use
+    static void setESpeakDataPath(const std::string &path);
+
+    // Load the phonemizer this voice uses now rather than on its first
+    // synthesis. Throws if eSpeak fails to initialize.
+    void preparePhonemizer() const;
+
+    const std::string &id() const { return m_id; }
+    int sampleRate() const { return m_voice.synthesisConfig.sampleRate; }
+    int numSpeakers() const { return m_voice.modelConfig.numSpeakers; }
+
+    // Resident memory estimate: weights (model file) plus runtime overhead
+    size_t memoryBytes() const { return m_memoryBytes; }
+
+    // int8 / fp32 check of the model file, made at load
+    const QuantizationReport &quantization() const { return m_quantization; }
+
+    // params with every default filled in from the voice config
+    SynthParams resolve(const SynthParams &params) const;
+
+    // Text to phoneme ids, one vector per sentence
+    void phonemize(const std::string &text, std::vector<std::vector<int64_t>> &sentences) const;
+
+    // One model run; appends peak-normalized PCM. params must be resolved.
+    // With runningPeak, normalizes to the larger of it and this run's peak
+    // (and updates it), for pieces of one sentence. Throws
+    // SynthesisCancelled if cancel fires before or during the run.
+    void infer(std::vector<int64_t> &phonemeIds, const SynthParams &params,
+               std::vector<int16_t> &pcm, double *inferMs = nullptr, float *runningPeak = nullptr,
+               const CancelToken *cancel = nullptr);
+
+    // One sentence's ids cut after clause marks into pieces of about maxIds
+    // (the first about half that), each wrapped in BOS / EOS again
+    std::vector<std::vector<int64_t>> splitAtClauses(const std::vector<int64_t> &ids, size_t maxIds) const;
+
+    // phonemize + infer every sentence, appending sentence silence after each
+    void synthesize(const std::string &text, const SynthParams &params,
+                    std::vector<int16_t> &pcm, SynthStats *stats = nullptr,
+                    const CancelToken *cancel = nullptr);
+
+    // Receives each finished piece of audio; false stops synthesis
+    using PcmSink = std::function<bool(std::vector<int16_t> &&pcm)>;
+
+    // synthesize, handing audio to sink as it is rendered: short sentences
+    // whole, long ones in splitAtClauses pieces. Returns false if sink stopped it.
+    bool synthesizeChunked(const std::string &text, const SynthParams &params, size_t maxIds,
+                           const PcmSink &sink, SynthStats *stats = nullptr,
+                           const CancelToken *cancel = nullptr);
+
+    // Samples of silence the voice puts after each sentence
+    size_t sentenceSilenceSamples() const;
+
+private:
+    PiperVoice() = default;
+
+    std::string m_id;
+    size_t m_memoryBytes = 0;
+    QuantizationReport m_quantization;
+    piper::Voice m_voice;               // config only; m_session does the inference
+    std::shared_ptr<piper::PhonemeIdMap> m_phonemeIdMap;
+    std::shared_ptr<Ort::Env> m_env;    // declared first: released after the session
+    std::unique_ptr<Ort::Session> m_session;
+    bool m_hasSpeakerInput = false;
+};
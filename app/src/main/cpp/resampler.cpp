@@ -0,0 +1,123 @@
+/**
+ * Streaming polyphase resampler — see resampler.h.
+ */
+
+#include "resampler.h"
+
+#include "audio_simd.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+// Zeroth-order modified Bessel function (power series), for the Kaiser window
+static double bessel_i0(double x) {
+    double sum = 1.0, term = 1.0;
+    const double q = x * x / 4.0;
+    for (int k = 1; k < 32; k++) {
+        term *= q / ((double) k * k);
+        sum += term;
+        if (term < sum * 1e-12) break;
+    }
+    return sum;
+}
+
+Resampler::Resampler(int inRate, int outRate)
+    : m_inRate(inRate), m_outRate(outRate) {
+    const int g = std::gcd(inRate, outRate);
+    m_up = outRate / g;
+    m_down = inRate / g;
+    // The filter spans TAPS samples at the lower rate: a downsampler's
+    // transition band is then as narrow relative to the output Nyquist as an
+    // upsampler's, instead of `down / up` times wider
+    m_taps = TAPS * std::max(1, (m_down + m_up - 1) / m_up);
+
+    if (!passthrough()) {
+        // Prototype over up * taps points, centred, in input-sample time units
+        const int len = m_up * m_taps;
+        const double centre = len / 2.0;
+        const double cutoff = ROLLOFF * std::min(1.0, (double) m_up / m_down);
+        const double i0Beta = bessel_i0(KAISER_BETA);
+
+        m_bank.assign((size_t) len, 0.0f);
+        for (int p = 0; p < m_up; p++) {
+            double sum = 0.0;
+            std::vector<double> taps(m_taps);
+            for (int i = 0; i < m_taps; i++) {
+                const double j = p + (double) i * m_up;
+                const double t = (j - centre) / m_up;
+                const double x = M_PI * cutoff * t;
+                const double sinc = std::abs(x) < 1e-9 ? 1.0 : std::sin(x) / x;
+                const double r = (j - centre) / centre;
+                const double window = std::abs(r) <= 1.0
+                                      ? bessel_i0(KAISER_BETA * std::sqrt(1.0 - r * r)) / i0Beta
+                                      : 0.0;
+                taps[i] = sinc * window;
+                sum += taps[i];
+            }
+            // Unity DC gain per phase; reversed so the dot runs forward in time
+            float *phase = m_bank.data() + (size_t) p * m_taps;
+            for (int i = 0; i < m_taps; i++) {
+                phase[m_taps - 1 - i] = (float) (sum != 0.0 ? taps[i] / sum : 0.0);
+            }
+        }
+    }
+    reset();
+}
+
+void Resampler::reset() {
+    // m_taps zeros of history stand in for the audio before the first sample
+    m_buf.assign(m_taps, 0.0f);
+    m_bufStart = -m_taps;
+    m_inputs = 0;
+    m_nextOut = 0;
+}
+
+void Resampler::process(const float *in, int n, std::vector<float> &out) {
+    if (n <= 0) return;
+    if (passthrough()) {
+        out.insert(out.end(), in, in + n);
+        m_inputs += n;
+        return;
+    }
+
+    m_buf.insert(m_buf.end(), in, in + n);
+    m_inputs += n;
+    emit(m_inputs, out);
+}
+
+void Resampler::flush(std::vector<float> &out) {
+    if (passthrough()) return;
+
+    // Outputs up to the last input instant, padding the look-ahead with zeros
+    const int64_t total = (m_inputs * m_up + m_down - 1) / m_down;
+    m_buf.insert(m_buf.end(), m_taps, 0.0f);
+    const int64_t available = m_bufStart + (int64_t) m_buf.size();
+    emit(available, out);
+    if (m_nextOut > total) {
+        out.resize(out.size() - (size_t) (m_nextOut - total));
+        m_nextOut = total;
+    }
+}
+
+// Produce every output whose newest tap lies below input index `limit`,
+// then drop history no future output can reach
+void Resampler::emit(int64_t limit, std::vector<float> &out) {
+    const int64_t centre = (int64_t) m_up * m_taps / 2;
+    for (;;) {
+        const int64_t pos = m_nextOut * m_down + centre;
+        const int64_t q = pos / m_up;
+        if (q >= limit) break;
+        const int p = (int) (pos % m_up);
+        const float *x = m_buf.data() + (q - m_taps + 1 - m_bufStart);
+        out.push_back(simd::dot(m_bank.data() + (size_t) p * m_taps, x, m_taps));
+        m_nextOut++;
+    }
+
+    const int64_t keepFrom = (m_nextOut * m_down + centre) / m_up - m_taps + 1;
+    if (keepFrom > m_bufStart) {
+        const size_t drop = (size_t) std::min<int64_t>(keepFrom - m_bufStart, (int64_t) m_buf.size());
+        m_buf.erase(m_buf.begin(), m_buf.begin() + (std::ptrdiff_t) drop);
+        m_bufStart += (int64_t) drop;
+    }
+}
@@ -0,0 +1,103 @@
+/**
+ * Lock-free single-producer / single-consumer queue.
+ *
+ * Links the stages of the native voice pipeline where neither side may wait
+ * on the other: front-end events leaving the capture worker, and PCM going
+ * into the AAudio output callback, which runs on a realtime thread and must
+ * not take locks. Capacity is rounded up to a power of two. Positions are
+ * free-running counters, so full vs. empty needs no spare slot. push / pop
+ * move single elements; write / read copy runs of trivially copyable
+ * samples.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+template <typename T>
+class SpscQueue {
+public:
+    explicit SpscQueue(size_t capacity) {
+        size_t cap = 1;
+        while (cap < capacity) cap <<= 1;
+        m_data.resize(cap);
+        m_mask = cap - 1;
+    }
+
+    SpscQueue(const SpscQueue &) = delete;
+    SpscQueue &operator=(const SpscQueue &) = delete;
+
+    size_t capacity() const { return m_data.size(); }
+
+    // Elements waiting; exact on either side, a snapshot from anywhere else
+    size_t size() const {
+        return m_write.load(std::memory_order_acquire) - m_read.load(std::memory_order_acquire);
+    }
+
+    bool empty() const { return size() == 0; }
+
+    // Producer: false if full
+    bool push(T value) {
+        const size_t w = m_write.load(std::memory_order_relaxed);
+        if (w - m_read.load(std::memory_order_acquire) == capacity()) return false;
+        m_data[w & m_mask] = std::move(value);
+        m_write.store(w + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer: false if empty
+    bool pop(T &out) {
+        const size_t r = m_read.load(std::memory_order_relaxed);
+        if (r == m_write.load(std::memory_order_acquire)) return false;
+        out = std::move(m_data[r & m_mask]);
+        m_read.store(r + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Producer: copies as much of [src, src + n) as fits, returns the count
+    size_t write(const T *src, size_t n) {
+        static_assert(std::is_trivially_copyable<T>::value, "bulk write needs trivially copyable T");
+        const size_t w = m_write.load(std::memory_order_relaxed);
+        n = std::min(n, capacity() - (w - m_read.load(std::memory_order_acquire)));
+        const size_t offset = w & m_mask;
+        const size_t first = std::min(n, capacity() - offset);
+        memcpy(m_data.data() + offset, src, first * sizeof(T));
+        if (first < n) memcpy(m_data.data(), src + first, (n - first) * sizeof(T));
+        m_write.store(w + n, std::memory_order_release);
+        return n;
+    }
+
+    // Consumer: copies up to n queued elements into dst, returns the count
+    size_t read(T *dst, size_t n) {
+        static_assert(std::is_trivially_copyable<T>::value, "bulk read needs trivially copyable T");
+        const size_t r = m_read.load(std::memory_order_relaxed);
+        n = std::min(n, m_write.load(std::memory_order_acquire) - r);
+        const size_t offset = r & m_mask;
+        const size_t first = std::min(n, capacity() - offset);
+        memcpy(dst, m_data.data() + offset, first * sizeof(T));
+        if (first < n) memcpy(dst + first, m_data.data(), (n - first) * sizeof(T));
+        m_read.store(r + n, std::memory_order_release);
+        return n;
+    }
+
+    // Consumer: drop everything queued so far; returns how many were dropped
+    size_t clear() {
+        const size_t r = m_read.load(std::memory_order_relaxed);
+        const size_t w = m_write.load(std::memory_order_acquire);
+        m_read.store(w, std::memory_order_release);
+        return w - r;
+    }
+
+private:
+    std::vector<T> m_data;
+    size_t m_mask = 0;
+    // Separate cache lines: each index is written by one thread only
+    alignas(64) std::atomic<size_t> m_write{0};
+    alignas(64) std::atomic<size_t> m_read{0};
+};
@@ -0,0 +1,65 @@
+/**
+ * C entry points the native voice pipeline (voice_pipeline.h) uses to drive
+ * the engines that live in the other native libraries.
+ *
+ * libnova_whisper, libnova_llama and libnova_piper each carry their own
+ * ggml / ONNX Runtime and are built with hidden visibility, so they can't
+ * link against each other. Instead, the LLM and TTS libraries export these
+ * few functions with default visibility. The pipeline resolves them with
+ * dlopen / dlsym when it starts. Those libraries are the same instances
+ * Kotlin loaded, so the model and voice loaded from Kotlin are the ones used.
+ *
+ * Callbacks run on the engine's own thread and must return quickly.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define NOVA_STAGE_API extern "C" __attribute__((visibility("default")))
+
+// One decoded piece of text; return 0 to stop generating
+typedef int (*nova_token_fn)(void *user, const char *piece);
+
+// A block of PCM at the stream's output rate; last is set once, on an empty
+// block after the final audio. Return 0 to stop synthesizing.
+typedef int (*nova_pcm_fn)(void *user, const int16_t *pcm, size_t n, int last);
+
+// ── libnova_llama (llama_jni.cpp) ──────────────────────────────
+
+// Nonzero once a model is loaded
+NOVA_STAGE_API int nova_llama_ready(void);
+
+// Blocking generation on the caller's thread, same sampling as
+// LlamaJNI.generateStreaming. Returns the tokens generated, or -1 if no
+// model is loaded or the prompt could not be evaluated.
+NOVA_STAGE_API int nova_llama_generate(const char *prompt, int maxTokens, float temperature, float topP,
+                                       const char *const *stops, int nStops,
+                                       nova_token_fn onToken, void *user);
+
+// Stop the generation in progress (any thread)
+NOVA_STAGE_API void nova_llama_cancel(void);
+
+// ── libnova_piper (piper_jni.cpp) ──────────────────────────────
+
+// Nonzero once a voice is active
+NOVA_STAGE_API int nova_piper_ready(void);
+
+// Start an incremental session on the active voice with its default
+// parameters, replacing any session in progress. Audio is resampled to
+// outputRate (0 keeps the voice's rate) and handed to onAudio from a native
+// pump thread. The session always ends with a last=1 call, also when a
+// Kotlin session replaces it, unless onAudio returned 0 or it was
+// cancelled. Returns 0 if there is no active voice.
+NOVA_STAGE_API int nova_piper_stream_begin(int outputRate, nova_pcm_fn onAudio, void *user);
+
+// Feed text (e.g. one LLM token); chunks are synthesized as they complete
+NOVA_STAGE_API void nova_piper_stream_append(const char *text);
+
+// No more text; speak whatever is left
+NOVA_STAGE_API void nova_piper_stream_finish(void);
+
+// Barge-in: stop synthesis and drop unplayed audio. Once this returns,
+// onAudio is not called again for the cancelled session.
+NOVA_STAGE_API void nova_piper_stream_cancel(void);
@@ -0,0 +1,173 @@
+/**
+ * Incremental text chunker — see text_chunker.h.
+ */
+
+#include "text_chunker.h"
+
+#include <cstring>
+
+static bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+static bool is_alpha(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+// Words whose trailing period is not a sentence end
+static const char *ABBREVIATIONS[] = {
+        "Dr", "Mr", "Mrs", "Ms", "Prof", "Sr", "Jr", "St", "Mt", "vs", "approx", "cf", "No",
+};
+
+// Closing quote / bracket, or the last byte of ” or ’ (U+201D / U+2019)
+static size_t closer_length(const std::string &s, size_t i) {
+    const char c = s[i];
+    if (c == '"' || c == '\'' || c == ')' || c == ']') return 1;
+    if (i >= 2 && (unsigned char) s[i - 2] == 0xE2 && (unsigned char) s[i - 1] == 0x80 &&
+        ((unsigned char) c == 0x9D || (unsigned char) c == 0x99)) {
+        return 3;
+    }
+    return 0;
+}
+
+// Last byte of a 4-byte pictograph (U+1F000 and up) or of U+FE0F
+static bool is_emoji_end(const std::string &s, size_t i) {
+    if (i >= 3 && (unsigned char) s[i - 3] == 0xF0 && (unsigned char) s[i - 2] == 0x9F) return true;
+    return i >= 2 && (unsigned char) s[i - 2] == 0xEF && (unsigned char) s[i - 1] == 0xB8 &&
+           (unsigned char) s[i] == 0x8F;
+}
+
+// '.' at i ends an abbreviation, a single-letter initial ("J. Smith") or
+// dotted letters ("U.S.", "e.g.", "p.m.")
+static bool is_abbreviation(const std::string &s, size_t i) {
+    size_t start = i;
+    while (start > 0 && (is_alpha(s[start - 1]) || s[start - 1] == '.') && i - start < 8) start--;
+    if (start > 0 && !is_space(s[start - 1]) && s[start - 1] != '(' && s[start - 1] != '"') return false;
+    const std::string word = s.substr(start, i - start);
+    if (word.size() == 1 && is_alpha(word[0]) && word[0] >= 'A' && word[0] <= 'Z') return true;
+    bool dotted = word.size() >= 3;
+    for (size_t k = 0; k < word.size() && dotted; k++) dotted = (k % 2 == 0) ? is_alpha(word[k]) : word[k] == '.';
+    if (dotted) return true;
+    for (const char *abbreviation : ABBREVIATIONS) {
+        if (word == abbreviation) return true;
+    }
+    return false;
+}
+
+// Sentence end at i: . ! ? (optionally followed by closers) or an emoji
+static bool is_sentence_end(const std::string &s, size_t i) {
+    size_t j = i;
+    for (int k = 0; k < 2; k++) {
+        const size_t len = closer_length(s, j);
+        if (len == 0 || j < len) break;
+        j -= len;
+    }
+    const char c = s[j];
+    if (c == '!' || c == '?') return true;
+    if (c == '.') return !is_abbreviation(s, j);
+    return is_emoji_end(s, i);
+}
+
+// ASCII clause marks, or the last byte of an en/em dash (U+2013 / U+2014)
+static bool is_clause_end(const std::string &s, size_t i) {
+    const char c = s[i];
+    if (c == ',' || c == ';' || c == ':') return true;
+    return i >= 2 && (unsigned char) s[i - 2] == 0xE2 && (unsigned char) s[i - 1] == 0x80 &&
+           ((unsigned char) c == 0x93 || (unsigned char) c == 0x94);
+}
+
+// Byte that belongs to a word or a number / URL form ("1,200.50", "3:30",
+// "a/b"), or any byte of a non-ASCII character
+static bool is_form_byte(char c) {
+    return is_alpha(c) || (c >= '0' && c <= '9') || (unsigned char) c >= 0x80 ||
+           std::strchr(".,:/%$-'_@#&+=", c) != nullptr;
+}
+
+// UTF-8 continuation byte: never the first byte of a character
+static bool is_continuation(char c) {
+    return ((unsigned char) c & 0xC0) == 0x80;
+}
+
+// Cut for a run-on with no clause mark in [0, max]: the last space, else the
+// last edge of a word or form, else the last character start
+static size_t run_on_cut(const std::string &s, size_t max) {
+    for (size_t k = max; k > 0; k--) {
+        if (is_space(s[k])) return k;
+    }
+    for (size_t k = max; k > 0; k--) {
+        if (!is_continuation(s[k]) && !(is_form_byte(s[k - 1]) && is_form_byte(s[k]))) return k;
+    }
+    size_t k = max;
+    while (k > 1 && is_continuation(s[k])) k--;
+    return k;
+}
+
+static std::string trim(const std::string &s) {
+    size_t start = 0, end = s.size();
+    while (start < end && is_space(s[start])) start++;
+    while (end > start && is_space(s[end - 1])) end--;
+    return s.substr(start, end - start);
+}
+
+void TextChunker::reset() {
+    m_pending.clear();
+    m_scanned = 0;
+    m_emitted = false;
+}
+
+void TextChunker::append(const std::string &fragment, std::vector<std::string> &out) {
+    m_pending += fragment;
+
+    // A boundary at i is only confirmed by whitespace at i + 1
+    size_t i = m_scanned;
+    while (i + 1 < m_pending.size()) {
+        const char next = m_pending[i + 1];
+        size_t length = i + 1;
+        bool cut = false;
+        if (m_pending[i] == '\n') {
+            cut = true;
+        } else if (is_space(next)) {
+            if (is_sentence_end(m_pending, i)) {
+                cut = length >= MIN_SENTENCE_CHARS;
+            } else if (is_clause_end(m_pending, i)) {
+                cut = length >= (m_emitted ? MIN_CLAUSE_CHARS : MIN_FIRST_CLAUSE_CHARS);
+            }
+        }
+        if (cut) {
+            emit(length, out);
+            i = 0;
+            continue;
+        }
+        i++;
+    }
+    m_scanned = i;
+
+    // No boundary in sight: cut a run-on at its last clause mark, else at
+    // its last word break (run_on_cut)
+    while (m_pending.size() > MAX_CHUNK_CHARS) {
+        size_t cut = 0;
+        for (size_t k = MAX_CHUNK_CHARS; k > MIN_FIRST_CLAUSE_CHARS; k--) {
+            if (is_space(m_pending[k]) && is_clause_end(m_pending, k - 1)) {
+                cut = k;
+                break;
+            }
+        }
+        if (cut == 0) cut = run_on_cut(m_pending, MAX_CHUNK_CHARS);
+        emit(cut, out);
+    }
+}
+
+void TextChunker::flush(std::vector<std::string> &out) {
+    emit(m_pending.size(), out);
+    reset();
+}
+
+// Release m_pending[0, end) as a chunk (dropped if only whitespace)
+void TextChunker::emit(size_t end, std::vector<std::string> &out) {
+    std::string chunk = trim(m_pending.substr(0, end));
+    m_pending.erase(0, end);
+    m_scanned = 0;
+    if (chunk.empty()) return;
+    out.push_back(std::move(chunk));
+    m_emitted = true;
+}
@@ -0,0 +1,50 @@
+/**
+ * Incremental text chunker for speaking LLM output as it streams.
+ *
+ * Fragments (tokens) are appended as they arrive; a chunk is released as
+ * soon as a clause or sentence boundary is confirmed — the punctuation mark
+ * followed by whitespace, so "3.5", "3:30", "$1,200" or a URL never split.
+ * A period after a title or other abbreviation ("Dr.", "e.g.", "vs.") or a
+ * single-letter initial is not a sentence end; closing quotes and brackets
+ * after the mark stay with it, and an emoji followed by a space ends a
+ * sentence like "!" does. A minimum-length policy keeps prosody natural:
+ * sentence ends release once the chunk has MIN_SENTENCE_CHARS, clause marks
+ * (, ; : and dashes) only past MIN_CLAUSE_CHARS. The first chunk of a reply
+ * uses a lower clause threshold so audio starts after roughly one short
+ * clause. Chunks that grow past MAX_CHUNK_CHARS without a boundary are cut
+ * at their last clause mark, else at the last space; a run with no space
+ * is cut at the edge of a word or number form, and never inside a UTF-8
+ * character.
+ *
+ * Each scan step looks at a fixed window around the byte, so appending a
+ * token costs O(token), not O(chunk). Chunks are cut only; spoken-form
+ * rewriting is normalize_for_speech (text_normalizer.h) per chunk.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+class TextChunker {
+public:
+    static constexpr size_t MIN_SENTENCE_CHARS = 12;
+    static constexpr size_t MIN_CLAUSE_CHARS = 60;
+    static constexpr size_t MIN_FIRST_CLAUSE_CHARS = 24;
+    static constexpr size_t MAX_CHUNK_CHARS = 240;
+
+    // Append a fragment; completed chunks are appended to out
+    void append(const std::string &fragment, std::vector<std::string> &out);
+
+    // End of text: whatever is left becomes the final chunk
+    void flush(std::vector<std::string> &out);
+
+    void reset();
+
+private:
+    void emit(size_t end, std::vector<std::string> &out);
+
+    std::string m_pending;
+    size_t m_scanned = 0;    // bytes of m_pending already checked for boundaries
+    bool m_emitted = false;  // any chunk released yet this reply
+};
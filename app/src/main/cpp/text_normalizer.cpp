@@ -0,0 +1,610 @@
+/**
+ * Spoken-form normalization — see text_normalizer.h.
+ */
+
+#include "text_normalizer.h"
+
+#include <cstring>
+
+static const char *ONES[] = {
+        "zero", "one", "two", "three", "four", "five", "six", "seven", "eight", "nine", "ten",
+        "eleven", "twelve", "thirteen", "fourteen", "fifteen", "sixteen", "seventeen", "eighteen", "nineteen"};
+static const char *TENS[] = {
+        "", "", "twenty", "thirty", "forty", "fifty", "sixty", "seventy", "eighty", "ninety"};
+static const char *SCALES[] = {
+        "", " thousand", " million", " billion", " trillion", " quadrillion", " quintillion"};
+static const char *MONTHS[] = {
+        "January", "February", "March", "April", "May", "June",
+        "July", "August", "September", "October", "November", "December"};
+
+// Numbers longer than this without grouping commas are read digit by digit
+static const size_t MAX_CARDINAL_DIGITS = 9;
+
+struct Abbreviation {
+    const char *text;
+    const char *spoken;
+};
+
+// Matched case-sensitively at a word start
+static const Abbreviation ABBREVIATIONS[] = {
+        {"Dr.", "Doctor"}, {"Mr.", "Mister"}, {"Mrs.", "Missus"}, {"Ms.", "Miz"},
+        {"Prof.", "Professor"}, {"e.g.", "for example"}, {"i.e.", "that is"},
+        {"etc.", "et cetera"}, {"vs.", "versus"}, {"approx.", "approximately"},
+};
+
+static const char *TLDS[] = {"com", "org", "net", "io", "dev", "ai", "app", "co", "edu", "gov", "uk", "de"};
+
+static bool is_digit(char c) { return c >= '0' && c <= '9'; }
+static bool is_alpha(char c) { return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'); }
+static bool is_alnum(char c) { return is_digit(c) || is_alpha(c); }
+static bool is_space(char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; }
+static char lower(char c) { return (c >= 'A' && c <= 'Z') ? (char) (c - 'A' + 'a') : c; }
+
+static bool starts_with(const std::string &s, size_t i, const char *prefix) {
+    return s.compare(i, strlen(prefix), prefix) == 0;
+}
+
+// Character at i, or '\0' past the end
+static char at(const std::string &s, size_t i) { return i < s.size() ? s[i] : '\0'; }
+
+// Pictographs, dingbats, skin-tone modifiers, ZWJ, variation selectors, tags
+static bool is_emoji(uint32_t cp) {
+    return (cp >= 0x1F000 && cp <= 0x1FAFF) || (cp >= 0x2600 && cp <= 0x27BF) ||
+           (cp >= 0x2B50 && cp <= 0x2B55) || (cp >= 0x231A && cp <= 0x231B) ||
+           (cp >= 0x23E9 && cp <= 0x23FA) || cp == 0x200D || cp == 0xFE0E || cp == 0xFE0F ||
+           (cp >= 0xE0020 && cp <= 0xE007F);
+}
+
+// Decode the UTF-8 sequence at i; len is its byte length (1 for invalid bytes)
+static uint32_t decode_utf8(const std::string &s, size_t i, size_t &len) {
+    const auto b = (unsigned char) s[i];
+    uint32_t cp;
+    if (b < 0x80) { len = 1; return b; }
+    else if ((b & 0xE0) == 0xC0) { len = 2; cp = b & 0x1F; }
+    else if ((b & 0xF0) == 0xE0) { len = 3; cp = b & 0x0F; }
+    else if ((b & 0xF8) == 0xF0) { len = 4; cp = b & 0x07; }
+    else { len = 1; return b; }
+    if (i + len > s.size()) { len = 1; return b; }
+    for (size_t k = 1; k < len; k++) cp = (cp << 6) | ((unsigned char) s[i + k] & 0x3F);
+    return cp;
+}
+
+static void below_thousand(int n, std::string &out) {
+    if (n >= 100) {
+        out += ONES[n / 100];
+        out += " hundred";
+        n %= 100;
+        if (n == 0) return;
+        out += ' ';
+    }
+    if (n < 20) {
+        out += ONES[n];
+    } else {
+        out += TENS[n / 10];
+        if (n % 10) {
+            out += '-';
+            out += ONES[n % 10];
+        }
+    }
+}
+
+std::string number_words(int64_t n) {
+    if (n == 0) return ONES[0];
+    std::string out;
+    uint64_t v;
+    if (n < 0) {
+        out = "minus ";
+        v = (uint64_t) 0 - (uint64_t) n;
+    } else {
+        v = (uint64_t) n;
+    }
+
+    int groups[7] = {0};
+    int count = 0;
+    while (v > 0) {
+        groups[count++] = (int) (v % 1000);
+        v /= 1000;
+    }
+    bool first = true;
+    for (int g = count - 1; g >= 0; g--) {
+        if (groups[g] == 0) continue;
+        if (!first) out += ' ';
+        below_thousand(groups[g], out);
+        out += SCALES[g];
+        first = false;
+    }
+    return out;
+}
+
+// "twenty-one" → "twenty-first"
+static std::string ordinal_words(int64_t n) {
+    std::string words = number_words(n);
+    size_t start = words.find_last_of(" -");
+    start = start == std::string::npos ? 0 : start + 1;
+    const std::string last = words.substr(start);
+    words.erase(start);
+
+    static const Abbreviation IRREGULAR[] = {
+            {"one", "first"}, {"two", "second"}, {"three", "third"}, {"five", "fifth"},
+            {"eight", "eighth"}, {"nine", "ninth"}, {"twelve", "twelfth"}};
+    for (const auto &irregular : IRREGULAR) {
+        if (last == irregular.text) return words + irregular.spoken;
+    }
+    if (last.back() == 'y') return words + last.substr(0, last.size() - 1) + "ieth";
+    return words + last + "th";
+}
+
+// 1999 → nineteen ninety-nine, 2005 → two thousand five, 1900 → nineteen hundred
+static std::string year_words(int year) {
+    if (year >= 2000 && year < 2010) return number_words(year);
+    const int hi = year / 100, lo = year % 100;
+    std::string out = number_words(hi);
+    if (lo == 0) return out + " hundred";
+    out += ' ';
+    if (lo < 10) out += "oh ";
+    return out + number_words(lo);
+}
+
+static void digit_words(const std::string &digits, std::string &out) {
+    for (size_t k = 0; k < digits.size(); k++) {
+        if (k) out += ' ';
+        out += ONES[digits[k] - '0'];
+    }
+}
+
+struct ParsedNumber {
+    std::string digits;     // integer part without commas
+    std::string fraction;   // digits after the point, if any
+    bool grouped = false;   // had thousands separators
+    size_t end = 0;
+};
+
+// Digits at i with optional 1,234 grouping and a .5 fraction
+static ParsedNumber parse_number(const std::string &s, size_t i) {
+    ParsedNumber num;
+    size_t j = i;
+    while (j < s.size() && is_digit(s[j])) num.digits += s[j++];
+    // Thousands groups: exactly three digits after each comma
+    while (num.digits.size() <= 3 || num.grouped) {
+        if (at(s, j) != ',' || !is_digit(at(s, j + 1)) || !is_digit(at(s, j + 2)) ||
+            !is_digit(at(s, j + 3)) || is_digit(at(s, j + 4))) {
+            break;
+        }
+        num.digits.append(s, j + 1, 3);
+        num.grouped = true;
+        j += 4;
+    }
+    if (at(s, j) == '.' && is_digit(at(s, j + 1))) {
+        j++;
+        while (j < s.size() && is_digit(s[j])) num.fraction += s[j++];
+    }
+    num.end = j;
+    return num;
+}
+
+static int64_t to_int(const std::string &digits) {
+    int64_t v = 0;
+    for (char c : digits) v = v * 10 + (c - '0');
+    return v;
+}
+
+static void cardinal(const ParsedNumber &num, std::string &out) {
+    if ((num.digits.size() > MAX_CARDINAL_DIGITS && !num.grouped) ||
+        (num.digits.size() > 1 && num.digits[0] == '0')) {
+        digit_words(num.digits, out);   // phone numbers, ids, zero-padded codes
+    } else if (num.digits.size() > 18) {
+        digit_words(num.digits, out);
+    } else {
+        out += number_words(to_int(num.digits));
+    }
+    if (!num.fraction.empty()) {
+        out += " point ";
+        digit_words(num.fraction, out);
+    }
+}
+
+// am / pm / a.m. / p.m. at i (after an optional space); returns its length
+static size_t match_meridiem(const std::string &s, size_t i, char &letter) {
+    size_t j = i;
+    if (at(s, j) == ' ') j++;
+    const char c = lower(at(s, j));
+    if (c != 'a' && c != 'p') return 0;
+    size_t k = j + 1;
+    if (at(s, k) == '.') k++;
+    if (lower(at(s, k)) != 'm') return 0;
+    k++;
+    if (at(s, k) == '.') k++;
+    if (is_alnum(at(s, k))) return 0;
+    // "a.m." ending a sentence (end of text, or a capital next) keeps its
+    // period for the chunker; "10 a.m. tomorrow" doesn't
+    if (at(s, k - 1) == '.' && (k >= s.size() || (is_space(s[k]) && at(s, k + 1) >= 'A' && at(s, k + 1) <= 'Z'))) k--;
+    letter = c;
+    return k - i;
+}
+
+static size_t two_digits(const std::string &s, size_t i, int &value) {
+    if (!is_digit(at(s, i)) || !is_digit(at(s, i + 1))) return 0;
+    value = (s[i] - '0') * 10 + (s[i + 1] - '0');
+    return 2;
+}
+
+static bool valid_date(int year, int month, int day) {
+    static const int DAYS[] = {31, 29, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    if (month < 1 || month > 12 || day < 1 || day > DAYS[month - 1]) return false;
+    const bool leap = year < 0 || (year % 4 == 0 && (year % 100 != 0 || year % 400 == 0));
+    return month != 2 || day <= 28 || leap;
+}
+
+// Digit group read as a number (zero-padded groups digit by digit)
+static void group_words(const std::string &s, size_t i, size_t len, std::string &out) {
+    cardinal(ParsedNumber{s.substr(i, len), std::string(), false, 0}, out);
+}
+
+// 2.0.1, 10.4.3.2 — read as "two point zero point one", never as a decimal.
+// Returns the end, or 0 if there aren't at least two dots.
+static size_t speak_dotted(const std::string &s, size_t i, std::string &out) {
+    size_t end = i, dots = 0;
+    while (is_digit(at(s, end))) {
+        while (is_digit(at(s, end))) end++;
+        if (at(s, end) != '.' || !is_digit(at(s, end + 1))) break;
+        end++;
+        dots++;
+    }
+    if (dots < 2 || is_alnum(at(s, end))) return 0;
+    for (size_t k = i; k < end;) {
+        size_t len = 0;
+        while (is_digit(at(s, k + len))) len++;
+        if (k > i) out += " point ";
+        group_words(s, k, len, out);
+        k += len + 1;
+    }
+    return end;
+}
+
+static void date_words(int year, int month, int day, std::string &out) {
+    out += MONTHS[month - 1];
+    out += ' ';
+    out += ordinal_words(day);
+    if (year >= 0) {
+        out += ", ";
+        out += year_words(year);
+    }
+}
+
+// Digits at i: dates, times, ordinals, percentages, years, plain numbers
+static size_t speak_number(const std::string &s, size_t i, std::string &out) {
+    int a = 0, b = 0, c = 0;
+
+    // ISO date 2024-03-15; out-of-range ones (2024-13-01) are read group by group
+    if (is_digit(at(s, i + 3)) && is_digit(at(s, i + 2)) && is_digit(at(s, i + 1)) &&
+        at(s, i + 4) == '-' && two_digits(s, i + 5, b) && at(s, i + 7) == '-' &&
+        two_digits(s, i + 8, c) && !is_digit(at(s, i + 10))) {
+        a = (int) to_int(s.substr(i, 4));
+        if (valid_date(a, b, c)) {
+            date_words(a, b, c, out);
+        } else {
+            group_words(s, i, 4, out);
+            out += ' ';
+            group_words(s, i + 5, 2, out);
+            out += ' ';
+            group_words(s, i + 8, 2, out);
+        }
+        return i + 10;
+    }
+
+    if (const size_t end = speak_dotted(s, i, out)) return end;
+
+    size_t j = i;
+    while (j < s.size() && is_digit(s[j]) && j - i < 3) j++;
+    const size_t lead = j - i;
+
+    // Time 3:05, 14:30, 9:15:00 with optional am / pm. Past 24:00 it's a
+    // duration (25:00 → twenty-five minutes); minutes past 59 are neither.
+    if (lead <= 2 && at(s, j) == ':' && two_digits(s, j + 1, b) && !is_digit(at(s, j + 3))) {
+        a = (int) to_int(s.substr(i, lead));
+        size_t end = j + 3;
+        if (b >= 60) {
+            out += number_words(a);
+            out += ' ';
+            out += number_words(b);
+            return end;
+        }
+        if (a > 24 || (a == 24 && b > 0)) {
+            out += number_words(a);
+            out += a == 1 ? " minute" : " minutes";
+            if (b > 0) {
+                out += " and ";
+                out += number_words(b);
+                out += b == 1 ? " second" : " seconds";
+            }
+            return end;
+        }
+        if (at(s, end) == ':' && two_digits(s, end + 1, c) && c < 60 && !is_digit(at(s, end + 3))) end += 3;
+        char meridiem = 0;
+        const size_t m = match_meridiem(s, end, meridiem);
+        out += number_words(a);
+        if (b == 0) {
+            if (!m) out += " o'clock";
+        } else {
+            out += ' ';
+            if (b < 10) out += "oh ";
+            out += number_words(b);
+        }
+        if (m) {
+            out += meridiem == 'a' ? " a m" : " p m";
+            end += m;
+        }
+        return end;
+    }
+
+    // US date 3/15/2024 or 3/15/24
+    if (lead <= 2 && at(s, j) == '/') {
+        size_t k = j + 1;
+        size_t dayLen = 0;
+        while (is_digit(at(s, k + dayLen)) && dayLen < 3) dayLen++;
+        if ((dayLen == 1 || dayLen == 2) && at(s, k + dayLen) == '/') {
+            size_t y = k + dayLen + 1, yearLen = 0;
+            while (is_digit(at(s, y + yearLen)) && yearLen < 5) yearLen++;
+            a = (int) to_int(s.substr(i, lead));
+            b = (int) to_int(s.substr(k, dayLen));
+            int year = (yearLen == 2 || yearLen == 4) ? (int) to_int(s.substr(y, yearLen)) : 0;
+            if (yearLen == 2) year += 2000;
+            if ((yearLen == 2 || yearLen == 4) && valid_date(year, a, b)) {
+                date_words(year, a, b, out);
+                return y + yearLen;
+            }
+        }
+    }
+
+    ParsedNumber num = parse_number(s, i);
+    size_t end = num.end;
+    const bool whole = num.fraction.empty();
+
+    // Ordinal 21st / 2nd / 3rd / 4th
+    if (whole && !num.grouped && num.digits.size() <= 6) {
+        const char x = lower(at(s, end)), y = lower(at(s, end + 1));
+        if (((x == 's' && y == 't') || (x == 'n' && y == 'd') || (x == 'r' && y == 'd') ||
+             (x == 't' && y == 'h')) && !is_alnum(at(s, end + 2))) {
+            out += ordinal_words(to_int(num.digits));
+            return end + 2;
+        }
+    }
+
+    // Hour with am / pm: 3pm, 11 a.m.
+    char meridiem = 0;
+    if (whole && num.digits.size() <= 2) {
+        const int hour = (int) to_int(num.digits);
+        const size_t m = hour >= 1 && hour <= 12 ? match_meridiem(s, end, meridiem) : 0;
+        if (m) {
+            out += number_words(hour);
+            out += meridiem == 'a' ? " a m" : " p m";
+            return end + m;
+        }
+    }
+
+    // Four-digit years read in pairs
+    if (whole && !num.grouped && num.digits.size() == 4 && at(s, end) != '%') {
+        const int year = (int) to_int(num.digits);
+        if (year >= 1100 && year <= 2099) {
+            out += year_words(year);
+            return end;
+        }
+    }
+
+    cardinal(num, out);
+    if (at(s, end) == '%') {
+        out += " percent";
+        end++;
+    }
+    return end;
+}
+
+struct Currency {
+    const char *symbol;
+    const char *one;
+    const char *many;
+    const char *cent;
+    const char *cents;
+};
+
+static const Currency CURRENCIES[] = {
+        {"$", "dollar", "dollars", "cent", "cents"},
+        {"\xE2\x82\xAC", "euro", "euros", "cent", "cents"},
+        {"\xC2\xA3", "pound", "pounds", "penny", "pence"},
+};
+
+// $12.50, €5 million, £3k
+static size_t speak_currency(const std::string &s, size_t i, const Currency &currency, std::string &out) {
+    const size_t start = i + strlen(currency.symbol);
+    ParsedNumber num = parse_number(s, start);
+    size_t end = num.end;
+
+    const char *scale = nullptr;
+    const char suffix = at(s, end);
+    if (!is_alpha(at(s, end + 1))) {
+        if (suffix == 'k' || suffix == 'K') scale = "thousand";
+        else if (suffix == 'm' || suffix == 'M') scale = "million";
+        else if (suffix == 'b' || suffix == 'B') scale = "billion";
+        if (scale) end++;
+    }
+    if (!scale && at(s, end) == ' ') {
+        static const char *WORDS[] = {"thousand", "million", "billion", "trillion"};
+        for (const char *word : WORDS) {
+            if (starts_with(s, end + 1, word) && !is_alpha(at(s, end + 1 + strlen(word)))) {
+                scale = word;
+                end += 1 + strlen(word);
+                break;
+            }
+        }
+    }
+
+    if (scale) {
+        cardinal(num, out);
+        out += ' ';
+        out += scale;
+        out += ' ';
+        out += currency.many;
+        return end;
+    }
+
+    const int64_t units = num.digits.size() <= 18 ? to_int(num.digits) : -1;
+    int64_t cents = 0;
+    if (!num.fraction.empty()) {
+        std::string digits = num.fraction.substr(0, 2);
+        if (digits.size() == 1) digits += '0';
+        cents = to_int(digits);
+    }
+    // $0.50 is fifty cents, not zero dollars and fifty cents
+    if (units != 0 || cents == 0) {
+        cardinal(ParsedNumber{num.digits, std::string(), num.grouped, 0}, out);
+        out += ' ';
+        out += units == 1 ? currency.one : currency.many;
+        if (cents > 0) out += " and ";
+    }
+    if (cents > 0) {
+        out += number_words(cents);
+        out += ' ';
+        out += cents == 1 ? currency.cent : currency.cents;
+    }
+    return end;
+}
+
+// Host part of a URL or bare domain, dots spoken
+static void speak_host(const std::string &host, std::string &out) {
+    for (char c : host) {
+        if (c == '.') out += " dot ";
+        else if (c == '-') out += ' ';
+        else out += c;
+    }
+}
+
+// Trailing sentence punctuation belongs to the text, not the URL
+static size_t url_end(const std::string &s, size_t i) {
+    size_t end = i;
+    while (end < s.size() && !is_space(s[end]) && s[end] != '"' && s[end] != '<' && s[end] != '>') end++;
+    while (end > i && strchr(".,;:!?)]'", s[end - 1])) end--;
+    return end;
+}
+
+static size_t speak_url(const std::string &s, size_t i, std::string &out) {
+    const size_t end = url_end(s, i);
+    size_t host = i;
+    const size_t scheme = s.find("://", i);
+    if (scheme != std::string::npos && scheme < end) host = scheme + 3;
+    if (starts_with(s, host, "www.")) host += 4;
+    size_t hostEnd = host;
+    while (hostEnd < end && (is_alnum(s[hostEnd]) || s[hostEnd] == '.' || s[hostEnd] == '-')) hostEnd++;
+    speak_host(s.substr(host, hostEnd - host), out);
+    return end;
+}
+
+// example.com, docs.example.io/path — a word whose last label is a known TLD
+static size_t match_domain(const std::string &s, size_t i) {
+    size_t j = i, lastDot = std::string::npos;
+    while (j < s.size() && (is_alnum(s[j]) || s[j] == '-' || (s[j] == '.' && is_alnum(at(s, j + 1))))) {
+        if (s[j] == '.') lastDot = j;
+        j++;
+    }
+    if (lastDot == std::string::npos || is_alnum(at(s, j))) return 0;
+    const std::string tld = s.substr(lastDot + 1, j - lastDot - 1);
+    for (const char *known : TLDS) {
+        if (tld == known) return j - i;
+    }
+    return 0;
+}
+
+std::string normalize_for_speech(const std::string &text) {
+    std::string out;
+    out.reserve(text.size() + text.size() / 4);
+
+    size_t i = 0;
+    while (i < text.size()) {
+        const char c = text[i];
+        const bool wordStart = i == 0 || !is_alnum(text[i - 1]);
+
+        if (wordStart && (starts_with(text, i, "http://") || starts_with(text, i, "https://") ||
+                          starts_with(text, i, "www."))) {
+            i = speak_url(text, i, out);
+            continue;
+        }
+
+        if (wordStart && is_alpha(c)) {
+            bool matched = false;
+            for (const auto &abbreviation : ABBREVIATIONS) {
+                const size_t len = strlen(abbreviation.text);
+                if (starts_with(text, i, abbreviation.text) && !is_alnum(at(text, i + len))) {
+                    out += abbreviation.spoken;
+                    // "... etc." can end a sentence; keep the stop for prosody
+                    if (strcmp(abbreviation.text, "etc.") == 0 &&
+                        (i + len >= text.size() || (is_space(text[i + len]) &&
+                                                    at(text, i + len + 1) >= 'A' && at(text, i + len + 1) <= 'Z'))) {
+                        out += '.';
+                    }
+                    i += len;
+                    matched = true;
+                    break;
+                }
+            }
+            if (matched) continue;
+
+            if (const size_t len = match_domain(text, i)) {
+                speak_host(text.substr(i, len), out);
+                i = at(text, i + len) == '/' ? url_end(text, i) : i + len;
+                continue;
+            }
+
+            // Copy the rest of the word so digits inside it ("mp3") stay
+            while (i < text.size() && is_alnum(text[i])) out += text[i++];
+            continue;
+        }
+
+        bool isCurrency = false;
+        for (const auto &currency : CURRENCIES) {
+            const size_t len = strlen(currency.symbol);
+            if (starts_with(text, i, currency.symbol) && is_digit(at(text, i + len))) {
+                i = speak_currency(text, i, currency, out);
+                isCurrency = true;
+                break;
+            }
+        }
+        if (isCurrency) continue;
+
+        if (c == '-' && is_digit(at(text, i + 1)) && (i == 0 || is_space(text[i - 1]) || text[i - 1] == '(')) {
+            out += "minus ";
+            i++;
+            continue;
+        }
+
+        if (is_digit(c) && wordStart) {
+            i = speak_number(text, i, out);
+            continue;
+        }
+
+        if (c == '&') {
+            out += " and ";
+            i++;
+            continue;
+        }
+
+        if ((unsigned char) c >= 0x80) {
+            size_t len;
+            const uint32_t cp = decode_utf8(text, i, len);
+            if (!is_emoji(cp)) out.append(text, i, len);
+            i += len;
+            continue;
+        }
+
+        out += c;
+        i++;
+    }
+
+    // Collapse the runs of spaces substitutions leave behind
+    std::string collapsed;
+    collapsed.reserve(out.size());
+    for (char ch : out) {
+        if (ch == ' ' && (collapsed.empty() || collapsed.back() == ' ' || collapsed.back() == '\n')) continue;
+        collapsed += ch;
+    }
+    while (!collapsed.empty() && collapsed.back() == ' ') collapsed.pop_back();
+    return collapsed;
+}
@@ -0,0 +1,36 @@
+/**
+ * Spoken-form normalization for Piper input.
+ *
+ * eSpeak reads digits and symbols literally or not at all, so each chunk is
+ * rewritten into words before phonemization:
+ *   numbers    1,234 → one thousand two hundred thirty-four; 3.5 → three
+ *              point five; -4 → minus four; 21st → twenty-first; 50% → fifty
+ *              percent; 1999 → nineteen ninety-nine (four-digit years)
+ *   currency   $12.50 → twelve dollars and fifty cents; €5 million → five
+ *              million euros ($ € £); $0.01 → one cent
+ *   times      3:05 pm → three oh five p m; 14:00 → fourteen o'clock;
+ *              25:00 → twenty-five minutes (past 24 h reads as a duration)
+ *   dates      2024-03-15 and 3/15/2024 → March fifteenth, twenty twenty-four
+ *              (only real dates; 2024-13-01 is read group by group)
+ *   versions   2.0.1 → two point zero point one
+ *   URLs       https://www.example.com/path → example dot com
+ *   abbrevs    Dr. Mr. Mrs. Ms. Prof. e.g. i.e. etc. vs. and &
+ *   emoji      dropped (pictographs, modifiers, ZWJ, variation selectors)
+ *
+ * One left-to-right pass per chunk; number words are built as small
+ * temporary strings. The chunker only cuts at whitespace after a boundary
+ * mark, so these forms stay whole in normal text; a run-on past
+ * MAX_CHUNK_CHARS with no space at all can still split a form, though
+ * never a UTF-8 character.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// Rewrite text into words eSpeak pronounces naturally
+std::string normalize_for_speech(const std::string &text);
+
+// Cardinal number in words ("minus" for negatives)
+std::string number_words(int64_t n);
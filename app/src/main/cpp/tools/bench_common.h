@@ -0,0 +1,88 @@
+/**
+ * Shared by the host voice benchmarks: the text corpus (short acks, medium
+ * replies and long paragraphs, written the way the LLM answers, with
+ * numbers, abbreviations and times so normalization is exercised), a
+ * loader for "category<TAB>text" replacement corpora, timing and the
+ * minimal JSON writing the reports need.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+struct CorpusEntry {
+    std::string category;
+    std::string text;
+};
+
+inline const std::vector<CorpusEntry> BENCH_CORPUS = {
+    {"short", "Okay."},
+    {"short", "Got it."},
+    {"short", "Sure, one moment."},
+    {"short", "Done! I set a timer for 10 minutes."},
+    {"medium", "It's 72 degrees and sunny right now, with a high of 78 this afternoon. "
+               "You probably won't need a jacket."},
+    {"medium", "I found three restaurants nearby. The closest is Luigi's, about 0.4 miles away, "
+               "and it's open until 10 pm."},
+    {"medium", "Your meeting with Dr. Patel moved to 3:30 pm on Thursday. Want me to update the reminder too?"},
+    {"long", "Here's a quick summary of your day. You have four meetings, starting with the design review "
+             "at 9 am, which usually runs long, so I'd plan for about ninety minutes. After lunch there's "
+             "the quarterly budget call with finance; they sent over the spreadsheet yesterday, and the "
+             "headline is that spending came in 3% under plan. Later in the afternoon you have two "
+             "one-on-ones, and I blocked thirty minutes after the last one so you can catch up on email "
+             "before heading home."},
+    {"long", "The Great Barrier Reef is the world's largest coral reef system, stretching for over 2,300 "
+             "kilometres off the coast of Queensland, Australia. It is made up of roughly 2,900 individual "
+             "reefs and 900 islands, and it can be seen from outer space. Scientists estimate that it began "
+             "forming around 20,000 years ago, although the older reef it grew on top of is much more "
+             "ancient. Today it faces serious pressure from rising ocean temperatures, which cause coral "
+             "bleaching, as well as from pollution and outbreaks of crown-of-thorns starfish."},
+};
+
+// Lines of "category<TAB>text"; blank lines and '#' comments are skipped
+inline bool load_corpus(const std::string &path, std::vector<CorpusEntry> &corpus) {
+    std::ifstream in(path);
+    if (!in) return false;
+    std::string line;
+    while (std::getline(in, line)) {
+        const size_t tab = line.find('\t');
+        if (line.empty() || line[0] == '#' || tab == std::string::npos) continue;
+        corpus.push_back({line.substr(0, tab), line.substr(tab + 1)});
+    }
+    return !corpus.empty();
+}
+
+inline double ms_since(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+
+inline std::string json_string(const std::string &s) {
+    std::string out = "\"";
+    for (const unsigned char c : s) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (c < 0x20) {
+                    char buf[8];
+                    std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+                    out += buf;
+                } else {
+                    out += (char) c;
+                }
+        }
+    }
+    return out + "\"";
+}
+
+inline std::string json_number(double value) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.3f", value);
+    return buf;
+}
@@ -0,0 +1,36 @@
+/**
+ * Host stand-in for <android/log.h> so the native voice sources build into
+ * desktop tools unchanged. Messages go to stderr (stdout carries the tool's
+ * output); debug and verbose lines only when NOVA_LOG_VERBOSE is set.
+ */
+
+#pragma once
+
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+
+enum android_LogPriority {
+    ANDROID_LOG_UNKNOWN = 0,
+    ANDROID_LOG_DEFAULT,
+    ANDROID_LOG_VERBOSE,
+    ANDROID_LOG_DEBUG,
+    ANDROID_LOG_INFO,
+    ANDROID_LOG_WARN,
+    ANDROID_LOG_ERROR,
+    ANDROID_LOG_FATAL,
+    ANDROID_LOG_SILENT,
+};
+
+inline int __android_log_print(int prio, const char *tag, const char *fmt, ...) {
+    static const bool verbose = std::getenv("NOVA_LOG_VERBOSE") != nullptr;
+    if (prio < ANDROID_LOG_INFO && !verbose) return 0;
+    static const char LEVELS[] = "??VDIWEF";
+    std::fprintf(stderr, "%c/%s: ", prio < 8 ? LEVELS[prio] : '?', tag);
+    va_list args;
+    va_start(args, fmt);
+    const int n = std::vfprintf(stderr, fmt, args);
+    va_end(args);
+    std::fputc('\n', stderr);
+    return n;
+}
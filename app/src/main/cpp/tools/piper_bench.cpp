@@ -0,0 +1,334 @@
+/**
+ * Host benchmark for the Piper synthesis core.
+ *
+ * Builds the same sources as libnova_piper (PiperVoice, VoiceRegistry,
+ * TextChunker, normalize_for_speech) without the JNI layer, so voices and
+ * session configurations can be compared on a desktop or over adb shell on
+ * a rooted device before anything ships in the app. Each reply in a fixed
+ * corpus (short acks, medium replies, long paragraphs) goes through the
+ * app's streaming path: chunked as if it arrived token by token, normalized
+ * per chunk, and rendered with synthesizeChunked at the app's piece size.
+ *
+ * Per voice × config it reports, as JSON on stdout:
+ *   loadMs         session creation
+ *   phonemizeMs    eSpeak + id mapping, summed over the reply's chunks
+ *   inferMs        model runs, summed
+ *   firstChunkMs   reply start to the first piece of audio (time to first audio)
+ *   audioSeconds   audio rendered
+ *   rtf            wall time / audioSeconds
+ *   peakRssKb      process high-water mark after the config ran (it only
+ *                  grows; run one voice per process to compare footprints)
+ *
+ * Usage:
+ *   piper_bench --espeak-data DIR --voice model.onnx[,config.json] ...
+ *               [--threads 1,2,4] [--opt 1,99] [--xnnpack] [--no-arena]
+ *               [--no-mem-pattern] [--chunk-ids 96] [--runs 3]
+ *               [--corpus FILE] [--out FILE]
+ *
+ * --corpus replaces the built-in corpus with lines of "category<TAB>text".
+ * Logs go to stderr; set NOVA_LOG_VERBOSE for debug lines.
+ */
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "bench_common.h"
+#include "piper_voice.h"
+#include "text_chunker.h"
+#include "text_normalizer.h"
+#include "voice_registry.h"
+
+namespace {
+
+constexpr size_t DEFAULT_CHUNK_IDS = 96;   // PiperTTS.DEFAULT_CHUNK_PHONEME_IDS
+constexpr int DEFAULT_RUNS = 3;
+
+struct VoiceSpec {
+    std::string model;
+    std::string config;
+};
+
+struct Options {
+    std::string espeakData;
+    std::vector<VoiceSpec> voices;
+    std::vector<int> threads = {2};
+    std::vector<int> optimization = {99};
+    bool xnnpack = false;
+    bool cpuArena = true;
+    bool memPattern = true;
+    size_t chunkIds = DEFAULT_CHUNK_IDS;
+    int runs = DEFAULT_RUNS;
+    std::string corpusPath;
+    std::string outPath;
+};
+
+struct ReplyResult {
+    double phonemizeMs = 0.0;
+    double inferMs = 0.0;
+    double firstChunkMs = 0.0;
+    double wallMs = 0.0;
+    double audioSeconds = 0.0;
+};
+
+long peak_rss_kb() {
+    struct rusage usage {};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;   // kilobytes on Linux / Android
+}
+
+std::vector<int> parse_int_list(const char *arg) {
+    std::vector<int> values;
+    std::stringstream ss(arg);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) values.push_back(std::atoi(item.c_str()));
+    }
+    return values;
+}
+
+void usage() {
+    std::fprintf(stderr,
+                 "usage: piper_bench --espeak-data DIR --voice model.onnx[,config.json] ...\n"
+                 "                   [--threads 1,2,4] [--opt 1,99] [--xnnpack] [--no-arena]\n"
+                 "                   [--no-mem-pattern] [--chunk-ids N] [--runs N]\n"
+                 "                   [--corpus FILE] [--out FILE]\n");
+}
+
+bool parse_args(int argc, char **argv, Options &opts) {
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (arg == "--espeak-data" && hasValue) {
+            opts.espeakData = argv[++i];
+        } else if (arg == "--voice" && hasValue) {
+            std::string spec = argv[++i];
+            const size_t comma = spec.find(',');
+            VoiceSpec voice;
+            voice.model = spec.substr(0, comma);
+            voice.config = comma == std::string::npos ? voice.model + ".json" : spec.substr(comma + 1);
+            opts.voices.push_back(voice);
+        } else if (arg == "--threads" && hasValue) {
+            opts.threads = parse_int_list(argv[++i]);
+        } else if (arg == "--opt" && hasValue) {
+            opts.optimization = parse_int_list(argv[++i]);
+        } else if (arg == "--xnnpack") {
+            opts.xnnpack = true;
+        } else if (arg == "--no-arena") {
+            opts.cpuArena = false;
+        } else if (arg == "--no-mem-pattern") {
+            opts.memPattern = false;
+        } else if (arg == "--chunk-ids" && hasValue) {
+            opts.chunkIds = (size_t) std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--runs" && hasValue) {
+            opts.runs = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--corpus" && hasValue) {
+            opts.corpusPath = argv[++i];
+        } else if (arg == "--out" && hasValue) {
+            opts.outPath = argv[++i];
+        } else {
+            std::fprintf(stderr, "Unknown or incomplete argument: %s\n", arg.c_str());
+            return false;
+        }
+    }
+    return !opts.espeakData.empty() && !opts.voices.empty() && !opts.threads.empty() &&
+           !opts.optimization.empty();
+}
+
+// One reply through the app's streaming path: fed to the chunker a word at
+// a time (like LLM tokens), each released chunk normalized and rendered
+// with synthesizeChunked before the next one is taken
+ReplyResult speak_reply(PiperVoice &voice, const std::string &text, size_t chunkIds) {
+    ReplyResult result;
+    SynthStats stats;
+    SynthParams params;
+    TextChunker chunker;
+    std::vector<std::string> chunks;
+    bool firstAudio = false;
+    const auto t0 = std::chrono::steady_clock::now();
+
+    auto render = [&](const std::string &chunk) {
+        const std::string spoken = normalize_for_speech(chunk);
+        if (spoken.empty()) return;
+        voice.synthesizeChunked(spoken, params, chunkIds, [&](std::vector<int16_t> &&) {
+            if (!firstAudio) {
+                result.firstChunkMs = ms_since(t0);
+                firstAudio = true;
+            }
+            return true;
+        }, &stats);
+    };
+
+    size_t pos = 0;
+    while (pos < text.size()) {
+        size_t end = text.find(' ', pos);
+        end = end == std::string::npos ? text.size() : end + 1;
+        chunker.append(text.substr(pos, end - pos), chunks);
+        for (const auto &chunk : chunks) render(chunk);
+        chunks.clear();
+        pos = end;
+    }
+    chunker.flush(chunks);
+    for (const auto &chunk : chunks) render(chunk);
+
+    result.wallMs = ms_since(t0);
+    result.phonemizeMs = stats.phonemizeMs;
+    result.inferMs = stats.inferMs;
+    result.audioSeconds = stats.audioSeconds;
+    return result;
+}
+
+// ============================================================
+// JSON output
+// ============================================================
+
+std::string reply_json(const ReplyResult &r) {
+    std::ostringstream os;
+    os << "\"phonemizeMs\": " << json_number(r.phonemizeMs)
+       << ", \"inferMs\": " << json_number(r.inferMs)
+       << ", \"firstChunkMs\": " << json_number(r.firstChunkMs)
+       << ", \"audioSeconds\": " << json_number(r.audioSeconds)
+       << ", \"rtf\": " << json_number(r.audioSeconds > 0.0 ? r.wallMs / 1000.0 / r.audioSeconds : 0.0);
+    return os.str();
+}
+
+ReplyResult mean_of(const std::vector<ReplyResult> &runs) {
+    ReplyResult mean;
+    if (runs.empty()) return mean;
+    for (const auto &r : runs) {
+        mean.phonemizeMs += r.phonemizeMs;
+        mean.inferMs += r.inferMs;
+        mean.firstChunkMs += r.firstChunkMs;
+        mean.wallMs += r.wallMs;
+        mean.audioSeconds += r.audioSeconds;
+    }
+    const double n = (double) runs.size();
+    mean.phonemizeMs /= n;
+    mean.inferMs /= n;
+    mean.firstChunkMs /= n;
+    mean.wallMs /= n;
+    mean.audioSeconds /= n;
+    return mean;
+}
+
+std::string config_json(const SessionConfig &c) {
+    std::ostringstream os;
+    os << "{\"threads\": " << c.threads << ", \"optimization\": " << c.optimization
+       << ", \"cpuArena\": " << (c.cpuArena ? "true" : "false")
+       << ", \"memPattern\": " << (c.memPattern ? "true" : "false")
+       << ", \"xnnpack\": " << (c.xnnpack ? "true" : "false") << "}";
+    return os.str();
+}
+
+// One voice under one config: load, one untimed warm-up reply, then every
+// corpus entry `runs` times
+std::string bench_config(VoiceRegistry &registry, const VoiceSpec &spec, const SessionConfig &config,
+                         const Options &opts, const std::vector<CorpusEntry> &corpus) {
+    std::ostringstream os;
+    os << "    {\"voice\": " << json_string(spec.model) << ", \"config\": " << config_json(config);
+
+    const auto t0 = std::chrono::steady_clock::now();
+    std::unique_ptr<PiperVoice> voice;
+    try {
+        voice = registry.openStandalone(spec.model, spec.config, config);
+    } catch (const std::exception &e) {
+        std::fprintf(stderr, "Failed to load %s: %s\n", spec.model.c_str(), e.what());
+        os << ", \"error\": " << json_string(e.what()) << "}";
+        return os.str();
+    }
+    const double loadMs = ms_since(t0);
+    std::fprintf(stderr, "%s threads=%d opt=%d xnnpack=%d: loaded in %.0f ms\n", spec.model.c_str(),
+                 config.threads, config.optimization, config.xnnpack, loadMs);
+
+    speak_reply(*voice, corpus.front().text, opts.chunkIds);
+
+    std::map<std::string, std::vector<ReplyResult>> byCategory;
+    std::vector<std::string> items;
+    for (const auto &entry : corpus) {
+        std::vector<ReplyResult> runs;
+        for (int r = 0; r < opts.runs; r++) runs.push_back(speak_reply(*voice, entry.text, opts.chunkIds));
+        const ReplyResult mean = mean_of(runs);
+        byCategory[entry.category].insert(byCategory[entry.category].end(), runs.begin(), runs.end());
+        items.push_back("        {\"category\": " + json_string(entry.category) + ", \"chars\": " +
+                        std::to_string(entry.text.size()) + ", " + reply_json(mean) + "}");
+    }
+
+    os << ", \"sampleRate\": " << voice->sampleRate() << ", \"loadMs\": " << json_number(loadMs)
+       << ", \"peakRssKb\": " << peak_rss_kb() << ",\n      \"summary\": {";
+    bool first = true;
+    for (const auto &entry : byCategory) {
+        os << (first ? "" : ", ") << json_string(entry.first) << ": {" << reply_json(mean_of(entry.second)) << "}";
+        first = false;
+    }
+    os << "},\n      \"items\": [\n";
+    for (size_t i = 0; i < items.size(); i++) os << items[i] << (i + 1 < items.size() ? ",\n" : "\n");
+    os << "      ]}";
+    return os.str();
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    Options opts;
+    if (!parse_args(argc, argv, opts)) {
+        usage();
+        return 2;
+    }
+
+    std::vector<CorpusEntry> corpus = BENCH_CORPUS;
+    if (!opts.corpusPath.empty()) {
+        corpus.clear();
+        if (!load_corpus(opts.corpusPath, corpus)) {
+            std::fprintf(stderr, "No entries in corpus %s\n", opts.corpusPath.c_str());
+            return 1;
+        }
+    }
+
+    PiperVoice::setESpeakDataPath(opts.espeakData);
+
+    std::vector<SessionConfig> configs;
+    for (const int threads : opts.threads) {
+        for (const int optimization : opts.optimization) {
+            SessionConfig config;
+            config.threads = threads;
+            config.optimization = optimization;
+            config.cpuArena = opts.cpuArena;
+            config.memPattern = opts.memPattern;
+            config.xnnpack = opts.xnnpack;
+            configs.push_back(config);
+        }
+    }
+
+    VoiceRegistry registry;
+    std::vector<std::string> results;
+    for (const auto &voice : opts.voices) {
+        for (const auto &config : configs) results.push_back(bench_config(registry, voice, config, opts, corpus));
+    }
+
+    std::ostringstream os;
+    os << "{\n  \"chunkIds\": " << opts.chunkIds << ", \"runs\": " << opts.runs
+       << ", \"corpusEntries\": " << corpus.size() << ",\n  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); i++) os << results[i] << (i + 1 < results.size() ? ",\n" : "\n");
+    os << "  ]\n}\n";
+
+    if (opts.outPath.empty()) {
+        std::fputs(os.str().c_str(), stdout);
+    } else {
+        std::ofstream out(opts.outPath);
+        out << os.str();
+        if (!out) {
+            std::fprintf(stderr, "Failed to write %s\n", opts.outPath.c_str());
+            return 1;
+        }
+    }
+    return 0;
+}
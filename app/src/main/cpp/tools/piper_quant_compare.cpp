@@ -0,0 +1,395 @@
+/**
+ * int8 vs fp32 comparison for a Piper voice.
+ *
+ * Renders the benchmark corpus with the fp32 voice and its quantized export
+ * under the same session config and reports, as JSON:
+ *   speedup        fp32 inferMs / int8 inferMs (per item, per category, overall)
+ *   logMelDistDb   spectral distance of the int8 audio from the fp32 audio:
+ *                  both resampled to 16 kHz and turned into 80-bin log-mel
+ *                  frames (the whisper front end), aligned with DTW, and the
+ *                  RMS dB difference over mel bins averaged along the path
+ *   variationDb    the same distance between two fp32 renders with the
+ *                  voice's own noise, i.e. how much the voice differs from
+ *                  itself; int8 distance near this is inaudible in practice
+ *   durationRatio  int8 / fp32 audio length (the duration predictor is
+ *                  quantized too)
+ * plus the quantization check of the int8 model as stored and as ONNX
+ * Runtime optimizes it, with the operators that stayed fp32.
+ *
+ * Quality renders use noise scale and noise-w 0, so the only difference
+ * between the two is quantization; timing renders use the voice defaults.
+ *
+ * Usage:
+ *   piper_quant_compare --espeak-data DIR --fp32 model.onnx[,config.json]
+ *                       --int8 model.int8.onnx[,config.json]
+ *                       [--threads 2] [--opt 99] [--runs 3]
+ *                       [--corpus FILE] [--scratch DIR] [--out FILE]
+ *
+ * The int8 voice uses the fp32 config unless it has its own
+ * (model.int8.onnx.json) or one is given.
+ */
+
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "audio_simd.h"
+#include "bench_common.h"
+#include "log_mel.h"
+#include "onnx_inspect.h"
+#include "piper_voice.h"
+#include "resampler.h"
+#include "text_normalizer.h"
+#include "voice_registry.h"
+
+namespace {
+
+constexpr int DEFAULT_RUNS = 3;
+// Log-mel frames are clamped to this far below their loudest frame (80 dB),
+// so silence and the log floor don't dominate the distance
+constexpr float DYNAMIC_RANGE_LOG10 = 8.0f;
+
+struct Options {
+    std::string espeakData;
+    std::string fp32Model, fp32Config;
+    std::string int8Model, int8Config;
+    int threads = 2;
+    int optimization = 99;
+    int runs = DEFAULT_RUNS;
+    std::string corpusPath;
+    std::string scratchDir = "/tmp";
+    std::string outPath;
+};
+
+struct ItemResult {
+    std::string category;
+    size_t chars = 0;
+    double fp32InferMs = 0.0;
+    double int8InferMs = 0.0;
+    double fp32AudioSeconds = 0.0;
+    double int8AudioSeconds = 0.0;
+    double logMelDistDb = 0.0;
+    double variationDb = 0.0;
+};
+
+bool file_exists(const std::string &path) {
+    struct stat st {};
+    return stat(path.c_str(), &st) == 0;
+}
+
+void split_spec(const std::string &spec, std::string &model, std::string &config) {
+    const size_t comma = spec.find(',');
+    model = spec.substr(0, comma);
+    config = comma == std::string::npos ? "" : spec.substr(comma + 1);
+}
+
+void usage() {
+    std::fprintf(stderr,
+                 "usage: piper_quant_compare --espeak-data DIR --fp32 model.onnx[,config.json]\n"
+                 "                           --int8 model.int8.onnx[,config.json]\n"
+                 "                           [--threads N] [--opt N] [--runs N]\n"
+                 "                           [--corpus FILE] [--scratch DIR] [--out FILE]\n");
+}
+
+bool parse_args(int argc, char **argv, Options &opts) {
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (arg == "--espeak-data" && hasValue) {
+            opts.espeakData = argv[++i];
+        } else if (arg == "--fp32" && hasValue) {
+            split_spec(argv[++i], opts.fp32Model, opts.fp32Config);
+        } else if (arg == "--int8" && hasValue) {
+            split_spec(argv[++i], opts.int8Model, opts.int8Config);
+        } else if (arg == "--threads" && hasValue) {
+            opts.threads = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--opt" && hasValue) {
+            opts.optimization = std::atoi(argv[++i]);
+        } else if (arg == "--runs" && hasValue) {
+            opts.runs = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--corpus" && hasValue) {
+            opts.corpusPath = argv[++i];
+        } else if (arg == "--scratch" && hasValue) {
+            opts.scratchDir = argv[++i];
+        } else if (arg == "--out" && hasValue) {
+            opts.outPath = argv[++i];
+        } else {
+            std::fprintf(stderr, "Unknown or incomplete argument: %s\n", arg.c_str());
+            return false;
+        }
+    }
+    if (opts.espeakData.empty() || opts.fp32Model.empty() || opts.int8Model.empty()) return false;
+    if (opts.fp32Config.empty()) opts.fp32Config = opts.fp32Model + ".json";
+    if (opts.int8Config.empty()) {
+        opts.int8Config = file_exists(opts.int8Model + ".json") ? opts.int8Model + ".json" : opts.fp32Config;
+    }
+    return true;
+}
+
+// ============================================================
+// Spectral distance
+// ============================================================
+
+// 16 kHz log10-mel frames [n][N_MEL], clamped to DYNAMIC_RANGE_LOG10 below the peak
+std::vector<float> log_mel_frames(const std::vector<int16_t> &pcm, int sampleRate) {
+    std::vector<float> audio(pcm.size());
+    simd::s16_to_f32(pcm.data(), audio.data(), (int) pcm.size(), 1.0f / 32768.0f);
+
+    Resampler resampler(sampleRate, logmel::SAMPLE_RATE);
+    std::vector<float> resampled;
+    resampler.process(audio.data(), (int) audio.size(), resampled);
+    resampler.flush(resampled);
+    // Pad so the last frames (FRAME_DELAY hops behind) come out
+    resampled.resize(resampled.size() + (LogMel::FRAME_DELAY + 1) * logmel::HOP, 0.0f);
+
+    LogMel mel;
+    std::vector<float> frames;
+    float frame[logmel::N_MEL];
+    for (size_t i = 0; i + logmel::HOP <= resampled.size(); i += logmel::HOP) {
+        if (mel.push(&resampled[i], frame)) frames.insert(frames.end(), frame, frame + logmel::N_MEL);
+    }
+    if (frames.empty()) return frames;
+
+    const float floor = *std::max_element(frames.begin(), frames.end()) - DYNAMIC_RANGE_LOG10;
+    for (float &v : frames) v = std::max(v, floor);
+    return frames;
+}
+
+// RMS over mel bins of the difference in dB between frame i of a and frame j of b
+double frame_distance_db(const float *a, const float *b) {
+    double sum = 0.0;
+    for (int k = 0; k < logmel::N_MEL; k++) {
+        const double d = 10.0 * (a[k] - b[k]);
+        sum += d * d;
+    }
+    return std::sqrt(sum / logmel::N_MEL);
+}
+
+// Mean frame distance along the cheapest DTW path (steps: match, insert,
+// delete), so a slightly faster or slower int8 rendering isn't penalized for
+// timing, only for timbre. Two rows of cost and path length; O(n·m) time.
+double dtw_distance_db(const std::vector<float> &a, const std::vector<float> &b) {
+    const size_t n = a.size() / logmel::N_MEL;
+    const size_t m = b.size() / logmel::N_MEL;
+    if (n == 0 || m == 0) return 0.0;
+
+    const double INF = std::numeric_limits<double>::infinity();
+    std::vector<double> prevCost(m + 1, INF), cost(m + 1, INF);
+    std::vector<int> prevLen(m + 1, 0), len(m + 1, 0);
+    prevCost[0] = 0.0;
+
+    for (size_t i = 1; i <= n; i++) {
+        cost[0] = INF;
+        for (size_t j = 1; j <= m; j++) {
+            // Predecessor with the lowest accumulated cost
+            double best = prevCost[j - 1];
+            int bestLen = prevLen[j - 1];
+            if (prevCost[j] < best) { best = prevCost[j]; bestLen = prevLen[j]; }
+            if (cost[j - 1] < best) { best = cost[j - 1]; bestLen = len[j - 1]; }
+            cost[j] = best + frame_distance_db(&a[(i - 1) * logmel::N_MEL], &b[(j - 1) * logmel::N_MEL]);
+            len[j] = bestLen + 1;
+        }
+        std::swap(cost, prevCost);
+        std::swap(len, prevLen);
+    }
+    return prevLen[m] > 0 ? prevCost[m] / prevLen[m] : 0.0;
+}
+
+// ============================================================
+// Rendering
+// ============================================================
+
+// Mean model time of `runs` renders with the voice's own noise settings
+double time_infer(PiperVoice &voice, const std::string &spoken, int runs, double &audioSeconds) {
+    SynthStats stats;
+    std::vector<int16_t> pcm;
+    for (int r = 0; r < runs; r++) {
+        pcm.clear();
+        voice.synthesize(spoken, SynthParams(), pcm, &stats);
+    }
+    audioSeconds = stats.audioSeconds / runs;
+    return stats.inferMs / runs;
+}
+
+std::vector<int16_t> render(PiperVoice &voice, const std::string &spoken, const SynthParams &params) {
+    std::vector<int16_t> pcm;
+    voice.synthesize(spoken, params, pcm);
+    return pcm;
+}
+
+ItemResult compare_item(PiperVoice &fp32, PiperVoice &int8, const CorpusEntry &entry, int runs) {
+    ItemResult item;
+    item.category = entry.category;
+    item.chars = entry.text.size();
+    const std::string spoken = normalize_for_speech(entry.text);
+
+    item.fp32InferMs = time_infer(fp32, spoken, runs, item.fp32AudioSeconds);
+    item.int8InferMs = time_infer(int8, spoken, runs, item.int8AudioSeconds);
+
+    SynthParams flat;
+    flat.noiseScale = 0.0f;
+    flat.noiseW = 0.0f;
+    const std::vector<float> reference = log_mel_frames(render(fp32, spoken, flat), fp32.sampleRate());
+    const std::vector<float> quantized = log_mel_frames(render(int8, spoken, flat), int8.sampleRate());
+    item.logMelDistDb = dtw_distance_db(reference, quantized);
+
+    const std::vector<float> noisyA = log_mel_frames(render(fp32, spoken, SynthParams()), fp32.sampleRate());
+    const std::vector<float> noisyB = log_mel_frames(render(fp32, spoken, SynthParams()), fp32.sampleRate());
+    item.variationDb = dtw_distance_db(noisyA, noisyB);
+    return item;
+}
+
+// ============================================================
+// JSON output
+// ============================================================
+
+std::string quantization_json(const QuantizationReport &q) {
+    std::ostringstream os;
+    os << "{\"format\": " << json_string(q.format()) << ", \"integerOps\": " << q.integerOps
+       << ", \"int8WeightBytes\": " << q.int8WeightBytes << ", \"floatWeightBytes\": " << q.floatWeightBytes
+       << ", \"fp32Fallbacks\": {";
+    bool first = true;
+    for (const auto &op : q.fp32Fallbacks) {
+        os << (first ? "" : ", ") << json_string(op.first) << ": " << op.second;
+        first = false;
+    }
+    os << "}}";
+    return os.str();
+}
+
+// Speedup from summed model time, distances as means
+std::string aggregate_json(const std::vector<const ItemResult *> &items) {
+    double fp32Ms = 0.0, int8Ms = 0.0, fp32Audio = 0.0, int8Audio = 0.0, dist = 0.0, variation = 0.0;
+    for (const ItemResult *item : items) {
+        fp32Ms += item->fp32InferMs;
+        int8Ms += item->int8InferMs;
+        fp32Audio += item->fp32AudioSeconds;
+        int8Audio += item->int8AudioSeconds;
+        dist += item->logMelDistDb;
+        variation += item->variationDb;
+    }
+    const double n = std::max<size_t>(1, items.size());
+    std::ostringstream os;
+    os << "\"speedup\": " << json_number(int8Ms > 0.0 ? fp32Ms / int8Ms : 0.0)
+       << ", \"fp32Rtf\": " << json_number(fp32Audio > 0.0 ? fp32Ms / 1000.0 / fp32Audio : 0.0)
+       << ", \"int8Rtf\": " << json_number(int8Audio > 0.0 ? int8Ms / 1000.0 / int8Audio : 0.0)
+       << ", \"logMelDistDb\": " << json_number(dist / n)
+       << ", \"variationDb\": " << json_number(variation / n)
+       << ", \"durationRatio\": " << json_number(fp32Audio > 0.0 ? int8Audio / fp32Audio : 0.0);
+    return os.str();
+}
+
+std::string item_json(const ItemResult &item) {
+    std::ostringstream os;
+    os << "    {\"category\": " << json_string(item.category) << ", \"chars\": " << item.chars
+       << ", \"fp32InferMs\": " << json_number(item.fp32InferMs)
+       << ", \"int8InferMs\": " << json_number(item.int8InferMs) << ", " << aggregate_json({&item}) << "}";
+    return os.str();
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    Options opts;
+    if (!parse_args(argc, argv, opts)) {
+        usage();
+        return 2;
+    }
+
+    std::vector<CorpusEntry> corpus = BENCH_CORPUS;
+    if (!opts.corpusPath.empty()) {
+        corpus.clear();
+        if (!load_corpus(opts.corpusPath, corpus)) {
+            std::fprintf(stderr, "No entries in corpus %s\n", opts.corpusPath.c_str());
+            return 1;
+        }
+    }
+
+    PiperVoice::setESpeakDataPath(opts.espeakData);
+
+    SessionConfig config;
+    config.threads = opts.threads;
+    config.optimization = opts.optimization;
+    VoiceRegistry registry;
+    registry.configure(config);
+
+    std::unique_ptr<PiperVoice> fp32, int8;
+    QuantizationReport fp32Report, int8Report, int8Optimized;
+    try {
+        fp32 = registry.openStandalone(opts.fp32Model, opts.fp32Config, config);
+        int8 = registry.openStandalone(opts.int8Model, opts.int8Config, config);
+        fp32Report = fp32->quantization();
+        int8Report = int8->quantization();
+        int8Optimized = registry.inspectOptimized(opts.int8Model, opts.scratchDir + "/piper_int8_optimized.onnx");
+    } catch (const std::exception &e) {
+        std::fprintf(stderr, "Failed to load voices: %s\n", e.what());
+        return 1;
+    }
+    if (!int8Report.quantized()) {
+        std::fprintf(stderr, "Warning: %s has no quantized operators\n", opts.int8Model.c_str());
+    }
+    if (fp32->sampleRate() != int8->sampleRate()) {
+        std::fprintf(stderr, "Warning: sample rates differ (%d vs %d Hz); comparing at 16 kHz\n",
+                     fp32->sampleRate(), int8->sampleRate());
+    }
+
+    // Warm both sessions up so the first item's timing isn't a cold start
+    render(*fp32, "Warming up.", SynthParams());
+    render(*int8, "Warming up.", SynthParams());
+
+    std::vector<ItemResult> items;
+    for (const auto &entry : corpus) {
+        items.push_back(compare_item(*fp32, *int8, entry, opts.runs));
+        const ItemResult &item = items.back();
+        std::fprintf(stderr, "%-6s %4zu chars: fp32 %.0f ms, int8 %.0f ms, log-mel %.2f dB (variation %.2f dB)\n",
+                     item.category.c_str(), item.chars, item.fp32InferMs, item.int8InferMs,
+                     item.logMelDistDb, item.variationDb);
+    }
+
+    std::vector<const ItemResult *> all;
+    std::map<std::string, std::vector<const ItemResult *>> byCategory;
+    for (const auto &item : items) {
+        all.push_back(&item);
+        byCategory[item.category].push_back(&item);
+    }
+
+    std::ostringstream os;
+    os << "{\n  \"config\": {\"threads\": " << config.threads << ", \"optimization\": " << config.optimization
+       << ", \"runs\": " << opts.runs << "},\n"
+       << "  \"fp32\": {\"model\": " << json_string(opts.fp32Model)
+       << ", \"quantization\": " << quantization_json(fp32Report) << "},\n"
+       << "  \"int8\": {\"model\": " << json_string(opts.int8Model)
+       << ", \"quantization\": " << quantization_json(int8Report)
+       << ",\n           \"optimized\": " << quantization_json(int8Optimized) << "},\n"
+       << "  \"summary\": {" << aggregate_json(all) << "},\n  \"categories\": {";
+    bool first = true;
+    for (const auto &category : byCategory) {
+        os << (first ? "\n" : ",\n") << "    " << json_string(category.first) << ": {"
+           << aggregate_json(category.second) << "}";
+        first = false;
+    }
+    os << "\n  },\n  \"items\": [\n";
+    for (size_t i = 0; i < items.size(); i++) os << item_json(items[i]) << (i + 1 < items.size() ? ",\n" : "\n");
+    os << "  ]\n}\n";
+
+    if (opts.outPath.empty()) {
+        std::fputs(os.str().c_str(), stdout);
+    } else {
+        std::ofstream out(opts.outPath);
+        out << os.str();
+        if (!out) {
+            std::fprintf(stderr, "Failed to write %s\n", opts.outPath.c_str());
+            return 1;
+        }
+    }
+    return 0;
+}
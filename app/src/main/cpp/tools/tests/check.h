@@ -0,0 +1,58 @@
+/**
+ * Minimal assertions for the host unit tests: each failed CHECK prints its
+ * location and the test keeps going; main() returns check_report(), the
+ * number of failures, which is what ctest looks at.
+ */
+
+#pragma once
+
+#include <cmath>
+#include <cstdio>
+#include <string>
+
+inline int &check_failures() {
+    static int failures = 0;
+    return failures;
+}
+
+#define CHECK(cond)                                                            \
+    do {                                                                       \
+        if (!(cond)) {                                                         \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__,        \
+                         __LINE__, #cond);                                     \
+            check_failures()++;                                                \
+        }                                                                      \
+    } while (0)
+
+#define CHECK_EQ(a, b)                                                         \
+    do {                                                                       \
+        const auto &check_a = (a);                                             \
+        const auto &check_b = (b);                                             \
+        if (!(check_a == check_b)) {                                           \
+            std::fprintf(stderr, "%s:%d: CHECK_EQ(%s, %s) failed: \"%s\" != \"%s\"\n", \
+                         __FILE__, __LINE__, #a, #b,                           \
+                         check_str(check_a).c_str(), check_str(check_b).c_str()); \
+            check_failures()++;                                                \
+        }                                                                      \
+    } while (0)
+
+#define CHECK_NEAR(a, b, tol)                                                  \
+    do {                                                                       \
+        const double check_a = (a), check_b = (b);                             \
+        if (!(std::fabs(check_a - check_b) <= (tol))) {                        \
+            std::fprintf(stderr, "%s:%d: CHECK_NEAR(%s, %s) failed: %g vs %g\n", \
+                         __FILE__, __LINE__, #a, #b, check_a, check_b);        \
+            check_failures()++;                                                \
+        }                                                                      \
+    } while (0)
+
+inline std::string check_str(const std::string &s) { return s; }
+inline std::string check_str(const char *s) { return s; }
+template <typename T>
+std::string check_str(const T &v) { return std::to_string(v); }
+
+// Return value for main(): the number of failed checks
+inline int check_report() {
+    if (check_failures() == 0) std::printf("OK\n");
+    return check_failures();
+}
@@ -0,0 +1,87 @@
+// Endpointer: when the streaming hypothesis may end a turn before the
+// silence hangover does
+
+#include "check.h"
+#include "endpointer.h"
+
+static const int RATE = 16000;
+static const int64_t HANGOVER = 3 * RATE;
+
+static int64_t ms(int v) { return (int64_t) v * RATE / 1000; }
+
+static void test_no_hypothesis_waits_for_hangover() {
+    Endpointer ep(RATE);
+    ep.reset(HANGOVER);
+    CHECK_EQ(ep.update(-1, ms(1000)), Endpointer::CONTINUE);
+    CHECK_EQ(ep.update(ms(1000), ms(2000)), Endpointer::CONTINUE);
+    CHECK_EQ(ep.update(ms(1000), ms(1000) + HANGOVER), Endpointer::HANGOVER);
+}
+
+static void test_stable_hypothesis_ends_after_stable_silence() {
+    Endpointer ep(RATE);
+    ep.reset(HANGOVER);
+    ep.onHypothesis("turn on the lights", ms(1000));
+    ep.onHypothesis("turn on the lights", ms(1400));   // stable for 400 ms, into the pause
+    const int64_t silence = ms(1200);
+    CHECK_EQ(ep.update(silence, silence + ms(Endpointer::STABLE_SILENCE_MS) - 1), Endpointer::CONTINUE);
+    CHECK_EQ(ep.update(silence, silence + ms(Endpointer::STABLE_SILENCE_MS)), Endpointer::END_OF_TURN);
+}
+
+static void test_changing_hypothesis_continues() {
+    Endpointer ep(RATE);
+    ep.reset(HANGOVER);
+    ep.onHypothesis("turn on", ms(1000));
+    ep.onHypothesis("turn on the lights", ms(1400));
+    CHECK_EQ(ep.update(ms(1200), ms(2000)), Endpointer::CONTINUE);
+}
+
+static void test_one_closed_partial_is_not_enough() {
+    Endpointer ep(RATE);
+    ep.reset(HANGOVER);
+    ep.onHypothesis("Set a timer", ms(600));
+    ep.onHypothesis("Set a timer.", ms(1000));   // same words, first time closed
+    const int64_t silence = ms(900);
+    // Greedy partials end in "." regardless; only the longer timeout applies
+    CHECK(!ep.sentenceConfirmedAfter(silence));
+    CHECK_EQ(ep.update(silence, silence + ms(Endpointer::SENTENCE_SILENCE_MS)), Endpointer::CONTINUE);
+}
+
+static void test_confirmed_sentence_ends_early() {
+    Endpointer ep(RATE);
+    ep.reset(HANGOVER);
+    ep.onHypothesis("Set a timer.", ms(1000));
+    ep.onHypothesis("Set a timer.", ms(1400));
+    ep.onHypothesis("Set a timer.", ms(1700));
+    const int64_t silence = ms(900);
+    CHECK(ep.sentenceConfirmedAfter(silence));
+    CHECK_EQ(ep.update(silence, silence + ms(Endpointer::SENTENCE_SILENCE_MS)), Endpointer::END_OF_TURN);
+}
+
+static void test_stale_decode_ignored() {
+    Endpointer ep(RATE);
+    ep.reset(HANGOVER);
+    ep.onHypothesis("hello there", ms(1000));
+    ep.onHypothesis("something else", ms(800));   // older audio: ignored
+    ep.onHypothesis("hello there", ms(1400));
+    CHECK_EQ(ep.stableSamples(), ms(400));
+}
+
+static void test_ellipsis_is_not_a_sentence_end() {
+    Endpointer ep(RATE);
+    ep.reset(HANGOVER);
+    ep.onHypothesis("I was thinking...", ms(1000));
+    CHECK(!ep.endsSentence());
+    ep.onHypothesis("What time is it? [BLANK_AUDIO]", ms(1400));
+    CHECK(ep.endsSentence());
+}
+
+int main() {
+    test_no_hypothesis_waits_for_hangover();
+    test_stable_hypothesis_ends_after_stable_silence();
+    test_changing_hypothesis_continues();
+    test_one_closed_partial_is_not_enough();
+    test_confirmed_sentence_ends_early();
+    test_stale_decode_ignored();
+    test_ellipsis_is_not_a_sentence_end();
+    return check_report();
+}
@@ -0,0 +1,105 @@
+// WindowFeed (long_window.h): window placement, word-ownership bounds and
+// source errors, on audio whose every sample holds its own index
+
+#include "check.h"
+#include "long_window.h"
+
+#include <memory>
+#include <vector>
+
+static const int64_t MS = LONG_SAMPLE_RATE / 1000;
+
+// Source of `total` samples in blocks of `block`, each sample = its index
+static SampleSource ramp(int64_t total, int block) {
+    auto pos = std::make_shared<int64_t>(0);
+    return [=](std::vector<float> &out) {
+        const int n = (int) std::min<int64_t>(block, total - *pos);
+        for (int i = 0; i < n; i++) out.push_back((float) (*pos + i));
+        *pos += n;
+        return n;
+    };
+}
+
+static std::vector<LongWindow> drain(WindowFeed &feed) {
+    std::vector<LongWindow> windows;
+    LongWindow w;
+    while (feed.next(w)) windows.push_back(w);
+    return windows;
+}
+
+static void test_short_audio_is_one_window() {
+    WindowFeed feed(ramp(10000 * MS, 4096));
+    const auto windows = drain(feed);
+    CHECK_EQ(windows.size(), (size_t) 1);
+    CHECK_EQ(windows[0].keepFromMs, KEEP_ALL_FROM);
+    CHECK_EQ(windows[0].keepToMs, KEEP_ALL_TO);
+    CHECK_EQ((int64_t) windows[0].audio.size(), 10000 * MS);
+    CHECK_EQ(feed.samples(), 10000 * MS);
+}
+
+static void test_exactly_one_window() {
+    WindowFeed feed(ramp(LONG_WINDOW_MS * MS, LONG_SAMPLE_RATE));
+    const auto windows = drain(feed);
+    CHECK_EQ(windows.size(), (size_t) 1);
+    CHECK_EQ(windows[0].keepToMs, KEEP_ALL_TO);
+}
+
+static void test_long_audio_windows() {
+    const int64_t total = 95000 * MS;
+    WindowFeed feed(ramp(total, 1000));   // blocks that don't divide the stride
+    const auto windows = drain(feed);
+    const int64_t stride = (LONG_WINDOW_MS - LONG_OVERLAP_MS) * MS;
+
+    // 0-30 s, 28-58 s, 56-86 s, 84-95 s
+    CHECK_EQ(windows.size(), (size_t) 4);
+    CHECK(!feed.failed());
+    CHECK_EQ(feed.samples(), total);
+    for (size_t i = 0; i < windows.size(); i++) {
+        const LongWindow &w = windows[i];
+        CHECK_EQ(w.index, i);
+        CHECK_EQ(w.start, (int64_t) i * stride);
+        const int64_t end = std::min(w.start + LONG_WINDOW_MS * MS, total);
+        CHECK_EQ((int64_t) w.audio.size(), end - w.start);
+        CHECK_EQ(w.audio.front(), (float) w.start);
+        CHECK_EQ(w.audio.back(), (float) (end - 1));
+    }
+
+    // Each word is owned by exactly one window: bounds meet in the middle of
+    // every overlap, open-ended at both ends of the stream
+    CHECK_EQ(windows.front().keepFromMs, KEEP_ALL_FROM);
+    CHECK_EQ(windows.back().keepToMs, KEEP_ALL_TO);
+    for (size_t i = 0; i + 1 < windows.size(); i++) {
+        CHECK_EQ(windows[i].keepToMs, windows[i + 1].keepFromMs);
+        CHECK_EQ(windows[i].keepToMs, (int32_t) (windows[i + 1].start / MS + LONG_OVERLAP_MS / 2));
+    }
+}
+
+static void test_source_error_fails_the_feed() {
+    int calls = 0;
+    WindowFeed feed([&](std::vector<float> &out) {
+        if (++calls > 40) return -1;   // fails after 40 s
+        out.insert(out.end(), LONG_SAMPLE_RATE, 0.0f);
+        return LONG_SAMPLE_RATE;
+    });
+    LongWindow w;
+    CHECK(feed.next(w));       // the first window only needs 30 s + 1 sample
+    CHECK(!feed.next(w));
+    CHECK(feed.failed());
+    CHECK(!feed.next(w));
+}
+
+static void test_empty_source() {
+    WindowFeed feed([](std::vector<float> &) { return 0; });
+    LongWindow w;
+    CHECK(!feed.next(w));
+    CHECK(!feed.failed());
+}
+
+int main() {
+    test_short_audio_is_one_window();
+    test_exactly_one_window();
+    test_long_audio_windows();
+    test_source_error_fails_the_feed();
+    test_empty_source();
+    return check_report();
+}
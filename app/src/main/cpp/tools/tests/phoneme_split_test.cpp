@@ -0,0 +1,107 @@
+// split_phoneme_ids: pieces end after clause marks, words are only cut in
+// long clause-free runs, and every piece keeps the sentence's BOS / EOS
+
+#include "check.h"
+#include "phoneme_split.h"
+
+#include <vector>
+
+// Piper's usual layout: BOS 1, PAD 0 after every phoneme, EOS 2
+static const int64_t BOS = 1, PAD = 0, EOS = 2, SPACE = 3, COMMA = 4, PHONE = 10;
+
+static PhonemeMarks marks() {
+    PhonemeMarks m;
+    m.bos = BOS;
+    m.pad = PAD;
+    m.eos = EOS;
+    m.interspersePad = true;
+    m.space = SPACE;
+    m.clause = {COMMA};
+    return m;
+}
+
+// Sentence ids from a pattern: 'w' a word of 4 phonemes, ' ' a space, ',' a comma
+static std::vector<int64_t> sentence(const char *pattern) {
+    std::vector<int64_t> ids = {BOS, PAD};
+    for (const char *c = pattern; *c; c++) {
+        const int n = *c == 'w' ? 4 : 1;
+        for (int i = 0; i < n; i++) {
+            ids.push_back(*c == 'w' ? PHONE : *c == ' ' ? SPACE : COMMA);
+            ids.push_back(PAD);
+        }
+    }
+    ids.push_back(EOS);
+    return ids;
+}
+
+static bool wrapped(const std::vector<int64_t> &piece) {
+    return piece.size() > 3 && piece[0] == BOS && piece[1] == PAD && piece.back() == EOS;
+}
+
+// Phoneme ids of all pieces with their BOS / PAD / EOS wrapping removed
+static std::vector<int64_t> body(const std::vector<std::vector<int64_t>> &pieces) {
+    std::vector<int64_t> out;
+    for (const auto &piece : pieces) out.insert(out.end(), piece.begin() + 2, piece.end() - 1);
+    return out;
+}
+
+static void test_short_or_disabled_is_whole() {
+    const auto ids = sentence("w w w, w w");
+    CHECK_EQ(split_phoneme_ids(ids, 0, marks()).size(), (size_t) 1);
+    CHECK_EQ(split_phoneme_ids(ids, 200, marks()).size(), (size_t) 1);
+}
+
+static void test_cuts_after_clause_marks() {
+    // Three clauses of four words (~40 ids each)
+    const auto ids = sentence("w w w w, w w w w, w w w w");
+    const auto pieces = split_phoneme_ids(ids, 24, marks());
+    CHECK_EQ(pieces.size(), (size_t) 3);
+    for (size_t p = 0; p < pieces.size(); p++) {
+        CHECK(wrapped(pieces[p]));
+        // Every piece but the last ends on its comma (then pad, space, pad),
+        // never mid-clause
+        if (p + 1 < pieces.size()) CHECK_EQ(pieces[p][pieces[p].size() - 5], COMMA);
+        // ...and the next one starts at a word
+        CHECK_EQ(pieces[p][2], PHONE);
+    }
+    // Nothing dropped or repeated between the pieces
+    CHECK(body(pieces) == std::vector<int64_t>(ids.begin() + 2, ids.end() - 1));
+}
+
+static void test_no_word_cut_in_normal_clause() {
+    // 10 words without a comma: ~100 ids, under 3x the 48-id pieces
+    const auto ids = sentence("w w w w w w w w w w");
+    CHECK_EQ(split_phoneme_ids(ids, 48, marks()).size(), (size_t) 1);
+}
+
+static void test_word_cut_in_long_run() {
+    // 40 words without a comma: ~400 ids, so the run is cut at spaces
+    std::string pattern;
+    for (int i = 0; i < 40; i++) pattern += i ? " w" : "w";
+    const auto ids = sentence(pattern.c_str());
+    const auto pieces = split_phoneme_ids(ids, 48, marks());
+    CHECK(pieces.size() >= 2);
+    for (size_t p = 0; p < pieces.size(); p++) {
+        CHECK(wrapped(pieces[p]));
+        CHECK_EQ(pieces[p][2], PHONE);
+        if (p > 0 && p + 1 < pieces.size()) CHECK(pieces[p].size() >= 48 * WORD_SPLIT_FACTOR);
+    }
+    CHECK(pieces.back().size() >= 24);   // no fragment left at the end
+    CHECK(body(pieces) == std::vector<int64_t>(ids.begin() + 2, ids.end() - 1));
+}
+
+static void test_first_piece_is_short() {
+    const auto ids = sentence("w w, w w w w w, w w w w w, w w w w w");
+    const auto pieces = split_phoneme_ids(ids, 40, marks());
+    CHECK(pieces.size() >= 3);
+    CHECK(pieces[0].size() < pieces[1].size());
+}
+
+int main() {
+    test_short_or_disabled_is_whole();
+    test_cuts_after_clause_marks();
+    test_no_word_cut_in_normal_clause();
+    test_word_cut_in_long_run();
+    test_first_piece_is_short();
+    return check_report();
+}
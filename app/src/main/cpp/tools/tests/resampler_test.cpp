@@ -0,0 +1,86 @@
+// Resampler: passband / stopband response of the downsamplers whisper's
+// file path uses, output length, and block-size independence
+
+#include "check.h"
+#include "resampler.h"
+
+#include <cmath>
+#include <vector>
+
+// Output level in dB of a full-scale sine at `hz`, steady-state part only
+static double gain_db(int inRate, int outRate, double hz) {
+    Resampler r(inRate, outRate);
+    std::vector<float> in((size_t) inRate), out;
+    for (size_t i = 0; i < in.size(); i++) in[i] = (float) std::sin(2.0 * M_PI * hz * (double) i / inRate);
+    r.process(in.data(), (int) in.size(), out);
+    double energy = 0.0;
+    const size_t from = out.size() / 4, to = out.size() * 3 / 4;
+    for (size_t i = from; i < to; i++) energy += (double) out[i] * out[i];
+    return 10.0 * std::log10(energy / (double) (to - from) / 0.5 + 1e-30);
+}
+
+static void test_downsampling_response() {
+    for (int inRate : {48000, 44100}) {
+        CHECK_NEAR(gain_db(inRate, 16000, 1000.0), 0.0, 0.1);
+        CHECK_NEAR(gain_db(inRate, 16000, 6000.0), 0.0, 0.1);
+        CHECK(gain_db(inRate, 16000, 6400.0) > -0.5);
+        // Content that would alias back into the speech band
+        CHECK(gain_db(inRate, 16000, 8400.0) < -40.0);
+        CHECK(gain_db(inRate, 16000, 9200.0) < -80.0);
+        CHECK(gain_db(inRate, 16000, 12000.0) < -80.0);
+    }
+    Resampler down(48000, 16000);
+    CHECK_EQ(down.taps(), 3 * Resampler::TAPS);
+}
+
+static void test_upsampling_response() {
+    Resampler up(22050, 48000);
+    CHECK_EQ(up.taps(), Resampler::TAPS);
+    CHECK_NEAR(gain_db(22050, 48000, 1000.0), 0.0, 0.1);
+    CHECK(gain_db(22050, 48000, 9000.0) > -0.5);
+}
+
+static void test_output_length() {
+    for (int inRate : {48000, 44100, 8000, 22050}) {
+        Resampler r(inRate, 16000);
+        std::vector<float> in((size_t) inRate / 2 + 7, 0.25f), out;   // 0.5 s and a bit
+        r.process(in.data(), (int) in.size(), out);
+        r.flush(out);
+        const size_t expected = (in.size() * 16000 + (size_t) inRate - 1) / (size_t) inRate;
+        CHECK_EQ(out.size(), expected);
+        CHECK_NEAR(out[out.size() / 2], 0.25, 1e-4);   // unity DC gain
+    }
+}
+
+static void test_block_size_independent() {
+    std::vector<float> in(48000);
+    for (size_t i = 0; i < in.size(); i++) in[i] = (float) std::sin((double) i * 0.01) * 0.5f;
+
+    Resampler whole(48000, 16000);
+    std::vector<float> expected;
+    whole.process(in.data(), (int) in.size(), expected);
+    whole.flush(expected);
+
+    Resampler blocks(48000, 16000);
+    std::vector<float> actual;
+    for (size_t pos = 0, block = 1; pos < in.size(); pos += block, block = block * 3 % 997 + 1) {
+        const size_t n = std::min(block, in.size() - pos);
+        blocks.process(in.data() + pos, (int) n, actual);
+    }
+    blocks.flush(actual);
+
+    CHECK_EQ(actual.size(), expected.size());
+    double maxDiff = 0.0;
+    for (size_t i = 0; i < std::min(actual.size(), expected.size()); i++) {
+        maxDiff = std::max(maxDiff, (double) std::fabs(actual[i] - expected[i]));
+    }
+    CHECK(maxDiff < 1e-6);
+}
+
+int main() {
+    test_downsampling_response();
+    test_upsampling_response();
+    test_output_length();
+    test_block_size_independent();
+    return check_report();
+}
@@ -0,0 +1,98 @@
+// TextChunker: where streamed LLM text is cut into speakable chunks
+
+#include "check.h"
+#include "text_chunker.h"
+
+#include <string>
+#include <vector>
+
+// Feed text in fragments of `step` bytes, as tokens would arrive
+static std::vector<std::string> chunk(const std::string &text, size_t step = 3) {
+    TextChunker chunker;
+    std::vector<std::string> out;
+    for (size_t i = 0; i < text.size(); i += step) chunker.append(text.substr(i, step), out);
+    chunker.flush(out);
+    return out;
+}
+
+static void test_sentences() {
+    const auto chunks = chunk("Sure, I can help with that. The meeting is at noon. Anything else?");
+    CHECK_EQ(chunks.size(), (size_t) 3);
+    if (chunks.size() == 3) {
+        CHECK_EQ(chunks[0], std::string("Sure, I can help with that."));
+        CHECK_EQ(chunks[2], std::string("Anything else?"));
+    }
+}
+
+static void test_no_split_inside_forms() {
+    struct Case {
+        const char *text;
+        const char *form;   // must come out whole, in one chunk
+    };
+    for (const Case &c : {Case{"Dr. Smith will see you at 3:30 today, okay.", "Dr. Smith"},
+                          Case{"It costs $1,200.50 in total, which is fine.", "$1,200.50"},
+                          Case{"Pi is about 3.14 and e is about 2.72 these days.", "3.14"},
+                          Case{"Go to https://example.com/a.b for the details now.", "https://example.com/a.b"},
+                          Case{"Use e.g. the blue one or the red one instead.", "e.g. the"},
+                          Case{"Update to version 2.0.1 tonight. It fixes the bug.", "2.0.1"}}) {
+        bool whole = false;
+        for (const std::string &piece : chunk(c.text)) whole |= piece.find(c.form) != std::string::npos;
+        CHECK(whole);
+    }
+}
+
+static void test_quotes_stay_with_sentence() {
+    const auto chunks = chunk("She said \"see you tomorrow.\" Then she left the room.");
+    CHECK_EQ(chunks.size(), (size_t) 2);
+    if (!chunks.empty()) CHECK_EQ(chunks[0], std::string("She said \"see you tomorrow.\""));
+}
+
+static void test_first_clause_releases_early() {
+    // A long first sentence is cut at a clause past MIN_FIRST_CLAUSE_CHARS
+    const auto chunks = chunk("Okay so here is what I found about it, the store opens at nine and closes late tonight.");
+    CHECK(chunks.size() >= 2);
+    if (!chunks.empty()) CHECK(chunks[0].back() == ',');
+}
+
+static void test_long_run_is_cut() {
+    std::string text;
+    for (int i = 0; i < 80; i++) text += "word ";
+    for (const std::string &c : chunk(text, 7)) CHECK(c.size() <= TextChunker::MAX_CHUNK_CHARS);
+}
+
+static void test_run_without_spaces() {
+    // Two-byte characters: no chunk may start or end mid-character
+    std::string text;
+    for (int i = 0; i < 300; i++) text += "\xC3\xA9";
+    size_t total = 0;
+    for (const std::string &c : chunk(text, 5)) {
+        CHECK(c.size() <= TextChunker::MAX_CHUNK_CHARS);
+        CHECK(c.size() % 2 == 0 && (unsigned char) c[0] == 0xC3);
+        total += c.size();
+    }
+    CHECK_EQ(total, text.size());
+
+    // A form straddling MAX_CHUNK_CHARS moves whole into the next chunk
+    const std::string form = "$1,200.50";
+    const auto chunks = chunk(std::string(235, 'x') + "(" + form + ")" + std::string(40, 'y'), 7);
+    bool whole = false;
+    for (const std::string &piece : chunks) whole |= piece.find(form) != std::string::npos;
+    CHECK(whole);
+}
+
+static void test_fragment_size_does_not_matter() {
+    const std::string text = "First one here. Second, with a clause that runs for a while longer than sixty chars. Third!";
+    CHECK(chunk(text, 1) == chunk(text, 5));
+    CHECK(chunk(text, 1) == chunk(text, text.size()));
+}
+
+int main() {
+    test_sentences();
+    test_no_split_inside_forms();
+    test_quotes_stay_with_sentence();
+    test_first_clause_releases_early();
+    test_long_run_is_cut();
+    test_run_without_spaces();
+    test_fragment_size_does_not_matter();
+    return check_report();
+}
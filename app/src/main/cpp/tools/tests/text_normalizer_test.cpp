@@ -0,0 +1,88 @@
+// normalize_for_speech: spoken forms of numbers, money, times, dates, URLs
+// and abbreviations, including the out-of-range and look-alike inputs that
+// must not be read as times, dates or decimals
+
+#include "check.h"
+#include "text_normalizer.h"
+
+#define SPEAKS(text, spoken) CHECK_EQ(normalize_for_speech(text), std::string(spoken))
+
+static void test_numbers() {
+    SPEAKS("1,234", "one thousand two hundred thirty-four");
+    SPEAKS("3.5", "three point five");
+    SPEAKS("-4", "minus four");
+    SPEAKS("21st", "twenty-first");
+    SPEAKS("50%", "fifty percent");
+    SPEAKS("1999", "nineteen ninety-nine");
+    SPEAKS("2005", "two thousand five");
+    SPEAKS("007", "zero zero seven");
+    CHECK_EQ(number_words(-1000001), std::string("minus one million one"));
+}
+
+static void test_versions_are_not_decimals() {
+    SPEAKS("version 2.0.1", "version two point zero point one");
+    SPEAKS("iOS 17.4.1 is out.", "iOS seventeen point four point one is out.");
+    SPEAKS("1.2.3.4", "one point two point three point four");
+    SPEAKS("3.14", "three point one four");
+}
+
+static void test_currency() {
+    SPEAKS("$12.50", "twelve dollars and fifty cents");
+    SPEAKS("$1", "one dollar");
+    SPEAKS("$0.01", "one cent");
+    SPEAKS("$0.50", "fifty cents");
+    SPEAKS("$0", "zero dollars");
+    SPEAKS("$1.01", "one dollar and one cent");
+    SPEAKS("\xE2\x82\xAC" "5 million", "five million euros");
+    SPEAKS("\xC2\xA3" "0.05", "five pence");
+    SPEAKS("$3k", "three thousand dollars");
+}
+
+static void test_times() {
+    SPEAKS("3:05 pm", "three oh five p m");
+    SPEAKS("14:00", "fourteen o'clock");
+    SPEAKS("9:15:00", "nine fifteen");
+    SPEAKS("3pm", "three p m");
+    SPEAKS("10:30 a.m. tomorrow", "ten thirty a m tomorrow");
+    SPEAKS("See you at 10 a.m. Tomorrow works.", "See you at ten a m. Tomorrow works.");
+    SPEAKS("at 9 a.m.", "at nine a m.");
+    // Not clock times
+    SPEAKS("12:60", "twelve sixty");
+    SPEAKS("25:00", "twenty-five minutes");
+    SPEAKS("45:30", "forty-five minutes and thirty seconds");
+    SPEAKS("24:00", "twenty-four o'clock");
+}
+
+static void test_dates() {
+    SPEAKS("2024-03-15", "March fifteenth, twenty twenty-four");
+    SPEAKS("3/15/2024", "March fifteenth, twenty twenty-four");
+    SPEAKS("2024-02-29", "February twenty-ninth, twenty twenty-four");
+    // Out of range: read group by group, never half-converted
+    SPEAKS("2024-13-01", "two thousand twenty-four thirteen zero one");
+    SPEAKS("2023-02-29", "two thousand twenty-three zero two twenty-nine");
+    SPEAKS("2024-04-31", "two thousand twenty-four zero four thirty-one");
+}
+
+static void test_urls_and_abbreviations() {
+    SPEAKS("https://www.example.com/path?q=1", "example dot com");
+    SPEAKS("see docs.example.io/x.", "see docs dot example dot io.");
+    SPEAKS("Dr. Smith", "Doctor Smith");
+    SPEAKS("apples, pears, etc.", "apples, pears, et cetera.");
+    SPEAKS("salt & pepper", "salt and pepper");
+}
+
+static void test_emoji_dropped() {
+    SPEAKS("Done! \xF0\x9F\x8E\x89", "Done!");
+    SPEAKS("ok \xF0\x9F\x91\x8D\xF0\x9F\x8F\xBD thanks", "ok thanks");
+}
+
+int main() {
+    test_numbers();
+    test_versions_are_not_decimals();
+    test_currency();
+    test_times();
+    test_dates();
+    test_urls_and_abbreviations();
+    test_emoji_dropped();
+    return check_report();
+}
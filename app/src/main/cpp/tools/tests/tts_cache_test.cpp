@@ -0,0 +1,156 @@
+// TtsCache: key normalization, the memory LRU, and the disk tier's budget,
+// mtime LRU and per-voice removal
+
+#include "check.h"
+#include "tts_cache.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <dirent.h>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const int RATE = 22050;
+
+static std::vector<int16_t> pcm(size_t samples, int16_t value = 1) {
+    return std::vector<int16_t>(samples, value);
+}
+
+static int count_files(const std::string &dir) {
+    int n = 0;
+    DIR *d = opendir(dir.c_str());
+    while (dirent *e = d ? readdir(d) : nullptr) n += e->d_name[0] != '.';
+    if (d) closedir(d);
+    return n;
+}
+
+static std::string temp_dir() {
+    char tmpl[] = "/tmp/nova_tts_cache_XXXXXX";
+    return mkdtemp(tmpl);
+}
+
+// A file standing in for a voice model, so the directory scan keeps its phrases
+static std::string fake_voice(const std::string &dir, const char *name) {
+    const std::string path = dir + "/" + name;
+    FILE *f = fopen(path.c_str(), "wb");
+    if (f) fclose(f);
+    return path;
+}
+
+static void test_key() {
+    const std::string a = TtsCache::key("  Done!\n", "amy", 0, 1.0f, 0.667f, 0.8f);
+    const std::string b = TtsCache::key("Done!", "amy", 0, 1.0f, 0.667f, 0.8f);
+    CHECK_EQ(a, b);
+    CHECK_EQ(TtsCache::key("one   two\tthree", "amy", 0, 1.0f, 0.667f, 0.8f),
+             TtsCache::key("one two three", "amy", 0, 1.0f, 0.667f, 0.8f));
+    CHECK(TtsCache::key("Done!", "amy", 0, 1.0f, 0.667f, 0.8f) !=
+          TtsCache::key("Done!", "amy", 0, 1.1f, 0.667f, 0.8f));
+    CHECK(TtsCache::key("Done!", "amy", 0, 1.0f, 0.667f, 0.8f) !=
+          TtsCache::key("Done!", "lessac", 0, 1.0f, 0.667f, 0.8f));
+    CHECK(TtsCache::key("Done!", "amy", 0, 1.0f, 0.667f, 0.8f) !=
+          TtsCache::key("Done!", "amy", 1, 1.0f, 0.667f, 0.8f));
+}
+
+static void test_memory_lru() {
+    TtsCache cache(3000);   // bytes: room for three 500-sample phrases
+    cache.put("a", RATE, pcm(500), false);
+    cache.put("b", RATE, pcm(500), false);
+    cache.put("c", RATE, pcm(500), false);
+    CHECK(cache.get("a", RATE) != nullptr);   // a is now the most recent
+    cache.put("d", RATE, pcm(500), false);    // evicts b
+    CHECK(cache.get("b", RATE) == nullptr);
+    CHECK(cache.get("a", RATE) != nullptr);
+    CHECK(cache.get("d", RATE) != nullptr);
+    CHECK_EQ(cache.bytes(), (size_t) 3000);
+}
+
+static void test_disk_round_trip() {
+    const std::string dir = temp_dir();
+    const std::string voice = fake_voice(dir, "amy.onnx");
+    const std::string key = TtsCache::key("Got it.", voice, 0, 1.0f, 0.667f, 0.8f);
+    {
+        TtsCache cache;
+        cache.setDirectory(dir);
+        cache.put(key, RATE, pcm(1000, 7), true);
+    }
+    TtsCache fresh;
+    fresh.setDirectory(dir);
+    TtsCache::Pcm hit = fresh.get(key, RATE);
+    CHECK(hit != nullptr);
+    if (hit) {
+        CHECK_EQ(hit->size(), (size_t) 1000);
+        CHECK_EQ((*hit)[999], (int16_t) 7);
+    }
+    CHECK(fresh.diskBytes() > 2000);
+}
+
+static void test_disk_budget_drops_oldest() {
+    const std::string dir = temp_dir();
+    const std::string voice = fake_voice(dir, "amy.onnx");
+    TtsCache cache;
+    cache.setDirectory(dir);
+    const size_t entry = 10000;   // samples per phrase, ~20 KB on disk
+    cache.setDiskBudget(3 * entry * sizeof(int16_t) + 3 * 512);
+
+    std::vector<std::string> keys;
+    for (int i = 0; i < 4; i++) {
+        keys.push_back(TtsCache::key("phrase " + std::to_string(i), voice, 0, 1.0f, 0.667f, 0.8f));
+        cache.put(keys.back(), RATE, pcm(entry), true);
+        usleep(20000);   // distinct mtimes
+    }
+    CHECK_EQ(count_files(dir), 4);   // three phrases + the voice file
+    CHECK(cache.diskBytes() <= 3 * entry * sizeof(int16_t) + 3 * 512);
+
+    TtsCache fresh;
+    fresh.setDirectory(dir);
+    CHECK(fresh.get(keys[0], RATE) == nullptr);   // oldest went first
+    CHECK(fresh.get(keys[3], RATE) != nullptr);
+}
+
+static void test_remove_voice() {
+    const std::string dir = temp_dir();
+    const std::string amy = fake_voice(dir, "amy.onnx");
+    const std::string lessac = fake_voice(dir, "lessac.onnx");
+    const std::string amyKey = TtsCache::key("Okay.", amy, 0, 1.0f, 0.667f, 0.8f);
+    const std::string lessacKey = TtsCache::key("Okay.", lessac, 0, 1.0f, 0.667f, 0.8f);
+
+    TtsCache cache;
+    cache.setDirectory(dir);
+    cache.put(amyKey, RATE, pcm(800), true);
+    cache.put(lessacKey, RATE, pcm(800), true);
+    cache.removeVoice(amy);
+    CHECK(cache.get(amyKey, RATE) == nullptr);
+    CHECK(cache.get(lessacKey, RATE) != nullptr);
+    CHECK_EQ(count_files(dir), 3);   // two voice files + lessac's phrase
+}
+
+static void test_scan_drops_missing_voices() {
+    const std::string dir = temp_dir();
+    const std::string voice = fake_voice(dir, "amy.onnx");
+    const std::string key = TtsCache::key("Sure.", voice, 0, 1.0f, 0.667f, 0.8f);
+    {
+        TtsCache cache;
+        cache.setDirectory(dir);
+        cache.put(key, RATE, pcm(800), true);
+    }
+    FILE *torn = fopen((dir + "/0123456789abcdef.tts.tmp").c_str(), "wb");
+    if (torn) fclose(torn);
+    remove(voice.c_str());
+
+    TtsCache fresh;
+    fresh.setDirectory(dir);
+    CHECK(fresh.get(key, RATE) == nullptr);
+    CHECK_EQ(count_files(dir), 0);
+    CHECK_EQ(fresh.diskBytes(), (size_t) 0);
+}
+
+int main() {
+    test_key();
+    test_memory_lru();
+    test_disk_round_trip();
+    test_disk_budget_drops_oldest();
+    test_remove_voice();
+    test_scan_drops_missing_voices();
+    return check_report();
+}
@@ -0,0 +1,255 @@
+/**
+ * Span tracing — see trace.h.
+ */
+
+#include "trace.h"
+
+#include <android/trace.h>
+#include <sys/prctl.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace trace {
+
+std::atomic<int> g_mode{MODE_OFF};
+
+namespace {
+
+// durNs of an instant event
+constexpr uint64_t INSTANT = UINT64_MAX;
+
+struct Span {
+    const char *category;
+    const char *name;
+    uint64_t startNs;
+    uint64_t durNs;
+    const char *arg0;
+    int64_t value0;
+    const char *arg1;
+    int64_t value1;
+};
+
+// Written only by its thread; read by dump_events under the registry lock.
+// A ring: span i of the session sits in spans[i % THREAD_CAPACITY], so once
+// full each span overwrites the oldest one.
+struct ThreadBuffer {
+    int tid = 0;
+    char name[16] = {};
+    std::atomic<uint32_t> session{0};   // session the recorded spans belong to
+    std::atomic<uint64_t> count{0};     // spans recorded this session, including overwritten ones
+    std::atomic<bool> retired{false};   // thread exited; the buffer can be reused
+    std::atomic<uint64_t> retiredAt{0}; // order of exit, oldest reused first
+    Span spans[THREAD_CAPACITY];
+};
+
+std::mutex g_registry_mutex;
+std::vector<std::unique_ptr<ThreadBuffer>> g_buffers;
+std::atomic<uint32_t> g_session{1};
+std::atomic<uint64_t> g_retire_seq{0};
+
+struct ThreadSlot {
+    ThreadBuffer *buffer = nullptr;
+    ~ThreadSlot() {
+        if (!buffer) return;
+        buffer->retiredAt.store(g_retire_seq.fetch_add(1) + 1, std::memory_order_relaxed);
+        buffer->retired.store(true, std::memory_order_release);
+    }
+};
+
+thread_local ThreadSlot t_slot;
+
+// First span of a thread: take a buffer left by an exited thread, else
+// allocate one. Short-lived threads (a Piper producer and pump per reply)
+// come and go all session, so buffers are reused within it too: one holding
+// an older session's spans first, else the one whose thread exited first,
+// giving up its spans as the ring gives up its oldest. The buffer count stays
+// at the most threads ever recording at once.
+ThreadBuffer *acquire_buffer() {
+    std::lock_guard<std::mutex> lock(g_registry_mutex);
+    ThreadBuffer *buffer = nullptr;
+    const uint32_t session = g_session.load();
+    for (auto &candidate : g_buffers) {
+        if (!candidate->retired.load(std::memory_order_acquire)) continue;
+        if (candidate->session.load() != session) {
+            buffer = candidate.get();
+            break;
+        }
+        if (!buffer || candidate->retiredAt.load(std::memory_order_relaxed) <
+                       buffer->retiredAt.load(std::memory_order_relaxed)) {
+            buffer = candidate.get();
+        }
+    }
+    if (!buffer) {
+        g_buffers.push_back(std::make_unique<ThreadBuffer>());
+        buffer = g_buffers.back().get();
+    }
+    buffer->retired.store(false);
+    buffer->tid = (int) gettid();
+    prctl(PR_GET_NAME, buffer->name, 0, 0, 0);
+    buffer->name[sizeof(buffer->name) - 1] = '\0';
+    buffer->count.store(0, std::memory_order_relaxed);
+    buffer->session.store(session, std::memory_order_release);
+    return buffer;
+}
+
+void record(const Span &span) {
+    ThreadBuffer *buffer = t_slot.buffer;
+    if (!buffer) buffer = t_slot.buffer = acquire_buffer();
+
+    // New session: restart this thread's buffer (count first, so a dump that
+    // sees the new session never pairs it with the old count)
+    const uint32_t session = g_session.load(std::memory_order_relaxed);
+    if (buffer->session.load(std::memory_order_relaxed) != session) {
+        buffer->count.store(0, std::memory_order_relaxed);
+        buffer->session.store(session, std::memory_order_release);
+    }
+
+    const uint64_t n = buffer->count.load(std::memory_order_relaxed);
+    buffer->spans[n % THREAD_CAPACITY] = span;
+    buffer->count.store(n + 1, std::memory_order_release);
+}
+
+// Chrome trace timestamps are microseconds; keep the ns as decimals
+void append_us(std::string &out, uint64_t ns) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%" PRIu64 ".%03u", ns / 1000, (unsigned) (ns % 1000));
+    out += buf;
+}
+
+void append_escaped(std::string &out, const char *text) {
+    for (const char *c = text; *c; c++) {
+        if (*c == '"' || *c == '\\') {
+            out += '\\';
+            out += *c;
+        } else if ((unsigned char) *c < 0x20) {
+            out += ' ';
+        } else {
+            out += *c;
+        }
+    }
+}
+
+void append_span(std::string &out, const Span &span, int pid, int tid) {
+    char buf[64];
+    out += "{\"name\":\"";
+    append_escaped(out, span.name);
+    out += "\",\"cat\":\"";
+    append_escaped(out, span.category);
+    out += span.durNs == INSTANT ? "\",\"ph\":\"i\",\"s\":\"t\",\"ts\":" : "\",\"ph\":\"X\",\"ts\":";
+    append_us(out, span.startNs);
+    if (span.durNs != INSTANT) {
+        out += ",\"dur\":";
+        append_us(out, span.durNs);
+    }
+    snprintf(buf, sizeof(buf), ",\"pid\":%d,\"tid\":%d", pid, tid);
+    out += buf;
+    if (span.arg0) {
+        out += ",\"args\":{\"";
+        append_escaped(out, span.arg0);
+        snprintf(buf, sizeof(buf), "\":%" PRId64, span.value0);
+        out += buf;
+        if (span.arg1) {
+            out += ",\"";
+            append_escaped(out, span.arg1);
+            snprintf(buf, sizeof(buf), "\":%" PRId64, span.value1);
+            out += buf;
+        }
+        out += '}';
+    }
+    out += '}';
+}
+
+} // namespace
+
+uint64_t now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ull + (uint64_t) ts.tv_nsec;
+}
+
+void set_mode(int mode) {
+    std::lock_guard<std::mutex> lock(g_registry_mutex);
+    const int previous = g_mode.load();
+    if ((mode & MODE_BUFFER) && !(previous & MODE_BUFFER)) g_session.fetch_add(1);
+    g_mode.store(mode);
+}
+
+void complete(const char *category, const char *name, uint64_t startNs, uint64_t endNs,
+              const char *arg0, int64_t value0, const char *arg1, int64_t value1) {
+    if (!(g_mode.load(std::memory_order_relaxed) & MODE_BUFFER)) return;
+    record({category, name, startNs, endNs > startNs ? endNs - startNs : 0, arg0, value0, arg1, value1});
+}
+
+void instant(const char *category, const char *name, const char *arg0, int64_t value0) {
+    if (!(g_mode.load(std::memory_order_relaxed) & MODE_BUFFER)) return;
+    record({category, name, now_ns(), INSTANT, arg0, value0, nullptr, 0});
+}
+
+std::string dump_events() {
+    std::lock_guard<std::mutex> lock(g_registry_mutex);
+    const uint32_t session = g_session.load();
+    const int pid = (int) getpid();
+    std::string out;
+    char buf[96];
+    std::vector<Span> copy;
+    copy.reserve(THREAD_CAPACITY);
+    for (const auto &buffer : g_buffers) {
+        if (buffer->session.load(std::memory_order_acquire) != session) continue;
+        const uint64_t n = buffer->count.load(std::memory_order_acquire);
+        if (n == 0) continue;
+
+        // Copy the newest spans, then drop any the thread may have overwritten
+        // while we copied (it keeps recording). Span `after`, which it may be
+        // writing right now, replaces span after - THREAD_CAPACITY, so only
+        // spans past that one are known intact.
+        const uint64_t first = n > THREAD_CAPACITY ? n - THREAD_CAPACITY : 0;
+        copy.clear();
+        for (uint64_t i = first; i < n; i++) copy.push_back(buffer->spans[i % THREAD_CAPACITY]);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const uint64_t after = buffer->count.load(std::memory_order_relaxed);
+        const uint64_t valid = after >= THREAD_CAPACITY ? std::max(first, after + 1 - THREAD_CAPACITY) : first;
+
+        if (!out.empty()) out += ',';
+        snprintf(buf, sizeof(buf), "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":\"",
+                 pid, buffer->tid);
+        out += buf;
+        append_escaped(out, buffer->name);
+        out += '"';
+        // Older spans the ring overwrote, shown with the thread's name
+        if (valid > 0) {
+            snprintf(buf, sizeof(buf), ",\"overwritten\":%" PRIu64, valid);
+            out += buf;
+        }
+        out += "}}";
+        for (uint64_t i = valid; i < n; i++) {
+            out += ',';
+            append_span(out, copy[i - first], pid, buffer->tid);
+        }
+    }
+    return out;
+}
+
+void Scope::begin(int mode, const char *category, const char *name) {
+    m_mode = mode;
+    m_category = category;
+    m_name = name;
+    if (mode & MODE_ATRACE) ATrace_beginSection(name);
+    m_start = now_ns();
+}
+
+void Scope::end() {
+    const uint64_t endNs = now_ns();
+    if (m_mode & MODE_ATRACE) ATrace_endSection();
+    if (m_mode & MODE_BUFFER) {
+        record({m_category, m_name, m_start, endNs - m_start, m_arg0, m_value0, m_arg1, m_value1});
+    }
+}
+
+} // namespace trace
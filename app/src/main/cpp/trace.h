@@ -0,0 +1,113 @@
+/**
+ * Span tracing across the native engines (front end, whisper, llama,
+ * Piper, the voice pipeline), dumped as Chrome trace JSON. The dump opens
+ * in Perfetto (ui.perfetto.dev) or chrome://tracing.
+ *
+ * A span is a name, a category, a start and duration in CLOCK_MONOTONIC
+ * nanoseconds and up to two integer args. Each thread records into its own
+ * fixed buffer, with no lock or allocation after that thread's first span.
+ * Spans are published with a release store of the count, so a dump can read
+ * them while the thread keeps recording. The buffer is a ring: once full,
+ * each new span overwrites the oldest (counted), so a dump always holds the
+ * latest THREAD_CAPACITY spans of each thread — the turn that just went
+ * wrong, not the start of the session.
+ *
+ * Disabled, a span costs one relaxed load. Enabled, it costs two clock
+ * reads and a store. Spans sit at model-call granularity (an encode, a
+ * decode step, a Piper piece) or per 10 ms hop, well under 1% of the work
+ * they measure. MODE_ATRACE also forwards scoped spans to ATrace, so they
+ * show in Perfetto system traces next to the scheduler.
+ *
+ * Every native library compiles its own copy (each is built with hidden
+ * visibility), so each has its own mode and buffers. The clock is shared,
+ * so their dumps merge into one timeline (NativeTrace.kt).
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace trace {
+
+// Bits; MODE_BUFFER | MODE_ATRACE does both
+enum Mode {
+    MODE_OFF = 0,
+    MODE_BUFFER = 1,    // record into the per-thread buffers
+    MODE_ATRACE = 2,    // forward scoped spans to ATrace
+};
+
+// Latest spans kept per thread (64 bytes each, 512 KB per thread that
+// records). A buffer is only allocated once its thread records while enabled,
+// and an exited thread's buffer is reused by the next new thread, so memory
+// follows the threads recording at once, not every thread ever traced.
+static constexpr uint32_t THREAD_CAPACITY = 8192;
+
+extern std::atomic<int> g_mode;
+
+inline bool enabled() { return g_mode.load(std::memory_order_relaxed) != MODE_OFF; }
+
+uint64_t now_ns();
+
+// Set the mode. Turning MODE_BUFFER on starts a new session: spans from
+// the previous one are dropped.
+void set_mode(int mode);
+
+// A finished span with explicit times (phases observed through callbacks).
+// name / category / arg names must be string literals.
+void complete(const char *category, const char *name, uint64_t startNs, uint64_t endNs,
+              const char *arg0 = nullptr, int64_t value0 = 0,
+              const char *arg1 = nullptr, int64_t value1 = 0);
+
+// A point in time (an endpoint, the first audio played)
+void instant(const char *category, const char *name, const char *arg0 = nullptr, int64_t value0 = 0);
+
+// This session's spans as comma-separated Chrome trace event objects, plus
+// thread-name metadata (with the count of overwritten spans, if any), for the
+// caller to wrap in {"traceEvents":[...]}.
+std::string dump_events();
+
+// Records [construction, destruction) as one span
+class Scope {
+public:
+    Scope(const char *category, const char *name) {
+        const int mode = g_mode.load(std::memory_order_relaxed);
+        if (mode == MODE_OFF) return;
+        begin(mode, category, name);
+    }
+    ~Scope() {
+        if (m_mode != MODE_OFF) end();
+    }
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+
+    // Attach a value known only by the end of the span (tokens, samples)
+    void arg(const char *name, int64_t value) {
+        if (m_mode == MODE_OFF) return;
+        if (!m_arg0) { m_arg0 = name; m_value0 = value; }
+        else { m_arg1 = name; m_value1 = value; }
+    }
+
+private:
+    void begin(int mode, const char *category, const char *name);
+    void end();
+
+    int m_mode = MODE_OFF;
+    const char *m_category = nullptr;
+    const char *m_name = nullptr;
+    uint64_t m_start = 0;
+    const char *m_arg0 = nullptr;
+    int64_t m_value0 = 0;
+    const char *m_arg1 = nullptr;
+    int64_t m_value1 = 0;
+};
+
+} // namespace trace
+
+#define NOVA_TRACE_CONCAT_(a, b) a##b
+#define NOVA_TRACE_CONCAT(a, b) NOVA_TRACE_CONCAT_(a, b)
+
+// Span over the rest of the enclosing block
+#define NOVA_TRACE_SCOPE(category, name) \
+    trace::Scope NOVA_TRACE_CONCAT(nova_trace_scope_, __LINE__)(category, name)
@@ -0,0 +1,356 @@
+/**
+ * Rendered-phrase cache — see tts_cache.h.
+ */
+
+#include "tts_cache.h"
+
+#include <android/log.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define LOG_TAG "TtsCache"
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
+#define LOGD(...) __android_log_print(ANDROID_LOG_DEBUG, LOG_TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+
+// Disk entry: magic, version, sample rate, key length, key, sample count, PCM
+static const char FILE_MAGIC[4] = {'N', 'T', 'T', 'S'};
+static const uint32_t FILE_VERSION = 1;
+static const int HITS_TO_PERSIST = 2;
+static const uint32_t MAX_KEY_BYTES = 64 * 1024;
+static const char FILE_EXT[] = ".tts";
+static const char TMP_EXT[] = ".tmp";
+
+struct DiskFile {
+    std::string path;
+    size_t size;
+    int64_t mtimeNs;
+};
+
+static bool has_suffix(const char *name, const char *suffix) {
+    const size_t n = strlen(name), k = strlen(suffix);
+    return n >= k && strcmp(name + n - k, suffix) == 0;
+}
+
+// Regular files in dir ending in suffix
+static std::vector<DiskFile> list_files(const std::string &dir, const char *suffix) {
+    std::vector<DiskFile> files;
+    DIR *d = opendir(dir.c_str());
+    if (!d) return files;
+    while (dirent *e = readdir(d)) {
+        if (!has_suffix(e->d_name, suffix)) continue;
+        std::string path = dir + "/" + e->d_name;
+        struct stat st;
+        if (stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) continue;
+        files.push_back({std::move(path), (size_t) st.st_size,
+                         (int64_t) st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec});
+    }
+    closedir(d);
+    return files;
+}
+
+// Header and key of a disk entry; leaves f at the sample count
+static bool read_header(FILE *f, uint32_t &sampleRate, std::string &key) {
+    char magic[4];
+    uint32_t header[3];   // version, sample rate, key length
+    if (fread(magic, 1, 4, f) != 4 || memcmp(magic, FILE_MAGIC, 4) != 0 ||
+        fread(header, sizeof(uint32_t), 3, f) != 3 ||
+        header[0] != FILE_VERSION || header[2] > MAX_KEY_BYTES) {
+        return false;
+    }
+    sampleRate = header[1];
+    key.assign(header[2], '\0');
+    return fread(&key[0], 1, key.size(), f) == key.size();
+}
+
+static bool read_key(const std::string &path, std::string &key) {
+    FILE *f = fopen(path.c_str(), "rb");
+    if (!f) return false;
+    uint32_t sampleRate = 0;
+    const bool ok = read_header(f, sampleRate, key);
+    fclose(f);
+    return ok;
+}
+
+// Voice id (model path) a key was rendered with
+static std::string voice_of(const std::string &key) {
+    return key.substr(0, key.find('|'));
+}
+
+// FNV-1a; names the disk file (the full key is stored inside and checked)
+static uint64_t fnv1a(const std::string &s) {
+    uint64_t h = 1469598103934665603ull;
+    for (unsigned char c : s) {
+        h ^= c;
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+std::string TtsCache::key(const std::string &text, const std::string &voiceId, int64_t speakerId,
+                          float lengthScale, float noiseScale, float noiseW) {
+    char params[96];
+    snprintf(params, sizeof(params), "|%lld|%.3f|%.3f|%.3f|", (long long) speakerId,
+             lengthScale, noiseScale, noiseW);
+
+    std::string out = voiceId + params;
+    bool space = false;
+    for (char c : text) {
+        if (c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+            space = true;
+            continue;
+        }
+        if (space && out.back() != '|') out += ' ';
+        space = false;
+        out += c;
+    }
+    return out;
+}
+
+TtsCache::Pcm TtsCache::get(const std::string &key, int sampleRate) {
+    Pcm pcm;
+    bool persist = false;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_index.find(key);
+        if (it != m_index.end()) {
+            m_lru.splice(m_lru.begin(), m_lru, it->second);
+            Entry &entry = *it->second;
+            pcm = entry.pcm;
+            // A phrase that keeps coming back is worth keeping across restarts
+            if (++entry.hits >= HITS_TO_PERSIST && !entry.onDisk && !m_dir.empty()) {
+                entry.onDisk = true;
+                persist = true;
+            }
+        }
+    }
+    if (pcm) {
+        if (persist) store(key, sampleRate, *pcm);
+        return pcm;
+    }
+
+    pcm = load(key, sampleRate);
+    if (pcm) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        insert(key, pcm, true);
+    }
+    return pcm;
+}
+
+void TtsCache::put(const std::string &key, int sampleRate, std::vector<int16_t> pcm, bool persist) {
+    if (pcm.empty()) return;
+    auto shared = std::make_shared<const std::vector<int16_t>>(std::move(pcm));
+    const bool onDisk = persist && store(key, sampleRate, *shared);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    insert(key, std::move(shared), onDisk);
+}
+
+void TtsCache::setDirectory(const std::string &dir) {
+    std::lock_guard<std::mutex> disk(m_diskMutex);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_dir = dir;
+    }
+    m_diskBytes = 0;
+    if (dir.empty()) return;
+
+    // Torn writes, unreadable entries and phrases of voices that are gone
+    int removed = 0;
+    for (const DiskFile &file : list_files(dir, TMP_EXT)) {
+        if (remove(file.path.c_str()) == 0) removed++;
+    }
+    for (const DiskFile &file : list_files(dir, FILE_EXT)) {
+        std::string key;
+        if (read_key(file.path, key) && access(voice_of(key).c_str(), F_OK) == 0) continue;
+        if (remove(file.path.c_str()) == 0) removed++;
+    }
+    trimDisk(dir, m_diskBudget);
+    LOGI("Disk tier %s: %zu KB, %d stale entries removed", dir.c_str(), m_diskBytes / 1024, removed);
+}
+
+void TtsCache::setBudget(size_t bytes) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_budget = bytes;
+    evict();
+}
+
+void TtsCache::setDiskBudget(size_t bytes) {
+    std::lock_guard<std::mutex> disk(m_diskMutex);
+    m_diskBudget = bytes;
+    const std::string dir = directory();
+    if (!dir.empty()) trimDisk(dir, m_diskBudget);
+}
+
+void TtsCache::removeVoice(const std::string &voiceId) {
+    const std::string prefix = voiceId + "|";
+    auto matches = [&](const std::string &key) { return key.compare(0, prefix.size(), prefix) == 0; };
+
+    std::lock_guard<std::mutex> disk(m_diskMutex);
+    size_t dropped = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto it = m_lru.begin(); it != m_lru.end();) {
+            if (!matches(it->key)) {
+                ++it;
+                continue;
+            }
+            m_bytes -= it->pcm->size() * sizeof(int16_t);
+            m_index.erase(it->key);
+            it = m_lru.erase(it);
+            dropped++;
+        }
+    }
+
+    const std::string dir = directory();
+    if (dir.empty()) return;
+    for (const DiskFile &file : list_files(dir, FILE_EXT)) {
+        std::string key;
+        if (!read_key(file.path, key) || !matches(key)) continue;
+        if (remove(file.path.c_str()) == 0) {
+            m_diskBytes -= std::min(m_diskBytes, file.size);
+            dropped++;
+        }
+    }
+    LOGD("Removed %zu cached phrases of %s", dropped, voiceId.c_str());
+}
+
+void TtsCache::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_lru.clear();
+    m_index.clear();
+    m_bytes = 0;
+}
+
+size_t TtsCache::bytes() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_bytes;
+}
+
+size_t TtsCache::entries() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_lru.size();
+}
+
+size_t TtsCache::diskBytes() const {
+    std::lock_guard<std::mutex> disk(m_diskMutex);
+    return m_diskBytes;
+}
+
+std::string TtsCache::directory() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_dir;
+}
+
+// Caller holds m_mutex
+void TtsCache::insert(const std::string &key, Pcm pcm, bool onDisk) {
+    auto it = m_index.find(key);
+    if (it != m_index.end()) {
+        m_bytes -= it->second->pcm->size() * sizeof(int16_t);
+        m_lru.erase(it->second);
+        m_index.erase(it);
+    }
+    m_bytes += pcm->size() * sizeof(int16_t);
+    m_lru.push_front(Entry{key, std::move(pcm), 0, onDisk});
+    m_index[key] = m_lru.begin();
+    evict();
+}
+
+// Caller holds m_mutex. Drops least recently used entries (disk copies stay).
+void TtsCache::evict() {
+    while (m_bytes > m_budget && !m_lru.empty()) {
+        const Entry &oldest = m_lru.back();
+        m_bytes -= oldest.pcm->size() * sizeof(int16_t);
+        m_index.erase(oldest.key);
+        m_lru.pop_back();
+    }
+}
+
+// Caller holds m_diskMutex. Recounts the tier and deletes the least
+// recently used files (oldest mtime) until it fits the budget.
+void TtsCache::trimDisk(const std::string &dir, size_t budget) {
+    std::vector<DiskFile> files = list_files(dir, FILE_EXT);
+    size_t total = 0;
+    for (const DiskFile &file : files) total += file.size;
+    if (total > budget) {
+        std::sort(files.begin(), files.end(),
+                  [](const DiskFile &a, const DiskFile &b) { return a.mtimeNs < b.mtimeNs; });
+        for (const DiskFile &file : files) {
+            if (total <= budget) break;
+            if (remove(file.path.c_str()) == 0) total -= file.size;
+        }
+    }
+    m_diskBytes = total;
+}
+
+std::string TtsCache::pathFor(const std::string &key) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_dir.empty()) return std::string();
+    char name[32];
+    snprintf(name, sizeof(name), "/%016llx.tts", (unsigned long long) fnv1a(key));
+    return m_dir + name;
+}
+
+TtsCache::Pcm TtsCache::load(const std::string &key, int sampleRate) const {
+    const std::string path = pathFor(key);
+    if (path.empty()) return nullptr;
+    FILE *f = fopen(path.c_str(), "rb");
+    if (!f) return nullptr;
+
+    Pcm result;
+    uint32_t rate = 0, count = 0;
+    std::string stored;
+    if (read_header(f, rate, stored) && (int) rate == sampleRate && stored == key &&
+        fread(&count, sizeof(count), 1, f) == 1) {
+        auto pcm = std::make_shared<std::vector<int16_t>>(count);
+        if (fread(pcm->data(), sizeof(int16_t), count, f) == count) result = std::move(pcm);
+    }
+    fclose(f);
+    if (result) {
+        // A hit counts as a use for the disk tier's LRU
+        utimensat(AT_FDCWD, path.c_str(), nullptr, 0);
+        LOGD("Disk hit: %s", path.c_str());
+    }
+    return result;
+}
+
+bool TtsCache::store(const std::string &key, int sampleRate, const std::vector<int16_t> &pcm) {
+    std::lock_guard<std::mutex> disk(m_diskMutex);
+    const std::string path = pathFor(key);
+    if (path.empty()) return false;
+
+    // Write aside and rename, so a crash never leaves a torn entry
+    const std::string tmp = path + TMP_EXT;
+    FILE *f = fopen(tmp.c_str(), "wb");
+    if (!f) {
+        LOGE("Cannot write %s", tmp.c_str());
+        return false;
+    }
+    const uint32_t header[3] = {FILE_VERSION, (uint32_t) sampleRate, (uint32_t) key.size()};
+    const uint32_t count = (uint32_t) pcm.size();
+    bool ok = fwrite(FILE_MAGIC, 1, 4, f) == 4 &&
+              fwrite(header, sizeof(uint32_t), 3, f) == 3 &&
+              fwrite(key.data(), 1, key.size(), f) == key.size() &&
+              fwrite(&count, sizeof(count), 1, f) == 1 &&
+              fwrite(pcm.data(), sizeof(int16_t), pcm.size(), f) == pcm.size();
+    ok = (fclose(f) == 0) && ok;
+
+    struct stat old;
+    const size_t replaced = stat(path.c_str(), &old) == 0 ? (size_t) old.st_size : 0;
+    if (ok) ok = rename(tmp.c_str(), path.c_str()) == 0;
+    if (!ok) {
+        remove(tmp.c_str());
+        return false;
+    }
+
+    m_diskBytes += 4 + sizeof(header) + key.size() + sizeof(count) + pcm.size() * sizeof(int16_t);
+    m_diskBytes -= std::min(m_diskBytes, replaced);
+    if (m_diskBytes > m_diskBudget) trimDisk(path.substr(0, path.rfind('/')), m_diskBudget);
+    return true;
+}
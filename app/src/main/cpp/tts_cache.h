@@ -0,0 +1,92 @@
+/**
+ * Rendered-phrase cache for Piper.
+ *
+ * Nova says the same short things over and over ("Done!", re-ask prompts,
+ * reminder prefixes); each one otherwise costs a phonemizer pass and a full
+ * ONNX run. Entries hold finished PCM keyed by (normalized text, voice,
+ * synthesis parameters), so a hit is a memcpy away from playback.
+ *
+ * Two tiers: an in-memory LRU bounded by a byte budget, and an optional
+ * directory of one file per phrase that survives restarts. Pre-rendered
+ * phrases and phrases hit a second time are written through to disk; a
+ * memory miss checks the disk before falling back to synthesis.
+ *
+ * The disk tier has its own byte budget, kept LRU by file mtime (a disk
+ * hit touches its file). Opening the directory drops leftovers of torn
+ * writes and phrases of voices whose model file is gone; removeVoice()
+ * drops a voice's phrases from both tiers when it's unloaded.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class TtsCache {
+public:
+    using Pcm = std::shared_ptr<const std::vector<int16_t>>;
+
+    static constexpr size_t DEFAULT_BUDGET_BYTES = 8 * 1024 * 1024;        // ~3 min at 22 kHz
+    static constexpr size_t DEFAULT_DISK_BUDGET_BYTES = 32 * 1024 * 1024;  // ~12 min at 22 kHz
+
+    explicit TtsCache(size_t budgetBytes = DEFAULT_BUDGET_BYTES) : m_budget(budgetBytes) {}
+
+    // Cache key for text spoken with the given voice and parameters.
+    // Whitespace is collapsed so token-streamed and typed text match.
+    static std::string key(const std::string &text, const std::string &voiceId, int64_t speakerId,
+                           float lengthScale, float noiseScale, float noiseW);
+
+    // Null on a miss in both tiers
+    Pcm get(const std::string &key, int sampleRate);
+
+    // persist: also write the disk tier now (pre-rendered phrases)
+    void put(const std::string &key, int sampleRate, std::vector<int16_t> pcm, bool persist);
+
+    // Disk tier location; empty disables it. Scans the directory once.
+    void setDirectory(const std::string &dir);
+    void setBudget(size_t bytes);
+    void setDiskBudget(size_t bytes);
+    void clear();
+
+    // Drop every phrase of voiceId, in memory and on disk
+    void removeVoice(const std::string &voiceId);
+
+    size_t bytes() const;
+    size_t entries() const;
+    size_t diskBytes() const;
+
+private:
+    struct Entry {
+        std::string key;
+        Pcm pcm;
+        int hits = 0;
+        bool onDisk = false;
+    };
+
+    std::string pathFor(const std::string &key) const;
+    Pcm load(const std::string &key, int sampleRate) const;
+    bool store(const std::string &key, int sampleRate, const std::vector<int16_t> &pcm);
+    void insert(const std::string &key, Pcm pcm, bool onDisk);
+    void evict();
+    void trimDisk(const std::string &dir, size_t budget);
+    std::string directory() const;
+
+    // Memory tier and the directory path, under m_mutex
+    mutable std::mutex m_mutex;
+    size_t m_budget;
+    size_t m_bytes = 0;
+    std::string m_dir;
+    std::list<Entry> m_lru;   // most recent first
+    std::unordered_map<std::string, std::list<Entry>::iterator> m_index;
+
+    // Disk bookkeeping, held across directory scans and writes. Taken before
+    // m_mutex when both are needed, never while holding it.
+    mutable std::mutex m_diskMutex;
+    size_t m_diskBudget = DEFAULT_DISK_BUDGET_BYTES;
+    size_t m_diskBytes = 0;
+};
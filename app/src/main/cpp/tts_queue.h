@@ -0,0 +1,75 @@
+/**
+ * Bounded hand-off queue between Piper's synthesis thread and playback.
+ *
+ * The producer synthesizes sentences ahead and pushes one chunk of PCM per
+ * sentence; push blocks once `depth` chunks are waiting, so lookahead (and
+ * memory) is capped while the consumer drains at playback speed — the
+ * consumer's AudioTrack.write blocks for as long as the audio takes to play.
+ * close() wakes both sides: the producer stops, the consumer drains what's
+ * left and then sees the end. cancel() also drops what's left (barge-in).
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+struct TtsChunk {
+    std::vector<int16_t> pcm;
+    int sampleRate = 0;
+    bool last = false;
+};
+
+class TtsQueue {
+public:
+    explicit TtsQueue(size_t depth) : m_depth(depth < 1 ? 1 : depth) {}
+
+    // Producer: blocks while full. False if the queue was closed.
+    bool push(TtsChunk chunk) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_notFull.wait(lock, [&] { return m_closed || m_chunks.size() < m_depth; });
+        if (m_closed) return false;
+        m_chunks.push_back(std::move(chunk));
+        m_notEmpty.notify_one();
+        return true;
+    }
+
+    // Consumer: blocks while empty. False once closed and drained.
+    bool pop(TtsChunk &chunk) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_notEmpty.wait(lock, [&] { return m_closed || !m_chunks.empty(); });
+        if (m_chunks.empty()) return false;
+        chunk = std::move(m_chunks.front());
+        m_chunks.pop_front();
+        m_notFull.notify_one();
+        return true;
+    }
+
+    // No more pushes; pending chunks stay poppable
+    void close() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_closed = true;
+        m_notFull.notify_all();
+        m_notEmpty.notify_all();
+    }
+
+    // close(), discarding pending chunks
+    void cancel() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_closed = true;
+        m_chunks.clear();
+        m_notFull.notify_all();
+        m_notEmpty.notify_all();
+    }
+
+private:
+    const size_t m_depth;
+    std::mutex m_mutex;
+    std::condition_variable m_notFull;
+    std::condition_variable m_notEmpty;
+    std::deque<TtsChunk> m_chunks;
+    bool m_closed = false;
+};
@@ -0,0 +1,109 @@
+/**
+ * Single-producer / single-consumer PCM ring for zero-copy TTS playback.
+ *
+ * The memory belongs to a direct ByteBuffer allocated once on the Kotlin
+ * side, so synthesized audio is written straight into memory that
+ * AudioTrack.write(ByteBuffer) reads from — no jshortArray per chunk and no
+ * steady GC churn over a long reply. The native pump thread writes (blocking
+ * while the ring is full, which also caps lookahead); the playback thread
+ * acquires the next contiguous run of samples, plays it in place and
+ * releases it. Positions are absolute sample counts, so readPos() is how
+ * much audio has been handed to playback.
+ *
+ * close() marks the end of the stream (the reader drains, then sees the
+ * end); cancel() drops everything and wakes both sides.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+
+class TtsRing {
+public:
+    // capacity in samples; data must stay valid for the ring's lifetime
+    TtsRing(int16_t *data, size_t capacity) : m_data(data), m_capacity(capacity) {}
+
+    size_t capacity() const { return m_capacity; }
+
+    // Producer: copies all n samples, blocking while full. False once cancelled.
+    bool write(const int16_t *samples, size_t n) {
+        while (n > 0) {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [&] { return m_cancelled || m_write - m_read < (int64_t) m_capacity; });
+            if (m_cancelled) return false;
+            const size_t offset = (size_t) (m_write % (int64_t) m_capacity);
+            const size_t room = std::min(m_capacity - (size_t) (m_write - m_read), m_capacity - offset);
+            const size_t count = std::min(n, room);
+            // Only the writer touches [m_write, m_read + capacity); copy unlocked
+            lock.unlock();
+            memcpy(m_data + offset, samples, count * sizeof(int16_t));
+            lock.lock();
+            m_write += (int64_t) count;
+            m_cv.notify_all();
+            samples += count;
+            n -= count;
+        }
+        return true;
+    }
+
+    // Consumer: waits up to timeoutMs for audio. Returns the length of the
+    // contiguous run starting at sample `offset`, 0 on timeout, or -1 once
+    // the stream ended (closed and drained, or cancelled).
+    long acquire(size_t &offset, int timeoutMs) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cv.wait_for(lock, std::chrono::milliseconds(timeoutMs),
+                      [&] { return m_cancelled || m_closed || m_write > m_read; });
+        if (m_cancelled) return -1;
+        if (m_write == m_read) return m_closed ? -1 : 0;
+        offset = (size_t) (m_read % (int64_t) m_capacity);
+        return (long) std::min((size_t) (m_write - m_read), m_capacity - offset);
+    }
+
+    // Consumer: n samples from the last acquire have been played
+    void release(size_t n) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_read = std::min(m_read + (int64_t) n, m_write);
+        m_cv.notify_all();
+    }
+
+    // Producer: no more audio
+    void close() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_closed = true;
+        m_cv.notify_all();
+    }
+
+    // Either side: stop now, discarding unplayed audio
+    void cancel() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_cancelled = true;
+        m_cv.notify_all();
+    }
+
+    // Empty and reopen for the next stream (no producer may be running)
+    void reset() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_read = m_write = 0;
+        m_closed = m_cancelled = false;
+    }
+
+    int64_t readPos() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_read;
+    }
+
+private:
+    int16_t *const m_data;
+    const size_t m_capacity;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cv;
+    int64_t m_read = 0;
+    int64_t m_write = 0;
+    bool m_closed = false;
+    bool m_cancelled = false;
+};
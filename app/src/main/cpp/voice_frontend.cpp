@@ -0,0 +1,430 @@
+/**
+ * Always-on native voice front end — see voice_frontend.h.
+ */
+
+#include "voice_frontend.h"
+
+#include "audio_simd.h"
+#include "trace.h"
+
+#include <android/log.h>
+#include <aaudio/AAudio.h>
+#include <algorithm>
+#include <chrono>
+
+#define LOG_TAG "NovaFrontend"
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+#define LOGD(...) __android_log_print(ANDROID_LOG_DEBUG, LOG_TAG, __VA_ARGS__)
+
+using namespace frontend;
+
+static constexpr int64_t READ_TIMEOUT_NS = 200 * 1000000LL;
+static constexpr int REOPEN_DELAY_MS = 500;
+static constexpr size_t EVENT_QUEUE_MAX = 64;
+
+// Keep the spotter running this long after the last speech hop
+static constexpr int KWS_GATE_HANGOVER_MS = 1000;
+// Mel frames replayed into the spotter when the gate opens (~300 ms onset)
+static constexpr int KWS_ONSET_FRAMES = 30;
+
+// AudioRecorder's amplitude scale: RMS / 8000, clamped
+static constexpr float LEVEL_FULL_SCALE_RMS = 8000.0f;
+
+// With noise suppression on, the AGC only adapts on frames this far above
+// the noise floor (a posteriori SNR ~6 dB)
+static constexpr float AGC_MIN_SNR = 4.0f;
+
+static inline int64_t ms_to_samples(int ms) {
+    return (int64_t) ms * VoiceFrontend::SAMPLE_RATE / 1000;
+}
+
+VoiceFrontend &VoiceFrontend::instance() {
+    static VoiceFrontend frontend;
+    return frontend;
+}
+
+VoiceFrontend::VoiceFrontend()
+    : m_ring(RING_SAMPLES),
+      m_vad(SAMPLE_RATE),
+      m_mels(MEL_RING_FRAMES),
+      m_endpointer(SAMPLE_RATE) {}
+
+// ════════════════════════════════════════════════════════════════
+// Lifecycle
+// ════════════════════════════════════════════════════════════════
+
+bool VoiceFrontend::start() {
+    std::lock_guard<std::mutex> lock(m_lifecycleMutex);
+    if (m_running.load()) return true;
+
+    if (!m_capture.open(SAMPLE_RATE)) return false;
+
+    m_vad.reset();
+    m_mel.reset();
+    m_nsActive = false;
+    m_agcActive = false;
+    m_ppHops.store(0);
+    m_ppTotalNs.store(0);
+    m_ppMaxNs.store(0);
+    m_ppOverBudget.store(0);
+    m_lastSpeechPos = -1;
+    m_kwsGateOpen = false;
+    m_sessionStart.store(m_ring.writePos());
+
+    m_running.store(true);
+    m_worker = std::thread(&VoiceFrontend::run, this);
+    LOGI("Voice front end started");
+    return true;
+}
+
+void VoiceFrontend::stop() {
+    std::lock_guard<std::mutex> lock(m_lifecycleMutex);
+    if (!m_running.load()) return;
+
+    m_running.store(false);
+    m_eventCv.notify_all();
+    if (m_worker.joinable()) m_worker.join();
+    m_capture.close();
+
+    {
+        std::lock_guard<std::mutex> stateLock(m_stateMutex);
+        m_utt = Utterance();
+        if (m_kws) m_kws->reset();
+    }
+    m_level.store(0.0f);
+
+    const PreprocessStats stats = preprocessStats();
+    if (stats.hops > 0) {
+        LOGI("Preprocessing: avg %.0f us, max %.0f us per hop, %lld/%lld over budget",
+             stats.avgUs, stats.maxUs, (long long) stats.overBudget, (long long) stats.hops);
+    }
+    LOGI("Voice front end stopped");
+}
+
+bool VoiceFrontend::loadKeywordModel(const char *path, float threshold) {
+    auto kws = std::make_unique<KeywordSpotter>();
+    if (!kws->load(path)) return false;
+    kws->setThreshold(threshold);
+
+    std::lock_guard<std::mutex> lock(m_stateMutex);
+    m_kws = std::move(kws);
+    m_kwsGateOpen = false;
+    return true;
+}
+
+// ════════════════════════════════════════════════════════════════
+// Worker
+// ════════════════════════════════════════════════════════════════
+
+void VoiceFrontend::run() {
+    int16_t hop[HOP];
+    int filled = 0;
+    bool errorReported = false;
+
+    while (m_running.load()) {
+        if (!m_capture.isOpen()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(REOPEN_DELAY_MS));
+            if (m_running.load() && m_capture.open(SAMPLE_RATE)) {
+                LOGI("Capture reopened");
+                errorReported = false;
+                filled = 0;
+            }
+            continue;
+        }
+
+        const int n = m_capture.read(hop + filled, HOP - filled, READ_TIMEOUT_NS);
+        if (n < 0) {
+            LOGE("Capture read failed: %s", AAudio_convertResultToText(n));
+            m_capture.close();
+            if (!errorReported) {
+                pushEvent(EVENT_CAPTURE_ERROR, m_ring.writePos());
+                errorReported = true;
+            }
+            continue;
+        }
+
+        filled += n;
+        if (filled < HOP) continue;
+        filled = 0;
+
+        processHop(hop, m_ring.writePos());
+    }
+}
+
+void VoiceFrontend::processHop(const int16_t *raw, int64_t position) {
+    NOVA_TRACE_SCOPE("frontend", "frontend.hop");
+
+    // Clean the hop before anything else sees it; the ring stores the result
+    float pcm[HOP];
+    int16_t hop[HOP];
+    simd::s16_to_f32(raw, pcm, HOP, 1.0f / 32768.0f);
+    preprocess(pcm);
+    simd::f32_to_s16(pcm, hop, HOP, 32768.0f);
+    m_ring.write(hop, HOP);
+
+    const bool speech = m_vad.process(hop, HOP);
+    m_level.store(std::min(m_vad.lastRms() / LEVEL_FULL_SCALE_RMS, 1.0f));
+
+    // One mel frame per hop, shared by every consumer. This hop completes
+    // the frame centred one hop before it (see LogMel::FRAME_DELAY).
+    float frame[logmel::N_MEL];
+    if (m_mel.push(pcm, frame)) {
+        m_mels.write(position / HOP - (LogMel::FRAME_DELAY - 1), frame);
+    }
+
+    std::lock_guard<std::mutex> lock(m_stateMutex);
+    runWakeWord(speech, position);
+    updateUtterance(speech, position);
+}
+
+void VoiceFrontend::preprocess(float *pcm) {
+    const bool ns = m_nsEnabled.load();
+    const bool agc = m_agcEnabled.load();
+    if (!ns && !agc) {
+        m_nsActive = m_agcActive = false;
+        return;
+    }
+
+    const auto t0 = std::chrono::steady_clock::now();
+
+    // Stages start from a clean state whenever they're switched back on
+    if (ns && !m_nsActive) m_ns.reset();
+    if (agc && !m_agcActive) m_agc.reset();
+    m_nsActive = ns;
+    m_agcActive = agc;
+
+    if (ns) m_ns.process(pcm, pcm);
+    if (agc) m_agc.process(pcm, HOP, !ns || m_ns.frameSnr() > AGC_MIN_SNR);
+
+    const int64_t elapsedNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - t0).count();
+    m_ppHops.fetch_add(1, std::memory_order_relaxed);
+    m_ppTotalNs.fetch_add(elapsedNs, std::memory_order_relaxed);
+    if (elapsedNs > m_ppMaxNs.load(std::memory_order_relaxed)) {
+        m_ppMaxNs.store(elapsedNs, std::memory_order_relaxed);
+    }
+    if (elapsedNs > PREPROCESS_BUDGET_US * 1000LL) {
+        if (m_ppOverBudget.fetch_add(1, std::memory_order_relaxed) == 0) {
+            LOGD("Preprocessing took %lld us, over the %d us budget",
+                 (long long) (elapsedNs / 1000), PREPROCESS_BUDGET_US);
+        }
+    }
+}
+
+PreprocessStats VoiceFrontend::preprocessStats() const {
+    PreprocessStats stats;
+    stats.hops = m_ppHops.load(std::memory_order_relaxed);
+    const int64_t total = m_ppTotalNs.load(std::memory_order_relaxed);
+    stats.avgUs = stats.hops > 0 ? (float) total / (float) stats.hops / 1000.0f : 0.0f;
+    stats.maxUs = (float) m_ppMaxNs.load(std::memory_order_relaxed) / 1000.0f;
+    stats.overBudget = m_ppOverBudget.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void VoiceFrontend::runWakeWord(bool speech, int64_t position) {
+    // No wake word while an utterance is being captured
+    const bool capturing = m_utt.active && !m_utt.ended;
+    if (!m_wakeEnabled.load() || !m_kws || !m_kws->loaded() || capturing) {
+        m_kwsGateOpen = false;
+        return;
+    }
+
+    // Energy gate: the network only runs around speech
+    if (speech) m_lastSpeechPos = position;
+    const bool gate = m_lastSpeechPos >= 0 &&
+                      position - m_lastSpeechPos < ms_to_samples(KWS_GATE_HANGOVER_MS);
+    if (!gate) {
+        if (m_kwsGateOpen) {
+            m_kwsGateOpen = false;
+            m_kws->reset();
+        }
+        return;
+    }
+
+    if (!m_kwsGateOpen) {
+        // Replay the onset that opened the gate straight from the mel ring
+        m_kwsGateOpen = true;
+        m_kws->reset();
+        const int64_t sessionFrame = m_sessionStart.load() / HOP;
+        m_nextKwsFrame = std::max({m_mels.writeIndex() - KWS_ONSET_FRAMES, m_mels.oldestIndex(), sessionFrame});
+    }
+
+    if (feedKeywordSpotter(m_nextKwsFrame)) {
+        pushEvent(EVENT_WAKE_WORD, position + HOP, m_kws->lastScore());
+    }
+}
+
+// Push every mel frame the spotter hasn't seen yet; true on a detection
+bool VoiceFrontend::feedKeywordSpotter(int64_t fromFrame) {
+    float frame[logmel::N_MEL];
+    const int64_t end = m_mels.writeIndex();
+    for (m_nextKwsFrame = std::max(fromFrame, m_mels.oldestIndex()); m_nextKwsFrame < end; ) {
+        if (!m_mels.read(m_nextKwsFrame++, 1, frame)) continue;
+        if (m_kws->push(frame)) {
+            m_nextKwsFrame = end;
+            return true;
+        }
+    }
+    return false;
+}
+
+void VoiceFrontend::updateUtterance(bool speech, int64_t position) {
+    Utterance &u = m_utt;
+    if (!u.active || u.ended) return;
+
+    const int64_t end = position + HOP;
+    if (speech) {
+        if (!u.speechStarted) {
+            u.speechStarted = true;
+            pushEvent(EVENT_SPEECH_START, position);
+        }
+        u.silenceStart = -1;
+    } else if (u.speechStarted && end - u.begin > u.minSpeechSamples) {
+        if (u.silenceStart < 0) u.silenceStart = position;
+    }
+
+    switch (m_endpointer.update(u.silenceStart, end)) {
+        case Endpointer::HANGOVER:
+            LOGD("Utterance endpoint after %lld ms", (long long) ((end - u.begin) * 1000 / SAMPLE_RATE));
+            u.ended = true;
+            pushEvent(EVENT_SPEECH_END, end);
+            return;
+        case Endpointer::END_OF_TURN:
+            LOGD("End of turn after %lld ms (%lld ms pause, hypothesis stable %lld ms%s)",
+                 (long long) ((end - u.begin) * 1000 / SAMPLE_RATE),
+                 (long long) ((end - u.silenceStart) * 1000 / SAMPLE_RATE),
+                 (long long) (m_endpointer.stableSamples() * 1000 / SAMPLE_RATE),
+                 m_endpointer.sentenceConfirmedAfter(u.silenceStart) ? ", sentence closed" : "");
+            u.ended = true;
+            pushEvent(EVENT_END_OF_TURN, end);
+            return;
+        case Endpointer::CONTINUE:
+            break;
+    }
+
+    if (end - u.begin >= u.maxSamples) {
+        u.ended = true;
+        pushEvent(EVENT_UTTERANCE_TIMEOUT, end);
+    }
+}
+
+// ════════════════════════════════════════════════════════════════
+// Utterances
+// ════════════════════════════════════════════════════════════════
+
+void VoiceFrontend::beginUtterance(int preRollMs, int silenceMs, int minSpeechMs, int maxMs) {
+    std::lock_guard<std::mutex> lock(m_stateMutex);
+    const int64_t now = m_ring.writePos();
+    const int64_t earliest = std::max(m_ring.oldestPos(), m_sessionStart.load());
+
+    m_utt = Utterance();
+    m_utt.active = true;
+    m_utt.begin = now;
+    m_utt.start = std::max(now - ms_to_samples(std::max(preRollMs, 0)), earliest);
+    m_utt.silenceSamples = ms_to_samples(silenceMs);
+    m_endpointer.reset(m_utt.silenceSamples);
+    m_utt.minSpeechSamples = ms_to_samples(minSpeechMs);
+    m_utt.maxSamples = ms_to_samples(maxMs);
+}
+
+std::vector<float> VoiceFrontend::endUtterance() {
+    std::lock_guard<std::mutex> lock(m_stateMutex);
+    if (!m_utt.active) return {};
+    int64_t start = m_utt.start;
+    m_utt = Utterance();
+    m_lastUttStart = m_lastUttEnd = 0;
+
+    const int64_t end = m_ring.writePos();
+    start = std::max(start, m_ring.oldestPos());
+    if (end <= start) return {};
+
+    std::vector<int16_t> pcm((size_t) (end - start));
+    if (!m_ring.read(start, pcm.data(), pcm.size())) {
+        // Lapped by the writer — drop the oldest second and retry once
+        start = std::max(start, m_ring.oldestPos() + SAMPLE_RATE);
+        if (end <= start) return {};
+        pcm.resize((size_t) (end - start));
+        if (!m_ring.read(start, pcm.data(), pcm.size())) return {};
+    }
+    m_lastUttStart = start;
+    m_lastUttEnd = end;
+
+    std::vector<float> out(pcm.size());
+    simd::s16_to_f32(pcm.data(), out.data(), (int) pcm.size(), 1.0f / 32768.0f);
+    return out;
+}
+
+bool VoiceFrontend::lastUtteranceMel(std::vector<float> &mel, int &nFrames, float gain) {
+    int64_t start, end;
+    {
+        std::lock_guard<std::mutex> lock(m_stateMutex);
+        start = m_lastUttStart;
+        end = m_lastUttEnd;
+    }
+    return rangeMel(start, end, mel, nFrames, gain);
+}
+
+bool VoiceFrontend::currentUtteranceMel(std::vector<float> &mel, int &nFrames, int64_t &coveredEnd) {
+    int64_t start;
+    {
+        std::lock_guard<std::mutex> lock(m_stateMutex);
+        if (!m_utt.active || m_utt.ended || !m_utt.speechStarted) return false;
+        start = std::max(m_utt.start, m_ring.oldestPos());
+    }
+    const int64_t end = m_mels.writeIndex() * HOP;
+    if (!rangeMel(start, end, mel, nFrames, 1.0f)) return false;
+    coveredEnd = end;
+    return true;
+}
+
+void VoiceFrontend::reportHypothesis(const std::string &text, int64_t coveredEnd) {
+    std::lock_guard<std::mutex> lock(m_stateMutex);
+    if (!m_utt.active || m_utt.ended || coveredEnd <= m_utt.begin) return;
+    m_endpointer.onHypothesis(text, coveredEnd);
+}
+
+bool VoiceFrontend::rangeMel(int64_t start, int64_t end, std::vector<float> &mel, int &nFrames, float gain) {
+    if (end <= start) return false;
+
+    // Frames centred inside the utterance; the newest FRAME_DELAY hops of
+    // audio have no finished frame yet and are dropped (~20 ms)
+    const int64_t first = (start + HOP - 1) / HOP;
+    const int64_t last = std::min(end / HOP, m_mels.writeIndex());
+    if (last - first < 1) return false;
+
+    const size_t n = (size_t) (last - first);
+    std::vector<float> frames(n * logmel::N_MEL);
+    if (!m_mels.read(first, n, frames.data())) {
+        LOGD("Utterance mel frames no longer available");
+        return false;
+    }
+    LogMel::toWhisperMel(frames.data(), (int) n, mel, gain);
+    nFrames = (int) n;
+    return true;
+}
+
+// ════════════════════════════════════════════════════════════════
+// Events
+// ════════════════════════════════════════════════════════════════
+
+void VoiceFrontend::pushEvent(int type, int64_t position, float score) {
+    {
+        std::lock_guard<std::mutex> lock(m_eventMutex);
+        if (m_events.size() >= EVENT_QUEUE_MAX) m_events.pop_front();
+        m_events.push_back({type, position, score});
+    }
+    m_eventCv.notify_one();
+    if (auto *tap = m_eventTap.load()) tap->push({type, position, score});
+}
+
+bool VoiceFrontend::waitEvent(Event &out, int timeoutMs) {
+    std::unique_lock<std::mutex> lock(m_eventMutex);
+    m_eventCv.wait_for(lock, std::chrono::milliseconds(timeoutMs), [this] {
+        return !m_events.empty() || !m_running.load();
+    });
+    if (m_events.empty()) return false;
+    out = m_events.front();
+    m_events.pop_front();
+    return true;
+}
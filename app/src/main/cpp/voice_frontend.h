@@ -0,0 +1,202 @@
+/**
+ * Always-on native voice front end: one mic owner feeding wake word, VAD
+ * and utterance capture for whisper.
+ *
+ *   AAudio ──> worker (10 ms hops) ──> NoiseSuppressor ──> Agc ──> AudioRing (~32 s history)
+ *                 ├─ EnergyVad
+ *                 ├─ LogMel ──> MelRing ──> KeywordSpotter (gated by VAD)
+ *                 │                    └──> whisper input (lastUtteranceMel)
+ *                 └─ utterance endpointing (Endpointer: VAD silence + partial hypotheses)
+ *
+ * Consumers never open the mic themselves: the wake word fires an event,
+ * and STT takes its audio straight out of the ring, including pre-roll from
+ * before the utterance was requested. Everything downstream sees the
+ * preprocessed audio, which replaces the OEM-dependent platform effects.
+ * Mel frames are computed once per hop and shared, so whisper can skip its
+ * own STFT for captured utterances. Events are delivered through a small
+ * queue that Kotlin drains with waitEvent(), and optionally copied into a
+ * lock-free tap for the native voice pipeline (voice_pipeline.h).
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "agc.h"
+#include "audio_capture.h"
+#include "audio_ring.h"
+#include "endpointer.h"
+#include "energy_vad.h"
+#include "kws.h"
+#include "log_mel.h"
+#include "mel_ring.h"
+#include "noise_suppressor.h"
+#include "spsc_queue.h"
+
+namespace frontend {
+
+enum EventType {
+    EVENT_NONE = 0,
+    EVENT_WAKE_WORD = 1,
+    EVENT_SPEECH_START = 2,
+    EVENT_SPEECH_END = 3,         // utterance endpoint (VAD silence)
+    EVENT_UTTERANCE_TIMEOUT = 4,  // utterance hit its max duration
+    EVENT_CAPTURE_ERROR = 5,      // mic lost; the worker keeps retrying
+    EVENT_END_OF_TURN = 6,        // early endpoint: stable hypothesis + short pause
+};
+
+struct Event {
+    int type = EVENT_NONE;
+    int64_t position = 0;  // absolute sample position in the ring
+    float score = 0.0f;
+};
+
+// CPU cost of the preprocessing stage since capture started
+struct PreprocessStats {
+    int64_t hops = 0;
+    float avgUs = 0.0f;
+    float maxUs = 0.0f;
+    int64_t overBudget = 0;   // hops that took longer than PREPROCESS_BUDGET_US
+};
+
+} // namespace frontend
+
+class VoiceFrontend {
+public:
+    static constexpr int SAMPLE_RATE = logmel::SAMPLE_RATE;
+    static constexpr int HOP = logmel::HOP;
+    static constexpr size_t RING_SAMPLES = 1 << 19;  // ~32.7 s
+    static constexpr size_t MEL_RING_FRAMES = 1 << 12;  // ~41 s, covers the PCM ring
+    // Preprocessing budget per 10 ms hop (10% of real time on one core)
+    static constexpr int PREPROCESS_BUDGET_US = 1000;
+
+    static VoiceFrontend &instance();
+    ~VoiceFrontend() { stop(); }
+
+    // Open the mic and start the worker. Idempotent.
+    bool start();
+    void stop();
+    bool running() const { return m_running.load(); }
+
+    bool loadKeywordModel(const char *path, float threshold);
+    void setWakeEnabled(bool enabled) { m_wakeEnabled.store(enabled); }
+
+    // Bypass switches for the preprocessing stages (both on by default)
+    void setPreprocessing(bool noiseSuppression, bool agc) {
+        m_nsEnabled.store(noiseSuppression);
+        m_agcEnabled.store(agc);
+    }
+    frontend::PreprocessStats preprocessStats() const;
+
+    // Start collecting an utterance, reaching preRollMs back into the ring.
+    // Endpointing emits SPEECH_END after silenceMs of silence once speech
+    // has lasted minSpeechMs, END_OF_TURN earlier when the partial
+    // hypotheses say the user is done (see Endpointer), or
+    // UTTERANCE_TIMEOUT after maxMs.
+    void beginUtterance(int preRollMs, int silenceMs, int minSpeechMs, int maxMs);
+
+    // Whisper input for the utterance still being captured, up to the newest
+    // finished mel frame; coveredEnd receives the sample position that
+    // frame reaches. False before speech started or once it has ended.
+    bool currentUtteranceMel(std::vector<float> &mel, int &nFrames, int64_t &coveredEnd);
+
+    // Partial transcript of the active utterance up to coveredEnd, fed to
+    // the endpointer. Ignored if that utterance is no longer active.
+    void reportHypothesis(const std::string &text, int64_t coveredEnd);
+
+    // Finish the utterance and return its audio as [-1, 1] floats
+    std::vector<float> endUtterance();
+
+    // Whisper input for the utterance last returned by endUtterance(), built
+    // from the shared mel frames (see LogMel::toWhisperMel) with the gain the
+    // caller applied to that audio. False if the frames are gone or there
+    // was no utterance.
+    bool lastUtteranceMel(std::vector<float> &mel, int &nFrames, float gain = 1.0f);
+
+    bool waitEvent(frontend::Event &out, int timeoutMs);
+
+    // Also push every event into `tap` (nullptr to detach) without taking it
+    // from waitEvent()'s queue. The worker thread is the tap's only producer;
+    // the queue must outlive the front end.
+    void setEventTap(SpscQueue<frontend::Event> *tap) { m_eventTap.store(tap); }
+
+    // Mic level of the last hop, 0..1 (same scale as AudioRecorder)
+    float level() const { return m_level.load(); }
+
+    const AudioRing &ring() const { return m_ring; }
+    const MelRing &mels() const { return m_mels; }
+
+private:
+    VoiceFrontend();
+
+    struct Utterance {
+        bool active = false;
+        bool ended = false;
+        int64_t start = 0;        // first sample returned (includes pre-roll)
+        int64_t begin = 0;        // position when the utterance was requested
+        int64_t silenceStart = -1;
+        bool speechStarted = false;
+        int64_t silenceSamples = 0;
+        int64_t minSpeechSamples = 0;
+        int64_t maxSamples = 0;
+    };
+
+    void run();
+    void processHop(const int16_t *raw, int64_t position);
+    void preprocess(float *pcm);
+    void runWakeWord(bool speech, int64_t position);
+    bool feedKeywordSpotter(int64_t fromFrame);
+    void updateUtterance(bool speech, int64_t position);
+    bool rangeMel(int64_t start, int64_t end, std::vector<float> &mel, int &nFrames, float gain);
+    void pushEvent(int type, int64_t position, float score = 0.0f);
+
+    AudioCapture m_capture;
+    NoiseSuppressor m_ns;
+    Agc m_agc;
+    AudioRing m_ring;
+    EnergyVad m_vad;
+    LogMel m_mel;
+    MelRing m_mels;
+
+    std::thread m_worker;
+    std::atomic<bool> m_running{false};
+    std::atomic<int64_t> m_sessionStart{0};  // ring position when capture started
+    std::mutex m_lifecycleMutex;  // start/stop
+
+    std::mutex m_stateMutex;      // utterance + keyword model
+    Utterance m_utt;
+    Endpointer m_endpointer;
+    int64_t m_lastUttStart = 0;   // sample range of the last finished utterance
+    int64_t m_lastUttEnd = 0;
+    std::unique_ptr<KeywordSpotter> m_kws;
+    std::atomic<bool> m_wakeEnabled{false};
+
+    int64_t m_nextKwsFrame = 0;   // next mel frame the spotter hasn't seen
+    int64_t m_lastSpeechPos = -1;
+    bool m_kwsGateOpen = false;
+
+    std::mutex m_eventMutex;
+    std::condition_variable m_eventCv;
+    std::deque<frontend::Event> m_events;
+    std::atomic<SpscQueue<frontend::Event> *> m_eventTap{nullptr};
+
+    std::atomic<float> m_level{0.0f};
+
+    // Preprocessing (worker thread) + its cost, readable from any thread
+    std::atomic<bool> m_nsEnabled{true};
+    std::atomic<bool> m_agcEnabled{true};
+    bool m_nsActive = false;
+    bool m_agcActive = false;
+    std::atomic<int64_t> m_ppHops{0};
+    std::atomic<int64_t> m_ppTotalNs{0};
+    std::atomic<int64_t> m_ppMaxNs{0};
+    std::atomic<int64_t> m_ppOverBudget{0};
+};
@@ -0,0 +1,497 @@
+/**
+ * Native offline voice pipeline — see voice_pipeline.h.
+ */
+
+#include "voice_pipeline.h"
+
+#include "stage_api.h"
+#include "trace.h"
+
+#include <android/log.h>
+#include <dlfcn.h>
+
+#include <algorithm>
+#include <cmath>
+
+#define LOG_TAG "NovaPipeline"
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+#define LOGD(...) __android_log_print(ANDROID_LOG_DEBUG, LOG_TAG, __VA_ARGS__)
+
+using namespace pipeline;
+
+static constexpr size_t EVENT_QUEUE_MAX = 512;
+
+// AudioRecorder's whole-utterance gain normalization
+static constexpr float GAIN_TARGET = 0.7f;
+static constexpr float GAIN_MIN = 0.1f;
+static constexpr float GAIN_MAX = 10.0f;
+
+// ════════════════════════════════════════════════════════════════
+// Stages in the other libraries (stage_api.h)
+// ════════════════════════════════════════════════════════════════
+
+struct Stages {
+    decltype(&nova_llama_ready) llamaReady = nullptr;
+    decltype(&nova_llama_generate) llamaGenerate = nullptr;
+    decltype(&nova_llama_cancel) llamaCancel = nullptr;
+    decltype(&nova_piper_ready) piperReady = nullptr;
+    decltype(&nova_piper_stream_begin) piperBegin = nullptr;
+    decltype(&nova_piper_stream_append) piperAppend = nullptr;
+    decltype(&nova_piper_stream_finish) piperFinish = nullptr;
+    decltype(&nova_piper_stream_cancel) piperCancel = nullptr;
+};
+
+static Stages g_stages;
+
+// Handles stay open: the libraries belong to the app's class loader anyway
+static void *open_stage(const char *library) {
+    // Normally Kotlin has loaded it already; load it ourselves otherwise
+    void *handle = dlopen(library, RTLD_NOW | RTLD_NOLOAD);
+    if (!handle) handle = dlopen(library, RTLD_NOW);
+    if (!handle) LOGE("%s not available: %s", library, dlerror());
+    return handle;
+}
+
+template <typename Fn>
+static bool resolve(void *handle, const char *name, Fn &fn) {
+    fn = handle ? reinterpret_cast<Fn>(dlsym(handle, name)) : nullptr;
+    if (handle && !fn) LOGE("Missing stage entry point %s", name);
+    return fn != nullptr;
+}
+
+static bool resolve_llama() {
+    if (g_stages.llamaGenerate) return true;
+    void *lib = open_stage("libnova_llama.so");
+    bool ok = resolve(lib, "nova_llama_ready", g_stages.llamaReady);
+    ok = resolve(lib, "nova_llama_generate", g_stages.llamaGenerate) && ok;
+    ok = resolve(lib, "nova_llama_cancel", g_stages.llamaCancel) && ok;
+    if (!ok) g_stages.llamaGenerate = nullptr;
+    return ok;
+}
+
+static bool resolve_piper() {
+    if (g_stages.piperBegin) return true;
+    void *lib = open_stage("libnova_piper.so");
+    bool ok = resolve(lib, "nova_piper_ready", g_stages.piperReady);
+    ok = resolve(lib, "nova_piper_stream_begin", g_stages.piperBegin) && ok;
+    ok = resolve(lib, "nova_piper_stream_append", g_stages.piperAppend) && ok;
+    ok = resolve(lib, "nova_piper_stream_finish", g_stages.piperFinish) && ok;
+    ok = resolve(lib, "nova_piper_stream_cancel", g_stages.piperCancel) && ok;
+    if (!ok) g_stages.piperBegin = nullptr;
+    return ok;
+}
+
+static std::string trimmed(const std::string &text) {
+    const size_t first = text.find_first_not_of(" \t\n");
+    if (first == std::string::npos) return "";
+    const size_t last = text.find_last_not_of(" \t\n");
+    return text.substr(first, last - first + 1);
+}
+
+// Gain that brings the utterance's peak to GAIN_TARGET
+static float utterance_gain(const std::vector<float> &pcm) {
+    float peak = 0.0f;
+    for (float v : pcm) peak = std::max(peak, std::fabs(v));
+    if (peak <= 0.0f) return 1.0f;
+    return std::max(GAIN_MIN, std::min(GAIN_MAX, GAIN_TARGET / peak));
+}
+
+VoicePipeline &VoicePipeline::instance() {
+    static VoicePipeline pipeline;
+    return pipeline;
+}
+
+// ════════════════════════════════════════════════════════════════
+// Lifecycle
+// ════════════════════════════════════════════════════════════════
+
+int VoicePipeline::start(const Config &config) {
+    std::lock_guard<std::mutex> lock(m_lifecycleMutex);
+    if (m_running.load()) return START_OK;
+
+    if (!stt::ready()) return START_NO_STT;
+    if (!resolve_llama() || !g_stages.llamaReady()) return START_NO_LLM;
+    if (!resolve_piper() || !g_stages.piperReady()) return START_NO_TTS;
+    if (!m_output.open()) return START_NO_SPEAKER;
+
+    // The tap has no consumer yet, so it can be emptied here
+    frontend::Event stale;
+    while (m_frontendEvents.pop(stale)) {}
+    VoiceFrontend &frontend = VoiceFrontend::instance();
+    frontend.setEventTap(&m_frontendEvents);
+    if (!frontend.start()) {
+        frontend.setEventTap(nullptr);
+        m_output.close();
+        return START_NO_MIC;
+    }
+
+    m_config = config;
+    m_history.clear();
+    m_phase = LISTENING;
+    m_utteranceActive = false;
+    m_speechStarted = false;
+    m_outputLost = false;
+    m_turnPending = false;
+    m_finishedId.store(m_replyId.load());
+    {
+        std::lock_guard<std::mutex> eventLock(m_eventMutex);
+        m_events.clear();
+    }
+
+    m_running.store(true);
+    m_replies = std::thread(&VoicePipeline::runReplies, this);
+    m_control = std::thread(&VoicePipeline::runControl, this);
+    LOGI("Voice pipeline started (language %s, barge-in %s, output %d Hz)",
+         m_config.language.c_str(), m_config.bargeIn ? "on" : "off", m_output.sampleRate());
+    return START_OK;
+}
+
+// The mic stays with the front end (other owners may still need it)
+void VoicePipeline::stop() {
+    std::lock_guard<std::mutex> lock(m_lifecycleMutex);
+    if (!m_running.load()) return;
+
+    m_running.store(false);
+    m_replyId++;
+    if (g_stages.llamaCancel) g_stages.llamaCancel();
+    m_turnCv.notify_all();
+    m_eventCv.notify_all();
+    if (m_control.joinable()) m_control.join();
+    if (m_replies.joinable()) m_replies.join();   // cancels its Piper session on the way out
+
+    VoiceFrontend &frontend = VoiceFrontend::instance();
+    frontend.setEventTap(nullptr);
+    if (m_utteranceActive) frontend.endUtterance();
+    m_utteranceActive = false;
+    m_output.close();
+    LOGI("Voice pipeline stopped");
+}
+
+// ════════════════════════════════════════════════════════════════
+// Control thread: endpointing, STT, barge-in, playback progress
+// ════════════════════════════════════════════════════════════════
+
+void VoicePipeline::runControl() {
+    listen();
+    while (m_running.load()) {
+        frontend::Event event;
+        while (m_running.load() && m_frontendEvents.pop(event)) {
+            switch (event.type) {
+                case frontend::EVENT_SPEECH_START:
+                    if (!m_utteranceActive) break;
+                    m_speechStarted = true;
+                    m_lastPartial = Clock::now();
+                    if (m_phase != LISTENING) bargeIn();
+                    pushEvent(EVENT_SPEECH_START);
+                    break;
+                case frontend::EVENT_SPEECH_END:
+                case frontend::EVENT_END_OF_TURN:
+                case frontend::EVENT_UTTERANCE_TIMEOUT:
+                    if (m_utteranceActive) finishUtterance();
+                    break;
+                case frontend::EVENT_CAPTURE_ERROR:
+                    pushEvent(EVENT_ERROR, "Microphone lost");
+                    break;
+                default:
+                    break;
+            }
+        }
+        if (!m_running.load()) break;
+
+        // Streaming hypotheses: live text, and the endpointer's early end of turn
+        if (m_phase == LISTENING && m_speechStarted &&
+            Clock::now() - m_lastPartial >= std::chrono::milliseconds(PARTIAL_INTERVAL_MS)) {
+            const std::string text = stt::partial(m_config.language);
+            m_lastPartial = Clock::now();
+            if (!text.empty()) pushEvent(EVENT_PARTIAL, text);
+        }
+
+        checkPlayback();
+        std::this_thread::sleep_for(std::chrono::milliseconds(POLL_MS));
+    }
+}
+
+void VoicePipeline::listen() {
+    VoiceFrontend::instance().beginUtterance(PRE_ROLL_MS, SILENCE_MS, MIN_SPEECH_MS, MAX_UTTERANCE_MS);
+    m_utteranceActive = true;
+    m_speechStarted = false;
+    pushEvent(EVENT_LISTENING);
+}
+
+void VoicePipeline::finishUtterance() {
+    const bool speech = m_speechStarted;
+    std::vector<float> pcm = VoiceFrontend::instance().endUtterance();
+    m_utteranceActive = false;
+    m_speechStarted = false;
+    if (!speech || pcm.empty()) {
+        // Timed out without speech (e.g. while a reply was playing): re-arm
+        listen();
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_statsMutex);
+        m_endpointAt = Clock::now();
+        m_latency = TurnLatency();
+    }
+    trace::instant("pipeline", "pipeline.endpoint", "samples", (int64_t) pcm.size());
+
+    std::string text;
+    if (!stt::transcribe(pcm, utterance_gain(pcm), m_config.language, text)) {
+        pushEvent(EVENT_ERROR, "Transcription failed");
+    }
+    text = trimmed(text);
+    const float sttMs = msSinceEndpoint();
+    {
+        std::lock_guard<std::mutex> lock(m_statsMutex);
+        m_latency.sttMs = sttMs;
+    }
+    if (text.empty()) {
+        listen();
+        return;
+    }
+    LOGI("Transcript in %.0f ms: \"%s\"", sttMs, text.c_str());
+    pushEvent(EVENT_TRANSCRIPT, text, sttMs);
+
+    m_replyHeard = false;
+    m_replyPlayedFrom = m_output.playedSamples();
+    {
+        std::lock_guard<std::mutex> lock(m_turnMutex);
+        m_pendingTurn = std::move(text);
+        m_pendingId = ++m_replyId;
+        m_turnPending = true;
+    }
+    m_turnCv.notify_one();
+    m_phase = THINKING;
+
+    // Full duplex: keep listening so the user can cut the reply off
+    if (m_config.bargeIn) listen();
+}
+
+// The user started talking over the reply: drop it everywhere at once.
+// The reply thread sees the new id and tears down its Piper session.
+void VoicePipeline::bargeIn() {
+    m_replyId++;
+    {
+        std::lock_guard<std::mutex> lock(m_turnMutex);
+        m_turnPending = false;
+    }
+    g_stages.llamaCancel();
+    m_output.flush();
+    m_phase = LISTENING;
+    LOGI("Barge-in");
+    trace::instant("pipeline", "pipeline.barge_in");
+    pushEvent(EVENT_BARGE_IN);
+}
+
+void VoicePipeline::checkPlayback() {
+    if (m_output.disconnected() || !m_output.isOpen()) reopenOutput();
+    if (m_phase == LISTENING) return;
+
+    if (!m_replyHeard && m_output.playedSamples() > m_replyPlayedFrom) {
+        m_replyHeard = true;
+        m_phase = SPEAKING;
+        const float ms = msSinceEndpoint();
+        {
+            std::lock_guard<std::mutex> lock(m_statsMutex);
+            m_latency.mouthToEarMs = ms;
+        }
+        LOGI("First audio out %.0f ms after the endpoint", ms);
+        trace::instant("pipeline", "pipeline.first_audio_played", "ms", (int64_t) ms);
+        pushEvent(EVENT_SPEAKING, std::string(), ms);
+    }
+
+    if (finished(m_replyId.load()) && m_output.idle()) {
+        m_phase = LISTENING;
+        pushEvent(EVENT_TURN_DONE);
+        // Half duplex: the mic re-arms only once the speaker is quiet
+        if (!m_utteranceActive) listen();
+    }
+}
+
+// The speaker went away (headset unplugged, route change): AAudio stops
+// calling back, so the fifo would never drain and the turn never end.
+// Drop the reply in progress, open a stream on the new device and go
+// back to listening. Retried every OUTPUT_RETRY_MS while that fails.
+void VoicePipeline::reopenOutput() {
+    if (m_outputLost && Clock::now() < m_outputRetryAt) return;
+    LOGI("Output device lost, reopening");
+    trace::instant("pipeline", "pipeline.output_reopen");
+    const bool replying = m_phase != LISTENING;
+    if (replying) {
+        m_replyId++;   // the reply thread cancels its Piper session
+        {
+            std::lock_guard<std::mutex> lock(m_turnMutex);
+            m_turnPending = false;
+        }
+        g_stages.llamaCancel();
+    }
+    m_output.flush();
+    m_output.close();
+    if (m_output.open()) {
+        m_outputLost = false;
+    } else {
+        if (!m_outputLost) pushEvent(EVENT_ERROR, "Speaker lost");
+        m_outputLost = true;
+        m_outputRetryAt = Clock::now() + std::chrono::milliseconds(OUTPUT_RETRY_MS);
+    }
+    if (replying) {
+        m_phase = LISTENING;
+        pushEvent(EVENT_TURN_DONE);
+        if (!m_utteranceActive) listen();
+    }
+}
+
+// ════════════════════════════════════════════════════════════════
+// Reply thread: llama → Piper
+// ════════════════════════════════════════════════════════════════
+
+// Same ChatML layout as NovaInference.formatPrompt
+std::string VoicePipeline::buildPrompt(const std::string &userText) const {
+    std::string prompt = "<|im_start|>system\n" + m_config.systemPrompt + "<|im_end|>\n";
+    for (const auto &turn : m_history) {
+        prompt += "<|im_start|>user\n" + turn.first + "<|im_end|>\n";
+        prompt += "<|im_start|>assistant\n" + turn.second + "<|im_end|>\n";
+    }
+    prompt += "<|im_start|>user\n" + userText + "<|im_end|>\n<|im_start|>assistant\n";
+    return prompt;
+}
+
+void VoicePipeline::runReplies() {
+    while (true) {
+        std::string userText;
+        Reply reply;
+        reply.self = this;
+        {
+            std::unique_lock<std::mutex> lock(m_turnMutex);
+            m_turnCv.wait(lock, [this] { return !m_running.load() || m_turnPending; });
+            if (!m_running.load()) break;
+            userText = std::move(m_pendingTurn);
+            reply.id = m_pendingId;
+            m_turnPending = false;
+        }
+        if (!current(reply)) continue;
+
+        trace::Scope span("pipeline", "pipeline.reply");
+        const std::string prompt = buildPrompt(userText);
+        const bool speaking = g_stages.piperBegin(m_output.sampleRate(), &VoicePipeline::onAudio, &reply) != 0;
+        if (!speaking) pushEvent(EVENT_ERROR, "No Piper voice");
+
+        std::vector<const char *> stops;
+        for (const auto &stop : m_config.stopStrings) stops.push_back(stop.c_str());
+        const int tokens = g_stages.llamaGenerate(prompt.c_str(), m_config.maxTokens, m_config.temperature,
+                                                  m_config.topP, stops.data(), (int) stops.size(),
+                                                  &VoicePipeline::onToken, &reply);
+
+        if (!m_running.load() || !current(reply)) {
+            // Barged in or stopping; joins the Piper pump, which holds &reply
+            if (speaking) g_stages.piperCancel();
+            continue;
+        }
+        if (tokens < 0) {
+            pushEvent(EVENT_ERROR, "Generation failed");
+            if (speaking) g_stages.piperCancel();
+            markFinished(reply.id);
+            continue;
+        }
+
+        const std::string text = trimmed(reply.text);
+        LOGI("Reply: %d tokens, \"%s\"", tokens, text.c_str());
+        pushEvent(EVENT_REPLY, text, (float) tokens);
+        m_history.emplace_back(userText, text);
+        while ((int) m_history.size() > std::max(0, m_config.maxHistoryTurns)) m_history.pop_front();
+
+        if (!speaking) {
+            markFinished(reply.id);
+            continue;
+        }
+        g_stages.piperFinish();
+        // The Piper pump holds &reply until its last callback
+        while (m_running.load() && current(reply) && !finished(reply.id)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(POLL_MS));
+        }
+        if (!m_running.load() || !current(reply)) g_stages.piperCancel();
+    }
+}
+
+// Ids only grow, so a late store for an older reply never hides a newer one
+void VoicePipeline::markFinished(uint64_t id) {
+    uint64_t seen = m_finishedId.load();
+    while (seen < id && !m_finishedId.compare_exchange_weak(seen, id)) {}
+}
+
+// llama's decode thread
+int VoicePipeline::onToken(void *user, const char *piece) {
+    auto *reply = static_cast<Reply *>(user);
+    VoicePipeline *self = reply->self;
+    if (!self->m_running.load() || !self->current(*reply)) return 0;
+
+    if (reply->firstToken) {
+        reply->firstToken = false;
+        const float ms = self->msSinceEndpoint();
+        trace::instant("pipeline", "pipeline.first_token", "ms", (int64_t) ms);
+        std::lock_guard<std::mutex> lock(self->m_statsMutex);
+        self->m_latency.firstTokenMs = ms;
+    }
+    reply->text += piece;
+    g_stages.piperAppend(piece);
+    self->pushEvent(EVENT_TOKEN, piece);
+    return 1;
+}
+
+// Piper's pump thread
+int VoicePipeline::onAudio(void *user, const int16_t *pcm, size_t n, int last) {
+    auto *reply = static_cast<Reply *>(user);
+    VoicePipeline *self = reply->self;
+    if (!self->m_running.load() || !self->current(*reply)) return 0;
+
+    if (last) {
+        self->markFinished(reply->id);
+        return 1;
+    }
+    if (reply->firstAudio) {
+        reply->firstAudio = false;
+        const float ms = self->msSinceEndpoint();
+        trace::instant("pipeline", "pipeline.first_audio", "ms", (int64_t) ms);
+        std::lock_guard<std::mutex> lock(self->m_statsMutex);
+        self->m_latency.firstAudioMs = ms;
+    }
+    return self->m_output.write(pcm, n, [self, reply] {
+        return self->m_running.load() && self->current(*reply);
+    }) ? 1 : 0;
+}
+
+// ════════════════════════════════════════════════════════════════
+// Events + stats
+// ════════════════════════════════════════════════════════════════
+
+float VoicePipeline::msSinceEndpoint() const {
+    std::lock_guard<std::mutex> lock(m_statsMutex);
+    return std::chrono::duration<float, std::milli>(Clock::now() - m_endpointAt).count();
+}
+
+TurnLatency VoicePipeline::lastTurnLatency() const {
+    std::lock_guard<std::mutex> lock(m_statsMutex);
+    return m_latency;
+}
+
+void VoicePipeline::pushEvent(int type, std::string text, float value) {
+    {
+        std::lock_guard<std::mutex> lock(m_eventMutex);
+        if (m_events.size() >= EVENT_QUEUE_MAX) m_events.pop_front();
+        m_events.push_back({type, std::move(text), value});
+    }
+    m_eventCv.notify_one();
+}
+
+bool VoicePipeline::waitEvent(Event &out, int timeoutMs) {
+    std::unique_lock<std::mutex> lock(m_eventMutex);
+    m_eventCv.wait_for(lock, std::chrono::milliseconds(timeoutMs), [this] {
+        return !m_events.empty() || !m_running.load();
+    });
+    if (m_events.empty()) return false;
+    out = std::move(m_events.front());
+    m_events.pop_front();
+    return true;
+}
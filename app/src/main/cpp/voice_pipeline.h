@@ -0,0 +1,212 @@
+/**
+ * Native offline voice pipeline: mic to speaker in one engine, with no
+ * Kotlin hop between stages.
+ *
+ *   VoiceFrontend ──(event tap, SpscQueue)──> control thread
+ *     AudioRing / MelRing ──> stt::partial every PARTIAL_INTERVAL_MS ──> endpointer
+ *     endpoint ──> stt::transcribe (shared mel frames) ──> turn
+ *   reply thread: nova_llama_generate ──token──> nova_piper_stream_append
+ *   Piper pump ──PCM──> AudioPlayback fifo (SpscQueue) ──> AAudio callback
+ *
+ * Every stage streams into the next: the reply starts synthesizing at the
+ * first clause while llama is still decoding, and audio plays as soon as
+ * the first piece is rendered. llama and Piper live in their own libraries
+ * and are driven through stage_api.h. Kotlin only starts and stops the
+ * pipeline and drains its events (transcripts, tokens, state changes) with
+ * waitEvent().
+ *
+ * Barge-in (optional) keeps the mic armed while replying: speech start
+ * cancels generation, drops unsynthesized text and flushes the speaker.
+ * This needs a headset or a capture path with echo cancellation; otherwise
+ * the pipeline is half-duplex and re-arms the mic once playback finishes.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "audio_playback.h"
+#include "spsc_queue.h"
+#include "voice_frontend.h"
+
+// STT stage, implemented in whisper_jni.cpp next to the context it uses
+namespace stt {
+bool ready();
+// Hypothesis of the utterance in progress, also fed to the endpointer
+std::string partial(const std::string &language);
+// Final text of the front end's last utterance: shared mel frames if they
+// are still there, else pcm (gain applied in place). False on failure.
+bool transcribe(std::vector<float> &pcm, float gain, const std::string &language, std::string &text);
+} // namespace stt
+
+namespace pipeline {
+
+enum EventType {
+    EVENT_NONE = 0,
+    EVENT_LISTENING = 1,     // mic armed for the next utterance
+    EVENT_SPEECH_START = 2,
+    EVENT_PARTIAL = 3,       // text: hypothesis so far
+    EVENT_TRANSCRIPT = 4,    // text: final utterance; value: STT ms after the endpoint
+    EVENT_TOKEN = 5,         // text: one piece of the reply
+    EVENT_SPEAKING = 6,      // first reply audio played; value: mouth-to-ear ms
+    EVENT_REPLY = 7,         // text: the whole reply; value: tokens generated
+    EVENT_TURN_DONE = 8,     // reply finished playing
+    EVENT_BARGE_IN = 9,      // reply cut off by the user
+    EVENT_ERROR = 10,        // text: what failed
+};
+
+// Values of start()'s result
+enum StartResult {
+    START_OK = 0,
+    START_NO_STT = -1,       // no whisper model
+    START_NO_LLM = -2,       // libnova_llama missing or no model loaded
+    START_NO_TTS = -3,       // libnova_piper missing or no active voice
+    START_NO_MIC = -4,
+    START_NO_SPEAKER = -5,
+};
+
+struct Event {
+    int type = EVENT_NONE;
+    std::string text;
+    float value = 0.0f;
+};
+
+struct Config {
+    std::string systemPrompt;
+    std::string language = "auto";
+    std::vector<std::string> stopStrings;
+    int maxTokens = 256;
+    float temperature = 0.7f;
+    float topP = 0.85f;
+    int maxHistoryTurns = 4;
+    bool bargeIn = false;
+};
+
+// Milliseconds from the endpoint of the last turn to each stage's first output
+struct TurnLatency {
+    float sttMs = 0.0f;
+    float firstTokenMs = 0.0f;
+    float firstAudioMs = 0.0f;   // first PCM rendered
+    float mouthToEarMs = 0.0f;   // first PCM played
+};
+
+} // namespace pipeline
+
+class VoicePipeline {
+public:
+    // Endpointing for pipeline turns (same scale as NovaVoicePipeline's follow-ups)
+    static constexpr int PRE_ROLL_MS = 300;
+    static constexpr int SILENCE_MS = 1200;
+    static constexpr int MIN_SPEECH_MS = 300;
+    static constexpr int MAX_UTTERANCE_MS = 12000;
+    static constexpr int PARTIAL_INTERVAL_MS = 300;
+    // Control loop period: bounds how late an endpoint or the first played
+    // sample is noticed (one front-end hop)
+    static constexpr int POLL_MS = 10;
+    // Speaker fifo: ~680 ms at 48 kHz, how far synthesis may run ahead
+    static constexpr size_t OUTPUT_FIFO_SAMPLES = 1 << 15;
+    // Retry period while no output device can be opened
+    static constexpr int OUTPUT_RETRY_MS = 1000;
+
+    static VoicePipeline &instance();
+    ~VoicePipeline() { stop(); }
+
+    // Resolve the stages, open mic and speaker and start listening.
+    // Returns a pipeline::StartResult.
+    int start(const pipeline::Config &config);
+    void stop();
+    bool running() const { return m_running.load(); }
+
+    bool waitEvent(pipeline::Event &out, int timeoutMs);
+    pipeline::TurnLatency lastTurnLatency() const;
+
+private:
+    VoicePipeline() : m_frontendEvents(EVENT_TAP_CAPACITY), m_output(OUTPUT_FIFO_SAMPLES) {}
+
+    static constexpr size_t EVENT_TAP_CAPACITY = 64;
+
+    enum Phase { LISTENING, THINKING, SPEAKING };
+
+    using Clock = std::chrono::steady_clock;
+
+    // One reply in flight; the stage callbacks get it as their user pointer
+    struct Reply {
+        VoicePipeline *self = nullptr;
+        uint64_t id = 0;
+        std::string text;
+        bool firstToken = true;
+        bool firstAudio = true;
+    };
+
+    void runControl();
+    void runReplies();
+    void listen();
+    void finishUtterance();
+    void bargeIn();
+    void checkPlayback();
+    void reopenOutput();
+    std::string buildPrompt(const std::string &userText) const;
+
+    static int onToken(void *user, const char *piece);
+    static int onAudio(void *user, const int16_t *pcm, size_t n, int last);
+
+    bool current(const Reply &reply) const { return reply.id == m_replyId.load(); }
+    bool finished(uint64_t id) const { return m_finishedId.load() >= id; }
+    void markFinished(uint64_t id);
+    float msSinceEndpoint() const;
+    void pushEvent(int type, std::string text = std::string(), float value = 0.0f);
+
+    pipeline::Config m_config;
+    std::atomic<bool> m_running{false};
+    std::mutex m_lifecycleMutex;   // start/stop
+
+    SpscQueue<frontend::Event> m_frontendEvents;
+    AudioPlayback m_output;
+    std::thread m_control;
+    std::thread m_replies;
+
+    // Control thread only
+    Phase m_phase = LISTENING;
+    bool m_utteranceActive = false;
+    bool m_speechStarted = false;
+    Clock::time_point m_lastPartial;
+    int64_t m_replyPlayedFrom = 0;   // m_output.playedSamples() when the reply was submitted
+    bool m_replyHeard = false;
+    bool m_outputLost = false;         // reopening the speaker failed
+    Clock::time_point m_outputRetryAt;
+
+    // Control → reply thread: one turn at a time
+    std::mutex m_turnMutex;
+    std::condition_variable m_turnCv;
+    std::string m_pendingTurn;
+    uint64_t m_pendingId = 0;
+    bool m_turnPending = false;
+
+    // Bumped per turn and on barge-in; stage callbacks of older replies stop
+    std::atomic<uint64_t> m_replyId{0};
+    // Latest reply whose last audio was queued. An id rather than a flag, so
+    // a reply that finishes just as a barge-in starts the next turn can't
+    // mark that turn finished
+    std::atomic<uint64_t> m_finishedId{0};
+
+    // Reply thread only
+    std::deque<std::pair<std::string, std::string>> m_history;
+
+    // Turn timing, relative to the endpoint
+    mutable std::mutex m_statsMutex;
+    Clock::time_point m_endpointAt;
+    pipeline::TurnLatency m_latency;
+
+    std::mutex m_eventMutex;
+    std::condition_variable m_eventCv;
+    std::deque<pipeline::Event> m_events;
+};
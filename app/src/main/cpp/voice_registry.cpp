@@ -0,0 +1,211 @@
+/**
+ * Resident Piper voices — see voice_registry.h.
+ */
+
+#include "voice_registry.h"
+
+#include <android/log.h>
+
+#include <cstdio>
+#include <iterator>
+
+#define LOG_TAG "VoiceRegistry"
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
+#define LOGW(...) __android_log_print(ANDROID_LOG_WARN, LOG_TAG, __VA_ARGS__)
+
+std::shared_ptr<Ort::Env> VoiceRegistry::env() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_env) {
+        Ort::ThreadingOptions threading;
+        threading.SetGlobalIntraOpNumThreads(m_config.threads);
+        threading.SetGlobalInterOpNumThreads(1);
+        threading.SetGlobalSpinControl(0);   // don't spin-wait between sentences
+        m_env = std::make_shared<Ort::Env>(threading, ORT_LOGGING_LEVEL_WARNING, "nova_piper");
+        m_env->DisableTelemetryEvents();
+        m_envThreads = m_config.threads;
+        LOGI("ONNX Runtime env: %d intra-op thread(s)", m_envThreads);
+    }
+    return m_env;
+}
+
+// ownThreads: a private intra-op pool instead of the env's global one
+Ort::SessionOptions VoiceRegistry::sessionOptions(const SessionConfig &config, bool ownThreads) {
+    Ort::SessionOptions options;
+    if (ownThreads) {
+        options.SetIntraOpNumThreads(config.threads);
+        options.SetInterOpNumThreads(1);
+    } else {
+        options.DisablePerSessionThreads();
+    }
+    options.SetExecutionMode(ORT_SEQUENTIAL);
+    options.SetGraphOptimizationLevel((GraphOptimizationLevel) config.optimization);
+    if (!config.cpuArena) options.DisableCpuMemArena();
+    if (!config.memPattern) options.DisableMemPattern();
+    if (config.xnnpack) {
+        try {
+            options.AppendExecutionProvider("XNNPACK", {{"intra_op_num_threads", std::to_string(config.threads)}});
+        } catch (const Ort::Exception &e) {
+            LOGW("XNNPACK unavailable, using the CPU provider: %s", e.what());
+        }
+    }
+    return options;
+}
+
+void VoiceRegistry::configure(const SessionConfig &config) {
+    SessionConfig next = config;
+    if (next.threads < 1) next.threads = 1;
+    if (next.optimization != 0 && next.optimization != 1 && next.optimization != 2) next.optimization = 99;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (next == m_config) return;
+    LOGI("Session config: %d thread(s), opt %d, arena %d, mem pattern %d, xnnpack %d",
+         next.threads, next.optimization, next.cpuArena, next.memPattern, next.xnnpack);
+    m_config = next;
+    // Sessions keep the options they were created with; reload under the new ones
+    m_active.reset();
+    m_voices.clear();
+
+    if (m_env && next.threads != m_envThreads) {
+        // ORT keeps one process-wide env: constructing another while this one
+        // is alive hands back the same instance, thread pool and all. Only
+        // rebuild once nothing else holds it; a synthesis or standalone voice
+        // still running keeps the old thread count until the next configure().
+        std::weak_ptr<Ort::Env> old = m_env;
+        m_env.reset();
+        m_env = old.lock();
+        if (m_env) {
+            LOGW("ONNX Runtime env still in use; intra-op threads stay at %d", m_envThreads);
+            m_config.threads = m_envThreads;
+        }
+    }
+}
+
+SessionConfig VoiceRegistry::config() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_config;
+}
+
+std::unique_ptr<PiperVoice> VoiceRegistry::openStandalone(const std::string &modelPath,
+                                                          const std::string &configPath,
+                                                          const SessionConfig &config) {
+    return PiperVoice::load(modelPath, configPath, env(), sessionOptions(config, true));
+}
+
+QuantizationReport VoiceRegistry::inspectOptimized(const std::string &modelPath, const std::string &scratchPath) {
+    // Nodes claimed by XNNPACK are compiled and can't be saved; inspect the
+    // CPU provider's graph, which is where integer kernels and fallbacks differ
+    SessionConfig cfg = config();
+    cfg.xnnpack = false;
+    Ort::SessionOptions options = sessionOptions(cfg, true);
+    options.SetOptimizedModelFilePath(scratchPath.c_str());
+    {
+        Ort::Session session(*env(), modelPath.c_str(), options);
+    }
+    QuantizationReport report;
+    try {
+        report = inspect_quantization(scratchPath);
+    } catch (...) {
+        std::remove(scratchPath.c_str());
+        throw;
+    }
+    std::remove(scratchPath.c_str());
+    LOGI("Optimized %s: %s", modelPath.c_str(), report.summary().c_str());
+    return report;
+}
+
+std::shared_ptr<PiperVoice> VoiceRegistry::load(const std::string &modelPath, const std::string &configPath) {
+    if (auto voice = get(modelPath)) return voice;
+
+    // Loading takes seconds; don't hold the lock over it
+    std::shared_ptr<PiperVoice> voice = PiperVoice::load(modelPath, configPath, env(),
+                                                         sessionOptions(config(), false));
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto &existing : m_voices) {
+        if (existing->id() == modelPath) return existing;   // loaded concurrently
+    }
+    m_voices.push_front(voice);
+    evict();
+    return voice;
+}
+
+std::shared_ptr<PiperVoice> VoiceRegistry::get(const std::string &modelPath) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto it = m_voices.begin(); it != m_voices.end(); ++it) {
+        if ((*it)->id() == modelPath) {
+            m_voices.splice(m_voices.begin(), m_voices, it);
+            return m_voices.front();
+        }
+    }
+    return nullptr;
+}
+
+bool VoiceRegistry::setActive(const std::string &modelPath) {
+    std::shared_ptr<PiperVoice> voice = get(modelPath);
+    if (!voice) return false;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_active = voice;
+    return true;
+}
+
+std::shared_ptr<PiperVoice> VoiceRegistry::active() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_active;
+}
+
+bool VoiceRegistry::unload(const std::string &modelPath) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto it = m_voices.begin(); it != m_voices.end(); ++it) {
+        if ((*it)->id() == modelPath) {
+            if (m_active == *it) m_active.reset();
+            m_voices.erase(it);
+            return true;
+        }
+    }
+    return false;
+}
+
+void VoiceRegistry::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_active.reset();
+    m_voices.clear();
+}
+
+void VoiceRegistry::setBudget(size_t bytes) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_budget = bytes;
+    evict();
+}
+
+size_t VoiceRegistry::residentBytes() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    size_t total = 0;
+    for (const auto &voice : m_voices) total += voice->memoryBytes();
+    return total;
+}
+
+std::vector<std::string> VoiceRegistry::resident() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<std::string> ids;
+    for (const auto &voice : m_voices) ids.push_back(voice->id());
+    return ids;
+}
+
+// Drop least recently used voices until under budget. The active voice and
+// the most recent one (just loaded) always stay, even if that overshoots.
+void VoiceRegistry::evict() {
+    size_t total = 0;
+    for (const auto &voice : m_voices) total += voice->memoryBytes();
+
+    while (total > m_budget && m_voices.size() > 1) {
+        auto victim = m_voices.end();
+        for (auto it = std::next(m_voices.begin()); it != m_voices.end(); ++it) {
+            if (*it != m_active) victim = it;
+        }
+        if (victim == m_voices.end()) break;
+        LOGI("Evicting voice %s (%zu MB resident, budget %zu MB)",
+             (*victim)->id().c_str(), total >> 20, m_budget >> 20);
+        total -= (*victim)->memoryBytes();
+        m_voices.erase(victim);
+    }
+}
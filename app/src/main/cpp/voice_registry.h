@@ -0,0 +1,99 @@
+/**
+ * Resident Piper voices sharing one ONNX Runtime environment.
+ *
+ * Every session is created against a single Ort::Env with global thread
+ * pools (per-session pools disabled), so keeping several voices loaded
+ * costs their weights, not extra threads. Voices are kept in LRU order under
+ * a memory budget (PiperVoice::memoryBytes); loading past the budget evicts
+ * the least recently used voices other than the active one. A synthesis that
+ * still holds an evicted voice keeps it alive until it finishes.
+ *
+ * How sessions run is a SessionConfig: intra-op threads for the global pool
+ * (two by default, so synthesis leaves the remaining cores to the LLM),
+ * graph optimization level, CPU arena and memory-pattern planning, and the
+ * XNNPACK execution provider when the ONNX Runtime build has it.
+ * configure() with a different config unloads every voice. A new thread
+ * count needs a new env, which ONNX Runtime (one env per process) only
+ * builds once nothing holds the old one: while a synthesis or standalone
+ * voice still does, the old count is kept — config() reports it — and the
+ * next configure() tries again.
+ * openStandalone() loads a voice outside the registry with its own thread
+ * pool, so configurations can be benchmarked side by side.
+ *
+ * int8 voices (onnxruntime dynamic or static / QDQ quantization) load the
+ * same way; inspectOptimized() reports which of their operators ONNX
+ * Runtime actually runs in integer and which fell back to fp32.
+ */
+
+#pragma once
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "piper_voice.h"
+
+struct SessionConfig {
+    int threads = 2;            // intra-op threads; inter-op stays at 1 (sequential graph)
+    int optimization = 99;      // GraphOptimizationLevel: 0 off, 1 basic, 2 extended, 99 all
+    bool cpuArena = true;
+    bool memPattern = true;
+    bool xnnpack = false;       // falls back to the CPU provider if unavailable
+
+    bool operator==(const SessionConfig &o) const {
+        return threads == o.threads && optimization == o.optimization && cpuArena == o.cpuArena &&
+               memPattern == o.memPattern && xnnpack == o.xnnpack;
+    }
+    bool operator!=(const SessionConfig &o) const { return !(*this == o); }
+};
+
+class VoiceRegistry {
+public:
+    static constexpr size_t DEFAULT_BUDGET_BYTES = 192 * 1024 * 1024;   // ~3 medium voices
+
+    // Resident voice for modelPath, loading it if needed. Throws on failure.
+    std::shared_ptr<PiperVoice> load(const std::string &modelPath, const std::string &configPath);
+
+    // Applies to voices loaded from now on; a change unloads resident voices.
+    // The thread count only changes if no session still holds the env.
+    void configure(const SessionConfig &config);
+    SessionConfig config() const;
+
+    // A voice with its own session and thread pool, not kept resident
+    std::unique_ptr<PiperVoice> openStandalone(const std::string &modelPath, const std::string &configPath,
+                                               const SessionConfig &config);
+
+    // Quantization check of the graph ONNX Runtime runs under the current
+    // config (QDQ nodes fused, fallbacks as executed): the optimized model
+    // is written to scratchPath, inspected and deleted. Throws on failure.
+    QuantizationReport inspectOptimized(const std::string &modelPath, const std::string &scratchPath);
+
+    // Resident voice or null; counts as a use for LRU
+    std::shared_ptr<PiperVoice> get(const std::string &modelPath);
+
+    // The voice synthesis uses when no other is named
+    bool setActive(const std::string &modelPath);
+    std::shared_ptr<PiperVoice> active() const;
+
+    bool unload(const std::string &modelPath);
+    void clear();
+
+    void setBudget(size_t bytes);
+    size_t residentBytes() const;
+    std::vector<std::string> resident() const;
+
+private:
+    std::shared_ptr<Ort::Env> env();
+    static Ort::SessionOptions sessionOptions(const SessionConfig &config, bool ownThreads);
+    void evict();   // caller holds m_mutex
+
+    mutable std::mutex m_mutex;
+    SessionConfig m_config;
+    std::shared_ptr<Ort::Env> m_env;
+    int m_envThreads = 0;
+    std::list<std::shared_ptr<PiperVoice>> m_voices;   // most recently used first
+    std::shared_ptr<PiperVoice> m_active;
+    size_t m_budget = DEFAULT_BUDGET_BYTES;
+};
@@ -6,19 +6,851 @@
  */
 
 #include <jni.h>
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <chrono>
+#include <cstring>
+#include <functional>
 #include <string>
+#include <thread>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
 #include <android/log.h>
 
 #include "whisper.h"
+#include "voice_frontend.h"
+#include "audio_file.h"
+#include "resampler.h"
+#include "long_window.h"
+#include "trace.h"
+#include "voice_pipeline.h"
 
 #define LOG_TAG "WhisperJNI"
 #define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
 #define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
 #define LOGD(...) __android_log_print(ANDROID_LOG_DEBUG, LOG_TAG, __VA_ARGS__)
 
-// Global whisper context
+// Global whisper context. Replaced / freed only under g_bias_mutex, so the
+// bias vocabulary (tokenized on the caller's thread) never sees a dead one.
 static struct whisper_context *g_ctx = nullptr;
 
+// Held for every decode on g_ctx and while it is loaded or freed: the JNI
+// entry points and the native pipeline's stt:: calls share the context and
+// its cached result. Taken before g_bias_mutex and g_lang_mutex.
+static std::mutex g_ctx_mutex;
+
+// Duration of the audio behind the last binary result (g_last_result)
+static int g_last_duration_ms = 0;
+
+// ============================================================
+// Contextual biasing (contact + app names)
+// ============================================================
+// Phrases are tokenized once when the vocabulary changes and cached per
+// phrase, so an updated list only tokenizes the new entries. Each transcribe
+// call just borrows the prebuilt prompt tokens and continuation trie.
+
+// Whisper keeps at most n_text_ctx/2 (224) prompt tokens — stay below that
+static const int BIAS_MAX_PROMPT_TOKENS = 192;
+
+struct BiasTrieNode {
+    std::unordered_map<whisper_token, int> next;  // token -> child node index
+};
+
+struct BiasPrompt {
+    std::vector<whisper_token> tokens;  // " Priyanka, Swiggy, ..." as prompt tokens
+    std::vector<BiasTrieNode> trie;     // node 0 is the root
+    int maxDepth = 0;                   // longest phrase in tokens
+    float boost = 0.0f;                 // logit boost for phrase continuations
+};
+
+static std::mutex g_bias_mutex;
+static std::vector<std::string> g_bias_phrases;  // most important first
+static std::unordered_map<std::string, std::vector<whisper_token>> g_bias_token_cache;
+static std::shared_ptr<const BiasPrompt> g_bias_prompt;
+static float g_bias_boost = 0.0f;
+
+static bool bias_tokenize(const std::string &text, std::vector<whisper_token> &out) {
+    out.resize(text.size() + 8);
+    int n = whisper_tokenize(g_ctx, text.c_str(), out.data(), (int) out.size());
+    if (n < 0) {
+        out.resize(-n);
+        n = whisper_tokenize(g_ctx, text.c_str(), out.data(), (int) out.size());
+    }
+    if (n < 0) {
+        out.clear();
+        return false;
+    }
+    out.resize(n);
+    return true;
+}
+
+// Rebuild the cached prompt from g_bias_phrases. Caller holds g_bias_mutex.
+static void bias_rebuild_locked() {
+    if (g_ctx == nullptr || g_bias_phrases.empty()) {
+        g_bias_prompt.reset();
+        return;
+    }
+
+    // Evict phrases that are no longer in the list, tokenize only new ones
+    std::unordered_set<std::string> wanted(g_bias_phrases.begin(), g_bias_phrases.end());
+    for (auto it = g_bias_token_cache.begin(); it != g_bias_token_cache.end();) {
+        if (wanted.count(it->first) == 0 && it->first != ",") {
+            it = g_bias_token_cache.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    int newlyTokenized = 0;
+    for (const auto &phrase : g_bias_phrases) {
+        if (g_bias_token_cache.count(phrase) != 0) continue;
+        std::vector<whisper_token> tokens;
+        if (bias_tokenize(" " + phrase, tokens) && !tokens.empty()) {
+            g_bias_token_cache.emplace(phrase, std::move(tokens));
+            newlyTokenized++;
+        }
+    }
+    if (g_bias_token_cache.count(",") == 0) {
+        std::vector<whisper_token> comma;
+        bias_tokenize(",", comma);
+        g_bias_token_cache.emplace(",", std::move(comma));
+    }
+    const auto &comma = g_bias_token_cache[","];
+
+    auto prompt = std::make_shared<BiasPrompt>();
+    prompt->boost = g_bias_boost;
+    prompt->trie.emplace_back();
+
+    // Take phrases in priority order until the budget is spent
+    std::vector<const std::vector<whisper_token> *> included;
+    int budget = BIAS_MAX_PROMPT_TOKENS;
+    for (const auto &phrase : g_bias_phrases) {
+        auto it = g_bias_token_cache.find(phrase);
+        if (it == g_bias_token_cache.end()) continue;
+        const auto &tokens = it->second;
+
+        // Every phrase goes into the trie, even ones that miss the prompt budget
+        int node = 0;
+        for (whisper_token t : tokens) {
+            auto next = prompt->trie[node].next.find(t);
+            if (next == prompt->trie[node].next.end()) {
+                prompt->trie.emplace_back();
+                int child = (int) prompt->trie.size() - 1;
+                prompt->trie[node].next.emplace(t, child);
+                node = child;
+            } else {
+                node = next->second;
+            }
+        }
+        prompt->maxDepth = std::max(prompt->maxDepth, (int) tokens.size());
+
+        const int cost = (int) (tokens.size() + comma.size());
+        if (cost <= budget) {
+            included.push_back(&tokens);
+            budget -= cost;
+        }
+    }
+
+    // Whisper truncates the prompt from the front, so the most important
+    // phrases go last — closest to the audio
+    for (auto it = included.rbegin(); it != included.rend(); ++it) {
+        prompt->tokens.insert(prompt->tokens.end(), (*it)->begin(), (*it)->end());
+        prompt->tokens.insert(prompt->tokens.end(), comma.begin(), comma.end());
+    }
+
+    LOGI("Bias vocabulary: %zu phrases (%d newly tokenized), %zu prompt tokens, %zu trie nodes",
+         g_bias_phrases.size(), newlyTokenized, prompt->tokens.size(), prompt->trie.size());
+
+    g_bias_prompt = std::move(prompt);
+}
+
+// Boost the tokens that continue a bias phrase whose prefix was just decoded.
+// Only continuations are boosted — whisper still has to commit to the first
+// token on its own (helped by the prompt), which keeps false insertions rare.
+static void bias_logits_filter(
+        struct whisper_context * /*ctx*/,
+        struct whisper_state * /*state*/,
+        const whisper_token_data *tokens,
+        int n_tokens,
+        float *logits,
+        void *user_data) {
+    const auto *bias = static_cast<const BiasPrompt *>(user_data);
+    const int depth = std::min(n_tokens, bias->maxDepth);
+
+    for (int start = n_tokens - depth; start < n_tokens; start++) {
+        int node = 0;
+        for (int i = start; i < n_tokens && node >= 0; i++) {
+            const auto &next = bias->trie[node].next;
+            auto it = next.find(tokens[i].id);
+            node = (it == next.end()) ? -1 : it->second;
+        }
+        if (node <= 0) continue;
+        for (const auto &kv : bias->trie[node].next) {
+            logits[kv.first] += bias->boost;
+        }
+    }
+}
+
+static std::shared_ptr<const BiasPrompt> bias_snapshot() {
+    std::lock_guard<std::mutex> lock(g_bias_mutex);
+    return g_bias_prompt;
+}
+
+static void bias_apply(struct whisper_full_params &params, const BiasPrompt *bias) {
+    if (bias == nullptr) return;
+    if (!bias->tokens.empty()) {
+        params.prompt_tokens = bias->tokens.data();
+        params.prompt_n_tokens = (int) bias->tokens.size();
+    }
+    if (bias->boost > 0.0f && bias->trie.size() > 1) {
+        params.logits_filter_callback = bias_logits_filter;
+        params.logits_filter_callback_user_data = const_cast<BiasPrompt *>(bias);
+    }
+}
+
+// ============================================================
+// Tracing (trace.h)
+// ============================================================
+// whisper_full runs mel, encoder and decoder in one call. Its callbacks mark
+// the phase changes: the encoder begins at encoder_begin_callback, and the
+// decoder with the first logits filter of the window. A call over several
+// windows alternates encode / decode spans.
+
+struct FullTrace {
+    whisper_encoder_begin_callback encoderBegin = nullptr;
+    void *encoderBeginUser = nullptr;
+    whisper_logits_filter_callback logitsFilter = nullptr;
+    void *logitsFilterUser = nullptr;
+    const char *phase = nullptr;
+    uint64_t phaseStart = 0;
+
+    void enter(const char *next) {
+        const uint64_t now = trace::now_ns();
+        if (phase) trace::complete("whisper", phase, phaseStart, now);
+        phase = next;
+        phaseStart = now;
+    }
+};
+
+static const char *TRACE_ENCODE = "whisper.encode";
+static const char *TRACE_DECODE = "whisper.decode";
+
+static bool trace_encoder_begin(struct whisper_context *ctx, struct whisper_state *state, void *user_data) {
+    auto *t = static_cast<FullTrace *>(user_data);
+    t->enter(TRACE_ENCODE);
+    return t->encoderBegin ? t->encoderBegin(ctx, state, t->encoderBeginUser) : true;
+}
+
+static void trace_logits_filter(
+        struct whisper_context *ctx,
+        struct whisper_state *state,
+        const whisper_token_data *tokens,
+        int n_tokens,
+        float *logits,
+        void *user_data) {
+    auto *t = static_cast<FullTrace *>(user_data);
+    if (t->phase != TRACE_DECODE) t->enter(TRACE_DECODE);
+    if (t->logitsFilter) t->logitsFilter(ctx, state, tokens, n_tokens, logits, t->logitsFilterUser);
+}
+
+// whisper_full / whisper_full_with_state, split into phase spans while
+// tracing (the params' own callbacks still run)
+static int full_traced(struct whisper_state *state, struct whisper_full_params params, const float *audio, int n) {
+    trace::Scope span("whisper", "whisper.full");
+    FullTrace t;
+    if (trace::enabled()) {
+        t.encoderBegin = params.encoder_begin_callback;
+        t.encoderBeginUser = params.encoder_begin_callback_user_data;
+        t.logitsFilter = params.logits_filter_callback;
+        t.logitsFilterUser = params.logits_filter_callback_user_data;
+        params.encoder_begin_callback = trace_encoder_begin;
+        params.encoder_begin_callback_user_data = &t;
+        params.logits_filter_callback = trace_logits_filter;
+        params.logits_filter_callback_user_data = &t;
+        // PCM input: the log-mel runs before the first encode
+        t.enter(audio != nullptr ? "whisper.mel" : nullptr);
+        if (audio != nullptr) span.arg("samples", n);
+    }
+    const int result = state ? whisper_full_with_state(g_ctx, state, params, audio, n)
+                             : whisper_full(g_ctx, params, audio, n);
+    if (t.phase) t.enter(nullptr);
+    return result;
+}
+
+// ============================================================
+// Session language lock
+// ============================================================
+// "auto" used to mean language detection on every utterance — an extra
+// encoder pass each time. Instead, detect once on the first confident
+// utterance, lock the decoder to that language and only re-check every few
+// utterances (or when a decode looks wrong) to follow code switching.
+
+struct LanguageSession {
+    int lockedId = -1;              // whisper language id, -1 until confident
+    int sinceCheck = 0;             // utterances decoded since the last detection
+    std::vector<int> allowed;       // candidate languages (empty = any)
+    float lockThreshold = 0.7f;     // min detection probability to lock/switch
+    int recheckInterval = 8;        // utterances between cheap re-checks
+};
+
+// Utterances shorter than this don't carry enough signal to lock on
+static const int LANG_MIN_LOCK_SAMPLES = WHISPER_SAMPLE_RATE;
+// Mean token probability below which a locked decode triggers a re-check
+static const float LANG_RECHECK_TOKEN_PROB = 0.5f;
+
+static std::mutex g_lang_mutex;
+static LanguageSession g_lang;
+
+// Detect the language of the mel currently held by g_ctx, restricted to the
+// allowed candidates (probabilities renormalized over them).
+static int detect_language(const std::vector<int> &allowed, int n_threads, float *outProb) {
+    NOVA_TRACE_SCOPE("whisper", "whisper.detect_language");
+    std::vector<float> probs(whisper_lang_max_id() + 1, 0.0f);
+    int best = whisper_lang_auto_detect(g_ctx, 0, n_threads, probs.data());
+    if (best < 0) return -1;
+
+    if (allowed.empty()) {
+        *outProb = probs[best];
+        return best;
+    }
+
+    float sum = 0.0f;
+    best = -1;
+    for (int id : allowed) {
+        sum += probs[id];
+        if (best < 0 || probs[id] > probs[best]) best = id;
+    }
+    *outProb = sum > 0.0f ? probs[best] / sum : 0.0f;
+    return best;
+}
+
+static float mean_token_prob(struct whisper_context *ctx) {
+    const whisper_token eot = whisper_token_eot(ctx);
+    float sum = 0.0f;
+    int count = 0;
+    for (int i = 0; i < whisper_full_n_segments(ctx); i++) {
+        for (int j = 0; j < whisper_full_n_tokens(ctx, i); j++) {
+            const whisper_token_data data = whisper_full_get_token_data(ctx, i, j);
+            if (data.id >= eot) continue;
+            sum += data.p;
+            count++;
+        }
+    }
+    return count > 0 ? sum / count : 0.0f;
+}
+
+// whisper_full with the session language policy applied. An explicit language
+// code is used as-is; "auto" resolves to the locked session language.
+// audio == nullptr decodes the mel already set on g_ctx (whisper_set_mel),
+// bounded by params.duration_ms.
+static int full_with_language(struct whisper_full_params params, const float *audio, int n, const char *requested) {
+    if (strcmp(requested, "auto") != 0 || !whisper_is_multilingual(g_ctx)) {
+        params.language = strcmp(requested, "auto") == 0 ? "en" : requested;
+        return full_traced(nullptr, params, audio, n);
+    }
+
+    LanguageSession session;
+    {
+        std::lock_guard<std::mutex> lock(g_lang_mutex);
+        session = g_lang;
+        if (g_lang.lockedId >= 0) g_lang.sinceCheck++;
+    }
+
+    if (session.lockedId < 0) {
+        // First utterance(s) of the session: pay for detection once
+        if (audio != nullptr) {
+            NOVA_TRACE_SCOPE("whisper", "whisper.mel");
+            if (whisper_pcm_to_mel(g_ctx, audio, n, params.n_threads) != 0) {
+                LOGE("Failed to compute mel for language detection");
+                return -1;
+            }
+        }
+        float prob = 0.0f;
+        int id = detect_language(session.allowed, params.n_threads, &prob);
+        if (id < 0) id = whisper_lang_id("en");
+
+        const int64_t samples = audio != nullptr ? n : (int64_t) params.duration_ms * WHISPER_SAMPLE_RATE / 1000;
+        if (prob >= session.lockThreshold && samples >= LANG_MIN_LOCK_SAMPLES) {
+            std::lock_guard<std::mutex> lock(g_lang_mutex);
+            g_lang.lockedId = id;
+            g_lang.sinceCheck = 0;
+            LOGI("Session language locked: %s (p=%.2f)", whisper_lang_str(id), prob);
+        } else {
+            LOGD("Detected %s (p=%.2f), not confident enough to lock", whisper_lang_str(id), prob);
+        }
+        params.language = whisper_lang_str(id);
+        return full_traced(nullptr, params, audio, n);
+    }
+
+    params.language = whisper_lang_str(session.lockedId);
+    int result = full_traced(nullptr, params, audio, n);
+    if (result != 0) return result;
+
+    // Cheap re-check: the mel of this utterance is still in the context, so
+    // detection costs one encoder pass — only every few utterances, or right
+    // away when the locked decode looks wrong (likely a code switch)
+    const bool due = session.sinceCheck + 1 >= session.recheckInterval;
+    const bool suspicious = mean_token_prob(g_ctx) < LANG_RECHECK_TOKEN_PROB;
+    if (!due && !suspicious) return result;
+
+    float prob = 0.0f;
+    const int id = detect_language(session.allowed, params.n_threads, &prob);
+    {
+        std::lock_guard<std::mutex> lock(g_lang_mutex);
+        g_lang.sinceCheck = 0;
+        if (id >= 0 && id != g_lang.lockedId && prob >= g_lang.lockThreshold) {
+            LOGI("Session language switched: %s -> %s (p=%.2f)",
+                 whisper_lang_str(g_lang.lockedId), whisper_lang_str(id), prob);
+            g_lang.lockedId = id;
+        } else {
+            return result;
+        }
+    }
+
+    // The utterance was decoded in the wrong language — redo it
+    params.language = whisper_lang_str(id);
+    return full_traced(nullptr, params, audio, n);
+}
+
+// ============================================================
+// Binary transcription result
+// ============================================================
+// Layout written by transcribeToBuffer (little-endian, decoded by
+// WhisperResult.decode in one pass):
+//
+//   header   magic 'NWR1', u16 version, u16 flags, i32 nSegments, i32 nWords,
+//            i32 textBytes, i32 durationMs, f32 noSpeechProb, f32 avgTokenProb
+//   segment  i32 t0Ms, i32 t1Ms, f32 noSpeechProb, f32 avgTokenProb,
+//            i32 firstWord, i32 nWords, i32 textOffset, i32 textLen
+//   word     i32 t0Ms, i32 t1Ms, f32 prob, f32 minProb, i32 textOffset, i32 textLen
+//   text     UTF-8 of all segments back to back (words point into it)
+
+static const uint32_t RESULT_MAGIC = 0x3152574E;  // "NWR1"
+static const uint16_t RESULT_VERSION = 1;
+static const size_t RESULT_HEADER_BYTES = 32;
+static const size_t RESULT_SEGMENT_BYTES = 32;
+static const size_t RESULT_WORD_BYTES = 24;
+
+struct ResultWord {
+    int32_t t0Ms = 0, t1Ms = 0;
+    float probSum = 0.0f, minProb = 1.0f;
+    int nTokens = 0;
+    int32_t textOffset = 0, textLen = 0;
+    bool spaced = false;   // preceded by a space in the segment text
+};
+
+struct ResultSegment {
+    int32_t t0Ms = 0, t1Ms = 0;
+    float noSpeechProb = 0.0f, avgTokenProb = 0.0f;
+    int32_t firstWord = 0, nWords = 0;
+    int32_t textOffset = 0, textLen = 0;
+};
+
+class ResultWriter {
+public:
+    ResultWriter(uint8_t *data, size_t capacity) : m_data(data), m_capacity(capacity) {}
+
+    template <typename T>
+    void put(T value) {
+        if (m_pos + sizeof(T) <= m_capacity) {
+            memcpy(m_data + m_pos, &value, sizeof(T));
+        }
+        m_pos += sizeof(T);
+    }
+
+    void putBytes(const std::string &bytes) {
+        if (m_pos + bytes.size() <= m_capacity) {
+            memcpy(m_data + m_pos, bytes.data(), bytes.size());
+        }
+        m_pos += bytes.size();
+    }
+
+    size_t size() const { return m_pos; }
+
+private:
+    uint8_t *m_data;
+    size_t m_capacity;
+    size_t m_pos = 0;
+};
+
+// A decoded transcript in the layout's terms, ready to serialize. The last
+// one is cached so a too-small buffer can be refilled without decoding again.
+struct Transcript {
+    std::vector<ResultSegment> segments;
+    std::vector<ResultWord> words;
+    std::string text;
+    float maxNoSpeech = 0.0f;
+    float probSum = 0.0f;
+    int nTokens = 0;
+};
+
+static Transcript g_last_result;
+
+// Read access to a whisper_full result: the context's own state, or a
+// separate whisper_state (long-form lanes)
+struct ResultSource {
+    struct whisper_context *ctx;
+    struct whisper_state *state = nullptr;
+
+    int nSegments() const {
+        return state ? whisper_full_n_segments_from_state(state) : whisper_full_n_segments(ctx);
+    }
+    int64_t t0(int i) const {
+        return state ? whisper_full_get_segment_t0_from_state(state, i) : whisper_full_get_segment_t0(ctx, i);
+    }
+    int64_t t1(int i) const {
+        return state ? whisper_full_get_segment_t1_from_state(state, i) : whisper_full_get_segment_t1(ctx, i);
+    }
+    float noSpeechProb(int i) const {
+        return state ? whisper_full_get_segment_no_speech_prob_from_state(state, i)
+                     : whisper_full_get_segment_no_speech_prob(ctx, i);
+    }
+    int nTokens(int i) const {
+        return state ? whisper_full_n_tokens_from_state(state, i) : whisper_full_n_tokens(ctx, i);
+    }
+    whisper_token_data tokenData(int i, int j) const {
+        return state ? whisper_full_get_token_data_from_state(state, i, j) : whisper_full_get_token_data(ctx, i, j);
+    }
+    const char *tokenText(int i, int j) const {
+        return state ? whisper_full_get_token_text_from_state(ctx, state, i, j) : whisper_full_get_token_text(ctx, i, j);
+    }
+};
+
+// Append a whisper_full result to out, shifting timestamps by offsetMs and
+// keeping only the words whose midpoint lies in [keepFromMs, keepToMs).
+// Segments keep whisper's own bounds unless some of their words were cut.
+static void append_result(const ResultSource &src, Transcript &out, int32_t offsetMs,
+                          int32_t keepFromMs = KEEP_ALL_FROM, int32_t keepToMs = KEEP_ALL_TO) {
+    const whisper_token eot = whisper_token_eot(src.ctx);
+    const int n_segments = src.nSegments();
+
+    std::vector<ResultWord> words;
+    std::string text;
+
+    for (int i = 0; i < n_segments; i++) {
+        ResultSegment seg;
+        seg.t0Ms = (int32_t) (src.t0(i) * 10) + offsetMs;
+        seg.t1Ms = (int32_t) (src.t1(i) * 10) + offsetMs;
+        seg.noSpeechProb = src.noSpeechProb(i);
+
+        words.clear();
+        text.clear();
+        const int n_tokens = src.nTokens(i);
+
+        for (int j = 0; j < n_tokens; j++) {
+            const whisper_token_data data = src.tokenData(i, j);
+            if (data.id >= eot) continue;  // timestamps and other special tokens
+
+            const char *piece = src.tokenText(i, j);
+            const size_t pieceLen = strlen(piece);
+            if (pieceLen == 0) continue;
+
+            // A leading space starts a new word; anything else (punctuation,
+            // word-internal BPE pieces) extends the current one
+            const bool startsWord = words.empty() || piece[0] == ' ';
+            if (startsWord) {
+                ResultWord word;
+                word.t0Ms = (int32_t) (data.t0 * 10) + offsetMs;
+                word.spaced = piece[0] == ' ';
+                word.textOffset = (int32_t) (text.size() + (word.spaced ? 1 : 0));
+                words.push_back(word);
+            }
+
+            ResultWord &word = words.back();
+            text.append(piece, pieceLen);
+            word.t1Ms = (int32_t) (data.t1 * 10) + offsetMs;
+            word.textLen = (int32_t) text.size() - word.textOffset;
+            word.probSum += data.p;
+            word.minProb = std::min(word.minProb, data.p);
+            word.nTokens++;
+        }
+
+        seg.firstWord = (int32_t) out.words.size();
+        seg.textOffset = (int32_t) out.text.size();
+        float segProb = 0.0f;
+        int segTokens = 0;
+        bool cut = false;
+
+        for (const ResultWord &word : words) {
+            const int32_t mid = word.t0Ms + (word.t1Ms - word.t0Ms) / 2;
+            if (mid < keepFromMs || mid >= keepToMs) {
+                cut = true;
+                continue;
+            }
+            ResultWord kept = word;
+            if (word.spaced) out.text.push_back(' ');
+            kept.textOffset = (int32_t) out.text.size();
+            out.text.append(text, (size_t) word.textOffset, (size_t) word.textLen);
+            out.words.push_back(kept);
+            segProb += word.probSum;
+            segTokens += word.nTokens;
+        }
+
+        seg.nWords = (int32_t) out.words.size() - seg.firstWord;
+        if (words.empty()) {
+            // Nothing but special tokens — owned by whoever owns its midpoint
+            const int32_t mid = seg.t0Ms + (seg.t1Ms - seg.t0Ms) / 2;
+            if (mid < keepFromMs || mid >= keepToMs) continue;
+        } else if (seg.nWords == 0) {
+            continue;
+        } else if (cut) {
+            seg.t0Ms = out.words[seg.firstWord].t0Ms;
+            seg.t1Ms = out.words.back().t1Ms;
+        }
+
+        seg.textLen = (int32_t) out.text.size() - seg.textOffset;
+        seg.avgTokenProb = segTokens > 0 ? segProb / segTokens : 0.0f;
+        out.maxNoSpeech = std::max(out.maxNoSpeech, seg.noSpeechProb);
+        out.probSum += segProb;
+        out.nTokens += segTokens;
+        out.segments.push_back(seg);
+    }
+}
+
+// Append one transcript to another, rebasing word and text references
+static void append_transcript(Transcript &out, const Transcript &part) {
+    const int32_t wordBase = (int32_t) out.words.size();
+    const int32_t textBase = (int32_t) out.text.size();
+    for (ResultSegment seg : part.segments) {
+        seg.firstWord += wordBase;
+        seg.textOffset += textBase;
+        out.segments.push_back(seg);
+    }
+    for (ResultWord word : part.words) {
+        word.textOffset += textBase;
+        out.words.push_back(word);
+    }
+    out.text += part.text;
+    out.maxNoSpeech = std::max(out.maxNoSpeech, part.maxNoSpeech);
+    out.probSum += part.probSum;
+    out.nTokens += part.nTokens;
+}
+
+// Serialize a transcript into out. Returns the number of bytes written, or
+// the negated required size if capacity is too small.
+static long write_binary_result(const Transcript &t, uint8_t *out, size_t capacity, int durationMs) {
+    const size_t required = RESULT_HEADER_BYTES
+                            + t.segments.size() * RESULT_SEGMENT_BYTES
+                            + t.words.size() * RESULT_WORD_BYTES
+                            + t.text.size();
+    if (required > capacity) {
+        return -(long) required;
+    }
+
+    ResultWriter w(out, capacity);
+    w.put<uint32_t>(RESULT_MAGIC);
+    w.put<uint16_t>(RESULT_VERSION);
+    w.put<uint16_t>(0);
+    w.put<int32_t>((int32_t) t.segments.size());
+    w.put<int32_t>((int32_t) t.words.size());
+    w.put<int32_t>((int32_t) t.text.size());
+    w.put<int32_t>(durationMs);
+    w.put<float>(t.maxNoSpeech);
+    w.put<float>(t.nTokens > 0 ? t.probSum / t.nTokens : 0.0f);
+
+    for (const auto &seg : t.segments) {
+        w.put<int32_t>(seg.t0Ms);
+        w.put<int32_t>(seg.t1Ms);
+        w.put<float>(seg.noSpeechProb);
+        w.put<float>(seg.avgTokenProb);
+        w.put<int32_t>(seg.firstWord);
+        w.put<int32_t>(seg.nWords);
+        w.put<int32_t>(seg.textOffset);
+        w.put<int32_t>(seg.textLen);
+    }
+    for (const auto &word : t.words) {
+        w.put<int32_t>(word.t0Ms);
+        w.put<int32_t>(word.t1Ms);
+        w.put<float>(word.nTokens > 0 ? word.probSum / word.nTokens : 0.0f);
+        w.put<float>(word.minProb);
+        w.put<int32_t>(word.textOffset);
+        w.put<int32_t>(word.textLen);
+    }
+    w.putBytes(t.text);
+
+    return (long) w.size();
+}
+
+// Cache the context's last whisper_full result as the current transcript
+static void cache_context_result() {
+    g_last_result = Transcript();
+    append_result({g_ctx}, g_last_result, 0);
+}
+
+// ============================================================
+// Model capability probe
+// ============================================================
+// Quantized models (q4_0/q4_1/q5_0/q5_1/q8_0) load through the same path as
+// f16 ones — ggml's quant kernels are compiled in. What differs per device
+// is speed, so the model selector benchmarks each candidate on the phone
+// itself: one 30 s encoder pass (whisper always encodes a full window)
+// plus decoding a typical dictation utterance — the bias prompt as one batch,
+// then one token at a time.
+
+// Utterance the probe's real-time factor is measured against
+static const int PROBE_UTTERANCE_MS = 5000;
+static const int PROBE_PROMPT_TOKENS = 64;
+static const int PROBE_OUTPUT_TOKENS = 24;
+
+static const char *ftype_name(int ftype) {
+    switch (ftype) {
+        case 0: return "f32";
+        case 1: return "f16";
+        case 2: return "q4_0";
+        case 3: return "q4_1";
+        case 7: return "q8_0";
+        case 8: return "q5_0";
+        case 9: return "q5_1";
+        default: return "other";
+    }
+}
+
+static double elapsed_ms(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - since).count();
+}
+
+// One encode + decode round on ctx; false if whisper rejects a step
+static bool probe_round(struct whisper_context *ctx, int n_threads, double &encodeMs, double &decodeMs) {
+    std::vector<whisper_token> tokens(PROBE_PROMPT_TOKENS, whisper_token_beg(ctx));
+
+    auto t0 = std::chrono::steady_clock::now();
+    if (whisper_encode(ctx, 0, n_threads) != 0) return false;
+    encodeMs = elapsed_ms(t0);
+
+    t0 = std::chrono::steady_clock::now();
+    if (whisper_decode(ctx, tokens.data(), PROBE_PROMPT_TOKENS, 0, n_threads) != 0) return false;
+    for (int i = 0; i < PROBE_OUTPUT_TOKENS; i++) {
+        if (whisper_decode(ctx, tokens.data(), 1, PROBE_PROMPT_TOKENS + i, n_threads) != 0) return false;
+    }
+    decodeMs = elapsed_ms(t0);
+    return true;
+}
+
+// ============================================================
+// Front-end utterance decodes
+// ============================================================
+// Shared by the JNI entry points below and the native voice pipeline's
+// STT stage (stt:: at the end of this file).
+
+// Decoding parameters shared by the binary-result entry points
+static struct whisper_full_params buffer_params() {
+    struct whisper_full_params params = whisper_full_default_params(WHISPER_SAMPLING_GREEDY);
+    params.translate = false;
+    params.n_threads = 4;
+    params.no_timestamps = false;
+    params.single_segment = false;
+    params.print_special = false;
+    params.print_progress = false;
+    params.print_realtime = false;
+    params.print_timestamps = false;
+    params.token_timestamps = true;
+    return params;
+}
+
+// Text of the context's last result, without the leading space
+static std::string context_text() {
+    std::string text;
+    const int n_segments = whisper_full_n_segments(g_ctx);
+    for (int i = 0; i < n_segments; i++) {
+        const char *segment = whisper_full_get_segment_text(g_ctx, i);
+        if (segment) text += segment;
+    }
+    text.erase(0, text.find_first_not_of(' '));
+    return text;
+}
+
+// Streaming hypothesis of the utterance in progress (see transcribePartial),
+// reported to the endpointer. "" when there's no active utterance with
+// speech yet, the model can't take the shared mel frames, or "auto" has no
+// language to use yet.
+static std::string decode_partial(const char *language) {
+    if (g_ctx == nullptr || whisper_model_n_mels(g_ctx) != logmel::N_MEL) return "";
+    NOVA_TRACE_SCOPE("whisper", "whisper.partial");
+
+    std::vector<float> mel;
+    int nFrames = 0;
+    int64_t coveredEnd = 0;
+    if (!VoiceFrontend::instance().currentUtteranceMel(mel, nFrames, coveredEnd)) return "";
+
+    const int nLen = nFrames + logmel::WHISPER_CHUNK_FRAMES;
+    if (whisper_set_mel(g_ctx, mel.data(), nLen, logmel::N_MEL) != 0) {
+        LOGE("Failed to set partial mel");
+        return "";
+    }
+
+    struct whisper_full_params params = whisper_full_default_params(WHISPER_SAMPLING_GREEDY);
+    params.n_threads = 4;
+    params.no_context = true;
+    params.no_timestamps = true;
+    params.single_segment = true;
+    params.print_special = false;
+    params.print_progress = false;
+    params.print_realtime = false;
+    params.print_timestamps = false;
+    params.duration_ms = (int) ((int64_t) nFrames * logmel::HOP * 1000 / logmel::SAMPLE_RATE);
+
+    // "auto" reaching whisper_full would detect the language on every
+    // partial (an extra encoder pass); until the final transcription locks
+    // one, only a single allowed candidate is usable
+    std::string resolved = language;
+    if (resolved == "auto") {
+        std::lock_guard<std::mutex> lock(g_lang_mutex);
+        if (g_lang.lockedId >= 0) resolved = whisper_lang_str(g_lang.lockedId);
+        else if (!whisper_is_multilingual(g_ctx)) resolved = "en";
+        else if (g_lang.allowed.size() == 1) resolved = whisper_lang_str(g_lang.allowed[0]);
+        else return "";
+    }
+    params.language = resolved.c_str();
+
+    auto bias = bias_snapshot();
+    bias_apply(params, bias.get());
+
+    if (full_traced(nullptr, params, nullptr, 0) != 0) {
+        LOGE("Partial decode failed");
+        return "";
+    }
+
+    const std::string text = context_text();
+    VoiceFrontend::instance().reportHypothesis(text, coveredEnd);
+    LOGD("Partial (%d ms): \"%s\"", params.duration_ms, text.c_str());
+    return text;
+}
+
+// Decode the front end's last utterance from its shared mel frames, with the
+// gain the caller applied to that utterance's PCM. Returns whisper's result
+// code (0 = decoded, durationMs set), or 1 if the frames aren't usable (no
+// native utterance, frames overwritten, or a model that doesn't use 80 mel
+// bins) and the caller should decode the PCM instead.
+static int decode_utterance_mel(float gain, const char *language, int &durationMs) {
+    if (whisper_model_n_mels(g_ctx) != logmel::N_MEL) {
+        LOGD("Model uses %d mel bins, shared frames not applicable", whisper_model_n_mels(g_ctx));
+        return 1;
+    }
+
+    std::vector<float> mel;
+    int nFrames = 0;
+    if (!VoiceFrontend::instance().lastUtteranceMel(mel, nFrames, gain)) return 1;
+
+    const int nLen = nFrames + logmel::WHISPER_CHUNK_FRAMES;
+    if (whisper_set_mel(g_ctx, mel.data(), nLen, logmel::N_MEL) != 0) {
+        LOGE("Failed to set utterance mel");
+        return 1;
+    }
+
+    struct whisper_full_params params = buffer_params();
+    params.duration_ms = (int) ((int64_t) nFrames * logmel::HOP * 1000 / logmel::SAMPLE_RATE);
+    auto bias = bias_snapshot();
+    bias_apply(params, bias.get());
+
+    LOGI("Transcribing utterance mel: %d frames...", nFrames);
+    durationMs = params.duration_ms;
+    return full_with_language(params, nullptr, 0, language);
+}
+
 extern "C" {
 
 // ============================================================
@@ -29,31 +861,106 @@ Java_com_nova_companion_voice_WhisperJNI_initContext(
         JNIEnv *env,
         jobject /* this */,
         jstring modelPath) {
+    std::lock_guard<std::mutex> ctxLock(g_ctx_mutex);
 
     if (g_ctx != nullptr) {
         LOGI("Freeing existing whisper context");
+        std::lock_guard<std::mutex> lock(g_bias_mutex);
         whisper_free(g_ctx);
         g_ctx = nullptr;
     }
 
+    NOVA_TRACE_SCOPE("whisper", "whisper.load");
     const char *path = env->GetStringUTFChars(modelPath, nullptr);
     LOGI("Loading whisper model: %s", path);
 
     struct whisper_context_params cparams = whisper_context_default_params();
     cparams.use_gpu = false;  // CPU only for Android
 
-    g_ctx = whisper_init_from_file_with_params(path, cparams);
+    struct whisper_context *ctx = whisper_init_from_file_with_params(path, cparams);
     env->ReleaseStringUTFChars(modelPath, path);
 
-    if (g_ctx == nullptr) {
+    if (ctx == nullptr) {
         LOGE("Failed to initialize whisper context");
         return JNI_FALSE;
     }
 
-    LOGI("Whisper model loaded successfully");
+    LOGI("Whisper model loaded: %s, %s", whisper_model_type_readable(ctx),
+         ftype_name(whisper_model_ftype(ctx)));
+
+    {
+        std::lock_guard<std::mutex> lock(g_lang_mutex);
+        g_lang.lockedId = -1;
+        g_lang.sinceCheck = 0;
+    }
+
+    // A different model may use a different vocabulary — retokenize
+    {
+        std::lock_guard<std::mutex> lock(g_bias_mutex);
+        g_ctx = ctx;
+        g_bias_token_cache.clear();
+        bias_rebuild_locked();
+    }
     return JNI_TRUE;
 }
 
+// ============================================================
+// probeModel - Benchmark a candidate model on this device
+// ============================================================
+// Loads the model into a private context (the active one is untouched),
+// warms up once and times a second round. Returns
+// [loadMs, encodeMs, decodeMs, rtf, ftype, nMels], or null if the model
+// can't be loaded or run. rtf is (encode + decode) / PROBE_UTTERANCE_MS.
+JNIEXPORT jfloatArray JNICALL
+Java_com_nova_companion_voice_WhisperJNI_probeModel(
+        JNIEnv *env,
+        jobject /* this */,
+        jstring modelPath,
+        jint nThreads) {
+
+    const char *path = env->GetStringUTFChars(modelPath, nullptr);
+    LOGI("Probing whisper model: %s", path);
+
+    struct whisper_context_params cparams = whisper_context_default_params();
+    cparams.use_gpu = false;
+
+    auto t0 = std::chrono::steady_clock::now();
+    struct whisper_context *ctx = whisper_init_from_file_with_params(path, cparams);
+    const double loadMs = elapsed_ms(t0);
+    env->ReleaseStringUTFChars(modelPath, path);
+
+    if (ctx == nullptr) {
+        LOGE("Probe: model failed to load");
+        return nullptr;
+    }
+
+    // Silence is as expensive to encode as speech
+    const int nMels = whisper_model_n_mels(ctx);
+    double encodeMs = 0.0, decodeMs = 0.0;
+    bool ok = whisper_set_mel(ctx, nullptr, 0, nMels) == 0 &&
+              probe_round(ctx, nThreads, encodeMs, decodeMs) &&
+              probe_round(ctx, nThreads, encodeMs, decodeMs);
+    const int ftype = whisper_model_ftype(ctx);
+    const char *type = whisper_model_type_readable(ctx);
+    if (!ok) {
+        LOGE("Probe: %s (%s) failed to run", type, ftype_name(ftype));
+        whisper_free(ctx);
+        return nullptr;
+    }
+
+    const float rtf = (float) ((encodeMs + decodeMs) / PROBE_UTTERANCE_MS);
+    LOGI("Probe: %s (%s) load %.0f ms, encode %.0f ms, decode %.0f ms, RTF %.2f",
+         type, ftype_name(ftype), loadMs, encodeMs, decodeMs, rtf);
+    whisper_free(ctx);
+
+    const jfloat values[6] = {
+            (jfloat) loadMs, (jfloat) encodeMs, (jfloat) decodeMs, rtf, (jfloat) ftype, (jfloat) nMels,
+    };
+    jfloatArray result = env->NewFloatArray(6);
+    if (result) env->SetFloatArrayRegion(result, 0, 6, values);
+    return result;
+}
+
 // ============================================================
 // transcribe - Basic transcription (returns full text)
 // ============================================================
@@ -65,6 +972,7 @@ Java_com_nova_companion_voice_WhisperJNI_transcribe(
         jint numSamples,
         jstring language,
         jboolean translate) {
+    std::lock_guard<std::mutex> ctxLock(g_ctx_mutex);
 
     if (g_ctx == nullptr) {
         LOGE("Whisper context not initialized");
@@ -78,7 +986,6 @@ Java_com_nova_companion_voice_WhisperJNI_transcribe(
     struct whisper_full_params params = whisper_full_default_params(WHISPER_SAMPLING_GREEDY);
 
     const char *lang = env->GetStringUTFChars(language, nullptr);
-    params.language = lang;
     params.translate = translate;
     params.n_threads = 4;
     params.no_timestamps = true;
@@ -88,10 +995,13 @@ Java_com_nova_companion_voice_WhisperJNI_transcribe(
     params.print_realtime = false;
     params.print_timestamps = false;
 
+    auto bias = bias_snapshot();
+    bias_apply(params, bias.get());
+
     LOGI("Transcribing %d samples...", numSamples);
 
     // Run inference
-    int result = whisper_full(g_ctx, params, audioData, numSamples);
+    int result = full_with_language(params, audioData, numSamples, lang);
 
     env->ReleaseFloatArrayElements(samples, audioData, JNI_ABORT);
     env->ReleaseStringUTFChars(language, lang);
@@ -127,6 +1037,7 @@ Java_com_nova_companion_voice_WhisperJNI_transcribeWithCallback(
         jint numSamples,
         jstring language,
         jobject callback) {
+    std::lock_guard<std::mutex> ctxLock(g_ctx_mutex);
 
     if (g_ctx == nullptr) {
         LOGE("Whisper context not initialized");
@@ -150,7 +1061,6 @@ Java_com_nova_companion_voice_WhisperJNI_transcribeWithCallback(
     struct whisper_full_params params = whisper_full_default_params(WHISPER_SAMPLING_GREEDY);
 
     const char *lang = env->GetStringUTFChars(language, nullptr);
-    params.language = lang;
     params.translate = false;
     params.n_threads = 4;
     params.no_timestamps = false;
@@ -161,10 +1071,13 @@ Java_com_nova_companion_voice_WhisperJNI_transcribeWithCallback(
     params.print_timestamps = false;
     params.token_timestamps = true;
 
+    auto bias = bias_snapshot();
+    bias_apply(params, bias.get());
+
     LOGI("Transcribing with callback: %d samples...", numSamples);
 
     // Run inference
-    int result = whisper_full(g_ctx, params, audioData, numSamples);
+    int result = full_with_language(params, audioData, numSamples, lang);
 
     env->ReleaseFloatArrayElements(samples, audioData, JNI_ABORT);
     env->ReleaseStringUTFChars(language, lang);
@@ -200,6 +1113,484 @@ Java_com_nova_companion_voice_WhisperJNI_transcribeWithCallback(
     return env->NewStringUTF(fullText.c_str());
 }
 
+// ============================================================
+// transcribeToBuffer - Transcription into a compact binary result
+// ============================================================
+// Writes segments, words, timestamps and confidences into a direct
+// ByteBuffer in one go — no per-segment upcalls or Java strings.
+// Returns bytes written, the negated required size if the buffer is too
+// small (the result stays cached — call again with a larger buffer),
+// or 0 on failure.
+JNIEXPORT jint JNICALL
+Java_com_nova_companion_voice_WhisperJNI_transcribeToBuffer(
+        JNIEnv *env,
+        jobject /* this */,
+        jfloatArray samples,
+        jint numSamples,
+        jstring language,
+        jobject outBuffer) {
+    std::lock_guard<std::mutex> ctxLock(g_ctx_mutex);
+
+    if (g_ctx == nullptr) {
+        LOGE("Whisper context not initialized");
+        return 0;
+    }
+
+    auto *out = static_cast<uint8_t *>(env->GetDirectBufferAddress(outBuffer));
+    const jlong capacity = env->GetDirectBufferCapacity(outBuffer);
+    if (out == nullptr || capacity <= 0) {
+        LOGE("transcribeToBuffer needs a direct ByteBuffer");
+        return 0;
+    }
+
+    // An empty sample array re-serializes the previous result (after a
+    // too-small buffer) without decoding again
+    if (numSamples > 0) {
+        jfloat *audioData = env->GetFloatArrayElements(samples, nullptr);
+
+        struct whisper_full_params params = buffer_params();
+
+        const char *lang = env->GetStringUTFChars(language, nullptr);
+        auto bias = bias_snapshot();
+        bias_apply(params, bias.get());
+
+        LOGI("Transcribing to buffer: %d samples...", numSamples);
+
+        int result = full_with_language(params, audioData, numSamples, lang);
+
+        env->ReleaseFloatArrayElements(samples, audioData, JNI_ABORT);
+        env->ReleaseStringUTFChars(language, lang);
+
+        if (result != 0) {
+            LOGE("Whisper inference failed with code: %d", result);
+            return 0;
+        }
+        g_last_duration_ms = (int) ((int64_t) numSamples * 1000 / WHISPER_SAMPLE_RATE);
+        cache_context_result();
+    }
+
+    long written = write_binary_result(g_last_result, out, (size_t) capacity, g_last_duration_ms);
+    if (written < 0) {
+        LOGD("Result needs %ld bytes, buffer has %lld", -written, (long long) capacity);
+    } else {
+        LOGI("Transcription to buffer complete: %ld bytes", written);
+    }
+    return (jint) written;
+}
+
+// ============================================================
+// transcribeUtteranceToBuffer - Decode the front end's last utterance
+// ============================================================
+// Same result layout as transcribeToBuffer, but the input is the log-mel
+// frames the native front end already computed while capturing, so
+// whisper's own STFT pass is skipped. Returns 0 when those frames aren't
+// available (no native utterance, frames overwritten, or a model that
+// doesn't use 80 mel bins) — the caller falls back to the PCM path.
+// gain is the amplitude gain the caller applied to the utterance PCM.
+JNIEXPORT jint JNICALL
+Java_com_nova_companion_voice_WhisperJNI_transcribeUtteranceToBuffer(
+        JNIEnv *env,
+        jobject /* this */,
+        jfloat gain,
+        jstring language,
+        jobject outBuffer) {
+    std::lock_guard<std::mutex> ctxLock(g_ctx_mutex);
+
+    if (g_ctx == nullptr) {
+        LOGE("Whisper context not initialized");
+        return 0;
+    }
+
+    auto *out = static_cast<uint8_t *>(env->GetDirectBufferAddress(outBuffer));
+    const jlong capacity = env->GetDirectBufferCapacity(outBuffer);
+    if (out == nullptr || capacity <= 0) {
+        LOGE("transcribeUtteranceToBuffer needs a direct ByteBuffer");
+        return 0;
+    }
+
+    const char *lang = env->GetStringUTFChars(language, nullptr);
+    int durationMs = 0;
+    const int result = decode_utterance_mel(gain, lang, durationMs);
+    env->ReleaseStringUTFChars(language, lang);
+
+    if (result != 0) {
+        if (result < 0) LOGE("Whisper inference failed with code: %d", result);
+        return 0;
+    }
+    g_last_duration_ms = durationMs;
+    cache_context_result();
+
+    long written = write_binary_result(g_last_result, out, (size_t) capacity, g_last_duration_ms);
+    if (written < 0) {
+        LOGD("Result needs %ld bytes, buffer has %lld", -written, (long long) capacity);
+    } else {
+        LOGI("Utterance transcription to buffer complete: %ld bytes", written);
+    }
+    return (jint) written;
+}
+
+// ============================================================
+// Long-form transcription (audio files: shared voice notes, recordings)
+// ============================================================
+// whisper_full walks a long recording one 30 s window at a time — encode,
+// decode, next window — and the decoder's serial token loop leaves most
+// cores idle while it runs. Long-form mode cuts the audio into overlapping
+// windows and runs two lanes, each with its own whisper_state and half the
+// threads, pulling windows off a shared feed. While one lane decodes
+// window N the other encodes N+1, so multi-minute audio approaches the
+// encoder-bound limit. Windows decode independently (no text context is
+// carried over; the bias prompt still applies). Each word belongs to the
+// window whose half of the overlap its midpoint falls in.
+//
+// Audio is pulled from a SampleSource as the feed needs it, so only about
+// one window per lane plus the feed's own window is ever resident — an
+// hour-long file costs the same memory as a 40 s one.
+
+static_assert(LONG_SAMPLE_RATE == WHISPER_SAMPLE_RATE, "long_window.h assumes whisper's rate");
+
+static const int LONG_LANES = 2;
+static const int LONG_MAX_THREADS = 8;
+static const int FILE_BLOCK_FRAMES = 4096;                  // per file read, at the file's rate
+
+// Language for a long-form run, resolved once up front: explicit codes
+// as-is, "auto" the session lock — detected on the first window (and locked
+// if confident) when nothing is locked yet.
+static int long_language(const float *audio, int n, const char *requested, int n_threads) {
+    if (strcmp(requested, "auto") != 0) {
+        const int id = whisper_lang_id(requested);
+        return id >= 0 ? id : whisper_lang_id("en");
+    }
+    if (!whisper_is_multilingual(g_ctx)) return whisper_lang_id("en");
+
+    LanguageSession session;
+    {
+        std::lock_guard<std::mutex> lock(g_lang_mutex);
+        session = g_lang;
+    }
+    if (session.lockedId >= 0) return session.lockedId;
+
+    const int first = std::min(n, LONG_WINDOW_MS * (WHISPER_SAMPLE_RATE / 1000));
+    float prob = 0.0f;
+    int id = -1;
+    if (whisper_pcm_to_mel(g_ctx, audio, first, n_threads) == 0) {
+        id = detect_language(session.allowed, n_threads, &prob);
+    }
+    if (id < 0) return whisper_lang_id("en");
+
+    if (prob >= session.lockThreshold && first >= LANG_MIN_LOCK_SAMPLES) {
+        std::lock_guard<std::mutex> lock(g_lang_mutex);
+        g_lang.lockedId = id;
+        g_lang.sinceCheck = 0;
+        LOGI("Session language locked: %s (p=%.2f)", whisper_lang_str(id), prob);
+    }
+    return id;
+}
+
+// Decode `first` and every window after it on LONG_LANES lanes; false if any
+// window failed or the source reported an error
+static bool transcribe_long(WindowFeed &feed, LongWindow first, int langId, const BiasPrompt *bias,
+                            Transcript &out) {
+    const int64_t msSamples = WHISPER_SAMPLE_RATE / 1000;
+    const int cores = std::max(2, std::min(LONG_MAX_THREADS, (int) std::thread::hardware_concurrency()));
+    // A single-window run keeps every core on one lane
+    const bool single = first.keepToMs == KEEP_ALL_TO;
+    const int lanes = single ? 1 : LONG_LANES;
+    const int threadsPerLane = std::max(1, cores / lanes);
+
+    std::mutex feedMutex;
+    bool haveFirst = true;
+    std::vector<Transcript> results;
+    std::atomic<bool> failed{false};
+
+    auto take = [&](LongWindow &w) {
+        std::lock_guard<std::mutex> lock(feedMutex);
+        if (failed.load()) return false;
+        if (haveFirst) {
+            w = std::move(first);
+            haveFirst = false;
+            return true;
+        }
+        return feed.next(w);
+    };
+
+    auto lane = [&]() {
+        struct whisper_state *state = whisper_init_state(g_ctx);
+        if (state == nullptr) {
+            LOGE("Long-form: failed to allocate a decoder state");
+            failed.store(true);
+            return;
+        }
+        LongWindow w;
+        while (take(w)) {
+            struct whisper_full_params params = buffer_params();
+            params.n_threads = threadsPerLane;
+            params.no_context = true;
+            params.language = whisper_lang_str(langId);
+            bias_apply(params, bias);
+
+            if (full_traced(state, params, w.audio.data(), (int) w.audio.size()) != 0) {
+                LOGE("Long-form: window %zu failed", w.index);
+                failed.store(true);
+                break;
+            }
+            Transcript part;
+            append_result({g_ctx, state}, part, (int32_t) (w.start / msSamples), w.keepFromMs, w.keepToMs);
+
+            std::lock_guard<std::mutex> lock(feedMutex);
+            if (results.size() <= w.index) results.resize(w.index + 1);
+            results[w.index] = std::move(part);
+        }
+        whisper_free_state(state);
+    };
+
+    std::vector<std::thread> workers;
+    for (int i = 1; i < lanes; i++) workers.emplace_back(lane);
+    lane();
+    for (auto &worker : workers) worker.join();
+    if (failed.load() || feed.failed()) return false;
+
+    LOGI("Long-form: %zu windows on %d lanes x %d threads", results.size(), lanes, threadsPerLane);
+    out = Transcript();
+    for (const Transcript &part : results) append_transcript(out, part);
+    return true;
+}
+
+// Resolve the language on the first window, decode, cache and serialize.
+// Returns the transcribeToBuffer byte count (0 on failure or empty input).
+static long transcribe_feed(WindowFeed &feed, const char *language, uint8_t *out, size_t capacity) {
+    const auto t0 = std::chrono::steady_clock::now();
+    LongWindow first;
+    if (!feed.next(first)) {
+        if (feed.failed()) LOGE("Long-form: could not read any audio");
+        return 0;
+    }
+
+    const int langId = long_language(first.audio.data(), (int) first.audio.size(), language,
+                                     buffer_params().n_threads);
+    auto bias = bias_snapshot();
+    Transcript transcript;
+    if (!transcribe_long(feed, std::move(first), langId, bias.get(), transcript)) {
+        LOGE("Long-form transcription failed");
+        return 0;
+    }
+    g_last_result = std::move(transcript);
+    g_last_duration_ms = (int) (feed.samples() * 1000 / WHISPER_SAMPLE_RATE);
+    LOGI("Long-form: %d ms of audio in %.0f ms (%s)", g_last_duration_ms, elapsed_ms(t0), whisper_lang_str(langId));
+
+    long written = write_binary_result(g_last_result, out, capacity, g_last_duration_ms);
+    if (written < 0) {
+        LOGD("Result needs %ld bytes, buffer has %zu", -written, capacity);
+    }
+    return written;
+}
+
+// ============================================================
+// transcribeFileToBuffer - Transcribe an audio file from disk
+// ============================================================
+// Streams the file through AudioFileReader (WAV, raw PCM, or any platform
+// codec — OGG/Opus voice notes, M4A, MP3) and the polyphase Resampler into
+// the long-form window feed, so neither the file nor its decoded audio is
+// ever held in memory whole. Same result layout and buffer contract as
+// transcribeToBuffer; the result's duration is the decoded length.
+JNIEXPORT jint JNICALL
+Java_com_nova_companion_voice_WhisperJNI_transcribeFileToBuffer(
+        JNIEnv *env,
+        jobject /* this */,
+        jstring path,
+        jstring language,
+        jobject outBuffer) {
+    std::lock_guard<std::mutex> ctxLock(g_ctx_mutex);
+
+    if (g_ctx == nullptr) {
+        LOGE("Whisper context not initialized");
+        return 0;
+    }
+
+    auto *out = static_cast<uint8_t *>(env->GetDirectBufferAddress(outBuffer));
+    const jlong capacity = env->GetDirectBufferCapacity(outBuffer);
+    if (out == nullptr || capacity <= 0) {
+        LOGE("transcribeFileToBuffer needs a direct ByteBuffer");
+        return 0;
+    }
+
+    const char *filePath = env->GetStringUTFChars(path, nullptr);
+    std::unique_ptr<AudioFileReader> reader = AudioFileReader::open(filePath);
+    env->ReleaseStringUTFChars(path, filePath);
+    if (!reader) return 0;
+
+    LOGI("Transcribing %s file at %d Hz", reader->format(), reader->sampleRate());
+    Resampler resampler(reader->sampleRate(), WHISPER_SAMPLE_RATE);
+    std::vector<float> block(FILE_BLOCK_FRAMES);
+    bool flushed = false;
+
+    WindowFeed feed([&](std::vector<float> &buf) {
+        const size_t before = buf.size();
+        while (buf.size() == before) {
+            if (flushed) return 0;
+            const int n = reader->read(block.data(), FILE_BLOCK_FRAMES);
+            if (n < 0) return -1;
+            if (n == 0) {
+                resampler.flush(buf);
+                flushed = true;
+            } else {
+                resampler.process(block.data(), n, buf);
+            }
+        }
+        return (int) (buf.size() - before);
+    });
+
+    const char *lang = env->GetStringUTFChars(language, nullptr);
+    const long written = transcribe_feed(feed, lang, out, (size_t) capacity);
+    env->ReleaseStringUTFChars(language, lang);
+    return (jint) written;
+}
+
+// ============================================================
+// transcribePartial - Streaming hypothesis of the utterance in progress
+// ============================================================
+// Cheap decode of everything the front end has captured so far (shared mel
+// frames, single segment, no timestamps). The text is handed to the front
+// end's endpointer, which ends the turn early once it stops changing, and
+// returned for live display. Never runs language detection: "auto" uses the
+// session lock (or the only allowed language) and skips partials until the
+// first final transcription has locked one. Returns "" when there's no
+// active utterance with speech yet.
+JNIEXPORT jstring JNICALL
+Java_com_nova_companion_voice_WhisperJNI_transcribePartial(
+        JNIEnv *env,
+        jobject /* this */,
+        jstring language) {
+    std::lock_guard<std::mutex> ctxLock(g_ctx_mutex);
+
+    if (g_ctx == nullptr) return env->NewStringUTF("");
+
+    const char *lang = env->GetStringUTFChars(language, nullptr);
+    const std::string text = decode_partial(lang);
+    env->ReleaseStringUTFChars(language, lang);
+    return env->NewStringUTF(text.c_str());
+}
+
+// ============================================================
+// setBiasVocabulary - Contact/app names to tune recognition toward
+// ============================================================
+JNIEXPORT jint JNICALL
+Java_com_nova_companion_voice_WhisperJNI_setBiasVocabulary(
+        JNIEnv *env,
+        jobject /* this */,
+        jobjectArray phrases,
+        jfloat boost) {
+
+    std::vector<std::string> list;
+    std::unordered_set<std::string> seen;
+    const int count = phrases ? env->GetArrayLength(phrases) : 0;
+    list.reserve(count);
+
+    for (int i = 0; i < count; i++) {
+        auto jstr = (jstring) env->GetObjectArrayElement(phrases, i);
+        if (jstr == nullptr) continue;
+        const char *s = env->GetStringUTFChars(jstr, nullptr);
+        std::string phrase(s);
+        env->ReleaseStringUTFChars(jstr, s);
+        env->DeleteLocalRef(jstr);
+
+        size_t start = phrase.find_first_not_of(" \t\n");
+        size_t end = phrase.find_last_not_of(" \t\n");
+        if (start == std::string::npos) continue;
+        phrase = phrase.substr(start, end - start + 1);
+        if (seen.insert(phrase).second) {
+            list.push_back(std::move(phrase));
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(g_bias_mutex);
+    g_bias_phrases = std::move(list);
+    g_bias_boost = boost;
+    bias_rebuild_locked();
+
+    return g_bias_prompt ? (jint) g_bias_prompt->tokens.size() : 0;
+}
+
+// ============================================================
+// clearBiasVocabulary
+// ============================================================
+JNIEXPORT void JNICALL
+Java_com_nova_companion_voice_WhisperJNI_clearBiasVocabulary(
+        JNIEnv *env,
+        jobject /* this */) {
+    std::lock_guard<std::mutex> lock(g_bias_mutex);
+    g_bias_phrases.clear();
+    g_bias_token_cache.clear();
+    g_bias_prompt.reset();
+    LOGI("Bias vocabulary cleared");
+}
+
+// ============================================================
+// configureLanguage - Candidate languages and lock policy
+// ============================================================
+JNIEXPORT void JNICALL
+Java_com_nova_companion_voice_WhisperJNI_configureLanguage(
+        JNIEnv *env,
+        jobject /* this */,
+        jstring allowedLanguages,
+        jfloat lockThreshold,
+        jint recheckInterval) {
+
+    const char *csv = env->GetStringUTFChars(allowedLanguages, nullptr);
+    std::vector<int> allowed;
+    std::string list(csv);
+    env->ReleaseStringUTFChars(allowedLanguages, csv);
+
+    size_t start = 0;
+    while (start <= list.size()) {
+        size_t end = list.find(',', start);
+        if (end == std::string::npos) end = list.size();
+        std::string code = list.substr(start, end - start);
+        code.erase(0, code.find_first_not_of(' '));
+        code.erase(code.find_last_not_of(' ') + 1);
+        if (!code.empty()) {
+            int id = whisper_lang_id(code.c_str());
+            if (id >= 0) {
+                allowed.push_back(id);
+            } else {
+                LOGE("Unknown language code: %s", code.c_str());
+            }
+        }
+        start = end + 1;
+    }
+
+    std::lock_guard<std::mutex> lock(g_lang_mutex);
+    g_lang.allowed = std::move(allowed);
+    g_lang.lockThreshold = lockThreshold;
+    g_lang.recheckInterval = std::max(1, (int) recheckInterval);
+    g_lang.lockedId = -1;
+    g_lang.sinceCheck = 0;
+    LOGI("Language policy: %zu candidates, lock at p>=%.2f, re-check every %d utterances",
+         g_lang.allowed.size(), g_lang.lockThreshold, g_lang.recheckInterval);
+}
+
+// ============================================================
+// resetLanguageSession - Forget the locked language
+// ============================================================
+JNIEXPORT void JNICALL
+Java_com_nova_companion_voice_WhisperJNI_resetLanguageSession(
+        JNIEnv *env,
+        jobject /* this */) {
+    std::lock_guard<std::mutex> lock(g_lang_mutex);
+    g_lang.lockedId = -1;
+    g_lang.sinceCheck = 0;
+}
+
+// ============================================================
+// getSessionLanguage - Locked language code ("" until detected)
+// ============================================================
+JNIEXPORT jstring JNICALL
+Java_com_nova_companion_voice_WhisperJNI_getSessionLanguage(
+        JNIEnv *env,
+        jobject /* this */) {
+    std::lock_guard<std::mutex> lock(g_lang_mutex);
+    return env->NewStringUTF(g_lang.lockedId >= 0 ? whisper_lang_str(g_lang.lockedId) : "");
+}
+
 // ============================================================
 // isInitialized
 // ============================================================
@@ -217,7 +1608,11 @@ JNIEXPORT void JNICALL
 Java_com_nova_companion_voice_WhisperJNI_freeContext(
         JNIEnv *env,
         jobject /* this */) {
+    std::lock_guard<std::mutex> ctxLock(g_ctx_mutex);
+    std::lock_guard<std::mutex> lock(g_bias_mutex);
     if (g_ctx != nullptr) {
+        g_bias_token_cache.clear();
+        g_bias_prompt.reset();
         whisper_free(g_ctx);
         g_ctx = nullptr;
         LOGI("Whisper context freed");
@@ -234,4 +1629,74 @@ Java_com_nova_companion_voice_WhisperJNI_getVersion(
     return env->NewStringUTF("whisper.cpp (Nova build)");
 }
 
+// ============================================================
+// Tracing (trace.h) - covers everything in libnova_whisper: the
+// front end, whisper and the native voice pipeline
+// ============================================================
+JNIEXPORT void JNICALL
+Java_com_nova_companion_voice_WhisperJNI_setTraceMode(
+        JNIEnv *env,
+        jobject /* this */,
+        jint mode) {
+    trace::set_mode(mode);
+}
+
+JNIEXPORT jstring JNICALL
+Java_com_nova_companion_voice_WhisperJNI_dumpTrace(
+        JNIEnv *env,
+        jobject /* this */) {
+    return env->NewStringUTF(trace::dump_events().c_str());
+}
+
 } // extern "C"
+
+// ============================================================
+// STT stage of the native voice pipeline (voice_pipeline.h)
+// ============================================================
+// Runs on the pipeline's control thread. The context is shared with
+// WhisperSTT (e.g. a voice note transcribed while the loop runs), so each
+// call holds g_ctx_mutex like the JNI entry points.
+
+namespace stt {
+
+bool ready() {
+    std::lock_guard<std::mutex> ctxLock(g_ctx_mutex);
+    return g_ctx != nullptr;
+}
+
+// Skipped while another decode holds the context; the next poll retries
+std::string partial(const std::string &language) {
+    std::unique_lock<std::mutex> ctxLock(g_ctx_mutex, std::try_to_lock);
+    if (!ctxLock.owns_lock() || g_ctx == nullptr) return "";
+    return decode_partial(language.c_str());
+}
+
+bool transcribe(std::vector<float> &pcm, float gain, const std::string &language, std::string &text) {
+    std::lock_guard<std::mutex> ctxLock(g_ctx_mutex);
+    if (g_ctx == nullptr) return false;
+    NOVA_TRACE_SCOPE("stt", "stt.transcribe");
+
+    int durationMs = 0;
+    int result = decode_utterance_mel(gain, language.c_str(), durationMs);
+    if (result == 1) {
+        if (pcm.empty()) return false;
+        for (float &v : pcm) v = std::max(-1.0f, std::min(1.0f, v * gain));
+        struct whisper_full_params params = buffer_params();
+        auto bias = bias_snapshot();
+        bias_apply(params, bias.get());
+        LOGI("Transcribing utterance PCM: %zu samples...", pcm.size());
+        result = full_with_language(params, pcm.data(), (int) pcm.size(), language.c_str());
+        durationMs = (int) ((int64_t) pcm.size() * 1000 / WHISPER_SAMPLE_RATE);
+    }
+    if (result != 0) {
+        LOGE("Whisper inference failed with code: %d", result);
+        return false;
+    }
+
+    g_last_duration_ms = durationMs;
+    cache_context_result();
+    text = context_text();
+    return true;
+}
+
+} // namespace stt
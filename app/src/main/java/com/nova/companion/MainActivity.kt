@@ -14,6 +14,7 @@ import android.util.Log
 import androidx.activity.ComponentActivity
 import androidx.activity.compose.setContent
 import androidx.activity.enableEdgeToEdge
+import androidx.activity.viewModels
 import androidx.activity.result.contract.ActivityResultContracts
 import androidx.compose.foundation.layout.Column
 import androidx.compose.foundation.layout.fillMaxWidth
@@ -37,6 +38,7 @@ import com.nova.companion.cloud.CloudConfig
 import com.nova.companion.notification.NovaNotificationPrefs
 import com.nova.companion.tools.ToolPermissionHelper
 import com.nova.companion.overlay.AuraOverlayService
+import com.nova.companion.ui.chat.ChatViewModel
 import com.nova.companion.ui.navigation.NovaNavigation
 import com.nova.companion.ui.theme.NovaTheme
 import com.nova.companion.vision.ScreenshotService
@@ -61,6 +63,9 @@ class MainActivity : ComponentActivity() {
 
     private var showAccessibilityBanner by mutableStateOf(false)
 
+    // Same instance NovaNavigation's chat screen gets (activity-scoped)
+    private val chatViewModel: ChatViewModel by viewModels()
+
     /**
      * Launcher for MediaProjection screen capture consent.
      * On approval, starts ScreenshotService with the projection token.
@@ -121,6 +126,25 @@ class MainActivity : ComponentActivity() {
                 NovaNavigation()
             }
         }
+
+        if (savedInstanceState == null) handleSharedAudio(intent)
+    }
+
+    override fun onNewIntent(intent: Intent) {
+        super.onNewIntent(intent)
+        handleSharedAudio(intent)
+    }
+
+    /**
+     * A voice note shared to Nova from another app: transcribed on-device and
+     * sent to the chat as the user's message.
+     */
+    private fun handleSharedAudio(intent: Intent?) {
+        if (intent?.action != Intent.ACTION_SEND || intent.type?.startsWith("audio/") != true) return
+        @Suppress("DEPRECATION")
+        val uri = intent.getParcelableExtra<Uri>(Intent.EXTRA_STREAM) ?: return
+        Log.i(TAG, "Voice note shared: $uri")
+        chatViewModel.transcribeVoiceNote(uri)
     }
 
     override fun onResume() {
@@ -3,6 +3,7 @@ package com.nova.companion
 import android.app.Application
 import android.util.Log
 import androidx.work.Configuration
+import com.nova.companion.core.NativeTrace
 import com.nova.companion.data.NovaDatabase
 import com.nova.companion.data.objectbox.NovaObjectBox
 import com.nova.companion.memory.SemanticSearch
@@ -17,6 +18,7 @@ class NovaApp : Application(), Configuration.Provider {
     override fun onCreate() {
         super.onCreate()
         ProactiveNotificationHelper.ensureChannel(this)
+        NativeTrace.applySetting(this)
 
         // Initialize ObjectBox vector store for semantic search
         try {
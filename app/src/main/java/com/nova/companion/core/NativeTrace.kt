@@ -0,0 +1,117 @@
+package com.nova.companion.core
+
+import android.content.Context
+import android.os.Process
+import android.util.Log
+import com.nova.companion.inference.LlamaJNI
+import com.nova.companion.voice.PiperJNI
+import com.nova.companion.voice.WhisperJNI
+import java.io.File
+
+/**
+ * Span tracing across the native engines (trace.h): the front end, Whisper
+ * and the native voice pipeline (nova_whisper), llama.cpp (nova_llama) and
+ * Piper (nova_piper), merged into one Chrome trace JSON timeline.
+ *
+ * Open the dump in ui.perfetto.dev or chrome://tracing. [MODE_ATRACE]
+ * additionally shows the same spans in a Perfetto / systrace system trace.
+ * Libraries that aren't built are skipped.
+ *
+ * Usage:
+ *   NativeTrace.enable()
+ *   ... run a few turns ...
+ *   NativeTrace.dump(File(context.getExternalFilesDir(null), "nova_trace.json"))
+ *
+ * Settings → Developer has the same as a toggle ([TRACE_PREF], applied at
+ * app start by [applySetting]) and a "Save trace" button ([defaultFile]).
+ */
+object NativeTrace {
+
+    private const val TAG = "NativeTrace"
+
+    // Mode bits (trace.h)
+    const val MODE_OFF = 0
+    const val MODE_BUFFER = 1
+    const val MODE_ATRACE = 2
+
+    // Settings key ("nova_settings"): trace from app start, off by default
+    const val TRACE_PREF = "native_trace"
+
+    private class Engine(
+        val name: String,
+        val setMode: (Int) -> Unit,
+        val dump: () -> String
+    )
+
+    private val engines: List<Engine> by lazy {
+        listOfNotNull(
+            load("nova_whisper") { WhisperJNI().let { Engine("nova_whisper", it::setTraceMode, it::dumpTrace) } },
+            load("nova_llama") { LlamaJNI().let { Engine("nova_llama", it::setTraceMode, it::dumpTrace) } },
+            load("nova_piper") { PiperJNI().let { Engine("nova_piper", it::setTraceMode, it::dumpTrace) } },
+        )
+    }
+
+    /**
+     * Start a new trace in every engine; spans recorded before are dropped.
+     * @param mode [MODE_BUFFER] to record for [dump], plus [MODE_ATRACE] to
+     *        forward spans to ATrace; [MODE_OFF] stops tracing.
+     */
+    fun enable(mode: Int = MODE_BUFFER) {
+        for (engine in engines) {
+            try {
+                engine.setMode(mode)
+            } catch (e: LinkageError) {
+                Log.w(TAG, "${engine.name} has no tracing", e)
+            }
+        }
+        Log.i(TAG, "Native tracing mode $mode (${engines.joinToString { it.name }})")
+    }
+
+    fun disable() = enable(MODE_OFF)
+
+    /** Turn tracing on if the Settings toggle ([TRACE_PREF]) is set. */
+    fun applySetting(context: Context) {
+        val prefs = context.getSharedPreferences("nova_settings", Context.MODE_PRIVATE)
+        if (prefs.getBoolean(TRACE_PREF, false)) enable()
+    }
+
+    /** Where Settings saves the trace (app-specific external storage, no permission needed). */
+    fun defaultFile(context: Context): File = File(context.getExternalFilesDir(null), "nova_trace.json")
+
+    /**
+     * Write the spans recorded so far as Chrome trace JSON. Tracing keeps
+     * running; call [disable] to stop it.
+     * @return false if nothing could be written.
+     */
+    fun dump(file: File): Boolean {
+        val pid = Process.myPid()
+        val events = mutableListOf("""{"name":"process_name","ph":"M","pid":$pid,"args":{"name":"nova"}}""")
+        for (engine in engines) {
+            val dumped = try {
+                engine.dump()
+            } catch (e: LinkageError) {
+                Log.w(TAG, "${engine.name} has no tracing", e)
+                continue
+            }
+            if (dumped.isNotEmpty()) events += dumped
+        }
+        val json = events.joinToString(",", prefix = "{\"traceEvents\":[", postfix = "]}")
+        return try {
+            file.parentFile?.mkdirs()
+            file.writeText(json)
+            Log.i(TAG, "Trace written to ${file.absolutePath} (${json.length / 1024} KB)")
+            true
+        } catch (e: Exception) {
+            Log.e(TAG, "Failed to write trace", e)
+            false
+        }
+    }
+
+    private fun load(library: String, create: () -> Engine): Engine? = try {
+        create()
+    } catch (e: LinkageError) {
+        // UnsatisfiedLinkError when not built; any other link failure also just skips it
+        Log.i(TAG, "$library not available — not traced")
+        null
+    }
+}
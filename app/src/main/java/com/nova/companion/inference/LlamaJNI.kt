@@ -72,6 +72,15 @@ class LlamaJNI {
 
     /** Check if generation is currently in progress. */
     external fun isGenerating(): Boolean
+
+    /**
+     * Span tracing for llama.cpp generation. Prefer [com.nova.companion.core.NativeTrace].
+     * @param mode Bits: 1 records spans for [dumpTrace], 2 forwards them to ATrace.
+     */
+    external fun setTraceMode(mode: Int)
+
+    /** Spans recorded since tracing was enabled, as comma-separated Chrome trace events. */
+    external fun dumpTrace(): String
 }
 
 /**
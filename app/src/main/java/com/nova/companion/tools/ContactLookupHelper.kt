@@ -1,9 +1,12 @@
 package com.nova.companion.tools
 
+import android.Manifest
 import android.content.Context
+import android.content.pm.PackageManager
 import android.database.Cursor
 import android.provider.ContactsContract
 import android.util.Log
+import androidx.core.content.ContextCompat
 import com.nova.companion.data.NovaDatabase
 import kotlinx.coroutines.runBlocking
 
@@ -80,6 +83,45 @@ object ContactLookupHelper {
         return results
     }
 
+    /**
+     * Load contact display names plus first names, for STT keyword biasing.
+     * Returns a list like ["Rahul Sharma", "Rahul", "Priya", ...] in contact order.
+     */
+    fun loadContactNames(context: Context): List<String> {
+        if (ContextCompat.checkSelfPermission(context, Manifest.permission.READ_CONTACTS)
+            != PackageManager.PERMISSION_GRANTED) return emptyList()
+
+        val names = linkedSetOf<String>()
+        var cursor: Cursor? = null
+        try {
+            cursor = context.contentResolver.query(
+                ContactsContract.Contacts.CONTENT_URI,
+                arrayOf(ContactsContract.Contacts.DISPLAY_NAME_PRIMARY),
+                null, null,
+                "${ContactsContract.Contacts.DISPLAY_NAME_PRIMARY} ASC"
+            )
+            cursor?.let {
+                val col = it.getColumnIndex(ContactsContract.Contacts.DISPLAY_NAME_PRIMARY)
+                while (it.moveToNext()) {
+                    val fullName = if (col >= 0) it.getString(col) else null
+                    if (!fullName.isNullOrBlank()) {
+                        // Add both full name and first name as keywords
+                        names.add(fullName.trim())
+                        fullName.trim().split(" ").firstOrNull()
+                            ?.takeIf { n -> n.length > 2 }
+                            ?.let { fn -> names.add(fn) }
+                    }
+                }
+            }
+        } catch (e: Exception) {
+            Log.w(TAG, "Failed to load contact names", e)
+        } finally {
+            cursor?.close()
+        }
+        Log.d(TAG, "Loaded ${names.size} contact names")
+        return names.toList()
+    }
+
     fun formatPhoneForWhatsApp(phone: String): String {
         val cleaned = phone.replace(Regex("[\\s\\-().]"), "")
         return if (cleaned.startsWith("+")) {
@@ -149,6 +149,8 @@ class NovaViewModel(app: Application) : AndroidViewModel(app) {
 
         val userText = text
         val appContext = getApplication<Application>().applicationContext
+        // Voice mode: speak the reply as it streams (Piper starts on the first clause)
+        var speakingStream = false
 
         viewModelScope.launch {
             // Inject memory context before generation (runs on IO)
@@ -169,6 +171,12 @@ class NovaViewModel(app: Application) : AndroidViewModel(app) {
                         memoryContext = memoryContext,
                         onToken = { token ->
                             _streamingText.value += token
+                            if (isVoiceModeEnabled.value) {
+                                if (!speakingStream) {
+                                    speakingStream = voiceManager.beginStreamingResponse(viewModelScope)
+                                }
+                                if (speakingStream) voiceManager.appendResponseText(token)
+                            }
                             val current = _messages.value.toMutableList()
                             if (current.isNotEmpty() && current.last().isStreaming) {
                                 current[current.lastIndex] = ChatMessage(
@@ -194,7 +202,9 @@ class NovaViewModel(app: Application) : AndroidViewModel(app) {
                             _streamingText.value = ""
 
                             // If voice mode: speak the response via Piper TTS
-                            if (isVoiceModeEnabled.value && finalText.isNotBlank()) {
+                            if (speakingStream) {
+                                voiceManager.finishResponse()
+                            } else if (isVoiceModeEnabled.value && finalText.isNotBlank()) {
                                 voiceManager.speakResponse(finalText, viewModelScope)
                             }
 
@@ -220,6 +230,7 @@ class NovaViewModel(app: Application) : AndroidViewModel(app) {
                                 _messages.value = current
                             }
                             _streamingText.value = ""
+                            if (speakingStream) voiceManager.interruptSpeech()
                         }
                     )
                 } catch (e: Exception) {
@@ -283,7 +294,9 @@ class NovaViewModel(app: Application) : AndroidViewModel(app) {
         viewModelScope.launch {
             _isVoiceLoading.value = true
             try {
-                voiceManager.toggleVoiceMode()
+                if (voiceManager.toggleVoiceMode(getApplication())) {
+                    voiceManager.refreshBiasVocabulary(getApplication())
+                }
             } finally {
                 _isVoiceLoading.value = false
             }
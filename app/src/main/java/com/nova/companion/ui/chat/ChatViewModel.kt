@@ -2,6 +2,8 @@ package com.nova.companion.ui.chat
 
 import android.app.Application
 import android.content.Context
+import android.net.Uri
+import android.webkit.MimeTypeMap
 import com.nova.companion.inference.HybridInferenceRouter
 import com.nova.companion.inference.OfflineCapabilityManager
 import android.os.Build
@@ -31,7 +33,9 @@ import com.nova.companion.overlay.bubble.TaskBubbleService
 import com.nova.companion.overlay.bubble.TaskProgressManager
 import com.nova.companion.tools.ToolRegistry
 import com.nova.companion.ui.aura.AuraState
+import com.nova.companion.voice.ActiveVoiceManagerHolder
 import com.nova.companion.voice.NovaVoicePipeline
+import com.nova.companion.voice.VoiceManager
 import com.nova.companion.voice.WakeWordService
 import com.nova.companion.widget.NovaWidget
 import kotlinx.coroutines.Dispatchers
@@ -45,7 +49,9 @@ import kotlinx.coroutines.flow.combine
 import kotlinx.coroutines.flow.stateIn
 import kotlinx.coroutines.flow.update
 import kotlinx.coroutines.launch
+import kotlinx.coroutines.withContext
 import java.io.File
+import java.io.IOException
 
 data class ChatMessage(
     val id: Long = 0,
@@ -908,6 +914,61 @@ class ChatViewModel(application: Application) : AndroidViewModel(application) {
         router.switchToTextMode()
     }
 
+    // Whisper for voice notes when voice mode has no VoiceManager registered.
+    // Kept for the ViewModel's lifetime: the whisper context is process-wide,
+    // so releasing it after each note could free it under another caller.
+    private var voiceNoteManager: VoiceManager? = null
+
+    /**
+     * Voice note shared to Nova (ACTION_SEND audio/*): transcribe it on-device
+     * and send the transcript as the user's message. Uses voice mode's Whisper
+     * when it's loaded, otherwise one loaded for voice notes.
+     */
+    fun transcribeVoiceNote(uri: Uri) {
+        viewModelScope.launch {
+            val transcript = withContext(Dispatchers.IO) {
+                // Unique per share, so notes shared back to back don't overwrite each other
+                val file = try {
+                    File.createTempFile("voice_note", ".${voiceNoteExtension(uri)}", appContext.cacheDir)
+                } catch (e: IOException) {
+                    Log.e(TAG, "No room for shared audio", e)
+                    return@withContext ""
+                }
+                try {
+                    val copied = try {
+                        appContext.contentResolver.openInputStream(uri)?.use { input ->
+                            file.outputStream().use { input.copyTo(it) }
+                        } != null
+                    } catch (e: Exception) {
+                        Log.e(TAG, "Could not read shared audio $uri", e)
+                        false
+                    }
+                    if (copied) voiceNoteVoiceManager().transcribeFile(appContext, file) else ""
+                } finally {
+                    file.delete()
+                }
+            }
+            if (transcript.isBlank()) {
+                Log.w(TAG, "Voice note had no transcribable speech")
+                return@launch
+            }
+            sendMessage(transcript)
+        }
+    }
+
+    @Synchronized
+    private fun voiceNoteVoiceManager(): VoiceManager =
+        ActiveVoiceManagerHolder.voiceManager
+            ?: voiceNoteManager
+            ?: VoiceManager().also { voiceNoteManager = it }
+
+    // The native reader picks WAV / raw PCM by header or extension, anything
+    // else goes to the platform decoder, so the extension only has to be plausible
+    private fun voiceNoteExtension(uri: Uri): String {
+        val type = appContext.contentResolver.getType(uri)
+        return type?.let { MimeTypeMap.getSingleton().getExtensionFromMimeType(it) } ?: "audio"
+    }
+
     // ── Conversation helpers ─────────────────────────────────
 
     /** Build history as role/content pairs — used by hybrid router and cloud APIs */
@@ -955,6 +1016,9 @@ class ChatViewModel(application: Application) : AndroidViewModel(application) {
         super.onCleared()
         cancelGeneration()
         voicePipeline.release()
+        // Only when nothing else registered since: then no one shares the context
+        if (ActiveVoiceManagerHolder.voiceManager == null) voiceNoteManager?.release()
+        voiceNoteManager = null
         OfflineCapabilityManager.shutdown()
     }
 }
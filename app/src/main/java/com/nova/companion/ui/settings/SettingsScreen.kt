@@ -1,6 +1,7 @@
 package com.nova.companion.ui.settings
 
 import android.app.TimePickerDialog
+import android.widget.Toast
 import androidx.compose.animation.core.FastOutSlowInEasing
 import androidx.compose.animation.core.LinearEasing
 import androidx.compose.animation.core.RepeatMode
@@ -74,6 +75,7 @@ import androidx.compose.ui.platform.LocalContext
 import androidx.compose.ui.text.font.FontWeight
 import androidx.compose.ui.unit.dp
 import androidx.compose.ui.unit.sp
+import com.nova.companion.core.NativeTrace
 import com.nova.companion.data.NovaDatabase
 import com.nova.companion.data.entity.ContactAlias
 import com.nova.companion.notification.NotificationScheduler
@@ -99,7 +101,11 @@ import com.nova.companion.ui.theme.NovaTextDim
 import com.nova.companion.ui.theme.NovaTextMuted
 import com.nova.companion.ui.theme.NovaTextPrimary
 import com.nova.companion.ui.theme.NovaTextSecondary
+import com.nova.companion.voice.NativeVoicePipeline
+import com.nova.companion.voice.VoiceManager
+import kotlinx.coroutines.Dispatchers
 import kotlinx.coroutines.launch
+import kotlinx.coroutines.withContext
 
 @OptIn(ExperimentalMaterial3Api::class)
 @Composable
@@ -343,6 +349,54 @@ fun SettingsScreen(
                             }
                         )
 
+                        Spacer(modifier = Modifier.height(12.dp))
+                        var sttLanguages by remember {
+                            mutableStateOf(voicePrefs.getString(VoiceManager.STT_LANGUAGES_PREF, "").orEmpty())
+                        }
+                        OutlinedTextField(
+                            value = sttLanguages,
+                            onValueChange = {
+                                sttLanguages = it
+                                voicePrefs.edit().putString(VoiceManager.STT_LANGUAGES_PREF, it).apply()
+                            },
+                            label = { Text("Speech languages (e.g. en, hi)") },
+                            supportingText = { Text("Local speech recognition only; empty detects any language") },
+                            singleLine = true,
+                            colors = OutlinedTextFieldDefaults.colors(
+                                focusedTextColor = Color.White,
+                                unfocusedTextColor = Color.White,
+                                focusedBorderColor = NovaPurpleCore,
+                                unfocusedBorderColor = NovaSurfaceVariant,
+                                focusedLabelColor = NovaPurpleCore,
+                                unfocusedLabelColor = NovaTextSecondary
+                            ),
+                            modifier = Modifier.fillMaxWidth()
+                        )
+
+                        Spacer(modifier = Modifier.height(12.dp))
+                        var nativeModelPath by remember {
+                            mutableStateOf(voicePrefs.getString(NativeVoicePipeline.MODEL_PATH_PREF, "").orEmpty())
+                        }
+                        OutlinedTextField(
+                            value = nativeModelPath,
+                            onValueChange = {
+                                nativeModelPath = it
+                                voicePrefs.edit().putString(NativeVoicePipeline.MODEL_PATH_PREF, it).apply()
+                            },
+                            label = { Text("Native pipeline model (.gguf path)") },
+                            supportingText = { Text("Offline voice loop; used only while no MLC model is loaded") },
+                            singleLine = true,
+                            colors = OutlinedTextFieldDefaults.colors(
+                                focusedTextColor = Color.White,
+                                unfocusedTextColor = Color.White,
+                                focusedBorderColor = NovaPurpleCore,
+                                unfocusedBorderColor = NovaSurfaceVariant,
+                                focusedLabelColor = NovaPurpleCore,
+                                unfocusedLabelColor = NovaTextSecondary
+                            ),
+                            modifier = Modifier.fillMaxWidth()
+                        )
+
                         Spacer(modifier = Modifier.height(12.dp))
                         HorizontalDivider(color = NovaSurfaceVariant.copy(alpha = 0.5f))
                         Spacer(modifier = Modifier.height(12.dp))
@@ -461,6 +515,45 @@ fun SettingsScreen(
 
                 Spacer(modifier = Modifier.height(8.dp))
 
+                // Native engine tracing (NativeTrace) — spans for Perfetto
+                SettingsCard {
+                    Column(modifier = Modifier.padding(16.dp)) {
+                        val context = LocalContext.current
+                        val tracePrefs = context.getSharedPreferences("nova_settings", 0)
+                        val traceScope = rememberCoroutineScope()
+                        var tracing by remember {
+                            mutableStateOf(tracePrefs.getBoolean(NativeTrace.TRACE_PREF, false))
+                        }
+                        NotifToggleRow(
+                            label = "Native Tracing",
+                            subtitle = "Record Whisper, llama.cpp and Piper spans, from app start while on",
+                            checked = tracing,
+                            onCheckedChange = {
+                                tracing = it
+                                tracePrefs.edit().putBoolean(NativeTrace.TRACE_PREF, it).apply()
+                                traceScope.launch(Dispatchers.IO) {
+                                    if (it) NativeTrace.enable() else NativeTrace.disable()
+                                }
+                            }
+                        )
+                        TextButton(
+                            onClick = {
+                                traceScope.launch {
+                                    val file = NativeTrace.defaultFile(context)
+                                    val saved = withContext(Dispatchers.IO) { NativeTrace.dump(file) }
+                                    val message = if (saved) "Trace saved to ${file.absolutePath}" else "Could not save trace"
+                                    Toast.makeText(context, message, Toast.LENGTH_LONG).show()
+                                }
+                            },
+                            enabled = tracing
+                        ) {
+                            Text("Save Trace", color = if (tracing) NovaPurpleCore else NovaTextDim)
+                        }
+                    }
+                }
+
+                Spacer(modifier = Modifier.height(8.dp))
+
                 // God Mode — animated gradient border banner
                 GodModeBanner(onClick = onNavigateToGodMode)
             }
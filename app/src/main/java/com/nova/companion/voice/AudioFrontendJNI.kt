@@ -0,0 +1,84 @@
+package com.nova.companion.voice
+
+/**
+ * JNI bridge to the native voice front end (AAudio mic capture, VAD,
+ * wake word, utterance capture). Prefer [NativeAudioFrontend], which owns
+ * the lifecycle and turns native events into flows.
+ *
+ * Native methods correspond to functions in frontend_jni.cpp, which is
+ * built into "nova_whisper" so utterances stay next to the decoder.
+ */
+class AudioFrontendJNI {
+
+    companion object {
+        init {
+            System.loadLibrary("nova_whisper")
+        }
+
+        // Event codes returned by nextEvent (voice_frontend.h)
+        const val EVENT_NONE = 0
+        const val EVENT_WAKE_WORD = 1
+        const val EVENT_SPEECH_START = 2
+        const val EVENT_SPEECH_END = 3
+        const val EVENT_UTTERANCE_TIMEOUT = 4
+        const val EVENT_CAPTURE_ERROR = 5
+        const val EVENT_END_OF_TURN = 6
+    }
+
+    /**
+     * Open the mic (16kHz mono, VOICE_RECOGNITION preset) and start the
+     * front-end worker. Idempotent.
+     * @return false if the input stream could not be opened.
+     */
+    external fun start(): Boolean
+
+    /**
+     * Stop the worker and release the mic.
+     */
+    external fun stop()
+
+    external fun isRunning(): Boolean
+
+    /**
+     * Load the "Hey Nova" keyword spotter (GGUF, see kws.h for the layout).
+     * @param threshold Smoothed posterior needed to fire, 0..1.
+     */
+    external fun loadKeywordModel(modelPath: String, threshold: Float): Boolean
+
+    external fun setWakeWordEnabled(enabled: Boolean)
+
+    /**
+     * Bypass switches for the native preprocessing stages (noise suppression
+     * and AGC) that run on every hop before VAD, wake word and STT.
+     */
+    external fun setPreprocessing(noiseSuppression: Boolean, agc: Boolean)
+
+    /**
+     * Preprocessing cost since capture started.
+     * @return [hops, average µs per hop, max µs per hop, hops over budget].
+     */
+    external fun getPreprocessStats(): FloatArray
+
+    /**
+     * Start collecting an utterance from the shared ring, including
+     * [preRollMs] of audio captured before the call.
+     */
+    external fun beginUtterance(preRollMs: Int, silenceMs: Int, minSpeechMs: Int, maxMs: Int)
+
+    /**
+     * Finish the utterance.
+     * @return 16kHz mono samples normalized to -1.0..1.0.
+     */
+    external fun endUtterance(): FloatArray
+
+    /**
+     * Block up to [timeoutMs] for the next front-end event.
+     * @return One of the EVENT_* codes, [EVENT_NONE] on timeout.
+     */
+    external fun nextEvent(timeoutMs: Int): Int
+
+    /**
+     * Mic level of the last 10 ms hop, 0..1.
+     */
+    external fun getLevel(): Float
+}
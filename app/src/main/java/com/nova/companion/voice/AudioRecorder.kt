@@ -13,6 +13,7 @@ import kotlinx.coroutines.flow.SharedFlow
 import kotlinx.coroutines.flow.StateFlow
 import kotlinx.coroutines.flow.asSharedFlow
 import kotlinx.coroutines.flow.asStateFlow
+import kotlinx.coroutines.flow.first
 import kotlin.math.abs
 import kotlin.math.sqrt
 
@@ -29,6 +30,13 @@ import kotlin.math.sqrt
  * - Adaptive VAD: samples ambient noise for first 500ms, threshold = 2.5× ambient RMS
  * - Gain normalization: running gain factor targets ~0.7 peak amplitude
  * - Min speech duration: 800ms before VAD can trigger auto-stop
+ *
+ * When the native front end is available the recorder doesn't open the mic
+ * itself: it takes the utterance out of [NativeAudioFrontend]'s shared
+ * capture (the same stream the wake word listens on), with the same VAD
+ * rules applied natively plus a short pre-roll. There the 3 s silence is
+ * only the backstop: streaming partials from [WhisperSTT] let the native
+ * endpointer end the turn after a short pause once the transcript settles.
  */
 class AudioRecorder {
 
@@ -55,6 +63,10 @@ class AudioRecorder {
         private const val GAIN_SMOOTH_FACTOR = 0.05f
         private const val GAIN_MIN = 0.1f
         private const val GAIN_MAX = 10f
+
+        // Native front end: owner name and audio kept from before startRecording()
+        private const val FRONTEND_OWNER = "AudioRecorder"
+        private const val NATIVE_PRE_ROLL_MS = 300
     }
 
     private var audioRecord: AudioRecord? = null
@@ -79,6 +91,17 @@ class AudioRecorder {
 
     @Volatile private var runningGain = 1f
 
+    // True while the current recording comes from the native front end
+    @Volatile var nativeCapture = false
+        private set
+
+    /**
+     * Gain applied to the last recording if it came from the native front end
+     * (its mel frames can then be decoded directly), null otherwise.
+     */
+    @Volatile var lastNativeGain: Float? = null
+        private set
+
     /**
      * Start recording from microphone.
      * Records until stopRecording() is called or VAD detects prolonged silence.
@@ -89,6 +112,13 @@ class AudioRecorder {
             Log.w(TAG, "Already recording")
             return false
         }
+        lastNativeGain = null
+
+        if (NativeAudioFrontend.acquire(FRONTEND_OWNER)) {
+            startNativeRecording()
+            return true
+        }
+        NativeAudioFrontend.release(FRONTEND_OWNER)
 
         val bufferSize = AudioRecord.getMinBufferSize(
             SAMPLE_RATE, CHANNEL_CONFIG, AUDIO_FORMAT
@@ -169,6 +199,13 @@ class AudioRecorder {
     fun stopRecording(): FloatArray? {
         if (!_isRecording.value) return null
 
+        if (nativeCapture) {
+            _isRecording.value = false
+            recordingJob?.cancel()
+            recordingScope?.cancel()
+            return finishNativeRecording().takeIf { it.isNotEmpty() }
+        }
+
         _isRecording.value = false
         audioRecord?.stop()
         recordingJob?.cancel()
@@ -303,6 +340,68 @@ class AudioRecorder {
         }
     }
 
+    // ── Native front end ──────────────────────────────────────────
+
+    private fun startNativeRecording() {
+        nativeCapture = true
+        NativeAudioFrontend.beginUtterance(
+            preRollMs = NATIVE_PRE_ROLL_MS,
+            silenceMs = VAD_SILENCE_DURATION_MS.toInt(),
+            minSpeechMs = VAD_MIN_SPEECH_MS.toInt(),
+            maxMs = MAX_RECORDING_MS.toInt()
+        )
+        _isRecording.value = true
+        _amplitudeLevel.value = 0f
+
+        recordingScope = CoroutineScope(Dispatchers.IO + SupervisorJob())
+        recordingJob = recordingScope?.launch {
+            val levelJob = launch {
+                NativeAudioFrontend.level.collect { _amplitudeLevel.value = it }
+            }
+            val event = NativeAudioFrontend.events.first {
+                it == NativeAudioFrontend.Event.SPEECH_END ||
+                    it == NativeAudioFrontend.Event.END_OF_TURN ||
+                    it == NativeAudioFrontend.Event.UTTERANCE_TIMEOUT ||
+                    it == NativeAudioFrontend.Event.CAPTURE_ERROR
+            }
+            levelJob.cancel()
+            if (!_isRecording.value) return@launch
+
+            Log.i(TAG, "Native front end ended utterance: $event")
+            _isRecording.value = false
+            _recordingComplete.emit(finishNativeRecording())
+            if (event == NativeAudioFrontend.Event.SPEECH_END ||
+                event == NativeAudioFrontend.Event.END_OF_TURN
+            ) {
+                _vadTriggered.emit(Unit)
+            }
+        }
+        Log.i(TAG, "Recording started (native front end, ${NATIVE_PRE_ROLL_MS}ms pre-roll)")
+    }
+
+    private fun finishNativeRecording(): FloatArray {
+        val samples = NativeAudioFrontend.endUtterance()
+        NativeAudioFrontend.release(FRONTEND_OWNER)
+        nativeCapture = false
+        _amplitudeLevel.value = 0f
+        // Native AGC has already levelled the capture; peak gain on top would
+        // only raise the noise floor of quiet utterances again
+        lastNativeGain = if (NativeAudioFrontend.agcEnabled) 1f else normalizeGain(samples)
+        Log.i(TAG, "Recording stopped. Samples: ${samples.size} (${samples.size / SAMPLE_RATE}s)")
+        return samples
+    }
+
+    // Whole-utterance version of the streaming gain normalization above;
+    // returns the gain applied
+    private fun normalizeGain(samples: FloatArray): Float {
+        var peak = 0f
+        for (v in samples) peak = maxOf(peak, abs(v))
+        if (peak <= 0f) return 1f
+        val gain = (GAIN_TARGET / peak).coerceIn(GAIN_MIN, GAIN_MAX)
+        for (i in samples.indices) samples[i] = (samples[i] * gain).coerceIn(-1f, 1f)
+        return gain
+    }
+
     private fun computeRMS(buffer: ShortArray, count: Int): Float {
         var sum = 0.0
         for (i in 0 until count) {
@@ -0,0 +1,238 @@
+package com.nova.companion.voice
+
+import android.content.Context
+import android.os.Environment
+import android.util.Log
+import kotlinx.coroutines.CoroutineScope
+import kotlinx.coroutines.Dispatchers
+import kotlinx.coroutines.Job
+import kotlinx.coroutines.SupervisorJob
+import kotlinx.coroutines.currentCoroutineContext
+import kotlinx.coroutines.isActive
+import kotlinx.coroutines.launch
+import kotlinx.coroutines.flow.MutableSharedFlow
+import kotlinx.coroutines.flow.MutableStateFlow
+import kotlinx.coroutines.flow.SharedFlow
+import kotlinx.coroutines.flow.StateFlow
+import kotlinx.coroutines.flow.asSharedFlow
+import kotlinx.coroutines.flow.asStateFlow
+import java.io.File
+
+/**
+ * Single owner of the microphone for on-device voice: wake word, VAD and
+ * Whisper utterances all read from one native capture stream.
+ *
+ * Consumers [acquire] the front end under a name and [release] it when done;
+ * the mic is open while at least one owner holds it. Components that need
+ * the raw mic for themselves (SpeechRecognizer, ElevenLabs) go through
+ * [suspendCapture] / [resumeCapture] via WakeWordService.pauseListening().
+ */
+object NativeAudioFrontend {
+
+    private const val TAG = "NativeAudioFrontend"
+
+    // Keyword spotter model — bundled in assets/ or copied next to the other models
+    const val KEYWORD_MODEL_NAME = "hey_nova_kws.gguf"
+
+    // Settings key ("nova_settings") for the native NS / AGC stages, on by default
+    const val PREPROCESSING_PREF = "native_audio_preprocessing"
+
+    private const val EVENT_POLL_MS = 100
+
+    /** Native preprocessing cost per 10 ms hop since capture started. */
+    data class PreprocessStats(
+        val hops: Long,
+        val avgMicros: Float,
+        val maxMicros: Float,
+        val overBudgetHops: Long
+    )
+
+    enum class Event {
+        WAKE_WORD,
+        SPEECH_START,
+        SPEECH_END,
+        UTTERANCE_TIMEOUT,
+        CAPTURE_ERROR,
+        /** Early endpoint: the partial transcript settled and the user paused. */
+        END_OF_TURN
+    }
+
+    private val jni: AudioFrontendJNI? by lazy {
+        try {
+            AudioFrontendJNI()
+        } catch (e: LinkageError) {
+            Log.w(TAG, "Native front end unavailable", e)
+            null
+        }
+    }
+
+    private val scope = CoroutineScope(Dispatchers.IO + SupervisorJob())
+    private var pumpJob: Job? = null
+
+    private val owners = mutableSetOf<String>()
+    private var suspended = false
+
+    private val _events = MutableSharedFlow<Event>(extraBufferCapacity = 16)
+    val events: SharedFlow<Event> = _events.asSharedFlow()
+
+    private val _level = MutableStateFlow(0f)
+    val level: StateFlow<Float> = _level.asStateFlow()
+
+    val isAvailable: Boolean get() = jni != null
+
+    /** Native AGC is levelling the capture (the native default), so callers skip their own gain. */
+    @Volatile var agcEnabled = true
+        private set
+
+    /** Capture is released for another mic consumer (see [suspendCapture]). */
+    val isSuspended: Boolean @Synchronized get() = suspended
+
+    /**
+     * Register [owner] as a consumer and make sure the mic is running.
+     * @return true if capture is running for the caller; false if the native
+     *         library is missing, the mic is suspended for another consumer,
+     *         or the input stream could not be opened.
+     */
+    @Synchronized
+    fun acquire(owner: String): Boolean {
+        val native = jni ?: return false
+        owners.add(owner)
+        if (suspended) return false
+        return startNative(native)
+    }
+
+    /**
+     * Drop [owner]; the mic is released once nobody holds the front end.
+     */
+    @Synchronized
+    fun release(owner: String) {
+        if (!owners.remove(owner)) return
+        if (owners.isEmpty()) stopNative()
+    }
+
+    /**
+     * Release the mic for a component that opens its own AudioRecord.
+     * Owners stay registered and capture restarts on [resumeCapture].
+     */
+    @Synchronized
+    fun suspendCapture() {
+        if (jni == null || suspended) return
+        suspended = true
+        stopNative()
+        Log.i(TAG, "Capture suspended — mic released")
+    }
+
+    @Synchronized
+    fun resumeCapture() {
+        val native = jni ?: return
+        if (!suspended) return
+        suspended = false
+        if (owners.isNotEmpty()) startNative(native)
+        Log.i(TAG, "Capture resumed")
+    }
+
+    /**
+     * Load the keyword spotter from app storage, assets or the shared model folders.
+     * @param threshold Smoothed posterior needed to fire, 0..1.
+     */
+    fun loadKeywordModel(context: Context, threshold: Float): Boolean {
+        val native = jni ?: return false
+        val model = findKeywordModel(context) ?: run {
+            Log.i(TAG, "$KEYWORD_MODEL_NAME not found — native wake word disabled")
+            return false
+        }
+        return native.loadKeywordModel(model.absolutePath, threshold)
+    }
+
+    fun setWakeWordEnabled(enabled: Boolean) {
+        jni?.setWakeWordEnabled(enabled)
+    }
+
+    /**
+     * Turn the native noise suppression / AGC stages on or off. They replace
+     * the platform NoiseSuppressor / AutomaticGainControl effects on the
+     * native path; bypass them to compare or to save CPU.
+     */
+    fun setPreprocessing(noiseSuppression: Boolean, agc: Boolean) {
+        agcEnabled = agc
+        jni?.setPreprocessing(noiseSuppression, agc)
+    }
+
+    /** Apply the Settings choice ([PREPROCESSING_PREF]) to both stages. */
+    fun applyPreprocessingPreference(context: Context) {
+        val enabled = context.getSharedPreferences("nova_settings", Context.MODE_PRIVATE)
+            .getBoolean(PREPROCESSING_PREF, true)
+        setPreprocessing(noiseSuppression = enabled, agc = enabled)
+    }
+
+    fun preprocessStats(): PreprocessStats? {
+        val values = jni?.getPreprocessStats() ?: return null
+        if (values.size < 4) return null
+        return PreprocessStats(values[0].toLong(), values[1], values[2], values[3].toLong())
+    }
+
+    fun beginUtterance(preRollMs: Int, silenceMs: Int, minSpeechMs: Int, maxMs: Int) {
+        jni?.beginUtterance(preRollMs, silenceMs, minSpeechMs, maxMs)
+    }
+
+    fun endUtterance(): FloatArray = jni?.endUtterance() ?: FloatArray(0)
+
+    // ── Internals ──────────────────────────────────────────────────
+
+    private fun startNative(native: AudioFrontendJNI): Boolean {
+        if (native.isRunning()) return true
+        if (!native.start()) {
+            Log.e(TAG, "Failed to start native capture")
+            return false
+        }
+        pumpJob?.cancel()
+        pumpJob = scope.launch { pumpEvents(native) }
+        return true
+    }
+
+    private fun stopNative() {
+        jni?.stop()
+        pumpJob?.cancel()
+        pumpJob = null
+        _level.value = 0f
+    }
+
+    // Drains the native event queue; exits once capture stops
+    private suspend fun pumpEvents(native: AudioFrontendJNI) {
+        while (currentCoroutineContext().isActive && native.isRunning()) {
+            val code = native.nextEvent(EVENT_POLL_MS)
+            _level.value = native.getLevel()
+            val event = when (code) {
+                AudioFrontendJNI.EVENT_WAKE_WORD -> Event.WAKE_WORD
+                AudioFrontendJNI.EVENT_SPEECH_START -> Event.SPEECH_START
+                AudioFrontendJNI.EVENT_SPEECH_END -> Event.SPEECH_END
+                AudioFrontendJNI.EVENT_UTTERANCE_TIMEOUT -> Event.UTTERANCE_TIMEOUT
+                AudioFrontendJNI.EVENT_CAPTURE_ERROR -> Event.CAPTURE_ERROR
+                AudioFrontendJNI.EVENT_END_OF_TURN -> Event.END_OF_TURN
+                else -> null
+            } ?: continue
+            _events.emit(event)
+        }
+    }
+
+    private fun findKeywordModel(context: Context): File? {
+        val local = File(context.filesDir, KEYWORD_MODEL_NAME)
+        if (local.exists()) return local
+
+        // Bundled model: copy out of assets once so native code can read it
+        try {
+            context.assets.open(KEYWORD_MODEL_NAME).use { input ->
+                local.outputStream().use { input.copyTo(it) }
+            }
+            return local
+        } catch (e: Exception) {
+            local.delete()
+        }
+
+        val shared = listOf(
+            Environment.getExternalStoragePublicDirectory(Environment.DIRECTORY_DOWNLOADS),
+            File(Environment.getExternalStorageDirectory(), "nova/models"),
+        )
+        return shared.map { File(it, KEYWORD_MODEL_NAME) }.firstOrNull { it.exists() && it.canRead() }
+    }
+}
@@ -0,0 +1,211 @@
+package com.nova.companion.voice
+
+import android.content.Context
+import android.util.Log
+import com.nova.companion.core.SystemPrompt
+import com.nova.companion.inference.LlamaJNI
+import com.nova.companion.inference.NovaInference
+import kotlinx.coroutines.CoroutineScope
+import kotlinx.coroutines.Dispatchers
+import kotlinx.coroutines.Job
+import kotlinx.coroutines.SupervisorJob
+import kotlinx.coroutines.currentCoroutineContext
+import kotlinx.coroutines.flow.MutableSharedFlow
+import kotlinx.coroutines.flow.SharedFlow
+import kotlinx.coroutines.flow.asSharedFlow
+import kotlinx.coroutines.isActive
+import kotlinx.coroutines.launch
+import kotlinx.coroutines.withContext
+import java.io.File
+
+/**
+ * Fully native offline voice loop: the front end's VAD and endpointer,
+ * Whisper, llama.cpp and Piper run as one streaming engine (voice_pipeline.h)
+ * with no Kotlin hop between stages, for the lowest mouth-to-ear latency.
+ *
+ * Needs the Whisper model and Piper voice loaded (VoiceManager does that
+ * when voice mode is on) and a GGUF chat model for llama.cpp, set in
+ * Settings ([MODEL_PATH_PREF]). llama.cpp holds that model only while the
+ * loop runs, and the loop doesn't start while MLC holds its chat model, so
+ * only one LLM is ever resident. Kotlin only starts / stops it and observes
+ * [events]; the mic is held through [NativeAudioFrontend] while running.
+ */
+object NativeVoicePipeline {
+
+    private const val TAG = "NativeVoicePipeline"
+    private const val OWNER = "VoicePipeline"
+
+    private const val EVENT_POLL_MS = 100
+    private const val MAX_TOKENS = 256
+    private const val TEMPERATURE = 0.7f
+    private const val TOP_P = 0.85f
+
+    // Settings key ("nova_settings"): path of the .gguf model llama.cpp runs;
+    // empty disables the native loop
+    const val MODEL_PATH_PREF = "native_llm_model_path"
+
+    sealed class Event {
+        object Listening : Event()
+        object SpeechStart : Event()
+        data class Partial(val text: String) : Event()
+        data class Transcript(val text: String, val sttMs: Float) : Event()
+        data class Token(val piece: String) : Event()
+        /** First reply audio reached the speaker. */
+        data class Speaking(val mouthToEarMs: Float) : Event()
+        data class Reply(val text: String, val tokens: Int) : Event()
+        object TurnDone : Event()
+        object BargeIn : Event()
+        data class Error(val message: String) : Event()
+    }
+
+    /** Milliseconds from the endpoint of the last turn to each stage's first output. */
+    data class TurnLatency(
+        val sttMs: Float,
+        val firstTokenMs: Float,
+        val firstAudioMs: Float,
+        val mouthToEarMs: Float
+    )
+
+    private val jni: VoicePipelineJNI? by lazy {
+        try {
+            VoicePipelineJNI()
+        } catch (e: LinkageError) {
+            Log.w(TAG, "Native voice pipeline unavailable", e)
+            null
+        }
+    }
+
+    private val llama: LlamaJNI? by lazy {
+        try {
+            LlamaJNI()
+        } catch (e: LinkageError) {
+            Log.w(TAG, "nova_llama not built — native voice pipeline disabled", e)
+            null
+        }
+    }
+
+    private val scope = CoroutineScope(Dispatchers.IO + SupervisorJob())
+    private var pumpJob: Job? = null
+
+    private val _events = MutableSharedFlow<Event>(extraBufferCapacity = 64)
+    val events: SharedFlow<Event> = _events.asSharedFlow()
+
+    val isRunning: Boolean get() = jni?.isRunning() == true
+
+    /**
+     * Start the native loop.
+     * @param context Reads the configured model path ([MODEL_PATH_PREF]).
+     * @param language Whisper language code, or "auto".
+     * @param bargeIn Let the user talk over replies (headset / AEC only).
+     * @return [VoicePipelineJNI.START_OK] or the reason it could not start;
+     *         callers fall back to the Kotlin pipeline on failure.
+     */
+    suspend fun start(
+        context: Context,
+        language: String = "auto",
+        bargeIn: Boolean = false
+    ): Int = withContext(Dispatchers.IO) {
+        val native = jni ?: return@withContext VoicePipelineJNI.START_NO_STT
+        if (native.isRunning()) return@withContext VoicePipelineJNI.START_OK
+        if (!ensureLlamaModel(context)) return@withContext VoicePipelineJNI.START_NO_LLM
+
+        // The wake word hand-off suspends capture; this loop listens through the
+        // front end itself. Put it back if we can't start, for the fallback's STT.
+        val wasSuspended = NativeAudioFrontend.isSuspended
+        NativeAudioFrontend.resumeCapture()
+        if (!NativeAudioFrontend.acquire(OWNER)) {
+            if (wasSuspended) NativeAudioFrontend.suspendCapture()
+            unloadLlamaModel()
+            return@withContext VoicePipelineJNI.START_NO_MIC
+        }
+
+        val systemPrompt = NovaInference.systemPrompt + "\n" + SystemPrompt.dateTimeContext()
+        val result = native.start(
+            systemPrompt, language, NovaInference.stopStrings,
+            MAX_TOKENS, TEMPERATURE, TOP_P, bargeIn
+        )
+        if (result != VoicePipelineJNI.START_OK) {
+            Log.w(TAG, "Native pipeline did not start ($result)")
+            NativeAudioFrontend.release(OWNER)
+            if (wasSuspended) NativeAudioFrontend.suspendCapture()
+            unloadLlamaModel()
+            return@withContext result
+        }
+
+        pumpJob?.cancel()
+        pumpJob = scope.launch { pumpEvents(native) }
+        Log.i(TAG, "Native voice pipeline running")
+        result
+    }
+
+    fun stop() {
+        val native = jni ?: return
+        native.stop()
+        pumpJob?.cancel()
+        pumpJob = null
+        NativeAudioFrontend.release(OWNER)
+        unloadLlamaModel()
+    }
+
+    fun lastTurnLatency(): TurnLatency? {
+        val values = jni?.getTurnLatency() ?: return null
+        if (values.size < 4) return null
+        return TurnLatency(values[0], values[1], values[2], values[3])
+    }
+
+    // ── Internals ──────────────────────────────────────────────────
+
+    // llama.cpp keeps its own model, separate from the MLC chat model, so
+    // it is loaded per session and only while MLC has none
+    private fun ensureLlamaModel(context: Context): Boolean {
+        val native = llama ?: return false
+        val mlcState = NovaInference.state.value
+        if (mlcState == NovaInference.ModelState.READY || mlcState == NovaInference.ModelState.LOADING) {
+            Log.i(TAG, "MLC chat model loaded — not loading a second LLM for the native pipeline")
+            return false
+        }
+        val path = context.getSharedPreferences("nova_settings", Context.MODE_PRIVATE)
+            .getString(MODEL_PATH_PREF, null)?.trim().orEmpty()
+        if (path.isEmpty()) {
+            Log.i(TAG, "No native pipeline model configured — native voice pipeline disabled")
+            return false
+        }
+        val model = File(path)
+        if (!model.isFile || !model.canRead() || !model.name.endsWith(".gguf")) {
+            Log.w(TAG, "Native pipeline model is not a readable .gguf file: $path")
+            return false
+        }
+        if (native.isModelLoaded()) native.unloadModel()
+
+        val threads = (Runtime.getRuntime().availableProcessors() / 2).coerceIn(2, 4)
+        Log.i(TAG, "Loading llama model: ${model.absolutePath} ($threads threads)")
+        return native.loadModel(model.absolutePath, threads)
+    }
+
+    private fun unloadLlamaModel() {
+        val native = llama ?: return
+        if (!native.isModelLoaded()) return
+        native.unloadModel()
+        Log.i(TAG, "llama model unloaded")
+    }
+
+    // Drains the native event queue; exits once the pipeline stops
+    private suspend fun pumpEvents(native: VoicePipelineJNI) {
+        while (currentCoroutineContext().isActive && native.isRunning()) {
+            val event = when (native.nextEvent(EVENT_POLL_MS)) {
+                VoicePipelineJNI.EVENT_LISTENING -> Event.Listening
+                VoicePipelineJNI.EVENT_SPEECH_START -> Event.SpeechStart
+                VoicePipelineJNI.EVENT_PARTIAL -> Event.Partial(native.eventText())
+                VoicePipelineJNI.EVENT_TRANSCRIPT -> Event.Transcript(native.eventText(), native.eventValue())
+                VoicePipelineJNI.EVENT_TOKEN -> Event.Token(native.eventText())
+                VoicePipelineJNI.EVENT_SPEAKING -> Event.Speaking(native.eventValue())
+                VoicePipelineJNI.EVENT_REPLY -> Event.Reply(native.eventText(), native.eventValue().toInt())
+                VoicePipelineJNI.EVENT_TURN_DONE -> Event.TurnDone
+                VoicePipelineJNI.EVENT_BARGE_IN -> Event.BargeIn
+                VoicePipelineJNI.EVENT_ERROR -> Event.Error(native.eventText())
+                else -> null
+            } ?: continue
+            _events.emit(event)
+        }
+    }
+}
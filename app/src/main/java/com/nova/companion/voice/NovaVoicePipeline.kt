@@ -3,8 +3,6 @@ package com.nova.companion.voice
 import android.Manifest
 import android.content.Context
 import android.content.pm.PackageManager
-import android.database.Cursor
-import android.provider.ContactsContract
 import android.media.AudioFormat
 import android.media.AudioRecord
 import android.media.MediaRecorder
@@ -24,8 +22,10 @@ import com.nova.companion.ui.aura.AuraState
 import com.nova.companion.inference.HybridInferenceRouter
 import com.nova.companion.inference.LocalInferenceClient
 import com.nova.companion.inference.OfflineCapabilityManager
+import com.nova.companion.tools.ContactLookupHelper
 import com.nova.companion.tools.ToolRegistry
 import kotlinx.coroutines.CoroutineScope
+import kotlinx.coroutines.CoroutineStart
 import kotlinx.coroutines.Dispatchers
 import kotlinx.coroutines.Job
 import kotlinx.coroutines.async
@@ -124,6 +124,8 @@ object NovaVoicePipeline {
     private var audioRecord: AudioRecord? = null
     private var pipelineJob: Job? = null
     private var recordingJob: Job? = null
+    private var nativeJob: Job? = null
+    private var nativeIdleJob: Job? = null
     private var scope: CoroutineScope? = null
     private var appContext: Context? = null
 
@@ -185,6 +187,7 @@ object NovaVoicePipeline {
         pipelineJob = null
         recordingJob?.cancel()
         recordingJob = null
+        stopNativeOffline()
 
         ElevenLabsTTS.stop()
         releaseAudioRecord()
@@ -212,7 +215,9 @@ object NovaVoicePipeline {
     // ── Offline Voice Pipeline ──────────────────────────────────
 
     /**
-     * Start an offline voice session: Android STT → llama.cpp → Android TTS.
+     * Start an offline voice session. Prefers the fully native loop
+     * (front end → Whisper → llama.cpp → Piper, see [NativeVoicePipeline]);
+     * without it: Android STT → local LLM → Android TTS.
      * Used when device is offline but a local model is loaded.
      */
     fun startOffline(context: Context, coroutineScope: CoroutineScope) {
@@ -231,6 +236,8 @@ object NovaVoicePipeline {
         OfflineTTS.init(context)
 
         pipelineJob = coroutineScope.launch {
+            if (startNativeOffline(coroutineScope)) return@launch
+
             _state.value = PipelineState.LISTENING
             pushAuraState(PipelineState.LISTENING)
             WakeWordService.updateStatus("Listening (offline)...")
@@ -299,6 +306,99 @@ object NovaVoicePipeline {
         }
     }
 
+    // ── Native Offline Loop ─────────────────────────────────────
+
+    /**
+     * Run the offline session on [NativeVoicePipeline]. Returns false if it
+     * can't start (no GGUF model configured, MLC model loaded, voice models
+     * not loaded, nova_llama not built...) so the caller takes the Kotlin path.
+     */
+    private suspend fun startNativeOffline(coroutineScope: CoroutineScope): Boolean {
+        if (!NativeAudioFrontend.isAvailable) return false
+        val context = appContext ?: return false
+
+        // Subscribe before starting so the first LISTENING isn't missed
+        val collector = coroutineScope.launch(start = CoroutineStart.UNDISPATCHED) {
+            NativeVoicePipeline.events.collect { onNativeEvent(it) }
+        }
+        val language = ActiveVoiceManagerHolder.voiceManager?.stt?.language ?: "auto"
+        val result = NativeVoicePipeline.start(context, language)
+        if (result != VoicePipelineJNI.START_OK) {
+            collector.cancel()
+            Log.i(TAG, "Native offline pipeline unavailable ($result) — using Android STT/TTS")
+            return false
+        }
+        Log.i(TAG, "Starting OFFLINE voice pipeline (native: Whisper → llama.cpp → Piper)")
+        nativeJob = collector
+        return true
+    }
+
+    private fun stopNativeOffline() {
+        nativeIdleJob?.cancel()
+        nativeIdleJob = null
+        nativeJob?.cancel()
+        nativeJob = null
+        // Also after the loop ended on its own: stop() frees its llama model
+        NativeVoicePipeline.stop()
+    }
+
+    private fun onNativeEvent(event: NativeVoicePipeline.Event) {
+        when (event) {
+            is NativeVoicePipeline.Event.Listening -> {
+                _state.value = PipelineState.LISTENING
+                pushAuraState(PipelineState.LISTENING)
+                WakeWordService.updateStatus("Listening (offline)...")
+                _partialText.value = "Listening..."
+                // Same give-up windows as the Kotlin path's first turn / follow-ups
+                armNativeIdleTimeout(if (turnCount == 0) NO_SPEECH_TIMEOUT_MS else FOLLOW_UP_NO_SPEECH_MS)
+            }
+            is NativeVoicePipeline.Event.SpeechStart -> {
+                nativeIdleJob?.cancel()
+                _partialText.value = "Hearing you..."
+            }
+            is NativeVoicePipeline.Event.Partial -> _partialText.value = event.text
+            is NativeVoicePipeline.Event.Transcript -> {
+                Log.i(TAG, "Offline transcription (${event.sttMs.toInt()}ms): \"${event.text}\"")
+                _recognizedText.value = event.text
+                _partialText.value = event.text
+                scope?.launch { _userMessageEvent.emit(event.text) }
+                _state.value = PipelineState.THINKING
+                pushAuraState(PipelineState.THINKING)
+                WakeWordService.updateStatus("Thinking (offline)...")
+            }
+            is NativeVoicePipeline.Event.Speaking -> {
+                Log.i(TAG, "Offline mouth-to-ear: ${event.mouthToEarMs.toInt()}ms")
+                _state.value = PipelineState.SPEAKING
+                pushAuraState(PipelineState.SPEAKING)
+                WakeWordService.updateStatus("Speaking (offline)...")
+            }
+            is NativeVoicePipeline.Event.Reply -> {
+                turnCount++
+                scope?.launch { _assistantMessageEvent.emit(event.text) }
+            }
+            is NativeVoicePipeline.Event.TurnDone -> {
+                if (turnCount >= MAX_TURNS) {
+                    Log.i(TAG, "Max turns reached ($MAX_TURNS), ending session")
+                    stopNativeOffline()
+                    endSession()
+                }
+            }
+            is NativeVoicePipeline.Event.BargeIn -> Log.i(TAG, "Barge-in (native)")
+            is NativeVoicePipeline.Event.Error -> Log.w(TAG, "Native pipeline: ${event.message}")
+            is NativeVoicePipeline.Event.Token -> Unit
+        }
+    }
+
+    private fun armNativeIdleTimeout(timeoutMs: Int) {
+        nativeIdleJob?.cancel()
+        nativeIdleJob = scope?.launch {
+            delay(timeoutMs.toLong())
+            Log.i(TAG, "No speech for ${timeoutMs}ms, ending native session")
+            stopNativeOffline()
+            endSession()
+        }
+    }
+
     // ── AudioRecord + Whisper STT ────────────────────────────────
 
     private suspend fun recordAndTranscribe(
@@ -667,40 +767,8 @@ object NovaVoicePipeline {
      * Returns a list like ["Rahul", "Priya", "Arjun", ...] — passed to Deepgram
      * so the STT engine recognises these names correctly instead of mishearing them.
      */
-    private fun loadContactKeywords(context: Context): List<String> {
-        if (ContextCompat.checkSelfPermission(context, Manifest.permission.READ_CONTACTS)
-            != PackageManager.PERMISSION_GRANTED) return emptyList()
-
-        val names = mutableSetOf<String>()
-        var cursor: Cursor? = null
-        try {
-            cursor = context.contentResolver.query(
-                ContactsContract.Contacts.CONTENT_URI,
-                arrayOf(ContactsContract.Contacts.DISPLAY_NAME_PRIMARY),
-                null, null,
-                "${ContactsContract.Contacts.DISPLAY_NAME_PRIMARY} ASC"
-            )
-            cursor?.let {
-                val col = it.getColumnIndex(ContactsContract.Contacts.DISPLAY_NAME_PRIMARY)
-                while (it.moveToNext()) {
-                    val fullName = if (col >= 0) it.getString(col) else null
-                    if (!fullName.isNullOrBlank()) {
-                        // Add both full name and first name as keywords
-                        names.add(fullName.trim())
-                        fullName.trim().split(" ").firstOrNull()
-                            ?.takeIf { n -> n.length > 2 }
-                            ?.let { fn -> names.add(fn) }
-                    }
-                }
-            }
-        } catch (e: Exception) {
-            Log.w(TAG, "Failed to load contact keywords", e)
-        } finally {
-            cursor?.close()
-        }
-        Log.d(TAG, "Loaded ${names.size} contact keywords for STT biasing")
-        return names.toList()
-    }
+    private fun loadContactKeywords(context: Context): List<String> =
+        ContactLookupHelper.loadContactNames(context)
 
     /**
      * Convert raw PCM data to WAV format (adds 44-byte WAV header).
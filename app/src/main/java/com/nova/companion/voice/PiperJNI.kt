@@ -13,45 +13,295 @@ class PiperJNI {
         init {
             System.loadLibrary("nova_piper")
         }
+
+        // Pass for any synthesis parameter to use the voice config's value
+        const val VOICE_DEFAULT = -1f
+        const val DEFAULT_SPEAKER = -1
+
+        // ONNX Runtime graph optimization levels for [initialize]
+        const val OPT_DISABLE_ALL = 0
+        const val OPT_BASIC = 1
+        const val OPT_EXTENDED = 2
+        const val OPT_ALL = 99
+
+        // Leaves the remaining cores to the LLM
+        const val DEFAULT_THREADS = 2
+
+        // [getReadiness] values
+        const val READINESS_NONE = 0
+        const val READINESS_LOADING = 1
+        const val READINESS_WARMING = 2
+        const val READINESS_READY = 3
     }
 
     /**
-     * Initialize Piper with a voice model and its config.
+     * Initialize Piper with a voice model and its config, making it the
+     * active voice. Already-resident voices switch without reloading.
+     * The session options apply to every voice; changing them unloads
+     * resident voices so they reload under the new options.
      * @param modelPath Absolute path to the ONNX voice model file.
      * @param configPath Absolute path to the voice model JSON config.
+     * @param threads Intra-op threads shared by all voices.
+     * @param optimization Graph optimization level, one of the OPT_ constants.
+     * @param cpuArena Use ONNX Runtime's CPU memory arena.
+     * @param memPattern Pre-plan tensor memory from previous runs.
+     * @param xnnpack Use the XNNPACK execution provider if the runtime has it.
+     * @param warmup Render a throwaway sentence on a native background
+     *        thread after loading, so the first real request runs at steady
+     *        speed; [getReadiness] reports WARMING until it's done.
      * @return true if initialized successfully.
      */
-    external fun initialize(modelPath: String, configPath: String): Boolean
+    external fun initialize(
+        modelPath: String,
+        configPath: String,
+        threads: Int = DEFAULT_THREADS,
+        optimization: Int = OPT_ALL,
+        cpuArena: Boolean = true,
+        memPattern: Boolean = true,
+        xnnpack: Boolean = false,
+        warmup: Boolean = true
+    ): Boolean
+
+    /**
+     * Directory holding espeak-ng-data. eSpeak loads from it on first use
+     * (or during warm-up), not at [initialize]; set it before either.
+     */
+    external fun setESpeakDataPath(path: String)
+
+    /**
+     * One of the READINESS_ constants: nothing loaded, loading, loaded but
+     * still warming up, or ready (steady-state speed).
+     */
+    external fun getReadiness(): Int
 
     /**
-     * Synthesize speech from text.
+     * Block until warm-up finishes, at most [timeoutMs].
+     * @return true once ready; false on timeout or if nothing is loaded.
+     */
+    external fun awaitReady(timeoutMs: Int): Boolean
+
+    /**
+     * Synthesize speech from text with the active voice. Parameters apply to
+     * this request only; [VOICE_DEFAULT] / [DEFAULT_SPEAKER] take the value
+     * from the voice config.
      * @param text The text to speak.
-     * @param speakerId Speaker ID for multi-speaker models (0 for single-speaker).
+     * @param speakerId Speaker ID for multi-speaker models.
      * @param lengthScale Controls speech speed (1.0 = normal, <1.0 = faster, >1.0 = slower).
-     * @param noiseScale Controls expressiveness/variation (0.667 default).
-     * @param noiseW Controls phoneme duration randomness (0.8 default).
+     * @param noiseScale Controls expressiveness/variation (typically 0.667).
+     * @param noiseW Controls phoneme duration randomness (typically 0.8).
      * @return Raw PCM audio samples as ShortArray (16-bit signed, mono).
      *         Sample rate is determined by the model (typically 22050Hz).
      */
     external fun synthesize(
         text: String,
-        speakerId: Int = 0,
-        lengthScale: Float = 1.0f,
-        noiseScale: Float = 0.667f,
-        noiseW: Float = 0.8f
+        speakerId: Int = DEFAULT_SPEAKER,
+        lengthScale: Float = VOICE_DEFAULT,
+        noiseScale: Float = VOICE_DEFAULT,
+        noiseW: Float = VOICE_DEFAULT
     ): ShortArray
 
     /**
      * Synthesize with callback for streaming audio output.
-     * Generates audio sentence-by-sentence for lower latency.
+     * Generates audio sentence-by-sentence for lower latency. A native
+     * producer thread synthesizes up to [setLookahead] sentences ahead while
+     * the callback plays the current one; the callback runs on the calling
+     * thread and may block (e.g. in AudioTrack.write).
      * @param text Full text to speak.
      * @param callback Receives audio chunks as they're generated.
+     * Synthesis parameters as for [synthesize].
      */
     external fun synthesizeStreaming(
         text: String,
+        speakerId: Int = DEFAULT_SPEAKER,
+        lengthScale: Float = VOICE_DEFAULT,
+        noiseScale: Float = VOICE_DEFAULT,
+        noiseW: Float = VOICE_DEFAULT,
         callback: PiperAudioCallback
     )
 
+    /**
+     * Start an incremental synthesis session for text that is still being
+     * generated, replacing any session in progress. Feed it with
+     * [streamAppend], end it with [streamFinish], and play it by calling
+     * [streamDrain] on the playback thread. Synthesis parameters as for
+     * [synthesize], fixed for the session.
+     * @return false if no voice is loaded.
+     */
+    external fun streamBegin(
+        speakerId: Int = DEFAULT_SPEAKER,
+        lengthScale: Float = VOICE_DEFAULT,
+        noiseScale: Float = VOICE_DEFAULT,
+        noiseW: Float = VOICE_DEFAULT
+    ): Boolean
+
+    /**
+     * Append a text fragment (e.g. one LLM token). Synthesis of a clause
+     * starts as soon as its boundary is confirmed.
+     */
+    external fun streamAppend(fragment: String)
+
+    /**
+     * End of text: the remainder is synthesized as the last chunk.
+     */
+    external fun streamFinish()
+
+    /**
+     * Deliver the session's audio to [callback] on the calling thread.
+     * Blocks until [streamFinish] was called and everything was delivered,
+     * or the session was replaced.
+     */
+    external fun streamDrain(callback: PiperAudioCallback)
+
+    /**
+     * Barge-in: stop the current session (from [synthesizeStreaming] or
+     * [streamBegin]) immediately. The model run in progress is terminated,
+     * queued text and audio are dropped and the ring is flushed.
+     * @return Samples of the session handed to playback, or -1 if none.
+     */
+    external fun cancel(): Long
+
+    /**
+     * Use [buffer] (a direct ByteBuffer, kept referenced by the caller) as
+     * the zero-copy playback ring for [streamDrainToRing].
+     * @return Capacity in samples, 0 if the buffer isn't direct.
+     */
+    external fun attachRing(buffer: java.nio.ByteBuffer): Int
+
+    /**
+     * Like [streamDrain], but audio is written straight into the attached
+     * ring by a native thread and this returns immediately. Play it with
+     * [ringAcquire] / [ringRelease]; no Java objects are allocated per chunk.
+     * @return false if there is no session or no ring.
+     */
+    external fun streamDrainToRing(): Boolean
+
+    /**
+     * Next contiguous run of 16-bit PCM in the ring, packed as
+     * `(byteOffset shl 32) or byteCount`; 0 if nothing arrived within
+     * [timeoutMs], -1 once the session's audio has all been acquired.
+     */
+    external fun ringAcquire(timeoutMs: Int): Long
+
+    /**
+     * The bytes from the last [ringAcquire] were played; frees their space.
+     */
+    external fun ringRelease(bytes: Int)
+
+    /**
+     * Drop unplayed ring audio and stop synthesizing the rest of the session.
+     */
+    external fun ringCancel()
+
+    /**
+     * How many finished sentences [synthesizeStreaming] may hold ahead of
+     * playback (default 2). Higher hides slow sentences, lower saves CPU on
+     * replies that get interrupted.
+     */
+    external fun setLookahead(sentences: Int)
+
+    /**
+     * Long sentences stream in pieces once they exceed [maxPhonemeIds]
+     * phoneme ids (default 96, about two seconds of speech), so audio starts
+     * before the whole sentence is rendered. Pieces are cut after clause
+     * marks (, ; :), since each one ends with a closing contour; only a run
+     * of over three pieces' length without one is cut between words. Pieces
+     * are joined with a short crossfade. 0 renders sentences whole.
+     */
+    external fun setChunking(maxPhonemeIds: Int)
+
+    /**
+     * Directory for the on-disk tier of the phrase cache. Short sentences
+     * are always cached in memory (LRU, keyed by text, voice and synthesis
+     * parameters); pre-rendered or repeatedly spoken ones also go to disk,
+     * which is capped at 32 MB (least recently used files go first). Entries
+     * of voices whose model file no longer exists are removed here.
+     */
+    external fun setCacheDirectory(path: String)
+
+    /**
+     * Render phrases into the cache (memory and disk) ahead of use.
+     * @return Number of phrases that had to be synthesized.
+     */
+    external fun prerender(phrases: Array<String>): Int
+
+    /**
+     * Drop the in-memory phrase cache (disk entries are kept).
+     */
+    external fun clearCache()
+
+    /**
+     * Load a voice and keep it resident next to the active one, so a later
+     * [selectVoice] costs nothing. Resident voices share one ONNX Runtime
+     * environment; past [setVoiceMemoryBudget] the least recently used
+     * inactive voice is evicted.
+     */
+    external fun loadVoice(modelPath: String, configPath: String): Boolean
+
+    /**
+     * Make a resident voice active. False if it isn't loaded.
+     */
+    external fun selectVoice(modelPath: String): Boolean
+
+    /**
+     * Unload a resident voice and drop its phrases from both cache tiers.
+     */
+    external fun unloadVoice(modelPath: String)
+
+    /**
+     * Memory budget for resident voices (estimated from model size).
+     */
+    external fun setVoiceMemoryBudget(bytes: Long)
+
+    /**
+     * Model paths of resident voices, most recently used first.
+     */
+    external fun getResidentVoices(): Array<String>
+
+    external fun getResidentBytes(): Long
+
+    /**
+     * Time one session configuration on a standalone copy of a voice (its
+     * own thread pool; resident voices are untouched). Synthesizes [text]
+     * once to warm up, then [runs] more times.
+     * @return [loadMs, firstMs, meanMs, audioSeconds, realTimeFactor], or
+     *         an empty array if the voice failed to load.
+     */
+    external fun benchmarkSession(
+        modelPath: String,
+        configPath: String,
+        text: String,
+        threads: Int,
+        optimization: Int,
+        cpuArena: Boolean,
+        memPattern: Boolean,
+        xnnpack: Boolean,
+        runs: Int
+    ): FloatArray
+
+    /**
+     * Check whether a voice model is int8-quantized and which compute
+     * operators still run in fp32. With a non-empty [scratchPath] the graph
+     * ONNX Runtime actually runs under the current session config is
+     * inspected (needed for QDQ models, whose fusion happens at load; takes
+     * as long as loading the voice); otherwise the model file as stored.
+     * @return [format, integerOps, int8WeightBytes, floatWeightBytes,
+     *         "Op=count" per fp32 fallback...], or empty on failure.
+     */
+    external fun inspectQuantization(modelPath: String, scratchPath: String): Array<String>
+
+    /**
+     * Resample streamed speech ([synthesizeStreaming], stream sessions) to
+     * [sampleRate] natively, e.g. the device's 48 kHz output rate, so the
+     * AudioTrack needs no mixer resampling. 0 keeps the voice's rate.
+     * Applies to sessions started afterwards.
+     */
+    external fun setOutputSampleRate(sampleRate: Int)
+
+    /**
+     * Rate of streamed audio: the output rate if set, else the voice's.
+     */
+    external fun getOutputSampleRate(): Int
+
     /**
      * Get the sample rate of the loaded voice model.
      * @return Sample rate in Hz (typically 22050).
@@ -67,6 +317,15 @@ class PiperJNI {
      * Free all Piper resources and ONNX session.
      */
     external fun release()
+
+    /**
+     * Span tracing for Piper synthesis. Prefer [com.nova.companion.core.NativeTrace].
+     * @param mode Bits: 1 records spans for [dumpTrace], 2 forwards them to ATrace.
+     */
+    external fun setTraceMode(mode: Int)
+
+    /** Spans recorded since tracing was enabled, as comma-separated Chrome trace events. */
+    external fun dumpTrace(): String
 }
 
 /**
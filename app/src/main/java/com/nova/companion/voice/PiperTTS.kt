@@ -11,6 +11,10 @@ import kotlinx.coroutines.flow.SharedFlow
 import kotlinx.coroutines.flow.StateFlow
 import kotlinx.coroutines.flow.asSharedFlow
 import kotlinx.coroutines.flow.asStateFlow
+import kotlinx.coroutines.flow.first
+import java.io.File
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
 
 /**
  * High-level Text-to-Speech engine using Piper TTS.
@@ -23,9 +27,76 @@ class PiperTTS {
 
     companion object {
         private const val TAG = "PiperTTS"
+        const val DEFAULT_LOOKAHEAD = 2
+        const val DEFAULT_CHUNK_PHONEME_IDS = 96
+        // ~3 s at 22.05 kHz, ~1.4 s at 48 kHz; also bounds how far synthesis runs ahead
+        private const val RING_BYTES = 128 * 1024
+        private const val RING_WAIT_MS = 50
+        private const val READY_POLL_MS = 500
+    }
+
+    /**
+     * Where the voice stands: loaded and warmed up means the first reply
+     * plays at steady-state speed.
+     */
+    enum class Readiness { NOT_LOADED, LOADING, WARMING, READY }
+
+    /**
+     * Per-request synthesis parameters; defaults come from the voice config.
+     */
+    data class Params(
+        val speakerId: Int = PiperJNI.DEFAULT_SPEAKER,
+        val lengthScale: Float = PiperJNI.VOICE_DEFAULT,
+        val noiseScale: Float = PiperJNI.VOICE_DEFAULT,
+        val noiseW: Float = PiperJNI.VOICE_DEFAULT
+    )
+
+    /**
+     * ONNX Runtime session options for every voice; see [PiperJNI.initialize].
+     */
+    data class SessionConfig(
+        val threads: Int = PiperJNI.DEFAULT_THREADS,
+        val optimization: Int = PiperJNI.OPT_ALL,
+        val cpuArena: Boolean = true,
+        val memPattern: Boolean = true,
+        val xnnpack: Boolean = false
+    )
+
+    /**
+     * One [benchmark] row. [realTimeFactor] is synthesis time over audio
+     * duration; below 1.0 speech is produced faster than it plays.
+     */
+    data class BenchmarkResult(
+        val config: SessionConfig,
+        val loadMs: Float,
+        val firstMs: Float,
+        val meanMs: Float,
+        val audioSeconds: Float,
+        val realTimeFactor: Float
+    )
+
+    /**
+     * [PiperJNI.inspectQuantization] result. [format] is "fp32" or
+     * "int8-dynamic" / "int8-static" / "int8-qdq" (joined with '+' if mixed);
+     * [fp32Fallbacks] counts compute ops left in float, by op type.
+     */
+    data class Quantization(
+        val format: String,
+        val integerOps: Int,
+        val int8WeightBytes: Long,
+        val floatWeightBytes: Long,
+        val fp32Fallbacks: Map<String, Int>
+    ) {
+        val quantized: Boolean get() = format != "fp32"
     }
 
     private val piper = PiperJNI()
+
+    // Zero-copy playback ring shared with native code, and a view of it
+    // whose position / limit are moved over each run of audio
+    private val ringBuffer: ByteBuffer = ByteBuffer.allocateDirect(RING_BYTES).order(ByteOrder.nativeOrder())
+    private val ringView: ByteBuffer = ringBuffer.duplicate().order(ByteOrder.nativeOrder())
+    private var ringAttached = false
     private var audioTrack: AudioTrack? = null
     private var playbackJob: Job? = null
     private var playbackScope: CoroutineScope? = null
@@ -33,6 +104,13 @@ class PiperTTS {
     private val _isModelLoaded = MutableStateFlow(false)
     val isModelLoaded: StateFlow<Boolean> = _isModelLoaded.asStateFlow()
 
+    private val _readiness = MutableStateFlow(Readiness.NOT_LOADED)
+    val readiness: StateFlow<Readiness> = _readiness.asStateFlow()
+
+    // Waits out the native warm-up
+    private val warmupScope = CoroutineScope(Dispatchers.IO + SupervisorJob())
+    private var warmupJob: Job? = null
+
     private val _isSpeaking = MutableStateFlow(false)
     val isSpeaking: StateFlow<Boolean> = _isSpeaking.asStateFlow()
 
@@ -48,31 +126,210 @@ class PiperTTS {
     private val _error = MutableSharedFlow<String>()
     val error: SharedFlow<String> = _error.asSharedFlow()
 
+    /**
+     * Sentences synthesized ahead of the one playing (at least 1).
+     */
+    var lookahead: Int = DEFAULT_LOOKAHEAD
+        set(value) {
+            field = value.coerceAtLeast(1)
+            if (_isModelLoaded.value) piper.setLookahead(field)
+        }
+
+    /**
+     * Phoneme ids above which a sentence streams in pieces cut after its
+     * clause marks (0 = whole sentences only).
+     */
+    var chunkPhonemeIds: Int = DEFAULT_CHUNK_PHONEME_IDS
+        set(value) {
+            field = value.coerceAtLeast(0)
+            if (_isModelLoaded.value) piper.setChunking(field)
+        }
+
+    /**
+     * Device output rate streamed speech is resampled to natively (see
+     * [PiperJNI.setOutputSampleRate]); 0 plays at the voice's own rate.
+     */
+    var outputSampleRate: Int = 0
+        set(value) {
+            field = value.coerceAtLeast(0)
+            if (_isModelLoaded.value) piper.setOutputSampleRate(field)
+        }
+
+    /**
+     * Directory holding espeak-ng-data for the phonemizer; eSpeak loads
+     * from it lazily (during warm-up when that's on).
+     */
+    var eSpeakDataDir: File? = null
+        set(value) {
+            field = value
+            if (value != null) piper.setESpeakDataPath(value.absolutePath)
+        }
+
+    /**
+     * Play streamed speech from the native ring buffer instead of per-chunk
+     * ShortArray callbacks; avoids allocation (and GC) during long replies.
+     */
+    var zeroCopyOutput: Boolean = true
+
     /**
      * Initialize Piper with voice model.
      * @param modelPath Path to the ONNX voice model file.
      * @param configPath Path to the model's JSON config file.
-     * @return true if initialized successfully.
+     * @param session Runtime options; a change reloads resident voices.
+     * @param warmUp Warm the session up in the background after loading;
+     *        [readiness] turns READY when the first reply will be fast.
+     * @return true if initialized successfully (warm-up may still be running).
      */
-    suspend fun loadModel(modelPath: String, configPath: String): Boolean =
+    suspend fun loadModel(
+        modelPath: String,
+        configPath: String,
+        session: SessionConfig = SessionConfig(),
+        warmUp: Boolean = true
+    ): Boolean =
         withContext(Dispatchers.IO) {
+            warmupJob?.cancel()
             try {
                 Log.i(TAG, "Loading Piper voice model: $modelPath")
-                val success = piper.initialize(modelPath, configPath)
+                _readiness.value = Readiness.LOADING
+                // Chunk size first: the warm-up renders at it
+                piper.setChunking(chunkPhonemeIds)
+                val success = piper.initialize(
+                    modelPath, configPath, session.threads, session.optimization,
+                    session.cpuArena, session.memPattern, session.xnnpack, warmUp
+                )
                 _isModelLoaded.value = success
                 if (success) {
+                    piper.setLookahead(lookahead)
+                    ringAttached = piper.attachRing(ringBuffer) > 0
+                    piper.setOutputSampleRate(outputSampleRate)
                     Log.i(TAG, "Piper loaded (sample rate: ${piper.getSampleRate()}Hz)")
                 } else {
                     Log.e(TAG, "Failed to initialize Piper")
                 }
+                trackReadiness()
                 success
             } catch (e: Exception) {
                 Log.e(TAG, "Error loading Piper model", e)
                 _isModelLoaded.value = false
+                _readiness.value = Readiness.NOT_LOADED
                 false
             }
         }
 
+    /**
+     * Suspend until the voice is warmed up (or [timeoutMs] passes).
+     */
+    suspend fun awaitReady(timeoutMs: Long = 5_000): Boolean =
+        withTimeoutOrNull(timeoutMs) { readiness.first { it == Readiness.READY || it == Readiness.NOT_LOADED } } ==
+            Readiness.READY
+
+    private fun readinessOf(native: Int): Readiness = when (native) {
+        PiperJNI.READINESS_LOADING -> Readiness.LOADING
+        PiperJNI.READINESS_WARMING -> Readiness.WARMING
+        PiperJNI.READINESS_READY -> Readiness.READY
+        else -> Readiness.NOT_LOADED
+    }
+
+    // Mirror the native state into [readiness], waiting out a warm-up off the caller's thread
+    private fun trackReadiness() {
+        _readiness.value = readinessOf(piper.getReadiness())
+        if (_readiness.value != Readiness.WARMING) return
+        warmupJob = warmupScope.launch {
+            while (isActive && !piper.awaitReady(READY_POLL_MS)) {
+                val state = readinessOf(piper.getReadiness())
+                if (state != Readiness.WARMING) {
+                    _readiness.value = state
+                    return@launch
+                }
+            }
+            if (isActive) {
+                _readiness.value = Readiness.READY
+                Log.i(TAG, "Piper warmed up")
+            }
+        }
+    }
+
+    /**
+     * Measure real-time factor for each session configuration on the given
+     * voice, e.g. to pick a thread count that keeps TTS ahead of playback
+     * without starving the LLM. Runs on a standalone session per config.
+     */
+    suspend fun benchmark(
+        modelPath: String,
+        configPath: String,
+        configs: List<SessionConfig>,
+        text: String = "The quick brown fox jumps over the lazy dog. How are you doing today?",
+        runs: Int = 3
+    ): List<BenchmarkResult> = withContext(Dispatchers.IO) {
+        configs.mapNotNull { config ->
+            val r = piper.benchmarkSession(
+                modelPath, configPath, text, config.threads, config.optimization,
+                config.cpuArena, config.memPattern, config.xnnpack, runs
+            )
+            if (r.size < 5) {
+                null
+            } else {
+                BenchmarkResult(config, r[0], r[1], r[2], r[3], r[4]).also {
+                    Log.i(TAG, "Benchmark $config: RTF ${"%.3f".format(it.realTimeFactor)}, " +
+                        "mean ${it.meanMs.toInt()} ms, first ${it.firstMs.toInt()} ms")
+                }
+            }
+        }
+    }
+
+    /**
+     * Report whether [modelPath] is an int8 voice and which operators fell
+     * back to fp32. Given [scratchDir], the graph ONNX Runtime optimizes it
+     * into is inspected (slow: one extra session load), else the file as is.
+     */
+    suspend fun inspectQuantization(modelPath: String, scratchDir: File? = null): Quantization? =
+        withContext(Dispatchers.IO) {
+            val scratch = scratchDir?.let { File(it, "piper_optimized.onnx").absolutePath } ?: ""
+            val r = piper.inspectQuantization(modelPath, scratch)
+            if (r.size < 4) return@withContext null
+            val fallbacks = r.drop(4).associate { entry ->
+                entry.substringBefore('=') to (entry.substringAfter('=').toIntOrNull() ?: 0)
+            }
+            Quantization(r[0], r[1].toInt(), r[2].toLong(), r[3].toLong(), fallbacks).also {
+                Log.i(TAG, "Quantization of $modelPath: ${it.format}, ${it.integerOps} integer ops, " +
+                    "fp32 fallbacks ${it.fp32Fallbacks}")
+            }
+        }
+
+    /**
+     * Load another voice and keep it resident (the active voice is unchanged),
+     * so switching with [selectVoice] later is instant.
+     */
+    suspend fun loadVoice(modelPath: String, configPath: String): Boolean = withContext(Dispatchers.IO) {
+        piper.loadVoice(modelPath, configPath).also { loaded ->
+            if (loaded) _isModelLoaded.value = true
+            if (loaded && _readiness.value == Readiness.NOT_LOADED) trackReadiness()
+        }
+    }
+
+    /**
+     * Switch to a voice loaded with [loadModel] or [loadVoice].
+     */
+    fun selectVoice(modelPath: String): Boolean = piper.selectVoice(modelPath)
+
+    /**
+     * Keep rendered phrases in [dir] across restarts (the in-memory cache is
+     * always on). Phrases pre-rendered or spoken repeatedly are written there.
+     */
+    fun setCacheDirectory(dir: File) {
+        if (dir.isDirectory || dir.mkdirs()) piper.setCacheDirectory(dir.absolutePath)
+    }
+
+    /**
+     * Render [phrases] into the phrase cache so speaking them later skips
+     * synthesis. Cheap once they're cached on disk.
+     * @return How many phrases were newly synthesized.
+     */
+    suspend fun prerender(phrases: List<String>): Int = withContext(Dispatchers.IO) {
+        if (!_isModelLoaded.value) return@withContext 0
+        piper.prerender(phrases.toTypedArray())
+    }
+
     /**
      * Speak the given text.
      * Synthesizes audio and plays it through the device speaker.
@@ -80,8 +337,9 @@ class PiperTTS {
      *
      * @param text The text to speak aloud.
      * @param scope CoroutineScope for async playback.
+     * @param params Speaker / speed / variation for this utterance only.
      */
-    fun speak(text: String, scope: CoroutineScope) {
+    fun speak(text: String, scope: CoroutineScope, params: Params = Params()) {
         if (!_isModelLoaded.value) {
             Log.e(TAG, "Piper model not loaded")
             return
@@ -94,19 +352,81 @@ class PiperTTS {
 
         _isSpeaking.value = true
 
+        Log.i(TAG, "Synthesizing: \"$text\"")
+        if (zeroCopyOutput && ringAttached &&
+            piper.streamBegin(params.speakerId, params.lengthScale, params.noiseScale, params.noiseW)
+        ) {
+            piper.streamAppend(text)
+            piper.streamFinish()
+            startRingPlayback()
+            return
+        }
+        startPlayback { callback ->
+            piper.synthesizeStreaming(
+                text, params.speakerId, params.lengthScale, params.noiseScale, params.noiseW, callback
+            )
+        }
+    }
+
+    /**
+     * Start speaking a reply that is still being generated. Feed it with
+     * [appendText] as tokens arrive and close it with [endStream]; the first
+     * clause plays while the rest is still streaming in.
+     * @return false if the model isn't loaded.
+     */
+    fun beginStream(params: Params = Params()): Boolean {
+        if (!_isModelLoaded.value) {
+            Log.e(TAG, "Piper model not loaded")
+            return false
+        }
+
+        // Stop any current speech first
+        stop()
+        if (!piper.streamBegin(params.speakerId, params.lengthScale, params.noiseScale, params.noiseW)) {
+            return false
+        }
+
+        _isSpeaking.value = true
+        if (zeroCopyOutput && ringAttached) {
+            startRingPlayback()
+        } else {
+            startPlayback { callback -> piper.streamDrain(callback) }
+        }
+        return true
+    }
+
+    /**
+     * Add a fragment (e.g. one LLM token) to the reply started by [beginStream].
+     */
+    fun appendText(fragment: String) {
+        if (_isSpeaking.value && fragment.isNotEmpty()) piper.streamAppend(fragment)
+    }
+
+    /**
+     * The reply is complete: speak what's left, then finish as [speak] does.
+     */
+    fun endStream() {
+        piper.streamFinish()
+    }
+
+    /**
+     * Play everything [synthesize] delivers to its callback, then emit
+     * [speechComplete]. The callback blocks in AudioTrack.write, so native
+     * code can synthesize ahead while audio plays.
+     */
+    private fun startPlayback(synthesize: (PiperAudioCallback) -> Unit) {
         playbackScope = CoroutineScope(Dispatchers.Default + SupervisorJob())
         playbackJob = playbackScope?.launch {
             try {
-                Log.i(TAG, "Synthesizing: \"$text\"")
-
-                val sampleRate = piper.getSampleRate()
+                val sampleRate = piper.getOutputSampleRate()
 
                 // Initialize AudioTrack for playback
                 val audioTrackInstance = createAudioTrack(sampleRate)
                 audioTrack = audioTrackInstance
                 audioTrackInstance.play()
 
-                // Use streaming synthesis for lower latency
+                // Streaming synthesis: the next sentence is synthesized natively
+                // while this callback blocks playing the current one
                 val callback = object : PiperAudioCallback {
                     override fun onAudioChunk(
                         samples: ShortArray,
@@ -128,10 +448,10 @@ class PiperTTS {
                     }
                 }
 
-                piper.synthesizeStreaming(text, callback)
+                synthesize(callback)
 
                 // Wait for AudioTrack to finish playing buffered audio
-                // (AudioTrack.write is blocking, so when synthesizeStreaming returns,
+                // (AudioTrack.write is blocking, so when synthesis returns,
                 // all audio has been written)
                 delay(200) // Small buffer for final audio drain
                 audioTrackInstance.stop()
@@ -160,6 +480,71 @@ class PiperTTS {
         }
     }
 
+    /**
+     * Play the current stream session out of the native ring: AudioTrack
+     * reads each run of samples in place, then it is released back to the
+     * producer. Emits [speechComplete] at the end like [startPlayback].
+     *
+     * The previous playback (already cancelled by [stop]) is joined before
+     * the ring is reset: returning from a blocking write, it would otherwise
+     * release its bytes against the new ring and skip the start of this
+     * utterance.
+     */
+    private fun startRingPlayback() {
+        val previous = playbackJob
+        playbackScope = CoroutineScope(Dispatchers.Default + SupervisorJob())
+        playbackJob = playbackScope?.launch {
+            previous?.cancelAndJoin()
+            try {
+                val audioTrackInstance = createAudioTrack(piper.getOutputSampleRate())
+                audioTrack = audioTrackInstance
+                audioTrackInstance.play()
+
+                if (!piper.streamDrainToRing()) {
+                    Log.e(TAG, "No stream to play")
+                }
+                while (isActive && _isSpeaking.value) {
+                    val run = piper.ringAcquire(RING_WAIT_MS)
+                    if (run < 0) break
+                    if (run == 0L) continue
+                    val offset = (run ushr 32).toInt()
+                    val bytes = (run and 0xffffffffL).toInt()
+
+                    ringView.clear()
+                    ringView.position(offset)
+                    ringView.limit(offset + bytes)
+                    audioTrackInstance.write(ringView, bytes, AudioTrack.WRITE_BLOCKING)
+                    _playbackAmplitude.value = computeAmplitude(ringBuffer, offset, bytes)
+                    piper.ringRelease(bytes)
+                }
+
+                delay(200) // Small buffer for final audio drain
+                audioTrackInstance.stop()
+                audioTrackInstance.release()
+                audioTrack = null
+
+                _isSpeaking.value = false
+                _playbackAmplitude.value = 0f
+
+                withContext(Dispatchers.Main) {
+                    _speechComplete.emit(Unit)
+                }
+
+                Log.i(TAG, "Speech playback complete")
+
+            } catch (e: CancellationException) {
+                Log.i(TAG, "Speech cancelled")
+                cleanupAudioTrack()
+            } catch (e: Exception) {
+                Log.e(TAG, "Speech synthesis error", e)
+                cleanupAudioTrack()
+                withContext(Dispatchers.Main) {
+                    _error.emit("Speech failed: ${e.message}")
+                }
+            }
+        }
+    }
+
     /**
      * Speak with pre-synthesized audio (for replay).
      * @param audioData Raw PCM samples to play.
@@ -190,14 +575,28 @@ class PiperTTS {
     }
 
     /**
-     * Stop current speech playback immediately.
+     * Stop current speech playback immediately (barge-in). Native synthesis
+     * is cancelled mid-inference and queued audio is dropped, so the CPU is
+     * free for STT right away.
+     * @return Samples of the interrupted utterance that were played (the
+     *         AudioTrack head, else what native code handed to playback),
+     *         or -1 if nothing was playing.
      */
-    fun stop() {
+    fun stop(): Long {
+        val played = audioTrack?.let { track ->
+            try {
+                track.playbackHeadPosition.toLong() and 0xffffffffL
+            } catch (_: Exception) {
+                null
+            }
+        }
         _isSpeaking.value = false
         _playbackAmplitude.value = 0f
+        val handed = if (_isModelLoaded.value) piper.cancel() else -1L
         playbackJob?.cancel()
         playbackScope?.cancel()
         cleanupAudioTrack()
+        return played ?: handed
     }
 
     /**
@@ -231,6 +630,10 @@ class PiperTTS {
             )
             .setBufferSizeInBytes(bufferSize * 2)
             .setTransferMode(AudioTrack.MODE_STREAM)
+            .apply {
+                // Only at the device rate does the fast mixer path take the track
+                if (sampleRate == outputSampleRate) setPerformanceMode(AudioTrack.PERFORMANCE_MODE_LOW_LATENCY)
+            }
             .build()
     }
 
@@ -261,14 +664,32 @@ class PiperTTS {
         return (rms / Short.MAX_VALUE).toFloat().coerceIn(0f, 1f)
     }
 
+    /**
+     * [computeAmplitude] over 16-bit samples in a ByteBuffer, read in place.
+     */
+    private fun computeAmplitude(buffer: ByteBuffer, offset: Int, bytes: Int): Float {
+        val count = bytes / 2
+        if (count == 0) return 0f
+        var sum = 0.0
+        for (i in 0 until count) {
+            val s = buffer.getShort(offset + i * 2).toDouble()
+            sum += s * s
+        }
+        val rms = kotlin.math.sqrt(sum / count)
+        return (rms / Short.MAX_VALUE).toFloat().coerceIn(0f, 1f)
+    }
+
     /**
      * Release all resources.
      */
     fun release() {
         stop()
+        warmupJob?.cancel()
+        _readiness.value = Readiness.NOT_LOADED
         if (_isModelLoaded.value) {
             piper.release()
             _isModelLoaded.value = false
+            ringAttached = false
         }
     }
 }
@@ -0,0 +1,58 @@
+package com.nova.companion.voice
+
+import android.content.Context
+import android.content.Intent
+import android.content.pm.PackageManager
+import android.os.Build
+import android.util.Log
+import com.nova.companion.tools.ContactLookupHelper
+
+/**
+ * Builds the vocabulary Whisper is biased toward: contact names and the labels of
+ * installed launcher apps. These are the words voice commands hinge on ("call
+ * Priyanka", "open Swiggy") and the ones a small Whisper model mishears most.
+ */
+object SpeechBiasVocabulary {
+
+    private const val TAG = "SpeechBiasVocabulary"
+
+    // Upper bound on phrases sent to native — the prompt only holds ~190 tokens,
+    // the rest still feed the continuation trie.
+    private const val MAX_PHRASES = 400
+
+    /**
+     * Collect bias phrases, most important first: app labels (short, few) then contacts.
+     */
+    fun collect(context: Context): List<String> {
+        val phrases = linkedMapOf<String, String>()
+        for (name in loadLauncherAppNames(context) + ContactLookupHelper.loadContactNames(context)) {
+            val key = name.lowercase()
+            if (key.length > 1 && key !in phrases) phrases[key] = name
+            if (phrases.size >= MAX_PHRASES) break
+        }
+        Log.d(TAG, "Collected ${phrases.size} bias phrases")
+        return phrases.values.toList()
+    }
+
+    private fun loadLauncherAppNames(context: Context): List<String> {
+        return try {
+            val pm = context.packageManager
+            val intent = Intent(Intent.ACTION_MAIN).addCategory(Intent.CATEGORY_LAUNCHER)
+            val activities = if (Build.VERSION.SDK_INT >= Build.VERSION_CODES.TIRAMISU) {
+                pm.queryIntentActivities(intent, PackageManager.ResolveInfoFlags.of(0))
+            } else {
+                @Suppress("DEPRECATION")
+                pm.queryIntentActivities(intent, 0)
+            }
+            activities.map { it.loadLabel(pm).toString().trim() }
+                .filter { it.isNotBlank() && !it.packageNameLike() }
+                .distinct()
+        } catch (e: Exception) {
+            Log.w(TAG, "Failed to load launcher app names", e)
+            emptyList()
+        }
+    }
+
+    // Some apps ship without a label and fall back to their package name
+    private fun String.packageNameLike(): Boolean = contains('.') && !contains(' ')
+}
@@ -1,5 +1,7 @@
 package com.nova.companion.voice
 
+import android.content.Context
+import android.media.AudioManager
 import android.os.Environment
 import android.util.Log
 import kotlinx.coroutines.*
@@ -17,21 +19,46 @@ class VoiceManager {
     companion object {
         private const val TAG = "VoiceManager"
 
-        // Default model paths (user copies these to device storage)
+        // Default model paths (user copies these to device storage). With a
+        // Context, WhisperModelSelector picks among every ggml-* model instead.
         private val WHISPER_MODEL_NAMES = listOf(
             "ggml-tiny.bin",
             "ggml-tiny.en.bin",
             "ggml-base.bin",
             "ggml-base.en.bin"
         )
-        private val PIPER_MODEL_NAMES = listOf(
-            "en_US-amy-medium.onnx",
-            "en_US-lessac-medium.onnx",
-            "en_US-amy-low.onnx",
-            "en_US-lessac-low.onnx"
+        // int8-quantized exports (<voice>.int8.onnx) are preferred: synthesis
+        // then leaves more of the CPU to the LLM. They may share the fp32 config.
+        private val PIPER_VOICES = listOf(
+            "en_US-amy-medium",
+            "en_US-lessac-medium",
+            "en_US-amy-low",
+            "en_US-lessac-low"
+        )
+        private val PIPER_MODEL_NAMES = PIPER_VOICES.flatMap { listOf("$it.int8.onnx", "$it.onnx") }
+
+        // Settings key: comma-separated Whisper language codes the user speaks
+        // ("en, hi"); empty lets auto-detection pick any language
+        const val STT_LANGUAGES_PREF = "stt_languages"
+
+        // Spoken when Whisper's confidence is too low to act on the transcript
+        private const val REASK_PROMPT = "Sorry, I didn't catch that. Could you say it again?"
+
+        // Rendered into Piper's phrase cache at startup so they play instantly
+        private val PRERENDER_PHRASES = listOf(
+            REASK_PROMPT,
+            "Done!",
+            "Okay.",
+            "Sure.",
+            "Got it.",
+            "On it.",
+            "One moment.",
+            "Here's a reminder."
         )
     }
 
+    private val cacheScope = CoroutineScope(Dispatchers.IO + SupervisorJob())
+
     // ── Voice state machine ───────────────────────────────────────
     enum class VoiceState {
         IDLE,           // Voice mode active but not doing anything
@@ -67,13 +94,15 @@ class VoiceManager {
 
     /**
      * Initialize voice models (Whisper + Piper).
-     * Searches common storage locations for model files.
+     * Searches common storage locations for model files. Given a [context],
+     * the Whisper model is the one WhisperModelSelector measured as the most
+     * accurate that runs in real time on this device (probed on first run).
      */
-    suspend fun initializeVoiceModels(): Boolean = withContext(Dispatchers.IO) {
+    suspend fun initializeVoiceModels(context: Context? = null): Boolean = withContext(Dispatchers.IO) {
         _voiceError.value = null
 
         // Find Whisper model
-        val whisperModel = findModelFile(WHISPER_MODEL_NAMES)
+        val whisperModel = findWhisperModel(context)
         if (whisperModel == null) {
             _voiceError.value = "Whisper model not found. Copy ggml-tiny.bin to Downloads/"
             Log.e(TAG, "Whisper model not found")
@@ -88,7 +117,7 @@ class VoiceManager {
             return@withContext false
         }
 
-        val piperConfig = File(piperModel.absolutePath.replace(".onnx", ".onnx.json"))
+        val piperConfig = piperConfigFor(piperModel)
         if (!piperConfig.exists()) {
             _voiceError.value = "Piper config not found: ${piperConfig.name}"
             Log.e(TAG, "Piper config not found: ${piperConfig.absolutePath}")
@@ -103,24 +132,92 @@ class VoiceManager {
             return@withContext false
         }
 
-        // Load Piper
+        // Load Piper; streamed speech is resampled natively to the device's output rate
         Log.i(TAG, "Loading Piper: ${piperModel.absolutePath}")
+        if (context != null) tts.outputSampleRate = deviceOutputRate(context)
+        findESpeakData(piperModel, context)?.let { tts.eSpeakDataDir = it }
         val piperLoaded = tts.loadModel(piperModel.absolutePath, piperConfig.absolutePath)
         if (!piperLoaded) {
             _voiceError.value = "Failed to load Piper voice model"
             return@withContext false
         }
 
+        // Phrase cache: disk tier in the app cache, fixed phrases rendered off the
+        // load path once warm-up is done (it gets the cores to itself)
+        if (context != null) tts.setCacheDirectory(File(context.cacheDir, "piper"))
+        cacheScope.launch {
+            tts.awaitReady()
+            tts.prerender(PRERENDER_PHRASES)
+        }
+
+        // Quantized voice: log which operators ONNX Runtime left in fp32
+        if (piperModel.name.endsWith(".int8.onnx")) {
+            val scratch = context?.cacheDir
+            cacheScope.launch {
+                tts.awaitReady()
+                tts.inspectQuantization(piperModel.absolutePath, scratch)
+            }
+        }
+
         _voiceModelsLoaded.value = true
         Log.i(TAG, "Voice models loaded successfully")
         true
     }
 
+    /**
+     * espeak-ng-data for the phonemizer: next to the voice (as Piper releases
+     * ship it), in app files, or in the usual model folders.
+     */
+    private fun findESpeakData(piperModel: File, context: Context?): File? {
+        val dirs = listOfNotNull(piperModel.parentFile, context?.filesDir) + modelSearchDirs()
+        return dirs.map { File(it, "espeak-ng-data") }.firstOrNull { it.isDirectory }
+            ?: null.also { Log.w(TAG, "espeak-ng-data not found; eSpeak voices can't phonemize") }
+    }
+
+    /**
+     * Config for a Piper model: <model>.onnx.json, or for an int8 export
+     * without its own config, the fp32 voice's (the quantized graph keeps
+     * the same phoneme map and audio settings).
+     */
+    private fun piperConfigFor(model: File): File {
+        val own = File(model.path + ".json")
+        if (own.exists() || !model.name.endsWith(".int8.onnx")) return own
+        val fp32 = File(model.parentFile, model.name.removeSuffix(".int8.onnx") + ".onnx.json")
+        return if (fp32.exists()) fp32 else own
+    }
+
+    /**
+     * The device's native output sample rate (typically 48000), 0 if unknown.
+     */
+    private fun deviceOutputRate(context: Context): Int {
+        val audioManager = context.getSystemService(Context.AUDIO_SERVICE) as? AudioManager ?: return 0
+        return audioManager.getProperty(AudioManager.PROPERTY_OUTPUT_SAMPLE_RATE)?.toIntOrNull() ?: 0
+    }
+
+    /**
+     * Refresh the names Whisper is biased toward (contacts + installed apps).
+     * Cheap to repeat: only phrases not seen before are tokenized natively.
+     */
+    suspend fun refreshBiasVocabulary(context: Context) = withContext(Dispatchers.IO) {
+        stt.setBiasVocabulary(SpeechBiasVocabulary.collect(context))
+    }
+
+    // Restrict "auto" detection to the Settings languages (also resets the lock)
+    private fun applyLanguageSetting(context: Context) {
+        val codes = context.getSharedPreferences("nova_settings", Context.MODE_PRIVATE)
+            .getString(STT_LANGUAGES_PREF, "").orEmpty()
+            .split(',')
+            .map { it.trim().lowercase() }
+            .filter { it.isNotEmpty() }
+        stt.configureLanguages(codes)
+        Log.i(TAG, "Speech languages: ${codes.ifEmpty { listOf("any") }.joinToString()}")
+    }
+
     /**
      * Toggle voice mode on/off.
      * When turning on, initializes voice models if not already loaded.
      */
-    suspend fun toggleVoiceMode(): Boolean {
+    suspend fun toggleVoiceMode(context: Context? = null): Boolean {
         if (_isVoiceModeEnabled.value) {
             // Turning off
             _isVoiceModeEnabled.value = false
@@ -130,9 +227,14 @@ class VoiceManager {
         } else {
             // Turning on - load models if needed
             if (!_voiceModelsLoaded.value) {
-                val loaded = initializeVoiceModels()
+                val loaded = initializeVoiceModels(context)
                 if (!loaded) return false
             }
+            // New voice session: detect the user's language again on first
+            // utterance, among the ones picked in Settings
+            if (context != null) applyLanguageSetting(context) else stt.resetLanguageSession()
+            // STT may capture without the wake word service having set these up
+            if (context != null) NativeAudioFrontend.applyPreprocessingPreference(context)
             _isVoiceModeEnabled.value = true
             _voiceState.value = VoiceState.IDLE
             return true
@@ -173,7 +275,11 @@ class VoiceManager {
             stt.transcriptionResult
                 .take(1) // Only take one result
                 .collect { text ->
-                    if (text.isNotBlank()) {
+                    if (text.isNotBlank() && stt.lastResult.value?.needsConfirmation() == true) {
+                        // Don't act on a transcript Whisper itself wasn't sure about
+                        Log.i(TAG, "Low-confidence transcript, re-asking: \"$text\"")
+                        speakResponse(REASK_PROMPT, scope)
+                    } else if (text.isNotBlank()) {
                         onTranscribed(text)
                     } else {
                         _voiceState.value = VoiceState.IDLE
@@ -212,11 +318,41 @@ class VoiceManager {
     }
 
     /**
-     * Interrupt current speech.
+     * Start speaking a response while the LLM is still generating it.
+     * Feed tokens with [appendResponseText] and call [finishResponse] when
+     * generation ends. Returns false if Piper isn't loaded; callers then
+     * speak the full text once it's done.
+     */
+    fun beginStreamingResponse(scope: CoroutineScope): Boolean {
+        if (!_voiceModelsLoaded.value || !tts.beginStream()) return false
+        _voiceState.value = VoiceState.SPEAKING
+
+        scope.launch {
+            tts.speechComplete
+                .take(1)
+                .collect {
+                    _voiceState.value = VoiceState.IDLE
+                }
+        }
+        return true
+    }
+
+    fun appendResponseText(token: String) {
+        tts.appendText(token)
+    }
+
+    fun finishResponse() {
+        tts.endStream()
+    }
+
+    /**
+     * Interrupt current speech. Synthesis is cancelled natively, so the
+     * cores are free for the next transcription at once.
      */
     fun interruptSpeech() {
         if (_voiceState.value == VoiceState.SPEAKING) {
-            tts.stop()
+            val played = tts.stop()
+            Log.i(TAG, "Speech interrupted after $played samples")
             _voiceState.value = VoiceState.IDLE
         }
     }
@@ -230,19 +366,42 @@ class VoiceManager {
         _voiceState.value = if (_isVoiceModeEnabled.value) VoiceState.IDLE else VoiceState.IDLE
     }
 
+    /**
+     * Transcribe an audio file — a voice note or recording shared to Nova.
+     * Loads Whisper first if voice mode hasn't. Files longer than one 30 s
+     * window go through the native long-form path (pipelined, overlapping
+     * windows), so minutes-long notes work and memory stays flat.
+     * @return The transcript; empty if there's no model or nothing was heard.
+     */
+    suspend fun transcribeFile(context: Context, file: File): String = withContext(Dispatchers.IO) {
+        if (!stt.isModelLoaded.value) {
+            val whisperModel = findWhisperModel(context)
+            if (whisperModel == null) {
+                _voiceError.value = "Whisper model not found. Copy ggml-tiny.bin to Downloads/"
+                return@withContext ""
+            }
+            if (!stt.loadModel(whisperModel.absolutePath)) {
+                _voiceError.value = "Failed to load Whisper model"
+                return@withContext ""
+            }
+            applyLanguageSetting(context)
+        }
+        val result = stt.transcribeFile(file.absolutePath)
+        Log.i(TAG, "Transcribed ${file.name}: ${result.durationMs} ms of audio, ${result.text.length} chars")
+        result.text
+    }
+
+    private fun findWhisperModel(context: Context?): File? = if (context != null) {
+        WhisperModelSelector.select(context, modelSearchDirs())
+    } else {
+        findModelFile(WHISPER_MODEL_NAMES)
+    }
+
     /**
      * Search common device storage locations for a model file.
      */
     private fun findModelFile(modelNames: List<String>): File? {
-        val searchDirs = listOf(
-            Environment.getExternalStoragePublicDirectory(Environment.DIRECTORY_DOWNLOADS),
-            Environment.getExternalStorageDirectory(),
-            File(Environment.getExternalStorageDirectory(), "Models"),
-            File(Environment.getExternalStorageDirectory(), "nova"),
-            File(Environment.getExternalStorageDirectory(), "nova/models"),
-        )
-
-        for (dir in searchDirs) {
+        for (dir in modelSearchDirs()) {
             if (!dir.exists() || !dir.isDirectory) continue
             for (name in modelNames) {
                 val file = File(dir, name)
@@ -255,6 +414,14 @@ class VoiceManager {
         return null
     }
 
+    private fun modelSearchDirs(): List<File> = listOf(
+        Environment.getExternalStoragePublicDirectory(Environment.DIRECTORY_DOWNLOADS),
+        Environment.getExternalStorageDirectory(),
+        File(Environment.getExternalStorageDirectory(), "Models"),
+        File(Environment.getExternalStorageDirectory(), "nova"),
+        File(Environment.getExternalStorageDirectory(), "nova/models"),
+    )
+
     /**
      * Release all voice resources.
      */
@@ -0,0 +1,84 @@
+package com.nova.companion.voice
+
+/**
+ * JNI bridge to the native voice pipeline (front end → Whisper → llama.cpp →
+ * Piper → AAudio in one engine). Prefer [NativeVoicePipeline], which handles
+ * model loading and turns native events into flows.
+ *
+ * Native methods correspond to functions in pipeline_jni.cpp, built into
+ * "nova_whisper". The LLM and TTS stages are reached from there through
+ * "nova_llama" and "nova_piper", which must be loaded with a model / voice.
+ */
+class VoicePipelineJNI {
+
+    companion object {
+        init {
+            System.loadLibrary("nova_whisper")
+        }
+
+        // Event codes returned by nextEvent (voice_pipeline.h)
+        const val EVENT_NONE = 0
+        const val EVENT_LISTENING = 1
+        const val EVENT_SPEECH_START = 2
+        const val EVENT_PARTIAL = 3
+        const val EVENT_TRANSCRIPT = 4
+        const val EVENT_TOKEN = 5
+        const val EVENT_SPEAKING = 6
+        const val EVENT_REPLY = 7
+        const val EVENT_TURN_DONE = 8
+        const val EVENT_BARGE_IN = 9
+        const val EVENT_ERROR = 10
+
+        // Results of start
+        const val START_OK = 0
+        const val START_NO_STT = -1
+        const val START_NO_LLM = -2
+        const val START_NO_TTS = -3
+        const val START_NO_MIC = -4
+        const val START_NO_SPEAKER = -5
+    }
+
+    /**
+     * Open mic and speaker and start listening for turns. Idempotent.
+     * @param systemPrompt System message of the ChatML prompt.
+     * @param language Whisper language code, or "auto".
+     * @param bargeIn Keep the mic armed while replying so speech cuts the
+     *        reply off (needs a headset or echo-cancelled capture).
+     * @return One of the START_* codes.
+     */
+    external fun start(
+        systemPrompt: String,
+        language: String,
+        stopStrings: Array<String>,
+        maxTokens: Int,
+        temperature: Float,
+        topP: Float,
+        bargeIn: Boolean
+    ): Int
+
+    /**
+     * Stop the pipeline and close the speaker. The mic stays with the front end.
+     */
+    external fun stop()
+
+    external fun isRunning(): Boolean
+
+    /**
+     * Block up to [timeoutMs] for the next pipeline event; its payload is
+     * then available from [eventText] / [eventValue].
+     * @return One of the EVENT_* codes, [EVENT_NONE] on timeout.
+     */
+    external fun nextEvent(timeoutMs: Int): Int
+
+    /** Text of the last event (partial, transcript, token, reply, error). */
+    external fun eventText(): String
+
+    /** Value of the last event (STT ms, mouth-to-ear ms, token count). */
+    external fun eventValue(): Float
+
+    /**
+     * Latency of the last turn, measured from the endpoint.
+     * @return [STT ms, first token ms, first audio ms, mouth-to-ear ms].
+     */
+    external fun getTurnLatency(): FloatArray
+}
@@ -22,6 +22,7 @@ import com.nova.companion.MainActivity
 import com.nova.companion.R
 import kotlinx.coroutines.CoroutineScope
 import kotlinx.coroutines.Dispatchers
+import kotlinx.coroutines.Job
 import kotlinx.coroutines.SupervisorJob
 import kotlinx.coroutines.cancel
 import kotlinx.coroutines.launch
@@ -30,8 +31,13 @@ import kotlinx.coroutines.flow.SharedFlow
 import kotlinx.coroutines.flow.asSharedFlow
 
 /**
- * WakeWordService — persistent foreground service that listens for the "Hey Nova" wake word
- * using Picovoice Porcupine with a custom-trained .ppn keyword file.
+ * WakeWordService — persistent foreground service that listens for the "Hey Nova" wake word.
+ *
+ * Preferred engine: the native keyword spotter in [NativeAudioFrontend], which listens on
+ * the same capture stream as the on-device VAD and Whisper, so the mic has a single owner
+ * and recording can start from audio that is already buffered. Used when
+ * hey_nova_kws.gguf is available. Otherwise falls back to Picovoice Porcupine with a
+ * custom-trained .ppn keyword file.
  *
  * When the wake word is detected, it:
  *   1. Requests audio focus
@@ -64,6 +70,11 @@ class WakeWordService : Service() {
         const val CHANNEL_ID = "nova_wake_word"
         private const val NOTIFICATION_ID = 1001
 
+        // Native keyword spotter: front-end owner name and sensitivity → threshold mapping
+        private const val FRONTEND_OWNER = "WakeWordService"
+        private const val NATIVE_THRESHOLD_MAX = 0.95f
+        private const val NATIVE_THRESHOLD_RANGE = 0.3f
+
         // Broadcast action emitted on wake word detection
         const val ACTION_WAKE_WORD_DETECTED = "com.nova.companion.WAKE_WORD_DETECTED"
 
@@ -131,6 +142,8 @@ class WakeWordService : Service() {
     // ── Internal state ──────────────────────────────────────────
 
     private var porcupineManager: PorcupineManager? = null
+    private var nativeWakeWord = false
+    private var nativeEventsJob: Job? = null
     private var audioManager: AudioManager? = null
     private var audioFocusRequest: AudioFocusRequest? = null
     private val serviceScope = CoroutineScope(Dispatchers.IO + SupervisorJob())
@@ -152,7 +165,9 @@ class WakeWordService : Service() {
     override fun onStartCommand(intent: Intent?, flags: Int, startId: Int): Int {
         Log.i(TAG, "WakeWordService starting")
         startForeground(NOTIFICATION_ID, buildNotification())
-        initPorcupine()
+        if (!nativeWakeWord && porcupineManager == null && !initNativeWakeWord()) {
+            initPorcupine()
+        }
         return START_STICKY // Restart automatically if killed by system
 
     }
@@ -160,6 +175,7 @@ class WakeWordService : Service() {
     override fun onDestroy() {
         Log.i(TAG, "WakeWordService destroyed")
         instance = null
+        releaseNativeWakeWord()
         releasePorcupine()
         abandonAudioFocus()
         serviceScope.cancel()
@@ -168,6 +184,57 @@ class WakeWordService : Service() {
 
     override fun onBind(intent: Intent?): IBinder? = null
 
+    // ── Native wake word ─────────────────────────────────────────
+
+    /**
+     * Start the native keyword spotter on the shared audio front end.
+     * @return false if the native library or the keyword model is missing.
+     */
+    private fun initNativeWakeWord(): Boolean {
+        if (!NativeAudioFrontend.isAvailable) return false
+
+        val threshold = NATIVE_THRESHOLD_MAX - NATIVE_THRESHOLD_RANGE * readSensitivity()
+        if (!NativeAudioFrontend.loadKeywordModel(applicationContext, threshold)) return false
+
+        if (!NativeAudioFrontend.acquire(FRONTEND_OWNER)) {
+            Log.e(TAG, "Native front end failed to start — falling back to Porcupine")
+            NativeAudioFrontend.release(FRONTEND_OWNER)
+            return false
+        }
+
+        nativeWakeWord = true
+        NativeAudioFrontend.applyPreprocessingPreference(applicationContext)
+        NativeAudioFrontend.setWakeWordEnabled(true)
+        nativeEventsJob = serviceScope.launch {
+            NativeAudioFrontend.events.collect { event ->
+                if (event == NativeAudioFrontend.Event.WAKE_WORD) dispatchWakeWord("native")
+            }
+        }
+        Log.i(TAG, "Native wake word started — listening for 'Hey Nova' (threshold=$threshold)")
+        updateNotification("Listening for 'Hey Nova'...")
+        return true
+    }
+
+    private fun releaseNativeWakeWord() {
+        if (!nativeWakeWord) return
+        nativeEventsJob?.cancel()
+        nativeEventsJob = null
+        NativeAudioFrontend.setWakeWordEnabled(false)
+        NativeAudioFrontend.preprocessStats()?.let {
+            Log.i(TAG, "Preprocessing: avg ${it.avgMicros}µs, max ${it.maxMicros}µs per hop " +
+                    "(${it.overBudgetHops}/${it.hops} over budget)")
+        }
+        NativeAudioFrontend.release(FRONTEND_OWNER)
+        nativeWakeWord = false
+        Log.i(TAG, "Native wake word released")
+    }
+
+    // Allow the user to override sensitivity via SharedPreferences (Settings screen).
+    private fun readSensitivity(): Float {
+        val prefs = applicationContext.getSharedPreferences("nova_settings", Context.MODE_PRIVATE)
+        return prefs.getFloat("wake_word_sensitivity", DEFAULT_SENSITIVITY).coerceIn(0.0f, 1.0f)
+    }
+
     // ── Porcupine initialization ─────────────────────────────────
 
     private fun initPorcupine() {
@@ -194,11 +261,7 @@ class WakeWordService : Service() {
             return
         }
 
-        // Allow the user to override sensitivity via SharedPreferences (Settings screen).
-
-        val prefs = applicationContext.getSharedPreferences("nova_settings", Context.MODE_PRIVATE)
-        val sensitivity = prefs.getFloat("wake_word_sensitivity", DEFAULT_SENSITIVITY)
-            .coerceIn(0.0f, 1.0f)
+        val sensitivity = readSensitivity()
 
         try {
             // Custom "Hey Nova" keyword — v4.0.0 ppn file requires Porcupine SDK 3.0.x.
@@ -229,25 +292,37 @@ class WakeWordService : Service() {
     private val WAKE_WORD_DEBOUNCE_MS = 3000L
 
     private val wakeWordCallback = PorcupineManagerCallback { keywordIndex ->
-        // Called on Porcupine's internal audio processing thread — dispatch to main
+        // Called on Porcupine's internal audio processing thread
+        dispatchWakeWord("keyword index=$keywordIndex")
+    }
+
+    // Debounce, then hand off to the main thread
+    private fun dispatchWakeWord(source: String) {
         val now = System.currentTimeMillis()
         if (now - lastWakeWordTime < WAKE_WORD_DEBOUNCE_MS) {
             Log.d(TAG, "Wake word detected but debounced (${now - lastWakeWordTime}ms since last)")
-            return@PorcupineManagerCallback
+            return
         }
         lastWakeWordTime = now
 
-        Log.i(TAG, "Wake word detected! keyword index=$keywordIndex")
+        Log.i(TAG, "Wake word detected! ($source)")
         serviceScope.launch(Dispatchers.Main) {
             onWakeWordDetected()
         }
     }
 
     /**
-     * Pause Porcupine audio processing to release the mic for ElevenLabs.
-     * Porcupine's internal AudioRecord is stopped but not destroyed.
+     * Pause wake word detection to release the mic for ElevenLabs.
+     * Porcupine's internal AudioRecord is stopped but not destroyed; the native
+     * front end suspends capture but keeps its owners and model loaded.
      */
     fun pausePorcupine() {
+        if (nativeWakeWord) {
+            NativeAudioFrontend.setWakeWordEnabled(false)
+            NativeAudioFrontend.suspendCapture()
+            Log.i(TAG, "Native wake word paused — mic released for ElevenLabs")
+            return
+        }
         try {
             porcupineManager?.stop()
             Log.i(TAG, "Porcupine paused — mic released for ElevenLabs")
@@ -260,6 +335,13 @@ class WakeWordService : Service() {
      * Resume Porcupine after ElevenLabs session ends.
      */
     fun resumePorcupine() {
+        if (nativeWakeWord) {
+            NativeAudioFrontend.resumeCapture()
+            NativeAudioFrontend.setWakeWordEnabled(true)
+            Log.i(TAG, "Native wake word resumed — listening for 'Hey Nova'")
+            updateNotification("Listening for 'Hey Nova'...")
+            return
+        }
         try {
             porcupineManager?.start()
             Log.i(TAG, "Porcupine resumed — listening for 'Hey Nova'")
@@ -272,7 +354,7 @@ class WakeWordService : Service() {
     private fun onWakeWordDetected() {
         Log.i(TAG, "Processing wake word trigger")
 
-        // 0. Pause Porcupine immediately to release mic before ElevenLabs opens AudioRecord
+        // 0. Pause detection immediately to release mic before ElevenLabs opens AudioRecord
         pausePorcupine()
 
         // 1. Vibrate the device — tactile confirmation for the user (100 ms)
@@ -1,5 +1,7 @@
 package com.nova.companion.voice
 
+import java.nio.ByteBuffer
+
 /**
  * JNI bridge to whisper.cpp native library.
  * Handles speech-to-text transcription using the Whisper tiny model.
@@ -22,11 +24,23 @@ class WhisperJNI {
      */
     external fun initContext(modelPath: String): Boolean
 
+    /**
+     * Benchmark a model on this device in a private context (the loaded one
+     * is untouched): a full 30 s encoder pass plus decoding a typical
+     * utterance. Quantized (q4/q5/q8) and f16 models are both supported.
+     * @param modelPath Absolute path to a ggml whisper model.
+     * @param nThreads Threads to benchmark with (use the transcription count).
+     * @return [loadMs, encodeMs, decodeMs, rtf, ftype, nMels] where rtf is
+     *         measured against a 5 s utterance, or null if the model fails.
+     */
+    external fun probeModel(modelPath: String, nThreads: Int): FloatArray?
+
     /**
      * Transcribe audio samples to text.
      * @param samples Float array of 16kHz mono audio samples (normalized -1.0 to 1.0).
      * @param numSamples Number of valid samples in the array.
-     * @param language Language code ("en" for English, "auto" for auto-detect).
+     * @param language Language code ("en" for English, "auto" for the session-locked
+     *        language, detected once and re-checked periodically).
      * @param translate If true, translate to English regardless of source language.
      * @return Transcribed text string.
      */
@@ -52,6 +66,114 @@ class WhisperJNI {
         callback: WhisperSegmentCallback
     ): String
 
+    /**
+     * Transcribe into a compact binary result (segments, words, timestamps,
+     * token probabilities, no-speech probability) written to a direct buffer.
+     * Avoids per-segment JNI upcalls; decode with [WhisperResult.decode].
+     * @param samples Float array of 16kHz mono audio.
+     * @param numSamples Number of valid samples. Pass 0 to re-serialize the
+     *        previous result, e.g. after growing a too-small buffer.
+     * @param language Language code.
+     * @param out Direct ByteBuffer to write into.
+     * @return Bytes written, the negated required size if [out] is too small,
+     *         or 0 on failure.
+     */
+    external fun transcribeToBuffer(
+        samples: FloatArray,
+        numSamples: Int,
+        language: String,
+        out: ByteBuffer
+    ): Int
+
+    /**
+     * Transcribe the utterance last captured by the native front end straight
+     * from the log-mel frames it computed while listening, skipping whisper's
+     * own STFT. Same result layout as [transcribeToBuffer].
+     * @param gain Amplitude gain applied to that utterance's PCM.
+     * @param language Language code.
+     * @param out Direct ByteBuffer to write into.
+     * @return Bytes written, the negated required size if [out] is too small
+     *         (re-serialize with [transcribeToBuffer] and 0 samples), or 0 if
+     *         the frames aren't available — fall back to [transcribeToBuffer].
+     */
+    external fun transcribeUtteranceToBuffer(
+        gain: Float,
+        language: String,
+        out: ByteBuffer
+    ): Int
+
+    /**
+     * Transcribe an audio file without loading it into memory: WAV (PCM or
+     * float), headerless 16 kHz s16le .pcm/.raw, or anything the platform
+     * decoder handles (OGG/Opus, M4A, MP3). Audio is resampled to 16 kHz
+     * natively; past one 30 s window, overlapping windows are decoded on two
+     * pipelined lanes — one encodes the next window while the other decodes —
+     * and stitched by word timestamps. Same result layout as [transcribeToBuffer].
+     * @param path Absolute path of a readable file.
+     * @param language Language code; "auto" uses (or establishes) the session lock.
+     * @param out Direct ByteBuffer to write into.
+     * @return Bytes written, the negated required size if [out] is too small
+     *         (re-serialize with [transcribeToBuffer] and 0 samples), or 0 on
+     *         failure. The result's duration is the decoded length.
+     */
+    external fun transcribeFileToBuffer(
+        path: String,
+        language: String,
+        out: ByteBuffer
+    ): Int
+
+    /**
+     * Quick hypothesis of the utterance the native front end is still
+     * capturing. The text also feeds the front end's endpointer, which ends
+     * the turn early once it stops changing. Don't call concurrently with
+     * another transcription — they share the whisper context.
+     * @param language Language code; "auto" reuses the session lock and
+     *        yields no partials while the session is still undetected.
+     * @return Partial text, or "" before speech has started.
+     */
+    external fun transcribePartial(language: String): String
+
+    /**
+     * Bias recognition toward a vocabulary of names (contacts, installed apps).
+     * Phrases are tokenized once and cached natively; calling this again with an
+     * updated list only tokenizes the new entries. Safe to call before the model
+     * is loaded — the prompt is built as soon as a context exists.
+     * @param phrases Names to favour, most important first.
+     * @param boost Logit boost applied to tokens that continue a phrase (0 = prompt only).
+     * @return Number of prompt tokens now fed to every transcription.
+     */
+    external fun setBiasVocabulary(phrases: Array<String>, boost: Float): Int
+
+    /**
+     * Drop the bias vocabulary and its cached tokens.
+     */
+    external fun clearBiasVocabulary()
+
+    /**
+     * Configure the session language lock used when transcribing with "auto".
+     * Detection runs once on the first confident utterance, then the decoder is
+     * locked to that language and only re-checked periodically.
+     * @param allowedLanguages Comma-separated candidates, e.g. "en,hi" for a
+     *        bilingual user. Empty allows every language the model knows.
+     * @param lockThreshold Minimum detection probability to lock or switch.
+     * @param recheckInterval Utterances between re-checks for code switching.
+     */
+    external fun configureLanguage(
+        allowedLanguages: String,
+        lockThreshold: Float,
+        recheckInterval: Int
+    )
+
+    /**
+     * Forget the locked language; the next "auto" utterance detects again.
+     */
+    external fun resetLanguageSession()
+
+    /**
+     * Language the session is locked to, or "" while still undetected.
+     */
+    external fun getSessionLanguage(): String
+
     /**
      * Check if whisper context is initialized and ready.
      */
@@ -66,6 +188,16 @@ class WhisperJNI {
      * Get the whisper.cpp version string.
      */
     external fun getVersion(): String
+
+    /**
+     * Span tracing for everything in nova_whisper (front end, Whisper, the
+     * native pipeline). Prefer [com.nova.companion.core.NativeTrace].
+     * @param mode Bits: 1 records spans for [dumpTrace], 2 forwards them to ATrace.
+     */
+    external fun setTraceMode(mode: Int)
+
+    /** Spans recorded since tracing was enabled, as comma-separated Chrome trace events. */
+    external fun dumpTrace(): String
 }
 
 /**
@@ -0,0 +1,186 @@
+package com.nova.companion.voice
+
+import android.app.ActivityManager
+import android.content.Context
+import android.os.Build
+import android.util.Log
+import java.io.File
+
+/**
+ * Picks the Whisper model for this device: the most accurate candidate on disk
+ * that still transcribes fast enough here. Speed is measured on the phone
+ * (WhisperJNI.probeModel) rather than looked up in a device list, so a
+ * flagship ends up on base/small while a budget phone gets a quantized tiny.
+ *
+ * Candidates follow whisper.cpp's file names: ggml-{tiny,base,small,medium}
+ * with an optional ".en" and an optional -q4_0/-q4_1/-q5_0/-q5_1/-q8_0
+ * suffix. The result is cached in nova_settings and only re-probed when the
+ * set of model files (or the OS build) changes.
+ */
+object WhisperModelSelector {
+
+    private const val TAG = "WhisperModelSelector"
+
+    // Transcribing a 5 s utterance should take at most ~1.5 s
+    const val TARGET_RTF = 0.3f
+
+    // Same thread count whisper_jni transcribes with
+    private const val PROBE_THREADS = 4
+
+    // Skip models that would take more than this share of device RAM
+    private const val MAX_RAM_FRACTION = 0.25
+
+    private const val PREFS_NAME = "nova_settings"
+    private const val KEY_MODEL = "whisper_model_path"
+    private const val KEY_FINGERPRINT = "whisper_model_fingerprint"
+    private const val KEY_RTF = "whisper_model_rtf"
+    // Set by the user to pin a model and skip the probe entirely
+    private const val KEY_OVERRIDE = "whisper_model_override"
+
+    private val MODEL_NAME = Regex("""ggml-(tiny|base|small|medium)(\.en)?(?:-(q4_0|q4_1|q5_0|q5_1|q8_0))?\.bin""")
+
+    enum class ModelSize { TINY, BASE, SMALL, MEDIUM }
+
+    // Ordered from least to most accurate
+    enum class Quantization { Q4_0, Q4_1, Q5_0, Q5_1, Q8_0, F16 }
+
+    data class Candidate(
+        val file: File,
+        val size: ModelSize,
+        val quantization: Quantization,
+        val englishOnly: Boolean
+    )
+
+    data class Probe(
+        val candidate: Candidate,
+        val loadMs: Float,
+        val encodeMs: Float,
+        val decodeMs: Float,
+        val rtf: Float
+    )
+
+    // Model size dominates accuracy; a quantized base still beats an f16 tiny.
+    // Multilingual before .en so the session language lock keeps working.
+    private val byAccuracy = compareByDescending<Candidate> { it.size }
+        .thenByDescending { it.quantization }
+        .thenBy { it.englishOnly }
+
+    private val jni: WhisperJNI? by lazy {
+        try {
+            WhisperJNI()
+        } catch (e: LinkageError) {
+            Log.w(TAG, "Whisper native library unavailable", e)
+            null
+        }
+    }
+
+    fun parse(file: File): Candidate? {
+        val match = MODEL_NAME.matchEntire(file.name) ?: return null
+        val (size, en, quant) = match.destructured
+        return Candidate(
+            file = file,
+            size = ModelSize.valueOf(size.uppercase()),
+            quantization = if (quant.isEmpty()) Quantization.F16 else Quantization.valueOf(quant.uppercase()),
+            englishOnly = en.isNotEmpty()
+        )
+    }
+
+    /**
+     * Every readable whisper model in [dirs], most accurate first. A file name
+     * found in several folders is only listed once (first folder wins).
+     */
+    fun findCandidates(dirs: List<File>): List<Candidate> {
+        val seen = mutableSetOf<String>()
+        val candidates = mutableListOf<Candidate>()
+        for (dir in dirs) {
+            if (!dir.isDirectory) continue
+            for (file in dir.listFiles().orEmpty()) {
+                if (!file.canRead() || !seen.add(file.name)) continue
+                parse(file)?.let { candidates.add(it) }
+            }
+        }
+        return candidates.sortedWith(byAccuracy)
+    }
+
+    /**
+     * The model to load on this device, probing candidates on first use.
+     * Blocks for a few seconds per probed model — call off the main thread.
+     * @return null if no whisper model is on disk.
+     */
+    fun select(context: Context, dirs: List<File>): File? {
+        val prefs = context.getSharedPreferences(PREFS_NAME, Context.MODE_PRIVATE)
+
+        prefs.getString(KEY_OVERRIDE, null)?.let { File(it) }?.takeIf { it.canRead() }?.let {
+            Log.i(TAG, "Using pinned whisper model: ${it.name}")
+            return it
+        }
+
+        val candidates = findCandidates(dirs)
+        if (candidates.isEmpty()) return null
+
+        val fingerprint = fingerprint(candidates)
+        val cached = prefs.getString(KEY_MODEL, null)?.let { File(it) }
+        if (cached != null && cached.canRead() && prefs.getString(KEY_FINGERPRINT, null) == fingerprint) {
+            Log.i(TAG, "Using probed whisper model: ${cached.name} (RTF ${prefs.getFloat(KEY_RTF, 0f)})")
+            return cached
+        }
+
+        val probe = choose(candidates, ramBudget(context))
+        val chosen = probe?.candidate?.file ?: candidates.last().file
+        prefs.edit()
+            .putString(KEY_MODEL, chosen.absolutePath)
+            .putString(KEY_FINGERPRINT, fingerprint)
+            .putFloat(KEY_RTF, probe?.rtf ?: 0f)
+            .apply()
+        Log.i(TAG, "Selected whisper model: ${chosen.name}" +
+                (probe?.let { " (RTF ${it.rtf}, target $TARGET_RTF)" } ?: " (unprobed)"))
+        return chosen
+    }
+
+    /**
+     * Forget the probe result; the next [select] benchmarks again.
+     */
+    fun invalidate(context: Context) {
+        context.getSharedPreferences(PREFS_NAME, Context.MODE_PRIVATE).edit()
+            .remove(KEY_MODEL)
+            .remove(KEY_FINGERPRINT)
+            .remove(KEY_RTF)
+            .apply()
+    }
+
+    // Walk from the most accurate model down and stop at the first one that
+    // meets the target; if none does, fall back to the fastest that ran.
+    private fun choose(candidates: List<Candidate>, ramBudget: Long): Probe? {
+        var fastest: Probe? = null
+        for (candidate in candidates) {
+            if (candidate.file.length() > ramBudget) {
+                Log.d(TAG, "Skipping ${candidate.file.name}: larger than the RAM budget")
+                continue
+            }
+            val probe = probe(candidate) ?: continue
+            if (probe.rtf <= TARGET_RTF) return probe
+            if (fastest == null || probe.rtf < fastest.rtf) fastest = probe
+        }
+        return fastest
+    }
+
+    private fun probe(candidate: Candidate): Probe? {
+        val values = jni?.probeModel(candidate.file.absolutePath, PROBE_THREADS) ?: return null
+        if (values.size < 4) return null
+        return Probe(candidate, values[0], values[1], values[2], values[3]).also {
+            Log.i(TAG, "Probed ${candidate.file.name}: encode ${it.encodeMs}ms, " +
+                    "decode ${it.decodeMs}ms, RTF ${it.rtf}")
+        }
+    }
+
+    private fun fingerprint(candidates: List<Candidate>): String =
+        candidates.joinToString("|", prefix = "${Build.FINGERPRINT}|") { "${it.file.absolutePath}:${it.file.length()}" }
+
+    private fun ramBudget(context: Context): Long {
+        val am = context.getSystemService(Context.ACTIVITY_SERVICE) as? ActivityManager
+            ?: return Long.MAX_VALUE
+        val info = ActivityManager.MemoryInfo()
+        am.getMemoryInfo(info)
+        return (info.totalMem * MAX_RAM_FRACTION).toLong()
+    }
+}
@@ -0,0 +1,128 @@
+package com.nova.companion.voice
+
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+
+/**
+ * Transcription with word timings and confidences, decoded from the compact
+ * binary layout written by WhisperJNI.transcribeToBuffer (see whisper_jni.cpp).
+ *
+ * Confidence signals let callers re-ask the user instead of acting on a bad
+ * transcript ("call Priyanka" misheard as "call Bianca").
+ */
+data class WhisperResult(
+    val text: String,
+    val segments: List<Segment>,
+    val words: List<Word>,
+    val durationMs: Int,
+    /** Highest no-speech probability over all decoded windows. */
+    val noSpeechProb: Float,
+    /** Mean probability of all text tokens. */
+    val avgTokenProb: Float
+) {
+
+    data class Segment(
+        val startMs: Int,
+        val endMs: Int,
+        val text: String,
+        val noSpeechProb: Float,
+        val avgTokenProb: Float,
+        val firstWord: Int,
+        val wordCount: Int
+    )
+
+    data class Word(
+        val startMs: Int,
+        val endMs: Int,
+        val text: String,
+        /** Mean probability of the word's tokens. */
+        val prob: Float,
+        /** Lowest token probability in the word. */
+        val minProb: Float
+    )
+
+    /**
+     * True when the transcript is too unreliable to act on — likely no speech,
+     * or a decode the model itself wasn't sure about.
+     */
+    fun needsConfirmation(): Boolean {
+        if (text.isBlank()) return false
+        if (noSpeechProb > NO_SPEECH_THRESHOLD && avgTokenProb < NO_SPEECH_MAX_TOKEN_PROB) return true
+        if (avgTokenProb < LOW_CONFIDENCE_THRESHOLD) return true
+        return false
+    }
+
+    companion object {
+        private const val MAGIC = 0x3152574E // "NWR1"
+        private const val VERSION = 1
+
+        // Re-ask thresholds (Whisper's own no-speech / logprob heuristics, in prob space)
+        private const val NO_SPEECH_THRESHOLD = 0.6f
+        private const val NO_SPEECH_MAX_TOKEN_PROB = 0.5f
+        private const val LOW_CONFIDENCE_THRESHOLD = 0.4f
+
+        val EMPTY = WhisperResult("", emptyList(), emptyList(), 0, 0f, 0f)
+
+        /**
+         * Decode [length] bytes from [buffer] (position 0) in a single pass.
+         * @throws IllegalArgumentException if the buffer doesn't hold a result.
+         */
+        fun decode(buffer: ByteBuffer, length: Int): WhisperResult {
+            val buf = buffer.duplicate().order(ByteOrder.LITTLE_ENDIAN)
+            buf.position(0)
+            buf.limit(length)
+
+            require(buf.int == MAGIC) { "Not a whisper result buffer" }
+            val version = buf.short.toInt()
+            require(version == VERSION) { "Unsupported whisper result version $version" }
+            buf.short // flags
+
+            val segmentCount = buf.int
+            val wordCount = buf.int
+            val textBytes = buf.int
+            val durationMs = buf.int
+            val noSpeechProb = buf.float
+            val avgTokenProb = buf.float
+
+            // Fixed-size records come first; the text blob sits at the end
+            val textStart = length - textBytes
+            val utf8 = ByteArray(textBytes)
+            buf.duplicate().also { it.position(textStart) }.get(utf8)
+
+            fun slice(offset: Int, len: Int) = String(utf8, offset, len, Charsets.UTF_8)
+
+            val segments = ArrayList<Segment>(segmentCount)
+            repeat(segmentCount) {
+                val t0 = buf.int
+                val t1 = buf.int
+                val noSpeech = buf.float
+                val prob = buf.float
+                val firstWord = buf.int
+                val nWords = buf.int
+                val offset = buf.int
+                val len = buf.int
+                segments.add(Segment(t0, t1, slice(offset, len), noSpeech, prob, firstWord, nWords))
+            }
+
+            val words = ArrayList<Word>(wordCount)
+            repeat(wordCount) {
+                val t0 = buf.int
+                val t1 = buf.int
+                val prob = buf.float
+                val minProb = buf.float
+                val offset = buf.int
+                val len = buf.int
+                words.add(Word(t0, t1, slice(offset, len), prob, minProb))
+            }
+
+            return WhisperResult(
+                text = String(utf8, Charsets.UTF_8).trim(),
+                segments = segments,
+                words = words,
+                durationMs = durationMs,
+                noSpeechProb = noSpeechProb,
+                avgTokenProb = avgTokenProb
+            )
+        }
+    }
+}
@@ -3,6 +3,10 @@ package com.nova.companion.voice
 import android.util.Log
 import kotlinx.coroutines.*
 import kotlinx.coroutines.flow.*
+import kotlinx.coroutines.sync.Mutex
+import kotlinx.coroutines.sync.withLock
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
 
 /**
  * High-level Speech-to-Text engine using whisper.cpp.
@@ -10,14 +14,40 @@ import kotlinx.coroutines.flow.*
  * Manages the AudioRecorder and WhisperJNI to provide a simple API:
  *   startListening() → records audio → auto-stops on silence → transcribes → returns text
  *
+ * While the native front end captures, partial hypotheses are decoded every
+ * few hundred ms; they update [partialText] and let the native endpointer end
+ * the turn as soon as the transcript stops changing, instead of waiting out
+ * the full silence hangover.
+ *
  * All processing is local. No internet required.
  */
 class WhisperSTT {
 
     companion object {
         private const val TAG = "WhisperSTT"
+
+        // Logit boost for continuing a bias phrase once its first token is decoded
+        const val DEFAULT_BIAS_BOOST = 2.0f
+
+        // Initial size of the native result buffer — grown on demand
+        private const val RESULT_BUFFER_BYTES = 16 * 1024
+
+        // Session language lock: detection confidence to lock/switch, and how
+        // many utterances pass between cheap re-checks for code switching
+        private const val LANGUAGE_LOCK_THRESHOLD = 0.7f
+        private const val LANGUAGE_RECHECK_INTERVAL = 8
+
+        // Pause between streaming partial decodes while recording
+        private const val PARTIAL_INTERVAL_MS = 300L
     }
 
+    /**
+     * Language passed to Whisper. "auto" uses the session lock (detected once,
+     * then fixed); set an explicit code like "en" to bypass detection entirely.
+     */
+    @Volatile
+    var language: String = "auto"
+
     private val whisper = WhisperJNI()
     val recorder = AudioRecorder()
 
@@ -35,6 +65,18 @@ class WhisperSTT {
     private val _transcriptionResult = MutableSharedFlow<String>()
     val transcriptionResult: SharedFlow<String> = _transcriptionResult.asSharedFlow()
 
+    // Detailed result (word timings + confidences) of the last transcription
+    private val _lastResult = MutableStateFlow<WhisperResult?>(null)
+    val lastResult: StateFlow<WhisperResult?> = _lastResult.asStateFlow()
+
+    // Reused across transcriptions so decoding a result allocates no native-side buffers
+    private var resultBuffer: ByteBuffer =
+        ByteBuffer.allocateDirect(RESULT_BUFFER_BYTES).order(ByteOrder.LITTLE_ENDIAN)
+
+    // Partial and final decodes share the native whisper context
+    private val decodeMutex = Mutex()
+    private var partialJob: Job? = null
+
     // Error events
     private val _error = MutableSharedFlow<String>()
     val error: SharedFlow<String> = _error.asSharedFlow()
@@ -62,9 +104,58 @@ class WhisperSTT {
         }
     }
 
+    /**
+     * Tune recognition toward names the user is likely to say ("call Priyanka",
+     * "open Swiggy"). Only new phrases are tokenized natively, so this is cheap to
+     * call again whenever contacts or installed apps change.
+     * @param phrases Names to favour, most important first.
+     * @return Number of prompt tokens the vocabulary occupies.
+     */
+    suspend fun setBiasVocabulary(
+        phrases: List<String>,
+        boost: Float = DEFAULT_BIAS_BOOST
+    ): Int = withContext(Dispatchers.IO) {
+        try {
+            val promptTokens = whisper.setBiasVocabulary(phrases.toTypedArray(), boost)
+            Log.i(TAG, "Bias vocabulary set: ${phrases.size} phrases, $promptTokens prompt tokens")
+            promptTokens
+        } catch (e: Exception) {
+            Log.e(TAG, "Failed to set bias vocabulary", e)
+            0
+        }
+    }
+
+    /**
+     * Restrict "auto" language detection to the languages this user speaks,
+     * e.g. listOf("en", "hi"); empty allows any. Resets the session lock.
+     * VoiceManager applies the Settings choice at the start of each voice session.
+     */
+    fun configureLanguages(allowed: List<String>) {
+        if (!_isModelLoaded.value) return
+        whisper.configureLanguage(
+            allowed.joinToString(","),
+            LANGUAGE_LOCK_THRESHOLD,
+            LANGUAGE_RECHECK_INTERVAL
+        )
+    }
+
+    /**
+     * Start a new language session — the next utterance is detected again.
+     */
+    fun resetLanguageSession() {
+        if (_isModelLoaded.value) whisper.resetLanguageSession()
+    }
+
+    /**
+     * Language the current session is locked to ("" until detected).
+     */
+    fun sessionLanguage(): String =
+        if (_isModelLoaded.value) whisper.getSessionLanguage() else ""
+
     /**
      * Start listening: begin recording from microphone.
-     * Will auto-stop after 3s of silence (VAD) or when stopListening() is called.
+     * Will auto-stop after 3s of silence (VAD) — sooner on the native path once
+     * the partial transcript settles — or when stopListening() is called.
      * After stopping, automatically transcribes the audio.
      *
      * @param scope CoroutineScope to launch transcription in.
@@ -89,10 +180,34 @@ class WhisperSTT {
         if (!started) {
             Log.e(TAG, "Failed to start recording")
             scope.launch { _error.emit("Failed to start microphone recording") }
+        } else if (recorder.nativeCapture) {
+            partialJob?.cancel()
+            partialJob = scope.launch(Dispatchers.Default) { decodePartials() }
         }
         return started
     }
 
+    /**
+     * Streaming hypotheses of the native utterance in progress. Each one is
+     * handed to the front end's endpointer natively; a decode that would
+     * collide with the final transcription is simply skipped.
+     */
+    private suspend fun decodePartials() {
+        while (currentCoroutineContext().isActive && recorder.isRecording.value) {
+            delay(PARTIAL_INTERVAL_MS)
+            if (!decodeMutex.tryLock()) continue
+            val text = try {
+                if (recorder.isRecording.value) whisper.transcribePartial(language) else ""
+            } catch (e: Exception) {
+                Log.w(TAG, "Partial decode failed", e)
+                ""
+            } finally {
+                decodeMutex.unlock()
+            }
+            if (text.isNotEmpty() && recorder.isRecording.value) _partialText.value = text
+        }
+    }
+
     /**
      * Stop listening manually and transcribe the recorded audio.
      * @param scope CoroutineScope to run transcription in.
@@ -120,34 +235,56 @@ class WhisperSTT {
             return
         }
 
+        partialJob?.cancel()
+        partialJob = null
         _isTranscribing.value = true
         _partialText.value = ""
 
         try {
             withContext(Dispatchers.Default) {
-                val durationSec = samples.size.toFloat() / AudioRecorder.SAMPLE_RATE
-                Log.i(TAG, "Transcribing ${durationSec}s of audio (${samples.size} samples)")
-
-                val callback = object : WhisperSegmentCallback {
-                    override fun onSegment(startMs: Long, endMs: Long, text: String) {
-                        val current = _partialText.value
-                        _partialText.value = (current + text).trim()
-                        Log.d(TAG, "Segment [${startMs}-${endMs}ms]: $text")
+                decodeMutex.withLock {
+                    val durationSec = samples.size.toFloat() / AudioRecorder.SAMPLE_RATE
+                    Log.i(TAG, "Transcribing ${durationSec}s of audio (${samples.size} samples)")
+
+                    // Native captures already have whisper's mel frames — use them
+                    // and fall back to the PCM path if they're gone
+                    val nativeGain = recorder.lastNativeGain
+                    var written = if (nativeGain != null) {
+                        whisper.transcribeUtteranceToBuffer(nativeGain, language, resultBuffer)
+                    } else {
+                        0
+                    }
+                    if (written == 0) {
+                        written = whisper.transcribeToBuffer(
+                            samples = samples,
+                            numSamples = samples.size,
+                            language = language,
+                            out = resultBuffer
+                        )
+                    }
+                    if (written < 0) {
+                        // Result is kept natively — grow the buffer and fetch it again
+                        resultBuffer = ByteBuffer.allocateDirect(-written).order(ByteOrder.LITTLE_ENDIAN)
+                        written = whisper.transcribeToBuffer(samples, 0, language, resultBuffer)
                     }
-                }
 
-                val result = whisper.transcribeWithCallback(
-                    samples = samples,
-                    numSamples = samples.size,
-                    language = "en",
-                    callback = callback
-                )
+                    val result = if (written > 0) {
+                        WhisperResult.decode(resultBuffer, written)
+                    } else {
+                        WhisperResult.EMPTY
+                    }
+                    for (segment in result.segments) {
+                        Log.d(TAG, "Segment [${segment.startMs}-${segment.endMs}ms]: ${segment.text}")
+                    }
 
-                val trimmed = result.trim()
-                Log.i(TAG, "Transcription complete: \"$trimmed\"")
+                    val trimmed = result.text
+                    Log.i(TAG, "Transcription complete: \"$trimmed\" " +
+                            "(avg p=${result.avgTokenProb}, no-speech p=${result.noSpeechProb})")
 
-                _partialText.value = trimmed
-                _transcriptionResult.emit(trimmed)
+                    _lastResult.value = result
+                    _partialText.value = trimmed
+                    _transcriptionResult.emit(trimmed)
+                }
             }
         } catch (e: Exception) {
             Log.e(TAG, "Transcription error", e)
@@ -157,19 +294,42 @@ class WhisperSTT {
         }
     }
 
+    /**
+     * Transcribe an audio file on disk (shared voice note, recording). The
+     * file is decoded, resampled to 16 kHz and fed to whisper window by
+     * window natively, so memory stays flat however long it is. WAV and raw
+     * 16 kHz .pcm are read directly; OGG/Opus, M4A and MP3 go through the
+     * platform decoder.
+     * @return The transcript, [WhisperResult.EMPTY] on failure.
+     */
+    suspend fun transcribeFile(path: String): WhisperResult = withContext(Dispatchers.IO) {
+        if (!_isModelLoaded.value) return@withContext WhisperResult.EMPTY
+        decodeMutex.withLock {
+            var written = whisper.transcribeFileToBuffer(path, language, resultBuffer)
+            if (written < 0) {
+                resultBuffer = ByteBuffer.allocateDirect(-written).order(ByteOrder.LITTLE_ENDIAN)
+                written = whisper.transcribeToBuffer(FloatArray(0), 0, language, resultBuffer)
+            }
+            if (written > 0) WhisperResult.decode(resultBuffer, written) else WhisperResult.EMPTY
+        }
+    }
+
     /**
      * Check if Whisper is ready for transcription.
      */
     fun isReady(): Boolean = _isModelLoaded.value && !_isTranscribing.value
 
     /**
-     * Release all resources.
+     * Release all resources. Blocks until a native decode still running
+     * (partial or final) has finished with the context.
      */
     fun release() {
+        partialJob?.cancel()
+        partialJob = null
         recorder.release()
         if (_isModelLoaded.value) {
-            whisper.freeContext()
             _isModelLoaded.value = false
+            runBlocking { decodeMutex.withLock { whisper.freeContext() } }
         }
     }
 }
@@ -0,0 +1,175 @@
+package com.nova.companion.voice
+
+import org.junit.Test
+import org.junit.Assert.*
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+
+/**
+ * Unit tests for WhisperResult.decode.
+ * Buffers are built here in the layout whisper_jni.cpp writes.
+ */
+class WhisperResultTest {
+
+    private class Seg(val t0: Int, val t1: Int, val noSpeech: Float, val prob: Float,
+                      val firstWord: Int, val nWords: Int, val text: String)
+
+    private class Wd(val t0: Int, val t1: Int, val prob: Float, val minProb: Float, val text: String)
+
+    /** Encode a result; segment and word text are taken from consecutive slices of the blob. */
+    private fun encode(
+        segments: List<Seg>,
+        words: List<Wd>,
+        durationMs: Int = 0,
+        noSpeechProb: Float = 0f,
+        avgTokenProb: Float = 0f,
+        magic: Int = 0x3152574E,
+        version: Int = 1,
+        padding: Int = 0
+    ): Pair<ByteBuffer, Int> {
+        val text = segments.joinToString("") { it.text }.toByteArray(Charsets.UTF_8)
+        val length = 32 + segments.size * 32 + words.size * 24 + text.size
+        val buf = ByteBuffer.allocateDirect(length + padding).order(ByteOrder.LITTLE_ENDIAN)
+        buf.putInt(magic).putShort(version.toShort()).putShort(0)
+        buf.putInt(segments.size).putInt(words.size).putInt(text.size).putInt(durationMs)
+        buf.putFloat(noSpeechProb).putFloat(avgTokenProb)
+
+        var offset = 0
+        for (s in segments) {
+            val len = s.text.toByteArray(Charsets.UTF_8).size
+            buf.putInt(s.t0).putInt(s.t1).putFloat(s.noSpeech).putFloat(s.prob)
+            buf.putInt(s.firstWord).putInt(s.nWords).putInt(offset).putInt(len)
+            offset += len
+        }
+
+        // Words are slices of their segment's text
+        val blob = String(text, Charsets.UTF_8)
+        var search = 0
+        for (w in words) {
+            val at = blob.indexOf(w.text, search)
+            val start = blob.substring(0, at).toByteArray(Charsets.UTF_8).size
+            val len = w.text.toByteArray(Charsets.UTF_8).size
+            buf.putInt(w.t0).putInt(w.t1).putFloat(w.prob).putFloat(w.minProb)
+            buf.putInt(start).putInt(len)
+            search = at + w.text.length
+        }
+        buf.put(text)
+        return buf to length
+    }
+
+    // ==================== DECODING ====================
+
+    @Test
+    fun testDecode_segmentsAndWords() {
+        val (buf, length) = encode(
+            segments = listOf(
+                Seg(0, 1200, 0.05f, 0.9f, 0, 2, " Call Priyanka."),
+                Seg(1200, 2500, 0.1f, 0.8f, 2, 2, " Then text Sam.")
+            ),
+            words = listOf(
+                Wd(0, 400, 0.95f, 0.9f, " Call"),
+                Wd(400, 1200, 0.85f, 0.6f, " Priyanka."),
+                Wd(1200, 1700, 0.8f, 0.7f, " Then"),
+                Wd(1700, 2000, 0.9f, 0.8f, " text")
+            ),
+            durationMs = 2500,
+            noSpeechProb = 0.1f,
+            avgTokenProb = 0.85f
+        )
+        val result = WhisperResult.decode(buf, length)
+
+        assertEquals("Call Priyanka. Then text Sam.", result.text)
+        assertEquals(2500, result.durationMs)
+        assertEquals(0.1f, result.noSpeechProb, 0f)
+        assertEquals(0.85f, result.avgTokenProb, 0f)
+
+        assertEquals(2, result.segments.size)
+        val second = result.segments[1]
+        assertEquals(" Then text Sam.", second.text)
+        assertEquals(1200, second.startMs)
+        assertEquals(2500, second.endMs)
+        assertEquals(2, second.firstWord)
+        assertEquals(2, second.wordCount)
+        assertEquals(0.8f, second.avgTokenProb, 0f)
+
+        assertEquals(4, result.words.size)
+        assertEquals(" Priyanka.", result.words[1].text)
+        assertEquals(0.6f, result.words[1].minProb, 0f)
+        assertEquals(" text", result.words[3].text)
+        assertEquals(1700, result.words[3].startMs)
+    }
+
+    @Test
+    fun testDecode_multiByteText() {
+        val (buf, length) = encode(
+            segments = listOf(Seg(0, 900, 0f, 0.9f, 0, 2, " Café über")),
+            words = listOf(Wd(0, 400, 0.9f, 0.9f, " Café"), Wd(400, 900, 0.9f, 0.9f, " über"))
+        )
+        val result = WhisperResult.decode(buf, length)
+        assertEquals("Café über", result.text)
+        assertEquals(" Café", result.words[0].text)
+        assertEquals(" über", result.words[1].text)
+    }
+
+    @Test
+    fun testDecode_ignoresBytesPastLength() {
+        val (buf, length) = encode(
+            segments = listOf(Seg(0, 500, 0f, 0.9f, 0, 1, " Hi")),
+            words = listOf(Wd(0, 500, 0.9f, 0.9f, " Hi")),
+            padding = 64
+        )
+        val result = WhisperResult.decode(buf, length)
+        assertEquals("Hi", result.text)
+        assertEquals(" Hi", result.words[0].text)
+    }
+
+    @Test
+    fun testDecode_empty() {
+        val (buf, length) = encode(emptyList(), emptyList())
+        val result = WhisperResult.decode(buf, length)
+        assertEquals("", result.text)
+        assertTrue(result.segments.isEmpty())
+        assertTrue(result.words.isEmpty())
+        assertFalse(result.needsConfirmation())
+    }
+
+    @Test
+    fun testDecode_leavesBufferPosition() {
+        val (buf, length) = encode(listOf(Seg(0, 500, 0f, 0.9f, 0, 0, " Hi")), emptyList())
+        buf.position(7)
+        WhisperResult.decode(buf, length)
+        assertEquals(7, buf.position())
+    }
+
+    @Test(expected = IllegalArgumentException::class)
+    fun testDecode_badMagic() {
+        val (buf, length) = encode(emptyList(), emptyList(), magic = 0x12345678)
+        WhisperResult.decode(buf, length)
+    }
+
+    @Test(expected = IllegalArgumentException::class)
+    fun testDecode_unsupportedVersion() {
+        val (buf, length) = encode(emptyList(), emptyList(), version = 2)
+        WhisperResult.decode(buf, length)
+    }
+
+    // ==================== CONFIDENCE ====================
+
+    @Test
+    fun testNeedsConfirmation_likelyNoSpeech() {
+        val result = WhisperResult("Thanks.", emptyList(), emptyList(), 1000, 0.8f, 0.3f)
+        assertTrue(result.needsConfirmation())
+    }
+
+    @Test
+    fun testNeedsConfirmation_lowConfidence() {
+        val result = WhisperResult("call bianca", emptyList(), emptyList(), 1000, 0.1f, 0.35f)
+        assertTrue(result.needsConfirmation())
+    }
+
+    @Test
+    fun testNeedsConfirmation_confident() {
+        val result = WhisperResult("call priyanka", emptyList(), emptyList(), 1000, 0.7f, 0.9f)
+        assertFalse(result.needsConfirmation())
+    }
+}